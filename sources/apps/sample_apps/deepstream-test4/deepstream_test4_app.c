@@ -13,13 +13,12 @@
 #include <glib.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
-#include <sys/timeb.h>
 
 #include "gstnvdsmeta.h"
+#include "nvds_timestamp.h"
+#include "nvds_event_meta.h"
 
 #define MAX_DISPLAY_LEN 64
-#define MAX_TIME_STAMP_LEN 32
 
 #define PGIE_CLASS_ID_VEHICLE 0
 #define PGIE_CLASS_ID_PERSON 2
@@ -32,185 +31,65 @@ gchar pgie_classes_str[4][32] = { "Vehicle", "TwoWheeler", "Person",
   "Roadsign"
 };
 
-static void generate_ts_rfc3339 (char *buf, int buf_size)
-{
-  time_t tloc;
-  struct timeb timeb_log;
-  struct tm tm_log;
-  struct timespec ts;
-  char strmsec[6]; //.nnnZ\0
-
-  clock_gettime(CLOCK_REALTIME,  &ts);
-  memcpy(&tloc, (void *)(&ts.tv_sec), sizeof(time_t));
-  gmtime_r(&tloc, &tm_log);
-  strftime(buf, buf_size,"%Y-%m-%dT%H:%M:%S", &tm_log);
-  int ms = ts.tv_nsec/1000000;
-  g_snprintf(strmsec, sizeof(strmsec),".%.3dZ", ms);
-  strncat(buf, strmsec, buf_size);
-}
-
-static gpointer meta_copy_func (gpointer data, gpointer user_data)
-{
-  NvDsEventMsgMeta *srcMeta = (NvDsEventMsgMeta *) data;
-  NvDsEventMsgMeta *dstMeta = NULL;
-
-  dstMeta = g_memdup (srcMeta, sizeof(NvDsEventMsgMeta));
-
-  if (srcMeta->ts)
-    dstMeta->ts = g_strdup (srcMeta->ts);
-
-  if (srcMeta->objSignature.size > 0) {
-    dstMeta->objSignature.signature = g_memdup (srcMeta->objSignature.signature,
-                                                srcMeta->objSignature.size);
-    dstMeta->objSignature.size = srcMeta->objSignature.size;
-  }
-
-  if (srcMeta->extMsgSize > 0) {
-    if (srcMeta->objType == NVDS_OBJECT_TYPE_VEHICLE) {
-      NvDsVehicleObject *srcObj = (NvDsVehicleObject *) srcMeta->extMsg;
-      NvDsVehicleObject *obj = (NvDsVehicleObject *) g_malloc0 (sizeof (NvDsVehicleObject));
-      if (srcObj->type)
-        obj->type = g_strdup (srcObj->type);
-      if (srcObj->make)
-        obj->make = g_strdup (srcObj->make);
-      if (srcObj->model)
-        obj->model = g_strdup (srcObj->model);
-      if (srcObj->color)
-        obj->color = g_strdup (srcObj->color);
-      if (srcObj->license)
-        obj->license = g_strdup (srcObj->license);
-      if (srcObj->region)
-        obj->region = g_strdup (srcObj->region);
-
-      dstMeta->extMsg = obj;
-      dstMeta->extMsgSize = sizeof (NvDsVehicleObject);
-    } else if (srcMeta->objType == NVDS_OBJECT_TYPE_PERSON) {
-      NvDsPersonObject *srcObj = (NvDsPersonObject *) srcMeta->extMsg;
-      NvDsPersonObject *obj = (NvDsPersonObject *) g_malloc0 (sizeof (NvDsPersonObject));
-
-      obj->age = srcObj->age;
-
-      if (srcObj->gender)
-        obj->gender = g_strdup (srcObj->gender);
-      if (srcObj->cap)
-        obj->cap = g_strdup (srcObj->cap);
-      if (srcObj->hair)
-        obj->hair = g_strdup (srcObj->hair);
-      if (srcObj->apparel)
-        obj->apparel = g_strdup (srcObj->apparel);
-    }
-  }
-
-  return dstMeta;
-}
-
-static void meta_free_func (gpointer data, gpointer user_data)
-{
-  NvDsEventMsgMeta *srcMeta = (NvDsEventMsgMeta *) data;
-
-  if (srcMeta->ts)
-    g_free (srcMeta->ts);
-
-  if (srcMeta->objSignature.size > 0) {
-    g_free (srcMeta->objSignature.signature);
-    srcMeta->objSignature.size = 0;
-  }
-
-  if (srcMeta->extMsgSize > 0) {
-    if (srcMeta->objType == NVDS_OBJECT_TYPE_VEHICLE) {
-      NvDsVehicleObject *obj = (NvDsVehicleObject *) srcMeta->extMsg;
-      if (obj->type)
-        g_free (obj->type);
-      if (obj->color)
-        g_free (obj->color);
-      if (obj->make)
-        g_free (obj->make);
-      if (obj->model)
-        g_free (obj->model);
-      if (obj->license)
-        g_free (obj->license);
-      if (obj->region)
-        g_free (obj->region);
-    } else if (srcMeta->objType == NVDS_OBJECT_TYPE_PERSON) {
-      NvDsPersonObject *obj = (NvDsPersonObject *) srcMeta->extMsg;
-
-      if (obj->gender)
-        g_free (obj->gender);
-      if (obj->cap)
-        g_free (obj->cap);
-      if (obj->hair)
-        g_free (obj->hair);
-      if (obj->apparel)
-        g_free (obj->apparel);
-    }
-    g_free (srcMeta->extMsg);
-    srcMeta->extMsgSize = 0;
-  }
-  g_free (data);
-}
+/* Event metas of the pipeline with their custom objects and strings are
+ * allocated in blocks of this arena, see nvds_event_meta.h */
+static NvDsEventMetaArena *event_meta_arena = NULL;
 
 static void
-generate_vehicle_meta (gpointer data)
+generate_vehicle_meta (NvDsEventMsgMeta *meta)
 {
-  NvDsVehicleObject *obj = (NvDsVehicleObject *) data;
-
-  obj->type = g_strdup ("sedan");
-  obj->color = g_strdup ("blue");
-  obj->make = g_strdup ("Bugatti");
-  obj->model = g_strdup ("M");
-  obj->license = g_strdup ("XX1234");
-  obj->region = g_strdup ("CA");
+  NvDsVehicleObject *obj = (NvDsVehicleObject *)
+      nvds_event_meta_alloc_ext (meta, sizeof (NvDsVehicleObject));
+
+  obj->type = nvds_event_meta_strdup (meta, "sedan");
+  obj->color = nvds_event_meta_strdup (meta, "blue");
+  obj->make = nvds_event_meta_strdup (meta, "Bugatti");
+  obj->model = nvds_event_meta_strdup (meta, "M");
+  obj->license = nvds_event_meta_strdup (meta, "XX1234");
+  obj->region = nvds_event_meta_strdup (meta, "CA");
 }
 
 static void
-generate_person_meta (gpointer data)
+generate_person_meta (NvDsEventMsgMeta *meta)
 {
-  NvDsPersonObject *obj = (NvDsPersonObject *) data;
+  NvDsPersonObject *obj = (NvDsPersonObject *)
+      nvds_event_meta_alloc_ext (meta, sizeof (NvDsPersonObject));
+
   obj->age = 45;
-  obj->cap = g_strdup ("none");
-  obj->hair = g_strdup ("black");
-  obj->gender = g_strdup ("male");
-  obj->apparel= g_strdup ("formal");
+  obj->cap = nvds_event_meta_strdup (meta, "none");
+  obj->hair = nvds_event_meta_strdup (meta, "black");
+  obj->gender = nvds_event_meta_strdup (meta, "male");
+  obj->apparel = nvds_event_meta_strdup (meta, "formal");
 }
 
 static void
-generate_event_msg_meta (gpointer data, gint class_id)
+generate_event_msg_meta (NvDsEventMsgMeta *meta, gint class_id)
 {
-  NvDsEventMsgMeta *meta = (NvDsEventMsgMeta *) data;
   meta->sensorId = 0;
   meta->placeId = 0;
   meta->moduleId = 0;
 
-  meta->ts = (gchar *) g_malloc0 (MAX_TIME_STAMP_LEN + 1);
-
-  generate_ts_rfc3339(meta->ts, MAX_TIME_STAMP_LEN);
+  /* numeric timestamp, nvmsgconv formats it without per event strftime
+   * and allocation (ts-epoch-ns=1 in dstest4_msgconv_config.txt) */
+  meta->tsEpochNs = nvds_get_epoch_ns ();
 
   /*
    * This demonstrates how to attach custom objects.
    * Any custom object as per requirement can be generated and attached
-   * like NvDsVehicleObject / NvDsPersonObject. Then that object should
-   * be handled in gst-nvmsgconv component accordingly.
+   * like NvDsVehicleObject / NvDsPersonObject in the block of the meta.
+   * Then that object should be handled in gst-nvmsgconv component
+   * accordingly.
    */
   if (class_id == PGIE_CLASS_ID_VEHICLE) {
     meta->type = NVDS_EVENT_MOVING;
     meta->objType = NVDS_OBJECT_TYPE_VEHICLE;
     meta->objClassId = PGIE_CLASS_ID_VEHICLE;
-
-    NvDsVehicleObject *obj = (NvDsVehicleObject *) g_malloc0 (sizeof (NvDsVehicleObject));
-    generate_vehicle_meta (obj);
-
-    meta->extMsg = obj;
-    meta->extMsgSize = sizeof (NvDsVehicleObject);
+    generate_vehicle_meta (meta);
   } else if (class_id == PGIE_CLASS_ID_PERSON) {
     meta->type = NVDS_EVENT_ENTRY;
     meta->objType = NVDS_OBJECT_TYPE_PERSON;
     meta->objClassId = PGIE_CLASS_ID_PERSON;
-
-    NvDsPersonObject *obj = (NvDsPersonObject *) g_malloc0 (sizeof (NvDsPersonObject));
-    generate_person_meta (obj);
-
-    meta->extMsg = obj;
-    meta->extMsgSize = sizeof (NvDsPersonObject);
+    generate_person_meta (meta);
   }
 }
 
@@ -316,18 +195,19 @@ osd_sink_pad_buffer_probe (GstPad * pad, GstPadProbeInfo * info,
              * Here message is being sent for first object every 30 frames.
              */
             NvDsMeta *gst_event_meta = NULL;
-            NvDsEventMsgMeta *msg_meta = (NvDsEventMsgMeta *) g_malloc0 (sizeof (NvDsEventMsgMeta));
+            NvDsEventMsgMeta *msg_meta = nvds_event_meta_new (event_meta_arena);
             generate_event_msg_meta (msg_meta, obj_meta->class_id);
             gst_event_meta = gst_buffer_add_nvds_meta (buf, msg_meta, NULL);
             if (gst_event_meta) {
               gst_event_meta->meta_type = NVDS_META_EVENT_MSG;
               /*
-               * Since generated event metadata has custom objects for
-               * Vehicle / Person which are allocated dynamically, we are
-               * setting copy and free function to handle those fields when
-               * metadata copy happens between two components.
+               * Generated event metadata and its custom objects for
+               * Vehicle / Person live in one arena block, copy between two
+               * components is a memcpy of the block and free returns it to
+               * the arena.
                */
-              nvds_meta_set_copy_function_full(gst_event_meta, meta_copy_func, NULL, meta_free_func);
+              nvds_meta_set_copy_function_full (gst_event_meta,
+                  nvds_event_meta_copy_func, NULL, nvds_event_meta_free_func);
             } else {
               g_print ("Error in attaching event meta to buffer\n");
             }
@@ -400,6 +280,10 @@ main (int argc, char *argv[])
   gst_init (&argc, &argv);
   loop = g_main_loop_new (NULL, FALSE);
 
+  /* a message is generated every 30 frames, a few free blocks are enough */
+  event_meta_arena = nvds_event_meta_arena_new (
+      NVDS_EVENT_META_DEFAULT_BLOCK_SIZE, 16);
+
   /* Create gstreamer elements */
   /* Create Pipeline element that will form a connection of other elements */
   pipeline = gst_pipeline_new ("dstest4-pipeline");
@@ -552,6 +436,8 @@ main (int argc, char *argv[])
   gst_element_set_state (pipeline, GST_STATE_NULL);
   g_print ("Deleting pipeline\n");
   gst_object_unref (GST_OBJECT (pipeline));
+  /* metas still referenced keep the arena alive */
+  nvds_event_meta_arena_unref (event_meta_arena);
   g_source_remove (bus_watch_id);
   g_main_loop_unref (loop);
   return 0;
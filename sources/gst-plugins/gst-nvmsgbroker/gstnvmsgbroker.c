@@ -12,6 +12,7 @@
 #include <gst/gst.h>
 #include <gst/base/gstbasesink.h>
 #include <dlfcn.h>
+#include <string.h>
 #include "gstnvmsgbroker.h"
 #include "gstnvdsmeta.h"
 #include "nvdsmeta.h"
@@ -54,15 +55,166 @@ nvds_msgapi_send_callback (void *data, NvDsMsgApiErrorType status)
   g_mutex_unlock (&self->flowLock);
 }
 
+/*
+ * Counts the callback of a send before calling the library. flowLock is
+ * not held across the call: the library may serve callbacks of earlier
+ * sends from it (e.g. while its queue is full), which take flowLock.
+ */
+static void
+gst_nvmsgbroker_add_pending_cb (GstNvMsgBroker * self)
+{
+  g_mutex_lock (&self->flowLock);
+  self->pendingCbCount++;
+  g_cond_signal (&self->flowCond);
+  g_mutex_unlock (&self->flowLock);
+}
+
+/* send failed, no callback will come */
+static void
+gst_nvmsgbroker_remove_pending_cb (GstNvMsgBroker * self)
+{
+  g_mutex_lock (&self->flowLock);
+  self->pendingCbCount--;
+  g_mutex_unlock (&self->flowLock);
+}
+
+/* max payloads of a buffer sent with one batch call */
+#define MAX_BATCH_SIZE 64
+
+/* reference to payload taken for the protocol library in zero-copy mode */
+typedef struct
+{
+  gpointer data;
+  gpointer userData;
+  NvDsMetaFreeFunc freeFunc;
+} GstNvMsgBrokerPayloadRef;
+
+static void
+nvds_msgapi_release_callback (void *data)
+{
+  GstNvMsgBrokerPayloadRef *ref = (GstNvMsgBrokerPayloadRef *) data;
+
+  if (ref->freeFunc)
+    ref->freeFunc (ref->data, ref->userData);
+  g_free (ref);
+}
+
+/*
+ * Parses "<id>:<topic>;<id>:<topic>..." into a table of topics by id, with
+ * component ids as keys if byCompId, sensor ids otherwise.
+ * Returns NULL if empty or malformed.
+ */
+static GHashTable *
+gst_nvmsgbroker_parse_topics (const gchar * str, gboolean byCompId)
+{
+  GHashTable *table;
+  gchar **entries;
+  gchar *sep;
+  gchar *end;
+  guint64 id;
+  guint i;
+
+  if (!str || !str[0])
+    return NULL;
+
+  if (byCompId)
+    table = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+  else
+    table = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  entries = g_strsplit (str, ";", -1);
+  for (i = 0; entries[i]; i++) {
+    g_strstrip (entries[i]);
+    if (!entries[i][0])
+      continue;
+
+    /* sensor ids may contain ':', topic names can't */
+    sep = g_strrstr (entries[i], ":");
+    if (!sep || sep == entries[i] || !sep[1])
+      goto error;
+    *sep = '\0';
+
+    if (byCompId) {
+      id = g_ascii_strtoull (entries[i], &end, 10);
+      if (*end || !id || id > G_MAXUINT)
+        goto error;
+      g_hash_table_insert (table, GUINT_TO_POINTER ((guint) id),
+                           g_strdup (sep + 1));
+    } else {
+      g_hash_table_insert (table, g_strdup (entries[i]), g_strdup (sep + 1));
+    }
+  }
+  g_strfreev (entries);
+
+  if (!g_hash_table_size (table)) {
+    g_hash_table_destroy (table);
+    return NULL;
+  }
+  return table;
+
+error:
+  g_strfreev (entries);
+  g_hash_table_destroy (table);
+  return NULL;
+}
+
+/*
+ * Topic of payload: by its sensor id (key), then its component id.
+ * Tables only change in NULL / READY state, while nothing is rendered.
+ */
+static gchar *
+gst_nvmsgbroker_get_topic (GstNvMsgBroker * self, NvDsPayload * payload)
+{
+  gchar keyBuf[64];
+  gchar *key;
+  gchar *topic;
+
+  if (self->sensorTopicTable && payload->key) {
+    /* key isn't necessarily null terminated */
+    key = payload->keyLen < sizeof (keyBuf) ? keyBuf :
+        (gchar *) g_malloc (payload->keyLen + 1);
+    memcpy (key, payload->key, payload->keyLen);
+    key[payload->keyLen] = '\0';
+    topic = (gchar *) g_hash_table_lookup (self->sensorTopicTable, key);
+    if (key != keyBuf)
+      g_free (key);
+    if (topic)
+      return topic;
+  }
+  if (self->compTopicTable) {
+    topic = (gchar *) g_hash_table_lookup (self->compTopicTable,
+                          GUINT_TO_POINTER (payload->componentId));
+    if (topic)
+      return topic;
+  }
+  return self->topic;
+}
+
 enum
 {
   PROP_0,
   PROP_CONNECTION_STRING,
   PROP_CONFIG_FILE,
   PROP_PROTOCOL_LIBRARY,
-  PROP_COMPONENT_ID
+  PROP_COMPONENT_ID,
+  PROP_ZERO_COPY,
+  PROP_COMP_ID_TOPICS,
+  PROP_SENSOR_TOPICS
 };
 
+/* whether element may render buffers, so topic tables can't be replaced */
+static gboolean
+gst_nvmsgbroker_is_active (GstNvMsgBroker * self)
+{
+  gboolean active;
+
+  GST_OBJECT_LOCK (self);
+  active = GST_STATE (self) > GST_STATE_READY ||
+      GST_STATE_PENDING (self) > GST_STATE_READY;
+  GST_OBJECT_UNLOCK (self);
+  return active;
+}
+
 static GstStaticPadTemplate gst_nvmsgbroker_sink_template =
 GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -141,6 +293,27 @@ gst_nvmsgbroker_class_init (GstNvMsgBrokerClass * klass)
       "\t\t\thaving this component id",
       0, G_MAXUINT, 0,
       (GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property (gobject_class, PROP_ZERO_COPY,
+      g_param_spec_boolean ("zero-copy", "Zero copy send",
+      "Hand payloads to protocol library without copy, holding a reference\n"
+      "\t\t\tuntil it is sent. Used with asynchronous send if the library\n"
+      "\t\t\tprovides nvds_msgapi_send_async_no_copy",
+      FALSE, (GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property (gobject_class, PROP_COMP_ID_TOPICS,
+      g_param_spec_string ("comp-id-topics", "Topics by component id",
+      "Topics of payloads by their component id, other payloads are sent\n"
+      "\t\t\tto topic of connection string (e.g. 1:topic1;2:topic2)",
+      NULL, (GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property (gobject_class, PROP_SENSOR_TOPICS,
+      g_param_spec_string ("sensor-topics", "Topics by sensor id",
+      "Topics of payloads by their sensor id (message key), takes\n"
+      "\t\t\tprecedence over comp-id-topics (e.g. CAM_0:topic1;CAM_1:topic2)",
+      NULL, (GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY)));
 }
 
 static void
@@ -156,8 +329,13 @@ gst_nvmsgbroker_init (GstNvMsgBroker * self)
   self->isRunning = FALSE;
   self->pendingCbCount = 0;
   self->asyncSend = TRUE;
+  self->zeroCopy = FALSE;
   self->lastError = NVDS_MSGAPI_OK;
   self->compId = 0;
+  self->compTopics = NULL;
+  self->sensorTopics = NULL;
+  self->compTopicTable = NULL;
+  self->sensorTopicTable = NULL;
 
   g_mutex_init (&self->flowLock);
   g_cond_init (&self->flowCond);
@@ -190,6 +368,37 @@ gst_nvmsgbroker_set_property (GObject * object, guint property_id,
     case PROP_COMPONENT_ID:
       self->compId = g_value_get_uint (value);
       break;
+    case PROP_ZERO_COPY:
+      self->zeroCopy = g_value_get_boolean (value);
+      break;
+    case PROP_COMP_ID_TOPICS:
+      if (gst_nvmsgbroker_is_active (self)) {
+        GST_WARNING_OBJECT (self, "comp-id-topics can only be set in NULL or "
+            "READY state");
+        break;
+      }
+      g_free (self->compTopics);
+      if (self->compTopicTable)
+        g_hash_table_destroy (self->compTopicTable);
+      self->compTopics = (gchar *) g_value_dup_string (value);
+      self->compTopicTable = gst_nvmsgbroker_parse_topics (self->compTopics, TRUE);
+      if (self->compTopics && self->compTopics[0] && !self->compTopicTable)
+        GST_WARNING_OBJECT (self, "invalid comp-id-topics %s", self->compTopics);
+      break;
+    case PROP_SENSOR_TOPICS:
+      if (gst_nvmsgbroker_is_active (self)) {
+        GST_WARNING_OBJECT (self, "sensor-topics can only be set in NULL or "
+            "READY state");
+        break;
+      }
+      g_free (self->sensorTopics);
+      if (self->sensorTopicTable)
+        g_hash_table_destroy (self->sensorTopicTable);
+      self->sensorTopics = (gchar *) g_value_dup_string (value);
+      self->sensorTopicTable = gst_nvmsgbroker_parse_topics (self->sensorTopics, FALSE);
+      if (self->sensorTopics && self->sensorTopics[0] && !self->sensorTopicTable)
+        GST_WARNING_OBJECT (self, "invalid sensor-topics %s", self->sensorTopics);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -217,6 +426,15 @@ gst_nvmsgbroker_get_property (GObject * object, guint property_id,
     case PROP_COMPONENT_ID:
       g_value_set_uint (value, self->compId);
       break;
+    case PROP_ZERO_COPY:
+      g_value_set_boolean (value, self->zeroCopy);
+      break;
+    case PROP_COMP_ID_TOPICS:
+      g_value_set_string (value, self->compTopics);
+      break;
+    case PROP_SENSOR_TOPICS:
+      g_value_set_string (value, self->sensorTopics);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -242,6 +460,13 @@ gst_nvmsgbroker_finalize (GObject * object)
   if (self->protoLib)
     g_free (self->protoLib);
 
+  g_free (self->compTopics);
+  g_free (self->sensorTopics);
+  if (self->compTopicTable)
+    g_hash_table_destroy (self->compTopicTable);
+  if (self->sensorTopicTable)
+    g_hash_table_destroy (self->sensorTopicTable);
+
   g_mutex_clear(&self->flowLock);
   g_cond_clear(&self->flowCond);
 
@@ -313,6 +538,27 @@ gst_nvmsgbroker_start (GstBaseSink * sink)
     return FALSE;
   }
 
+  /* payload key is passed to libraries which take it */
+  if (self->asyncSend)
+    self->nvds_msgapi_send_async_with_key = (nvds_msgapi_send_async_with_key_ptr)
+        dlsym (self->libHandle, "nvds_msgapi_send_async_with_key");
+  else
+    self->nvds_msgapi_send_with_key = (nvds_msgapi_send_with_key_ptr)
+        dlsym (self->libHandle, "nvds_msgapi_send_with_key");
+  self->nvds_msgapi_send_async_no_copy = NULL;
+  if (self->asyncSend && self->zeroCopy) {
+    self->nvds_msgapi_send_async_no_copy = (nvds_msgapi_send_async_no_copy_ptr)
+        dlsym (self->libHandle, "nvds_msgapi_send_async_no_copy");
+    if (!self->nvds_msgapi_send_async_no_copy)
+      GST_WARNING_OBJECT (self, "zero-copy not supported by protocol library");
+  }
+  /* payloads of a buffer are sent in one call, unless sent without copy */
+  self->nvds_msgapi_send_batch = NULL;
+  if (self->asyncSend && !self->nvds_msgapi_send_async_no_copy)
+    self->nvds_msgapi_send_batch = (nvds_msgapi_send_batch_ptr)
+        dlsym (self->libHandle, "nvds_msgapi_send_batch");
+  dlerror();
+
   self->connHandle = self->nvds_msgapi_connect (self->connStr,
                                (nvds_msgapi_connect_cb_t) nvds_msgapi_connect_callback,
                                self->configFile);
@@ -364,6 +610,55 @@ gst_nvmsgbroker_stop (GstBaseSink * sink)
   return TRUE;
 }
 
+static GstFlowReturn
+gst_nvmsgbroker_send_batch (GstNvMsgBroker * self, gchar * topic,
+    NvDsMsgApiBatchMsg * msgs, guint numMsgs)
+{
+  NvDsMsgApiErrorType err;
+
+  /* one callback for the batch */
+  gst_nvmsgbroker_add_pending_cb (self);
+  err = self->nvds_msgapi_send_batch (self->connHandle, topic, msgs,
+                                      numMsgs, nvds_msgapi_send_callback, self);
+  if (err != NVDS_MSGAPI_OK) {
+    GST_ELEMENT_ERROR (self, LIBRARY, FAILED, (NULL),
+                       ("failed to send %u messages. err(%d)", numMsgs, err));
+
+    gst_nvmsgbroker_remove_pending_cb (self);
+    return GST_FLOW_ERROR;
+  }
+  return GST_FLOW_OK;
+}
+
+/* sends gathered payloads with one batch per topic, in order per topic */
+static GstFlowReturn
+gst_nvmsgbroker_flush_batch (GstNvMsgBroker * self, NvDsMsgApiBatchMsg * msgs,
+    gchar ** topics, guint numMsgs)
+{
+  NvDsMsgApiBatchMsg group[MAX_BATCH_SIZE];
+  gchar *topic;
+  guint numGroup;
+  guint numLeft;
+  guint i;
+
+  while (numMsgs) {
+    topic = topics[0];
+    numGroup = numLeft = 0;
+    for (i = 0; i < numMsgs; i++) {
+      if (topics[i] == topic) {
+        group[numGroup++] = msgs[i];
+      } else {
+        msgs[numLeft] = msgs[i];
+        topics[numLeft++] = topics[i];
+      }
+    }
+    if (gst_nvmsgbroker_send_batch (self, topic, group, numGroup) != GST_FLOW_OK)
+      return GST_FLOW_ERROR;
+    numMsgs = numLeft;
+  }
+  return GST_FLOW_OK;
+}
+
 static GstFlowReturn
 gst_nvmsgbroker_render (GstBaseSink * sink, GstBuffer * buf)
 {
@@ -373,6 +668,11 @@ gst_nvmsgbroker_render (GstBaseSink * sink, GstBuffer * buf)
   gpointer state = NULL;
   NvDsMsgApiErrorType err;
   NvDsPayload *payload;
+  GstNvMsgBrokerPayloadRef *ref;
+  NvDsMsgApiBatchMsg msgs[MAX_BATCH_SIZE];
+  gchar *topics[MAX_BATCH_SIZE];
+  gchar *topic;
+  guint numMsgs = 0;
 
   GST_DEBUG_OBJECT (self, "render");
 
@@ -397,27 +697,80 @@ gst_nvmsgbroker_render (GstBaseSink * sink, GstBuffer * buf)
         if (self->compId && payload->componentId != self->compId)
           continue;
 
+        topic = gst_nvmsgbroker_get_topic (self, payload);
+
+        /* payloads stay attached to the buffer until batch is sent */
+        if (self->nvds_msgapi_send_batch) {
+          msgs[numMsgs].payload = (const uint8_t *) payload->payload;
+          msgs[numMsgs].nbuf = payload->payloadSize;
+          msgs[numMsgs].key = payload->key;
+          msgs[numMsgs].keylen = payload->keyLen;
+          topics[numMsgs] = topic;
+          if (++numMsgs == MAX_BATCH_SIZE) {
+            if (gst_nvmsgbroker_flush_batch (self, msgs, topics, numMsgs) != GST_FLOW_OK)
+              return GST_FLOW_ERROR;
+            numMsgs = 0;
+          }
+          continue;
+        }
+
         if (self->asyncSend) {
-          g_mutex_lock (&self->flowLock);
-          err = self->nvds_msgapi_send_async (self->connHandle, self->topic,
-                                              (uint8_t *) payload->payload,
-                                              payload->payloadSize,
-                                              nvds_msgapi_send_callback, self);
+          ref = NULL;
+          /* payload buffer is kept alive by own reference to the meta data
+           * instead of being copied by the library. Broker stops (and
+           * flushes) before the upstream converter, so references are
+           * released while the payload library is still loaded. */
+          if (self->nvds_msgapi_send_async_no_copy && meta->copyfunc) {
+            ref = g_new (GstNvMsgBrokerPayloadRef, 1);
+            ref->data = meta->copyfunc (meta->meta_data, meta->user_data);
+            ref->userData = meta->user_data;
+            ref->freeFunc = meta->freefunc;
+            if (!ref->data) {
+              g_free (ref);
+              ref = NULL;
+            }
+          }
+
+          gst_nvmsgbroker_add_pending_cb (self);
+          if (ref) {
+            NvDsPayload *refPayload = (NvDsPayload *) ref->data;
+
+            /* key is copied by the library, the one of the meta is used */
+            err = self->nvds_msgapi_send_async_no_copy (self->connHandle,
+                      topic, (uint8_t *) refPayload->payload,
+                      refPayload->payloadSize, payload->key, payload->keyLen,
+                      nvds_msgapi_send_callback, self,
+                      nvds_msgapi_release_callback, ref);
+          } else if (self->nvds_msgapi_send_async_with_key)
+            err = self->nvds_msgapi_send_async_with_key (self->connHandle,
+                      topic, (uint8_t *) payload->payload,
+                      payload->payloadSize, payload->key, payload->keyLen,
+                      nvds_msgapi_send_callback, self);
+          else
+            err = self->nvds_msgapi_send_async (self->connHandle, topic,
+                                                (uint8_t *) payload->payload,
+                                                payload->payloadSize,
+                                                nvds_msgapi_send_callback, self);
 
           if (err != NVDS_MSGAPI_OK) {
             GST_ELEMENT_ERROR (self, LIBRARY, FAILED, (NULL),
                                ("failed to send the message. err(%d)", err));
 
-            g_mutex_unlock (&self->flowLock);
+            gst_nvmsgbroker_remove_pending_cb (self);
+            /* not taken over by the library */
+            if (ref)
+              nvds_msgapi_release_callback (ref);
             return GST_FLOW_ERROR;
           }
-          self->pendingCbCount++;
-          g_cond_signal (&self->flowCond);
-          g_mutex_unlock (&self->flowLock);
         } else {
-          err = self->nvds_msgapi_send (self->connHandle, self->topic,
-                                        (uint8_t *) payload->payload,
-                                        payload->payloadSize);
+          if (self->nvds_msgapi_send_with_key)
+            err = self->nvds_msgapi_send_with_key (self->connHandle,
+                      topic, (uint8_t *) payload->payload,
+                      payload->payloadSize, payload->key, payload->keyLen);
+          else
+            err = self->nvds_msgapi_send (self->connHandle, topic,
+                                          (uint8_t *) payload->payload,
+                                          payload->payloadSize);
 
           if (err != NVDS_MSGAPI_OK) {
             GST_ELEMENT_ERROR (self, LIBRARY, FAILED, (NULL),
@@ -429,6 +782,9 @@ gst_nvmsgbroker_render (GstBaseSink * sink, GstBuffer * buf)
       }
     }
   }
+
+  if (numMsgs)
+    return gst_nvmsgbroker_flush_batch (self, msgs, topics, numMsgs);
   return GST_FLOW_OK;
 }
 
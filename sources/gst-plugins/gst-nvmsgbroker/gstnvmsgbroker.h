@@ -36,6 +36,23 @@ typedef NvDsMsgApiErrorType (*nvds_msgapi_send_async_ptr)(NvDsMsgApiHandle h_ptr
     char *topic, const uint8_t *payload, size_t nbuf,
     nvds_msgapi_send_cb_t send_callback, void *user_ptr);
 
+typedef NvDsMsgApiErrorType (*nvds_msgapi_send_with_key_ptr)(NvDsMsgApiHandle h_ptr,
+    char *topic, const uint8_t *payload, size_t nbuf, const char *key,
+    size_t keylen);
+
+typedef NvDsMsgApiErrorType (*nvds_msgapi_send_async_with_key_ptr)(NvDsMsgApiHandle h_ptr,
+    char *topic, const uint8_t *payload, size_t nbuf, const char *key,
+    size_t keylen, nvds_msgapi_send_cb_t send_callback, void *user_ptr);
+
+typedef NvDsMsgApiErrorType (*nvds_msgapi_send_async_no_copy_ptr)(NvDsMsgApiHandle h_ptr,
+    char *topic, const uint8_t *payload, size_t nbuf, const char *key,
+    size_t keylen, nvds_msgapi_send_cb_t send_callback, void *user_ptr,
+    nvds_msgapi_release_cb_t release_cb, void *release_ptr);
+
+typedef NvDsMsgApiErrorType (*nvds_msgapi_send_batch_ptr)(NvDsMsgApiHandle h_ptr,
+    char *topic, const NvDsMsgApiBatchMsg *msgs, size_t nmsgs,
+    nvds_msgapi_send_cb_t send_callback, void *user_ptr);
+
 typedef void (*nvds_msgapi_do_work_ptr) (NvDsMsgApiHandle h_ptr);
 
 typedef NvDsMsgApiErrorType (*nvds_msgapi_disconnect_ptr)(NvDsMsgApiHandle conn);
@@ -51,17 +68,28 @@ struct _GstNvMsgBroker
   gchar *connStr;
   gchar *topic;
   guint compId;
+  /* payload routing, "<id>:<topic>;..." as set and parsed per id */
+  gchar *compTopics;
+  gchar *sensorTopics;
+  GHashTable *compTopicTable;
+  GHashTable *sensorTopicTable;
   GMutex flowLock;
   GCond flowCond;
   GThread *doWorkThread;
   gboolean isRunning;
   gboolean asyncSend;
+  gboolean zeroCopy;
   gint pendingCbCount;
   NvDsMsgApiHandle connHandle;
   NvDsMsgApiErrorType lastError;
   nvds_msgapi_connect_ptr nvds_msgapi_connect;
   nvds_msgapi_send_ptr nvds_msgapi_send;
   nvds_msgapi_send_async_ptr nvds_msgapi_send_async;
+  /* optional, NULL if not provided by protocol library */
+  nvds_msgapi_send_with_key_ptr nvds_msgapi_send_with_key;
+  nvds_msgapi_send_async_with_key_ptr nvds_msgapi_send_async_with_key;
+  nvds_msgapi_send_async_no_copy_ptr nvds_msgapi_send_async_no_copy;
+  nvds_msgapi_send_batch_ptr nvds_msgapi_send_batch;
   nvds_msgapi_do_work_ptr nvds_msgapi_do_work;
   nvds_msgapi_disconnect_ptr nvds_msgapi_disconnect;
 };
@@ -13,6 +13,7 @@
 #include <gst/gst.h>
 #include <gst/base/gstbasetransform.h>
 #include <dlfcn.h>
+#include <string.h>
 #include "gstnvmsgconv.h"
 #include "nvdsmeta.h"
 #include "gstnvdsmeta.h"
@@ -21,6 +22,13 @@ GST_DEBUG_CATEGORY_STATIC (gst_nvmsgconv_debug_category);
 #define GST_CAT_DEFAULT gst_nvmsgconv_debug_category
 
 #define DEFAULT_PAYLOAD_TYPE NVDS_PAYLOAD_DEEPSTREAM
+#define DEFAULT_BATCH_FORMAT NVDS_MSG2P_BATCH_NONE
+#define DEFAULT_WORKER_THREADS 0
+#define DEFAULT_QUEUE_DEPTH 4
+#define DEFAULT_DEDUP_WINDOW 0
+#define DEFAULT_DEDUP_IOU 0.0
+#define DEFAULT_RATE_LIMIT 0.0
+#define DEFAULT_RATE_BURST 1
 
 #define GST_TYPE_NVMSGCONV_PAYLOAD_TYPE (gst_nvmsgconv_payload_get_type ())
 
@@ -32,6 +40,7 @@ gst_nvmsgconv_payload_get_type (void)
   if (qtype == 0) {
     static const GEnumValue values[] = {
       {NVDS_PAYLOAD_DEEPSTREAM, "Deepstream schema payload", "PAYLOAD_DEEPSTREAM"},
+      {NVDS_PAYLOAD_DEEPSTREAM_BINARY, "Deepstream schema compact binary payload", "PAYLOAD_DEEPSTREAM_BINARY"},
       {NVDS_PAYLOAD_RESERVED, "Reserved type", "PAYLOAD_RESERVED"},
       {NVDS_PAYLOAD_CUSTOM, "Custom schema payload", "PAYLOAD_CUSTOM"},
       {0, NULL, NULL}
@@ -42,6 +51,28 @@ gst_nvmsgconv_payload_get_type (void)
   return qtype;
 }
 
+#define GST_TYPE_NVMSGCONV_BATCH_FORMAT (gst_nvmsgconv_batch_format_get_type ())
+
+static GType
+gst_nvmsgconv_batch_format_get_type (void)
+{
+  static GType qtype = 0;
+
+  if (qtype == 0) {
+    static const GEnumValue values[] = {
+      {NVDS_MSG2P_BATCH_NONE, "One payload per event", "none"},
+      {NVDS_MSG2P_BATCH_JSON_ARRAY, "One json array payload per buffer",
+          "json-array"},
+      {NVDS_MSG2P_BATCH_FRAMED,
+          "One payload per buffer with offset table and messages", "framed"},
+      {0, NULL, NULL}
+    };
+
+    qtype = g_enum_register_static ("GstNvMsgConvBatchFormat", values);
+  }
+  return qtype;
+}
+
 static void gst_nvmsgconv_set_property (GObject * object,
     guint property_id, const GValue * value, GParamSpec * pspec);
 static void gst_nvmsgconv_get_property (GObject * object,
@@ -55,6 +86,55 @@ static gboolean gst_nvmsgconv_start (GstBaseTransform * trans);
 static gboolean gst_nvmsgconv_stop (GstBaseTransform * trans);
 static GstFlowReturn gst_nvmsgconv_transform_ip (GstBaseTransform * trans,
     GstBuffer * buf);
+static GstFlowReturn gst_nvmsgconv_generate_output (GstBaseTransform * trans,
+    GstBuffer ** outbuf);
+static gboolean gst_nvmsgconv_sink_event (GstBaseTransform * trans,
+    GstEvent * event);
+static void gst_nvmsgconv_worker (gpointer data, gpointer user_data);
+static gpointer gst_nvmsgconv_output_loop (gpointer data);
+static GstFlowReturn gst_nvmsgconv_drain (GstNvMsgConv *self, gboolean push);
+
+/**
+ * Events of a buffer being converted by worker threads.
+ */
+typedef struct _GstNvMsgConvJob GstNvMsgConvJob;
+
+typedef struct
+{
+  GstNvMsgConvJob *job;
+  guint index;
+} GstNvMsgConvTask;
+
+struct _GstNvMsgConvJob
+{
+  GstBuffer *buf;
+  GArray *events;
+  /** one payload per event, or single one for batch format. */
+  NvDsPayload **payloads;
+  GstNvMsgConvTask *tasks;
+  guint numPayloads;
+  gint remaining;
+  /** all the payloads are generated, protected by workerLock. */
+  gboolean done;
+};
+
+/**
+ * Last sent event of an object, also used as its own key.
+ */
+typedef struct
+{
+  gint sensorId;
+  gint trackingId;
+  gint type;
+  NvDsRect bbox;
+  GstClockTime ts;
+} GstNvMsgConvDedupEntry;
+
+typedef struct
+{
+  gdouble tokens;
+  GstClockTime ts;
+} GstNvMsgConvRateBucket;
 
 enum
 {
@@ -62,7 +142,19 @@ enum
   PROP_CONFIG_FILE,
   PROP_MSG2P_LIB_NAME,
   PROP_PAYLOAD_TYPE,
-  PROP_COMPONENT_ID
+  PROP_COMPONENT_ID,
+  PROP_BATCH_FORMAT,
+  PROP_POOL_HITS,
+  PROP_POOL_MISSES,
+  PROP_WORKER_THREADS,
+  PROP_QUEUE_DEPTH,
+  PROP_RELOAD_CONFIG,
+  PROP_DEDUP_WINDOW,
+  PROP_DEDUP_IOU,
+  PROP_RATE_LIMIT,
+  PROP_RATE_BURST,
+  PROP_DROPPED_DUPLICATES,
+  PROP_DROPPED_RATE_LIMITED
 };
 
 static GstStaticPadTemplate gst_nvmsgconv_src_template =
@@ -93,20 +185,224 @@ static void gst_nvmsgconv_free_meta (gpointer data, gpointer uData)
   }
 }
 
+static void gst_nvmsgconv_update_pool_stats (GstNvMsgConv *self)
+{
+  if (self->pCtx && self->msg2p_get_pool_stats)
+    self->msg2p_get_pool_stats (self->pCtx, &self->poolStats);
+}
+
+static void gst_nvmsgconv_reload_config (GstNvMsgConv *self)
+{
+  NvDsMsg2pReloadStats stats;
+
+  if (!self->pCtx || !self->msg2p_reload) {
+    GST_WARNING_OBJECT (self, "configuration can't be reloaded");
+    return;
+  }
+
+  if (!self->msg2p_reload (self->pCtx)) {
+    GST_WARNING_OBJECT (self, "reload of %s failed, keeping previous "
+        "configuration", self->configFile);
+    return;
+  }
+
+  if (self->msg2p_get_reload_stats) {
+    self->msg2p_get_reload_stats (self->pCtx, &stats);
+    GST_INFO_OBJECT (self, "reloaded %s in %" G_GINT64_FORMAT " us: %u "
+        "sensors, %u places, %u analytics modules", self->configFile,
+        stats.lastReloadTime, stats.numSensors, stats.numPlaces,
+        stats.numModules);
+  }
+}
+
+static guint gst_nvmsgconv_dedup_hash (gconstpointer key)
+{
+  const GstNvMsgConvDedupEntry *entry = (const GstNvMsgConvDedupEntry *) key;
+
+  return ((guint) entry->sensorId * 31 + (guint) entry->trackingId) * 31 +
+      (guint) entry->type;
+}
+
+static gboolean gst_nvmsgconv_dedup_equal (gconstpointer a, gconstpointer b)
+{
+  const GstNvMsgConvDedupEntry *e1 = (const GstNvMsgConvDedupEntry *) a;
+  const GstNvMsgConvDedupEntry *e2 = (const GstNvMsgConvDedupEntry *) b;
+
+  return e1->sensorId == e2->sensorId && e1->trackingId == e2->trackingId &&
+      e1->type == e2->type;
+}
+
+static gboolean gst_nvmsgconv_dedup_expired (gpointer key, gpointer value,
+    gpointer uData)
+{
+  GstNvMsgConvDedupEntry *entry = (GstNvMsgConvDedupEntry *) key;
+  GstClockTime oldest = *(GstClockTime *) uData;
+
+  return entry->ts < oldest;
+}
+
+static gdouble gst_nvmsgconv_iou (const NvDsRect *a, const NvDsRect *b)
+{
+  gint left = MAX (a->left, b->left);
+  gint top = MAX (a->top, b->top);
+  gint right = MIN (a->left + a->width, b->left + b->width);
+  gint bottom = MIN (a->top + a->height, b->top + b->height);
+  gdouble inter, uni;
+
+  if (right <= left || bottom <= top)
+    return 0.0;
+
+  inter = (gdouble) (right - left) * (bottom - top);
+  uni = (gdouble) a->width * a->height + (gdouble) b->width * b->height - inter;
+  return uni > 0 ? inter / uni : 1.0;
+}
+
+/**
+ * Decides if event should be converted. Events of an object repeated within
+ * dedupWindow are dropped unless their bbox changed more than dedupIou, then
+ * token bucket of the sensor drops events above rateLimit. Runs on streaming
+ * thread only, @a ts is running time of the buffer.
+ */
+static gboolean
+gst_nvmsgconv_filter_event (GstNvMsgConv *self, NvDsEventMsgMeta *eventMsg,
+    GstClockTime ts, guint64 *duplicates, guint64 *rateLimited)
+{
+  GstNvMsgConvDedupEntry key;
+  GstNvMsgConvDedupEntry *entry = NULL;
+  GstNvMsgConvRateBucket *bucket = NULL;
+  GstClockTime window = self->dedupWindow * GST_MSECOND;
+  // distinct untracked objects would share the key.
+  gboolean dedup = self->dedupWindow && eventMsg->trackingId > 0;
+
+  if (dedup) {
+    key.sensorId = eventMsg->sensorId;
+    key.trackingId = eventMsg->trackingId;
+    key.type = eventMsg->type;
+    entry = (GstNvMsgConvDedupEntry *) g_hash_table_lookup (
+        self->dedupEntries, &key);
+
+    // time going back (e.g. after flush) restarts deduplication.
+    if (entry && ts >= entry->ts && ts - entry->ts < window &&
+        gst_nvmsgconv_iou (&entry->bbox, &eventMsg->bbox) >= self->dedupIou) {
+      (*duplicates)++;
+      return FALSE;
+    }
+  }
+
+  if (self->rateLimit > 0) {
+    bucket = (GstNvMsgConvRateBucket *) g_hash_table_lookup (
+        self->rateBuckets, GINT_TO_POINTER (eventMsg->sensorId));
+    if (!bucket) {
+      bucket = g_new (GstNvMsgConvRateBucket, 1);
+      bucket->tokens = self->rateBurst;
+      bucket->ts = ts;
+      g_hash_table_insert (self->rateBuckets,
+          GINT_TO_POINTER (eventMsg->sensorId), bucket);
+    } else if (ts > bucket->ts) {
+      bucket->tokens = MIN (self->rateBurst, bucket->tokens +
+          self->rateLimit * (ts - bucket->ts) / GST_SECOND);
+      bucket->ts = ts;
+    } else {
+      bucket->ts = ts;
+    }
+
+    if (bucket->tokens < 1.0) {
+      (*rateLimited)++;
+      return FALSE;
+    }
+    bucket->tokens -= 1.0;
+  }
+
+  if (dedup) {
+    if (!entry) {
+      entry = g_new (GstNvMsgConvDedupEntry, 1);
+      *entry = key;
+      g_hash_table_add (self->dedupEntries, entry);
+    }
+    entry->bbox = eventMsg->bbox;
+    entry->ts = ts;
+
+    // entries older than window can't cause a drop any more.
+    if (ts > self->lastPurge + window || ts < self->lastPurge) {
+      GstClockTime oldest = ts > window ? ts - window : 0;
+
+      g_hash_table_foreach_remove (self->dedupEntries,
+          gst_nvmsgconv_dedup_expired, &oldest);
+      self->lastPurge = ts;
+    }
+  }
+  return TRUE;
+}
+
+static void gst_nvmsgconv_reset_filter (GstNvMsgConv *self)
+{
+  g_hash_table_remove_all (self->dedupEntries);
+  g_hash_table_remove_all (self->rateBuckets);
+  self->lastPurge = 0;
+}
+
 static gpointer gst_nvmsgconv_copy_meta (gpointer data, gpointer uData)
 {
   GstNvMsgConv *self = (GstNvMsgConv *) uData;
   NvDsPayload *srcPayload = (NvDsPayload *) data;
   NvDsPayload *outPayload = NULL;
 
-  if (srcPayload) {
+  if (srcPayload && self->msg2p_payload_ref) {
+    outPayload = self->msg2p_payload_ref (self->pCtx, srcPayload);
+  } else if (srcPayload) {
     outPayload = (NvDsPayload *) g_memdup (srcPayload, sizeof(NvDsPayload));
     outPayload->payload = g_memdup (srcPayload->payload, srcPayload->payloadSize);
     outPayload->payloadSize = srcPayload->payloadSize;
+    /* key is owned by payload of the library, not freed with the copy */
+    outPayload->key = NULL;
+    outPayload->keyLen = 0;
   }
   return outPayload;
 }
 
+/**
+ * Full size NvDsPayload for payload of a library built against nvdsmeta.h
+ * without key, which allocates a smaller struct. Key stays NULL.
+ */
+typedef struct
+{
+  NvDsPayload payload;
+  /** payload of the library released with this one, NULL for copies. */
+  NvDsPayload *libPayload;
+} GstNvMsgConvLegacyPayload;
+
+static GstNvMsgConvLegacyPayload *
+gst_nvmsgconv_legacy_payload_new (gpointer data, guint size, guint compId)
+{
+  GstNvMsgConvLegacyPayload *legacy = g_new0 (GstNvMsgConvLegacyPayload, 1);
+
+  legacy->payload.payload = data;
+  legacy->payload.payloadSize = size;
+  legacy->payload.componentId = compId;
+  return legacy;
+}
+
+static gpointer gst_nvmsgconv_copy_legacy_meta (gpointer data, gpointer uData)
+{
+  NvDsPayload *srcPayload = (NvDsPayload *) data;
+
+  return gst_nvmsgconv_legacy_payload_new (
+      g_memdup (srcPayload->payload, srcPayload->payloadSize),
+      srcPayload->payloadSize, srcPayload->componentId);
+}
+
+static void gst_nvmsgconv_free_legacy_meta (gpointer data, gpointer uData)
+{
+  GstNvMsgConv *self = (GstNvMsgConv *) uData;
+  GstNvMsgConvLegacyPayload *legacy = (GstNvMsgConvLegacyPayload *) data;
+
+  if (legacy->libPayload)
+    self->msg2p_release (self->pCtx, legacy->libPayload);
+  else
+    g_free (legacy->payload.payload);
+  g_free (legacy);
+}
+
 static void
 gst_nvmsgconv_class_init (GstNvMsgConvClass * klass)
 {
@@ -133,6 +429,10 @@ gst_nvmsgconv_class_init (GstNvMsgConvClass * klass)
   base_transform_class->stop = GST_DEBUG_FUNCPTR (gst_nvmsgconv_stop);
   base_transform_class->transform_ip =
       GST_DEBUG_FUNCPTR (gst_nvmsgconv_transform_ip);
+  base_transform_class->generate_output =
+      GST_DEBUG_FUNCPTR (gst_nvmsgconv_generate_output);
+  base_transform_class->sink_event =
+      GST_DEBUG_FUNCPTR (gst_nvmsgconv_sink_event);
 
   g_object_class_install_property (gobject_class, PROP_CONFIG_FILE,
       g_param_spec_string ("config", "configuration file name",
@@ -141,7 +441,9 @@ gst_nvmsgconv_class_init (GstNvMsgConvClass * klass)
 
   g_object_class_install_property (gobject_class, PROP_MSG2P_LIB_NAME,
       g_param_spec_string ("msg2p-lib", "configuration file name",
-      "Name of payload generation library with absolute path.",
+      "Name of payload generation library with absolute path.\n"
+      "\t\t\tNot needed for custom payloads from template of configuration "
+      "file.",
       NULL, (GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
   g_object_class_install_property (gobject_class, PROP_PAYLOAD_TYPE,
@@ -157,6 +459,92 @@ gst_nvmsgconv_class_init (GstNvMsgConvClass * klass)
       "\t\t\thaving this component id\n",
       0, G_MAXUINT, 0,
       (GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property (gobject_class, PROP_BATCH_FORMAT,
+      g_param_spec_enum ("batch-format", "Batch format",
+      "By default one payload is attached for each event.\n"
+      "\t\t\tOtherwise all the events of a buffer are converted in\n"
+      "\t\t\tsingle payload of this format",
+      GST_TYPE_NVMSGCONV_BATCH_FORMAT, DEFAULT_BATCH_FORMAT,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_WORKER_THREADS,
+      g_param_spec_uint ("worker-threads", "Worker threads",
+      "Number of threads generating payloads. By default payloads are\n"
+      "\t\t\tgenerated on streaming thread. Otherwise buffers are pushed\n"
+      "\t\t\tin order once their payloads are ready. Converter library\n"
+      "\t\t\tshould be thread safe. Not supported with delta-encoding",
+      0, 64, DEFAULT_WORKER_THREADS,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_QUEUE_DEPTH,
+      g_param_spec_uint ("queue-depth", "Queue depth",
+      "Max number of buffers waiting for payloads with worker-threads.\n"
+      "\t\t\tStreaming thread waits once this limit is reached",
+      1, G_MAXUINT, DEFAULT_QUEUE_DEPTH,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_RELOAD_CONFIG,
+      g_param_spec_boolean ("reload-config", "Reload configuration",
+      "Setting TRUE re-reads sensor, place and analytics entries of config\n"
+      "\t\t\tfile without stopping the pipeline",
+      FALSE,
+      (GParamFlags) (G_PARAM_WRITABLE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING)));
+
+  g_object_class_install_property (gobject_class, PROP_DEDUP_WINDOW,
+      g_param_spec_uint ("dedup-window", "Deduplication window",
+      "Events with same sensor id, tracking id and type as one converted\n"
+      "\t\t\twithin this many milliseconds are dropped. Events of\n"
+      "\t\t\tuntracked objects (tracking id 0 or -1) are kept. 0 disables",
+      0, G_MAXUINT, DEFAULT_DEDUP_WINDOW,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_DEDUP_IOU,
+      g_param_spec_double ("dedup-iou", "Deduplication IoU threshold",
+      "Repeated event within dedup-window is still converted if IoU of its\n"
+      "\t\t\tbbox with the last converted one is below this. 0 drops\n"
+      "\t\t\tregardless of bbox",
+      0.0, 1.0, DEFAULT_DEDUP_IOU,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_RATE_LIMIT,
+      g_param_spec_double ("rate-limit", "Rate limit",
+      "Max events per second converted for each sensor id, events above\n"
+      "\t\t\tthe limit are dropped. 0 disables",
+      0.0, G_MAXDOUBLE, DEFAULT_RATE_LIMIT,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_RATE_BURST,
+      g_param_spec_uint ("rate-burst", "Rate limit burst",
+      "Number of events of a sensor converted back to back before\n"
+      "\t\t\trate-limit applies",
+      1, G_MAXUINT, DEFAULT_RATE_BURST,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_DROPPED_DUPLICATES,
+      g_param_spec_uint64 ("dropped-duplicates", "Dropped duplicates",
+      "Number of events dropped by dedup-window",
+      0, G_MAXUINT64, 0,
+      (GParamFlags) (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property (gobject_class, PROP_DROPPED_RATE_LIMITED,
+      g_param_spec_uint64 ("dropped-rate-limited", "Dropped by rate limit",
+      "Number of events dropped by rate-limit",
+      0, G_MAXUINT64, 0,
+      (GParamFlags) (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property (gobject_class, PROP_POOL_HITS,
+      g_param_spec_uint64 ("pool-hits", "Payload pool hits",
+      "Number of payloads generated in a reused buffer",
+      0, G_MAXUINT64, 0,
+      (GParamFlags) (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property (gobject_class, PROP_POOL_MISSES,
+      g_param_spec_uint64 ("pool-misses", "Payload pool misses",
+      "Number of payloads which needed a new buffer",
+      0, G_MAXUINT64, 0,
+      (GParamFlags) (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
 }
 
 static void
@@ -166,8 +554,35 @@ gst_nvmsgconv_init (GstNvMsgConv * self)
   self->msg2pLib = NULL;
   self->configFile = NULL;
   self->paylodType = DEFAULT_PAYLOAD_TYPE;
+  self->batchFormat = DEFAULT_BATCH_FORMAT;
+  self->events = g_array_new (FALSE, FALSE, sizeof (NvDsEvent));
   self->libHandle = NULL;
   self->compId = 0;
+  self->msg2p_payload_ref = NULL;
+  self->msg2p_get_pool_stats = NULL;
+  self->msg2p_reload = NULL;
+  self->msg2p_get_reload_stats = NULL;
+  self->msg2p_needs_ordered_generation = NULL;
+  self->legacyPayload = FALSE;
+  memset (&self->poolStats, 0, sizeof (self->poolStats));
+  self->workerThreads = DEFAULT_WORKER_THREADS;
+  self->queueDepth = DEFAULT_QUEUE_DEPTH;
+  self->workerPool = NULL;
+  self->pendingJobs = g_queue_new ();
+  self->outputThread = NULL;
+  g_mutex_init (&self->workerLock);
+  g_cond_init (&self->workerCond);
+  self->dedupWindow = DEFAULT_DEDUP_WINDOW;
+  self->dedupIou = DEFAULT_DEDUP_IOU;
+  self->rateLimit = DEFAULT_RATE_LIMIT;
+  self->rateBurst = DEFAULT_RATE_BURST;
+  self->dedupEntries = g_hash_table_new_full (gst_nvmsgconv_dedup_hash,
+      gst_nvmsgconv_dedup_equal, g_free, NULL);
+  self->rateBuckets = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+      NULL, g_free);
+  self->lastPurge = 0;
+  self->droppedDuplicates = 0;
+  self->droppedRateLimited = 0;
   self->dsMetaQuark = g_quark_from_static_string (NVDS_META_STRING);
 }
 
@@ -196,6 +611,31 @@ gst_nvmsgconv_set_property (GObject * object, guint property_id,
     case PROP_COMPONENT_ID:
       self->compId = g_value_get_uint (value);
       break;
+    case PROP_BATCH_FORMAT:
+      self->batchFormat = (NvDsMsg2pBatchFormat) g_value_get_enum (value);
+      break;
+    case PROP_WORKER_THREADS:
+      self->workerThreads = g_value_get_uint (value);
+      break;
+    case PROP_QUEUE_DEPTH:
+      self->queueDepth = g_value_get_uint (value);
+      break;
+    case PROP_DEDUP_WINDOW:
+      self->dedupWindow = g_value_get_uint (value);
+      break;
+    case PROP_DEDUP_IOU:
+      self->dedupIou = g_value_get_double (value);
+      break;
+    case PROP_RATE_LIMIT:
+      self->rateLimit = g_value_get_double (value);
+      break;
+    case PROP_RATE_BURST:
+      self->rateBurst = g_value_get_uint (value);
+      break;
+    case PROP_RELOAD_CONFIG:
+      if (g_value_get_boolean (value))
+        gst_nvmsgconv_reload_config (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -223,6 +663,45 @@ gst_nvmsgconv_get_property (GObject * object, guint property_id,
     case PROP_COMPONENT_ID:
       g_value_set_uint (value, self->compId);
       break;
+    case PROP_BATCH_FORMAT:
+      g_value_set_enum (value, self->batchFormat);
+      break;
+    case PROP_WORKER_THREADS:
+      g_value_set_uint (value, self->workerThreads);
+      break;
+    case PROP_QUEUE_DEPTH:
+      g_value_set_uint (value, self->queueDepth);
+      break;
+    case PROP_DEDUP_WINDOW:
+      g_value_set_uint (value, self->dedupWindow);
+      break;
+    case PROP_DEDUP_IOU:
+      g_value_set_double (value, self->dedupIou);
+      break;
+    case PROP_RATE_LIMIT:
+      g_value_set_double (value, self->rateLimit);
+      break;
+    case PROP_RATE_BURST:
+      g_value_set_uint (value, self->rateBurst);
+      break;
+    case PROP_DROPPED_DUPLICATES:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, self->droppedDuplicates);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_DROPPED_RATE_LIMITED:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, self->droppedRateLimited);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_POOL_HITS:
+      gst_nvmsgconv_update_pool_stats (self);
+      g_value_set_uint64 (value, self->poolStats.hits);
+      break;
+    case PROP_POOL_MISSES:
+      gst_nvmsgconv_update_pool_stats (self);
+      g_value_set_uint64 (value, self->poolStats.misses);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -239,6 +718,13 @@ gst_nvmsgconv_finalize (GObject * object)
   if (self->configFile)
     g_free (self->configFile);
 
+  g_array_free (self->events, TRUE);
+  g_hash_table_destroy (self->dedupEntries);
+  g_hash_table_destroy (self->rateBuckets);
+  g_queue_free (self->pendingJobs);
+  g_mutex_clear (&self->workerLock);
+  g_cond_clear (&self->workerCond);
+
   G_OBJECT_CLASS (gst_nvmsgconv_parent_class)->finalize (object);
 }
 
@@ -258,38 +744,58 @@ gst_nvmsgconv_start (GstBaseTransform * trans)
 {
   GstNvMsgConv *self = GST_NVMSGCONV (trans);
   gchar *error;
+  nvds_msg2p_get_payload_version_ptr get_payload_version;
 
   GST_DEBUG_OBJECT (self, "start");
 
-  if (self->paylodType == NVDS_PAYLOAD_CUSTOM) {
-    if (self->msg2pLib == NULL) {
-      GST_ELEMENT_ERROR (self, RESOURCE, NOT_FOUND, (NULL),
-                         ("No converter library for custom payload type"));
+  /* without converter library, custom payloads come from template of
+   * configuration file */
+  if (self->paylodType == NVDS_PAYLOAD_CUSTOM && self->msg2pLib) {
+    self->libHandle = dlopen(self->msg2pLib, RTLD_LAZY);
+    if (!self->libHandle) {
+      GST_ELEMENT_ERROR (self, LIBRARY, INIT, (NULL),
+                         ("unable to open converter library"));
       return FALSE;
-    } else {
-      self->libHandle = dlopen(self->msg2pLib, RTLD_LAZY);
-      if (!self->libHandle) {
-        GST_ELEMENT_ERROR (self, LIBRARY, INIT, (NULL),
-                           ("unable to open converter library"));
-        return FALSE;
-      }
+    }
 
-      dlerror();    /* Clear any existing error */
-      self->ctx_create = (nvds_msg2p_ctx_create_ptr) dlsym (self->libHandle, "nvds_msg2p_ctx_create");
-      self->ctx_destroy = (nvds_msg2p_ctx_destroy_ptr) dlsym (self->libHandle, "nvds_msg2p_ctx_destroy");
-      self->msg2p_generate = (nvds_msg2p_generate_ptr) dlsym (self->libHandle, "nvds_msg2p_generate");
-      self->msg2p_release = (nvds_msg2p_release_ptr) dlsym (self->libHandle, "nvds_msg2p_release");
+    dlerror();    /* Clear any existing error */
+    self->ctx_create = (nvds_msg2p_ctx_create_ptr) dlsym (self->libHandle, "nvds_msg2p_ctx_create");
+    self->ctx_destroy = (nvds_msg2p_ctx_destroy_ptr) dlsym (self->libHandle, "nvds_msg2p_ctx_destroy");
+    self->msg2p_generate = (nvds_msg2p_generate_ptr) dlsym (self->libHandle, "nvds_msg2p_generate");
+    self->msg2p_release = (nvds_msg2p_release_ptr) dlsym (self->libHandle, "nvds_msg2p_release");
+    if (self->batchFormat != NVDS_MSG2P_BATCH_NONE)
+      self->msg2p_generate_batch = (nvds_msg2p_generate_batch_ptr) dlsym (self->libHandle, "nvds_msg2p_generate_batch");
 
-      if ((error = dlerror()) != NULL) {
-        GST_ERROR_OBJECT (self, "%s", error);
-        return FALSE;
-      }
+    if ((error = dlerror()) != NULL) {
+      GST_ERROR_OBJECT (self, "%s", error);
+      return FALSE;
     }
+
+    self->msg2p_payload_ref = (nvds_msg2p_payload_ref_ptr) dlsym (self->libHandle, "nvds_msg2p_payload_ref");
+    self->msg2p_get_pool_stats = (nvds_msg2p_get_pool_stats_ptr) dlsym (self->libHandle, "nvds_msg2p_get_pool_stats");
+    self->msg2p_reload = (nvds_msg2p_reload_ptr) dlsym (self->libHandle, "nvds_msg2p_reload");
+    self->msg2p_get_reload_stats = (nvds_msg2p_get_reload_stats_ptr) dlsym (self->libHandle, "nvds_msg2p_get_reload_stats");
+    get_payload_version = (nvds_msg2p_get_payload_version_ptr) dlsym (self->libHandle, "nvds_msg2p_get_payload_version");
+    self->msg2p_needs_ordered_generation = (nvds_msg2p_needs_ordered_generation_ptr) dlsym (self->libHandle, "nvds_msg2p_needs_ordered_generation");
+    dlerror();    /* optional symbols */
+
+    /* library built against nvdsmeta.h without key of NvDsPayload */
+    self->legacyPayload = !get_payload_version ||
+        get_payload_version () < NVDS_MSG2P_PAYLOAD_VERSION;
+    if (self->legacyPayload)
+      GST_INFO_OBJECT (self, "payloads of %s have no key", self->msg2pLib);
   } else {
     self->ctx_create = (nvds_msg2p_ctx_create_ptr) nvds_msg2p_ctx_create;
     self->ctx_destroy = (nvds_msg2p_ctx_destroy_ptr) nvds_msg2p_ctx_destroy;
     self->msg2p_generate = (nvds_msg2p_generate_ptr) nvds_msg2p_generate;
     self->msg2p_release = (nvds_msg2p_release_ptr) nvds_msg2p_release;
+    self->msg2p_generate_batch = (nvds_msg2p_generate_batch_ptr) nvds_msg2p_generate_batch;
+    self->msg2p_payload_ref = (nvds_msg2p_payload_ref_ptr) nvds_msg2p_payload_ref;
+    self->msg2p_get_pool_stats = (nvds_msg2p_get_pool_stats_ptr) nvds_msg2p_get_pool_stats;
+    self->msg2p_reload = (nvds_msg2p_reload_ptr) nvds_msg2p_reload;
+    self->msg2p_get_reload_stats = (nvds_msg2p_get_reload_stats_ptr) nvds_msg2p_get_reload_stats;
+    self->msg2p_needs_ordered_generation = (nvds_msg2p_needs_ordered_generation_ptr) nvds_msg2p_needs_ordered_generation;
+    self->legacyPayload = FALSE;
   }
 
   self->pCtx = self->ctx_create (self->configFile, self->paylodType);
@@ -302,6 +808,47 @@ gst_nvmsgconv_start (GstBaseTransform * trans)
     GST_ERROR_OBJECT (self, "unable to create instance");
     return FALSE;
   }
+
+  /* e.g. delta-encoding numbers messages in generation order, which worker
+   * threads don't keep */
+  if (self->workerThreads && self->msg2p_needs_ordered_generation &&
+      self->msg2p_needs_ordered_generation (self->pCtx)) {
+    GST_ELEMENT_ERROR (self, RESOURCE, SETTINGS, (NULL),
+        ("configuration of converter needs worker-threads=0"));
+    self->ctx_destroy (self->pCtx);
+    self->pCtx = NULL;
+    if (self->libHandle) {
+      dlclose (self->libHandle);
+      self->libHandle = NULL;
+    }
+    return FALSE;
+  }
+
+  if (self->workerThreads) {
+    GError *error = NULL;
+
+    self->workerPool = g_thread_pool_new (gst_nvmsgconv_worker, self,
+                           self->workerThreads, TRUE, &error);
+    if (!self->workerPool) {
+      GST_ERROR_OBJECT (self, "unable to create worker threads: %s",
+          error->message);
+      g_clear_error (&error);
+      self->ctx_destroy (self->pCtx);
+      self->pCtx = NULL;
+      if (self->libHandle) {
+        dlclose (self->libHandle);
+        self->libHandle = NULL;
+      }
+      return FALSE;
+    }
+
+    self->outputRunning = TRUE;
+    self->pushingJob = FALSE;
+    self->discardJobs = FALSE;
+    self->outputRet = GST_FLOW_OK;
+    self->outputThread = g_thread_new ("nvmsgconv_output",
+                             gst_nvmsgconv_output_loop, self);
+  }
   return TRUE;
 }
 
@@ -312,7 +859,24 @@ gst_nvmsgconv_stop (GstBaseTransform * trans)
 
   GST_DEBUG_OBJECT (self, "stop");
 
+  if (self->workerPool) {
+    gst_nvmsgconv_drain (self, FALSE);
+    g_thread_pool_free (self->workerPool, FALSE, TRUE);
+    self->workerPool = NULL;
+
+    g_mutex_lock (&self->workerLock);
+    self->outputRunning = FALSE;
+    g_cond_broadcast (&self->workerCond);
+    g_mutex_unlock (&self->workerLock);
+    g_thread_join (self->outputThread);
+    self->outputThread = NULL;
+  }
+
   if (self->pCtx) {
+    gst_nvmsgconv_update_pool_stats (self);
+    GST_INFO_OBJECT (self, "payload pool hits %" G_GUINT64_FORMAT
+        " misses %" G_GUINT64_FORMAT, self->poolStats.hits,
+        self->poolStats.misses);
     self->ctx_destroy (self->pCtx);
     self->pCtx = NULL;
   }
@@ -322,20 +886,68 @@ gst_nvmsgconv_stop (GstBaseTransform * trans)
     self->libHandle = NULL;
   }
 
+  GST_INFO_OBJECT (self, "dropped %" G_GUINT64_FORMAT " duplicates, %"
+      G_GUINT64_FORMAT " events above rate limit", self->droppedDuplicates,
+      self->droppedRateLimited);
+  gst_nvmsgconv_reset_filter (self);
+
   return TRUE;
 }
 
-static GstFlowReturn
-gst_nvmsgconv_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
+static void
+gst_nvmsgconv_attach_payload (GstNvMsgConv *self, GstBuffer *buf,
+    NvDsPayload *payload)
+{
+  NvDsMeta *meta = NULL;
+  GstNvMsgConvLegacyPayload *legacy;
+
+  payload->componentId = self->compId;
+  if (self->legacyPayload) {
+    legacy = gst_nvmsgconv_legacy_payload_new (payload->payload,
+        payload->payloadSize, self->compId);
+    legacy->libPayload = payload;
+    meta = gst_buffer_add_nvds_meta (buf, legacy, NULL);
+    if (meta) {
+      meta->meta_type = NVDS_META_PAYLOAD;
+      nvds_meta_set_copy_function_full (meta,
+                      (NvDsMetaCopyFunc) gst_nvmsgconv_copy_legacy_meta, self,
+                      (NvDsMetaFreeFunc) gst_nvmsgconv_free_legacy_meta);
+    }
+    return;
+  }
+
+  meta = gst_buffer_add_nvds_meta (buf, payload, NULL);
+  if (meta) {
+    meta->meta_type = NVDS_META_PAYLOAD;
+    nvds_meta_set_copy_function_full (meta,
+                    (NvDsMetaCopyFunc) gst_nvmsgconv_copy_meta, self,
+                    (NvDsMetaFreeFunc) gst_nvmsgconv_free_meta);
+  }
+}
+
+/**
+ * Collects event messages of @a buf which should be converted by this
+ * element into @a events, dropping duplicates and events above rate limit.
+ */
+static void
+gst_nvmsgconv_collect_events (GstNvMsgConv *self, GstBuffer *buf,
+    GArray *events)
 {
-  GstNvMsgConv *self = GST_NVMSGCONV (trans);
-  NvDsPayload *payload = NULL;
   NvDsEventMsgMeta *eventMsg = NULL;
   NvDsMeta *meta = NULL;
   GstMeta *gstMeta = NULL;
   gpointer state = NULL;
+  gboolean filter = self->dedupWindow || self->rateLimit > 0;
+  GstClockTime ts = 0;
+  guint64 duplicates = 0;
+  guint64 rateLimited = 0;
 
-  GST_DEBUG_OBJECT (self, "transform_ip");
+  if (filter) {
+    ts = gst_segment_to_running_time (&GST_BASE_TRANSFORM (self)->segment,
+        GST_FORMAT_TIME, GST_BUFFER_PTS (buf));
+    if (!GST_CLOCK_TIME_IS_VALID (ts))
+      ts = g_get_monotonic_time () * GST_USECOND;
+  }
 
   while ((gstMeta = gst_buffer_iterate_meta (buf, &state))) {
      if (gst_meta_api_type_has_tag (gstMeta->info->api, self->dsMetaQuark)) {
@@ -347,28 +959,271 @@ gst_nvmsgconv_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
          if (self->compId && eventMsg->componentId != self->compId)
            continue;
 
+         if (filter && !gst_nvmsgconv_filter_event (self, eventMsg, ts,
+                 &duplicates, &rateLimited))
+           continue;
+
          //should eventType be separate field of NvDsEvent?
          event.eventType = eventMsg->type;
          event.metadata = eventMsg;
-
-         payload = self->msg2p_generate (self->pCtx, &event, 1);
-
-         if (payload) {
-           payload->componentId = self->compId;
-           meta = gst_buffer_add_nvds_meta (buf, payload, NULL);
-           if (meta) {
-             meta->meta_type = NVDS_META_PAYLOAD;
-             nvds_meta_set_copy_function_full (meta,
-                             (NvDsMetaCopyFunc) gst_nvmsgconv_copy_meta, self,
-                             (NvDsMetaFreeFunc) gst_nvmsgconv_free_meta);
-           }
-         }
+         g_array_append_val (events, event);
        }
      }
    }
+
+  if (duplicates || rateLimited) {
+    GST_OBJECT_LOCK (self);
+    self->droppedDuplicates += duplicates;
+    self->droppedRateLimited += rateLimited;
+    GST_OBJECT_UNLOCK (self);
+  }
+}
+
+static GstFlowReturn
+gst_nvmsgconv_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
+{
+  GstNvMsgConv *self = GST_NVMSGCONV (trans);
+  NvDsPayload *payload = NULL;
+  guint i;
+
+  GST_DEBUG_OBJECT (self, "transform_ip");
+
+  g_array_set_size (self->events, 0);
+  gst_nvmsgconv_collect_events (self, buf, self->events);
+
+  if (!self->events->len)
+    return GST_FLOW_OK;
+
+  if (self->batchFormat != NVDS_MSG2P_BATCH_NONE) {
+    // all the events of buffer in single payload.
+    payload = self->msg2p_generate_batch (self->pCtx,
+                  (NvDsEvent *) self->events->data, self->events->len,
+                  self->batchFormat);
+    if (payload)
+      gst_nvmsgconv_attach_payload (self, buf, payload);
+    return GST_FLOW_OK;
+  }
+
+  for (i = 0; i < self->events->len; i++) {
+    payload = self->msg2p_generate (self->pCtx,
+                  &g_array_index (self->events, NvDsEvent, i), 1);
+    if (payload)
+      gst_nvmsgconv_attach_payload (self, buf, payload);
+  }
   return GST_FLOW_OK;
 }
 
+static void
+gst_nvmsgconv_worker (gpointer data, gpointer user_data)
+{
+  GstNvMsgConvTask *task = (GstNvMsgConvTask *) data;
+  GstNvMsgConvJob *job = task->job;
+  GstNvMsgConv *self = GST_NVMSGCONV (user_data);
+
+  if (self->batchFormat != NVDS_MSG2P_BATCH_NONE)
+    job->payloads[0] = self->msg2p_generate_batch (self->pCtx,
+                           (NvDsEvent *) job->events->data, job->events->len,
+                           self->batchFormat);
+  else
+    job->payloads[task->index] = self->msg2p_generate (self->pCtx,
+        &g_array_index (job->events, NvDsEvent, task->index), 1);
+
+  if (g_atomic_int_dec_and_test (&job->remaining)) {
+    g_mutex_lock (&self->workerLock);
+    job->done = TRUE;
+    g_cond_broadcast (&self->workerCond);
+    g_mutex_unlock (&self->workerLock);
+  }
+}
+
+static void
+gst_nvmsgconv_free_job (GstNvMsgConvJob *job)
+{
+  g_array_free (job->events, TRUE);
+  g_free (job->payloads);
+  g_free (job->tasks);
+  g_free (job);
+}
+
+/**
+ * Attaches payloads of completed @a job to its buffer in event order and
+ * returns the buffer.
+ */
+static GstBuffer *
+gst_nvmsgconv_finish_job (GstNvMsgConv *self, GstNvMsgConvJob *job)
+{
+  GstBuffer *buf = job->buf;
+  guint i;
+
+  for (i = 0; i < job->numPayloads; i++) {
+    if (job->payloads[i])
+      gst_nvmsgconv_attach_payload (self, buf, job->payloads[i]);
+  }
+  gst_nvmsgconv_free_job (job);
+  return buf;
+}
+
+/**
+ * Pushes buffers of pending jobs downstream in arrival order as soon as their
+ * payloads are generated. Buffers are discarded while draining without push
+ * or after a push failed.
+ */
+static gpointer
+gst_nvmsgconv_output_loop (gpointer data)
+{
+  GstNvMsgConv *self = (GstNvMsgConv *) data;
+  GstNvMsgConvJob *job = NULL;
+  GstBuffer *buf = NULL;
+  GstFlowReturn ret;
+  gboolean discard;
+
+  g_mutex_lock (&self->workerLock);
+  while (TRUE) {
+    job = (GstNvMsgConvJob *) g_queue_peek_head (self->pendingJobs);
+    if (!job && !self->outputRunning)
+      break;
+    if (!job || !job->done) {
+      g_cond_wait (&self->workerCond, &self->workerLock);
+      continue;
+    }
+
+    g_queue_pop_head (self->pendingJobs);
+    self->pushingJob = TRUE;
+    discard = self->discardJobs || self->outputRet != GST_FLOW_OK;
+    g_mutex_unlock (&self->workerLock);
+
+    buf = gst_nvmsgconv_finish_job (self, job);
+    if (discard) {
+      gst_buffer_unref (buf);
+      ret = GST_FLOW_OK;
+    } else {
+      ret = gst_pad_push (GST_BASE_TRANSFORM_SRC_PAD (self), buf);
+    }
+
+    g_mutex_lock (&self->workerLock);
+    if (ret != GST_FLOW_OK && self->outputRet == GST_FLOW_OK)
+      self->outputRet = ret;
+    self->pushingJob = FALSE;
+    g_cond_broadcast (&self->workerCond);
+  }
+  g_mutex_unlock (&self->workerLock);
+
+  return NULL;
+}
+
+/**
+ * Waits until buffers of all the pending jobs left the element. Buffers are
+ * pushed downstream in order if @a push is TRUE, otherwise discarded.
+ */
+static GstFlowReturn
+gst_nvmsgconv_drain (GstNvMsgConv *self, gboolean push)
+{
+  GstFlowReturn ret;
+
+  g_mutex_lock (&self->workerLock);
+  if (!push)
+    self->discardJobs = TRUE;
+  while (!g_queue_is_empty (self->pendingJobs) || self->pushingJob)
+    g_cond_wait (&self->workerCond, &self->workerLock);
+  self->discardJobs = FALSE;
+  ret = self->outputRet;
+  g_mutex_unlock (&self->workerLock);
+
+  return ret;
+}
+
+/*
+ * Input buffers are taken by the default submit_input_buffer, which handles
+ * QoS and discontinuities, and handed to worker threads here. Output thread
+ * pushes them, so no buffer is returned.
+ */
+static GstFlowReturn
+gst_nvmsgconv_generate_output (GstBaseTransform * trans, GstBuffer ** outbuf)
+{
+  GstNvMsgConv *self = GST_NVMSGCONV (trans);
+  GstNvMsgConvJob *job = NULL;
+  GstBuffer *buf = NULL;
+  GstFlowReturn ret;
+  GError *error = NULL;
+  guint i;
+
+  if (!self->workerPool)
+    return GST_BASE_TRANSFORM_CLASS (gst_nvmsgconv_parent_class)->
+        generate_output (trans, outbuf);
+
+  *outbuf = NULL;
+  buf = trans->queued_buf;
+  trans->queued_buf = NULL;
+  if (!buf)
+    return GST_FLOW_OK;
+
+  // wait for room in the queue, stop on failed push.
+  g_mutex_lock (&self->workerLock);
+  while (g_queue_get_length (self->pendingJobs) >= self->queueDepth &&
+      self->outputRet == GST_FLOW_OK)
+    g_cond_wait (&self->workerCond, &self->workerLock);
+  ret = self->outputRet;
+  g_mutex_unlock (&self->workerLock);
+
+  if (ret != GST_FLOW_OK) {
+    gst_buffer_unref (buf);
+    return ret;
+  }
+
+  job = g_new0 (GstNvMsgConvJob, 1);
+  job->buf = gst_buffer_make_writable (buf);
+  job->events = g_array_new (FALSE, FALSE, sizeof (NvDsEvent));
+  gst_nvmsgconv_collect_events (self, job->buf, job->events);
+
+  if (job->events->len)
+    job->numPayloads =
+        self->batchFormat != NVDS_MSG2P_BATCH_NONE ? 1 : job->events->len;
+
+  job->payloads = g_new0 (NvDsPayload *, job->numPayloads);
+  job->tasks = g_new0 (GstNvMsgConvTask, job->numPayloads);
+  job->remaining = job->numPayloads;
+  job->done = job->numPayloads == 0;
+
+  g_mutex_lock (&self->workerLock);
+  g_queue_push_tail (self->pendingJobs, job);
+  g_cond_broadcast (&self->workerCond);
+  g_mutex_unlock (&self->workerLock);
+
+  for (i = 0; i < job->numPayloads; i++) {
+    job->tasks[i].job = job;
+    job->tasks[i].index = i;
+    if (!g_thread_pool_push (self->workerPool, &job->tasks[i], &error)) {
+      GST_WARNING_OBJECT (self, "unable to queue payload generation: %s",
+          error->message);
+      g_clear_error (&error);
+      gst_nvmsgconv_worker (&job->tasks[i], self);
+    }
+  }
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+gst_nvmsgconv_sink_event (GstBaseTransform * trans, GstEvent * event)
+{
+  GstNvMsgConv *self = GST_NVMSGCONV (trans);
+
+  if (self->workerPool) {
+    // buffers queued before serialized event should go downstream first.
+    if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP) {
+      gst_nvmsgconv_drain (self, FALSE);
+      g_mutex_lock (&self->workerLock);
+      self->outputRet = GST_FLOW_OK;
+      g_mutex_unlock (&self->workerLock);
+    }
+    else if (GST_EVENT_IS_SERIALIZED (event))
+      gst_nvmsgconv_drain (self, TRUE);
+  }
+
+  return GST_BASE_TRANSFORM_CLASS (gst_nvmsgconv_parent_class)->
+      sink_event (trans, event);
+}
+
 static gboolean
 plugin_init (GstPlugin * plugin)
 {
@@ -32,8 +32,23 @@ typedef void (*nvds_msg2p_ctx_destroy_ptr) (NvDsMsg2pCtx *ctx);
 
 typedef NvDsPayload* (*nvds_msg2p_generate_ptr) (NvDsMsg2pCtx *ctx, NvDsEvent *events, guint size);
 
+typedef NvDsPayload* (*nvds_msg2p_generate_batch_ptr) (NvDsMsg2pCtx *ctx,
+    NvDsEvent *events, guint size, NvDsMsg2pBatchFormat format);
+
 typedef void (*nvds_msg2p_release_ptr) (NvDsMsg2pCtx *ctx, NvDsPayload *payload);
 
+typedef NvDsPayload* (*nvds_msg2p_payload_ref_ptr) (NvDsMsg2pCtx *ctx, NvDsPayload *payload);
+
+typedef void (*nvds_msg2p_get_pool_stats_ptr) (NvDsMsg2pCtx *ctx, NvDsMsg2pPoolStats *stats);
+
+typedef gboolean (*nvds_msg2p_reload_ptr) (NvDsMsg2pCtx *ctx);
+
+typedef void (*nvds_msg2p_get_reload_stats_ptr) (NvDsMsg2pCtx *ctx, NvDsMsg2pReloadStats *stats);
+
+typedef guint (*nvds_msg2p_get_payload_version_ptr) (void);
+
+typedef gboolean (*nvds_msg2p_needs_ordered_generation_ptr) (NvDsMsg2pCtx *ctx);
+
 struct _GstNvMsgConv
 {
   GstBaseTransform parent;
@@ -44,12 +59,66 @@ struct _GstNvMsgConv
   gpointer libHandle;
   guint compId;
   NvDsPayloadType paylodType;
+  NvDsMsg2pBatchFormat batchFormat;
   NvDsMsg2pCtx *pCtx;
+  /** events of current buffer, used when batchFormat is set. */
+  GArray *events;
+  /** payload pool counters, kept after context is destroyed. */
+  NvDsMsg2pPoolStats poolStats;
+
+  /** number of serializer threads, 0 converts on streaming thread. */
+  guint workerThreads;
+  /** max number of buffers waiting for conversion. */
+  guint queueDepth;
+  GThreadPool *workerPool;
+  /** GstNvMsgConvJob of buffers in arrival order. */
+  GQueue *pendingJobs;
+  GMutex workerLock;
+  GCond workerCond;
+  /** pushes buffers of completed jobs, state below protected by workerLock. */
+  GThread *outputThread;
+  gboolean outputRunning;
+  /** buffer of a popped job is being pushed. */
+  gboolean pushingJob;
+  /** pending buffers are dropped instead of pushed. */
+  gboolean discardJobs;
+  /** first failed push, returned to upstream until flush. */
+  GstFlowReturn outputRet;
+
+  /** events of same sensor, object and type within this time (ms) are
+   * dropped as duplicates, 0 disables. */
+  guint dedupWindow;
+  /** repeated event is sent anyway if IoU of its bbox with last sent one is
+   * below this. */
+  gdouble dedupIou;
+  /** max events per second of each sensor, 0 disables. */
+  gdouble rateLimit;
+  guint rateBurst;
+  /** GstNvMsgConvDedupEntry of last sent event of each object. */
+  GHashTable *dedupEntries;
+  /** GstNvMsgConvRateBucket of each sensor id. */
+  GHashTable *rateBuckets;
+  GstClockTime lastPurge;
+  /** drop counters, protected by object lock. */
+  guint64 droppedDuplicates;
+  guint64 droppedRateLimited;
 
   nvds_msg2p_ctx_create_ptr ctx_create;
   nvds_msg2p_ctx_destroy_ptr ctx_destroy;
   nvds_msg2p_generate_ptr msg2p_generate;
+  nvds_msg2p_generate_batch_ptr msg2p_generate_batch;
   nvds_msg2p_release_ptr msg2p_release;
+  /** optional for custom library, payload is copied if not available. */
+  nvds_msg2p_payload_ref_ptr msg2p_payload_ref;
+  nvds_msg2p_get_pool_stats_ptr msg2p_get_pool_stats;
+  /** optional, configuration can't be reloaded if not available. */
+  nvds_msg2p_reload_ptr msg2p_reload;
+  nvds_msg2p_get_reload_stats_ptr msg2p_get_reload_stats;
+  /** optional, generation is assumed to be unordered if not available. */
+  nvds_msg2p_needs_ordered_generation_ptr msg2p_needs_ordered_generation;
+  /** payloads of custom library lack key and keyLen (no
+   * nvds_msg2p_get_payload_version), attached in a full size copy. */
+  gboolean legacyPayload;
 };
 
 struct _GstNvMsgConvClass
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/**
+ * @file
+ * <b>NVIDIA DeepStream: Event metadata arena</b>
+ *
+ * @b Description: Allocation of NvDsEventMsgMeta in single blocks. The
+ * meta, its extMsg object, signature and all the strings are carved out of
+ * one block of fixed size taken from a per-pipeline arena, so an event
+ * costs one allocation (none once the arena has free blocks), copy is one
+ * memcpy plus fix-up of the pointers into the block and free returns the
+ * block to the arena.
+ *
+ * @code
+ *   arena = nvds_event_meta_arena_new (NVDS_EVENT_META_DEFAULT_BLOCK_SIZE, 64);
+ *
+ *   meta = nvds_event_meta_new (arena);
+ *   meta->objType = NVDS_OBJECT_TYPE_VEHICLE;
+ *   obj = (NvDsVehicleObject *) nvds_event_meta_alloc_ext (meta,
+ *                                              sizeof (NvDsVehicleObject));
+ *   obj->make = nvds_event_meta_strdup (meta, "Bugatti");
+ *   ...
+ *   nvds_meta_set_copy_function_full (gst_meta, nvds_event_meta_copy_func,
+ *                                     NULL, nvds_event_meta_free_func);
+ *
+ *   nvds_event_meta_arena_unref (arena);
+ * @endcode
+ *
+ * Pointers of the meta and of the leading strings of vehicle, person and
+ * face objects are relocated on copy when they point into the block,
+ * other pointers are copied as is. Custom extMsg objects allocated in the
+ * block must not point into it. Blocks keep the arena alive, it is freed
+ * once unreferenced by its owner and all the metas are freed.
+ */
+
+#ifndef _NVDS_EVENT_META_H_
+#define _NVDS_EVENT_META_H_
+
+#include <glib.h>
+#include <string.h>
+#include "nvdsmeta.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** block size fitting meta, an ext object and a few hundred string bytes. */
+#define NVDS_EVENT_META_DEFAULT_BLOCK_SIZE 1024
+
+#define NVDS_EVENT_META_ALIGN 8
+
+typedef struct _NvDsEventMetaBlock NvDsEventMetaBlock;
+
+typedef struct _NvDsEventMetaArena {
+  /** owner and metas in use. */
+  gint refCount;
+  /** size of blocks including their header. */
+  gsize blockSize;
+  /** max number of free blocks kept. */
+  guint maxFree;
+  GMutex lock;
+  NvDsEventMetaBlock *freeList;
+  guint numFree;
+} NvDsEventMetaArena;
+
+struct _NvDsEventMetaBlock {
+  NvDsEventMetaArena *arena;
+  /** next free block, while in free list. */
+  NvDsEventMetaBlock *next;
+  /** bytes of the block in use, from its start. */
+  gsize used;
+  NvDsEventMsgMeta meta;
+};
+
+static inline NvDsEventMetaBlock *
+nvds_event_meta_get_block (const NvDsEventMsgMeta *meta)
+{
+  return (NvDsEventMetaBlock *) ((const gchar *) meta -
+                                 G_STRUCT_OFFSET (NvDsEventMetaBlock, meta));
+}
+
+/**
+ * Creates arena of blocks of @a blockSize bytes, keeping up to @a maxFree
+ * freed blocks for reuse. Thread safe.
+ */
+static inline NvDsEventMetaArena *
+nvds_event_meta_arena_new (gsize blockSize, guint maxFree)
+{
+  NvDsEventMetaArena *arena = g_new0 (NvDsEventMetaArena, 1);
+
+  arena->refCount = 1;
+  arena->blockSize = MAX (blockSize, sizeof (NvDsEventMetaBlock));
+  arena->maxFree = maxFree;
+  g_mutex_init (&arena->lock);
+  return arena;
+}
+
+/**
+ * Releases reference of the owner (or of a meta). Arena and its free blocks
+ * are freed with the last reference.
+ */
+static inline void
+nvds_event_meta_arena_unref (NvDsEventMetaArena *arena)
+{
+  NvDsEventMetaBlock *block;
+
+  if (!g_atomic_int_dec_and_test (&arena->refCount))
+    return;
+
+  while ((block = arena->freeList)) {
+    arena->freeList = block->next;
+    g_free (block);
+  }
+  g_mutex_clear (&arena->lock);
+  g_free (arena);
+}
+
+/**
+ * Allocates zeroed meta from @a arena.
+ */
+static inline NvDsEventMsgMeta *
+nvds_event_meta_new (NvDsEventMetaArena *arena)
+{
+  NvDsEventMetaBlock *block;
+
+  g_mutex_lock (&arena->lock);
+  block = arena->freeList;
+  if (block) {
+    arena->freeList = block->next;
+    arena->numFree--;
+  }
+  g_mutex_unlock (&arena->lock);
+
+  if (!block)
+    block = (NvDsEventMetaBlock *) g_malloc (arena->blockSize);
+
+  g_atomic_int_inc (&arena->refCount);
+  block->arena = arena;
+  block->next = NULL;
+  block->used = sizeof (NvDsEventMetaBlock);
+  memset (&block->meta, 0, sizeof (block->meta));
+  return &block->meta;
+}
+
+/**
+ * Returns block of @a meta to its arena.
+ */
+static inline void
+nvds_event_meta_free (NvDsEventMsgMeta *meta)
+{
+  NvDsEventMetaBlock *block = nvds_event_meta_get_block (meta);
+  NvDsEventMetaArena *arena = block->arena;
+
+  g_mutex_lock (&arena->lock);
+  if (arena->numFree < arena->maxFree) {
+    block->next = arena->freeList;
+    arena->freeList = block;
+    arena->numFree++;
+    block = NULL;
+  }
+  g_mutex_unlock (&arena->lock);
+
+  g_free (block);
+  nvds_event_meta_arena_unref (arena);
+}
+
+/**
+ * Reserves @a size zeroed bytes aligned to @a align in block of @a meta.
+ *
+ * @return NULL if the block is full.
+ */
+static inline gpointer
+nvds_event_meta_alloc (NvDsEventMsgMeta *meta, gsize size, gsize align)
+{
+  NvDsEventMetaBlock *block = nvds_event_meta_get_block (meta);
+  gsize offset = (block->used + align - 1) & ~(align - 1);
+  gchar *ptr;
+
+  if (offset > block->arena->blockSize ||
+      size > block->arena->blockSize - offset) {
+    g_warning ("Event meta block of %" G_GSIZE_FORMAT " bytes is full",
+               block->arena->blockSize);
+    return NULL;
+  }
+
+  ptr = (gchar *) block + offset;
+  block->used = offset + size;
+  memset (ptr, 0, size);
+  return ptr;
+}
+
+/**
+ * Allocates zeroed extMsg object of @a size in block of @a meta and sets
+ * extMsg / extMsgSize.
+ */
+static inline gpointer
+nvds_event_meta_alloc_ext (NvDsEventMsgMeta *meta, gsize size)
+{
+  meta->extMsg = nvds_event_meta_alloc (meta, size, NVDS_EVENT_META_ALIGN);
+  meta->extMsgSize = meta->extMsg ? size : 0;
+  return meta->extMsg;
+}
+
+/**
+ * Allocates signature of @a size values in block of @a meta.
+ */
+static inline gdouble *
+nvds_event_meta_alloc_signature (NvDsEventMsgMeta *meta, guint size)
+{
+  meta->objSignature.signature = (gdouble *) nvds_event_meta_alloc (meta,
+      size * sizeof (gdouble), NVDS_EVENT_META_ALIGN);
+  meta->objSignature.size = meta->objSignature.signature ? size : 0;
+  return meta->objSignature.signature;
+}
+
+/**
+ * Copies @a str into block of @a meta.
+ *
+ * @return NULL for NULL @a str or if the block is full.
+ */
+static inline gchar *
+nvds_event_meta_strdup (NvDsEventMsgMeta *meta, const gchar *str)
+{
+  gsize len;
+  gchar *dst;
+
+  if (!str)
+    return NULL;
+
+  len = strlen (str) + 1;
+  dst = (gchar *) nvds_event_meta_alloc (meta, len, 1);
+  if (dst)
+    memcpy (dst, str, len);
+  return dst;
+}
+
+/** Moves @a ptr from @a src block to @a dst one if it points into it. */
+static inline gpointer
+nvds_event_meta_relocate (gpointer ptr, const NvDsEventMetaBlock *src,
+                          NvDsEventMetaBlock *dst)
+{
+  const gchar *p = (const gchar *) ptr;
+
+  if (p < (const gchar *) src || p >= (const gchar *) src + src->used)
+    return ptr;
+  return (gchar *) dst + (p - (const gchar *) src);
+}
+
+/**
+ * Copies @a src with everything allocated in its block into a new block of
+ * the same arena.
+ */
+static inline NvDsEventMsgMeta *
+nvds_event_meta_copy (const NvDsEventMsgMeta *src)
+{
+  const NvDsEventMetaBlock *srcBlock = nvds_event_meta_get_block (src);
+  NvDsEventMsgMeta *meta = nvds_event_meta_new (srcBlock->arena);
+  NvDsEventMetaBlock *block = nvds_event_meta_get_block (meta);
+  gchar **strings = NULL;
+  guint numStrings = 0;
+  guint i;
+
+  memcpy (meta, src, srcBlock->used - G_STRUCT_OFFSET (NvDsEventMetaBlock,
+                                                       meta));
+  block->used = srcBlock->used;
+
+  meta->ts = (gchar *) nvds_event_meta_relocate (meta->ts, srcBlock, block);
+  meta->objectId = (gchar *) nvds_event_meta_relocate (meta->objectId,
+                                                       srcBlock, block);
+  meta->otherAttrs = (gchar *) nvds_event_meta_relocate (meta->otherAttrs,
+                                                         srcBlock, block);
+  meta->videoPath = (gchar *) nvds_event_meta_relocate (meta->videoPath,
+                                                        srcBlock, block);
+  meta->objSignature.signature = (gdouble *) nvds_event_meta_relocate (
+      meta->objSignature.signature, srcBlock, block);
+  meta->extMsg = nvds_event_meta_relocate (meta->extMsg, srcBlock, block);
+
+  /* ext objects of known types start with their strings */
+  if (meta->extMsg != src->extMsg) {
+    strings = (gchar **) meta->extMsg;
+    switch (meta->objType) {
+      case NVDS_OBJECT_TYPE_VEHICLE:
+        numStrings = sizeof (NvDsVehicleObject) / sizeof (gchar *);
+        break;
+      case NVDS_OBJECT_TYPE_PERSON:
+        numStrings = G_STRUCT_OFFSET (NvDsPersonObject, age) / sizeof (gchar *);
+        break;
+      case NVDS_OBJECT_TYPE_FACE:
+        numStrings = G_STRUCT_OFFSET (NvDsFaceObject, age) / sizeof (gchar *);
+        break;
+      default:
+        break;
+    }
+    for (i = 0; i < numStrings; i++)
+      strings[i] = (gchar *) nvds_event_meta_relocate (strings[i], srcBlock,
+                                                       block);
+  }
+
+  return meta;
+}
+
+/** NvDsMetaCopyFunc of arena metas. */
+static inline gpointer
+nvds_event_meta_copy_func (gpointer data, gpointer user_data)
+{
+  return nvds_event_meta_copy ((const NvDsEventMsgMeta *) data);
+}
+
+/** NvDsMetaFreeFunc of arena metas. */
+static inline void
+nvds_event_meta_free_func (gpointer data, gpointer user_data)
+{
+  nvds_event_meta_free ((NvDsEventMsgMeta *) data);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -54,6 +54,13 @@ NVDS_MSGAPI_UNKNOWN_TOPIC
   */
 typedef void (*nvds_msgapi_send_cb_t)(void *user_ptr,  NvDsMsgApiErrorType completion_flag);
 
+/**
+  * Type definition for release callback of payloads sent without copy
+  *
+  * @param[in] release_ptr Pointer passed during send for the payload
+  */
+typedef void (*nvds_msgapi_release_cb_t)(void *release_ptr);
+
 /**
  * Type definition for handle method callback registered during connect.
  * using which events corresponding to connection are delivered
@@ -103,6 +110,92 @@ NvDsMsgApiErrorType nvds_msgapi_send(NvDsMsgApiHandle h_ptr, char *topic, const
  */
 NvDsMsgApiErrorType nvds_msgapi_send_async(NvDsMsgApiHandle h_ptr, char  *topic, const uint8_t *payload, size_t nbuf, nvds_msgapi_send_cb_t send_callback, void *user_ptr);
 
+/**
+ * Send message with its key synchronously. Adapters use the key e.g. to
+ * select the partition of the message (kafka) instead of looking for it in
+ * the payload.
+ * Optional, clients should look it up and fall back to nvds_msgapi_send
+ * if the adapter doesn't provide it.
+ *
+ * @param[in] h_ptr connection handle
+ * @param[in] topic topic to which send message
+ * @param[in] payload message data
+ * @param[in] nbuf number of bytes of data to send
+ * @param[in] key message key, NULL to let the adapter find it in payload
+ * @param[in] keylen number of bytes of key
+ *
+ * @return Completion status of send operation
+ */
+NvDsMsgApiErrorType nvds_msgapi_send_with_key(NvDsMsgApiHandle h_ptr, char *topic, const uint8_t *payload, size_t nbuf, const char *key, size_t keylen);
+
+/**
+ * Send message with its key asynchronously, see nvds_msgapi_send_with_key.
+ * Optional, clients should fall back to nvds_msgapi_send_async.
+ *
+ * @param[in] h_ptr connection handle
+ * @param[in] topic topic to which send message
+ * @param[in] payload message data
+ * @param[in] nbuf number of bytes of data to send
+ * @param[in] key message key, NULL to let the adapter find it in payload
+ * @param[in] keylen number of bytes of key
+ * @param[in] send_callback callback to be invoked when operation complets
+ * @param[in] user_ptr pointer to pass to callback for context
+ *
+ * @return Completion status of send operation
+ */
+NvDsMsgApiErrorType nvds_msgapi_send_async_with_key(NvDsMsgApiHandle h_ptr, char *topic, const uint8_t *payload, size_t nbuf, const char *key, size_t keylen, nvds_msgapi_send_cb_t send_callback, void *user_ptr);
+
+/**
+ * Send message with its key asynchronously without copying the payload.
+ * Payload must stay valid until the adapter is done with it and calls
+ * release_cb with release_ptr, after send_callback. If the send fails,
+ * release_cb is not called and payload is still owned by the caller.
+ * Optional, clients should fall back to nvds_msgapi_send_async_with_key.
+ *
+ * @param[in] h_ptr connection handle
+ * @param[in] topic topic to which send message
+ * @param[in] payload message data
+ * @param[in] nbuf number of bytes of data to send
+ * @param[in] key message key, NULL to let the adapter find it in payload
+ * @param[in] keylen number of bytes of key
+ * @param[in] send_callback callback to be invoked when operation complets
+ * @param[in] user_ptr pointer to pass to callback for context
+ * @param[in] release_cb callback to be invoked when payload is released
+ * @param[in] release_ptr pointer to pass to release callback
+ *
+ * @return Completion status of send operation
+ */
+NvDsMsgApiErrorType nvds_msgapi_send_async_no_copy(NvDsMsgApiHandle h_ptr, char *topic, const uint8_t *payload, size_t nbuf, const char *key, size_t keylen, nvds_msgapi_send_cb_t send_callback, void *user_ptr, nvds_msgapi_release_cb_t release_cb, void *release_ptr);
+
+/**
+ * Message of a batch send
+ */
+typedef struct {
+  const uint8_t *payload; /* message data */
+  size_t nbuf;            /* number of bytes of data to send */
+  const char *key;        /* message key, NULL to let the adapter find it in payload */
+  size_t keylen;          /* number of bytes of key */
+} NvDsMsgApiBatchMsg;
+
+/**
+ * Send messages asynchronously in one operation. send_callback is invoked
+ * once all the messages enqueued are done, with NVDS_MSGAPI_OK if all the
+ * messages were sent. If some messages can't be enqueued, the others are
+ * still sent and the callback reports the error.
+ * Optional, clients should fall back to per message sends.
+ *
+ * @param[in] h_ptr connection handle
+ * @param[in] topic topic to which send messages
+ * @param[in] msgs messages to send, only referenced during the call
+ * @param[in] nmsgs number of messages
+ * @param[in] send_callback callback to be invoked when operation complets
+ * @param[in] user_ptr pointer to pass to callback for context
+ *
+ * @return Completion status of send operation, callback is not invoked on
+ *         error
+ */
+NvDsMsgApiErrorType nvds_msgapi_send_batch(NvDsMsgApiHandle h_ptr, char *topic, const NvDsMsgApiBatchMsg *msgs, size_t nmsgs, nvds_msgapi_send_cb_t send_callback, void *user_ptr);
+
 /**
  * Calls into the adapter to allow for execution of undnerlying protocol logic.
  * As part of this routine, adapter should service outstanding incoming and
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/**
+ * @file
+ * <b>NVIDIA DeepStream: Event timestamps</b>
+ *
+ * @b Description: Helpers to fill NvDsEventMsgMeta timestamps. Formatting
+ * keeps the date and time of the last second per thread, so only
+ * milliseconds are formatted for events within the same second.
+ */
+
+#ifndef _NVDS_TIMESTAMP_H_
+#define _NVDS_TIMESTAMP_H_
+
+#include <glib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** length of "2018-09-10T11:12:13.456Z" */
+#define NVDS_TIMESTAMP_LEN 24
+
+#define NVDS_NSEC_PER_SEC G_GUINT64_CONSTANT (1000000000)
+
+/**
+ * Current time in nanoseconds since Unix epoch, e.g. for tsEpochNs of
+ * NvDsEventMsgMeta.
+ */
+static inline guint64
+nvds_get_epoch_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_REALTIME, &ts);
+  return (guint64) ts.tv_sec * NVDS_NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/**
+ * Formats @a epochNs as RFC 3339 UTC timestamp with milliseconds, e.g.
+ * "2018-09-10T11:12:13.456Z", into @a buf of at least NVDS_TIMESTAMP_LEN + 1
+ * characters. Thread safe.
+ *
+ * @return NVDS_TIMESTAMP_LEN
+ */
+static inline guint
+nvds_format_timestamp (guint64 epochNs, gchar *buf)
+{
+  /* "YYYY-MM-DDTHH:MM:SS" of cachedSecond */
+  static __thread gchar cachedPrefix[20];
+  static __thread guint64 cachedSecond = G_MAXUINT64;
+  guint64 second = epochNs / NVDS_NSEC_PER_SEC;
+  guint ms = (guint) (epochNs % NVDS_NSEC_PER_SEC / 1000000);
+  time_t tloc = (time_t) second;
+  struct tm tm;
+
+  if (second != cachedSecond) {
+    gmtime_r (&tloc, &tm);
+    if (strftime (cachedPrefix, sizeof (cachedPrefix), "%Y-%m-%dT%H:%M:%S",
+                  &tm) != sizeof (cachedPrefix) - 1)
+      memcpy (cachedPrefix, "0000-00-00T00:00:00", sizeof (cachedPrefix));
+    cachedSecond = second;
+  }
+
+  memcpy (buf, cachedPrefix, sizeof (cachedPrefix) - 1);
+  buf[19] = '.';
+  buf[20] = '0' + ms / 100;
+  buf[21] = '0' + ms / 10 % 10;
+  buf[22] = '0' + ms % 10;
+  buf[23] = 'Z';
+  buf[24] = '\0';
+  return NVDS_TIMESTAMP_LEN;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
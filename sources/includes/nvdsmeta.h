@@ -64,9 +64,14 @@ typedef enum NvDsObjectType {
  */
 typedef enum NvDsPayloadType {
   NVDS_PAYLOAD_DEEPSTREAM,
+  /** Compact binary encoding of deepstream schema (see binary_schema.h). */
+  NVDS_PAYLOAD_DEEPSTREAM_BINARY,
   /** Reserved for future use. Use value greater than this for custom payloads. */
   NVDS_PAYLOAD_RESERVED = 0x100,
-  /** To support custom payload. User need to implement nvds_msg2p_* interface */
+  /**
+   * To support custom payload. Generated from template of nvmsgconv
+   * configuration or user need to implement nvds_msg2p_* interface
+   */
   NVDS_PAYLOAD_CUSTOM = 0x101,
   NVDS_PAYLOAD_FORCE32 = 0x7FFFFFFF
 } NvDsPayloadType;
@@ -199,6 +204,13 @@ typedef struct NvDsEventMsgMeta {
   gpointer extMsg;
   /** size of custom object */
   guint extMsgSize;
+  /**
+   * time stamp in nanoseconds since Unix epoch, 0 if not set. Cheaper
+   * alternative to ts (see nvds_timestamp.h), used when ts is NULL.
+   * Added after the other fields, nvmsgconv only reads it with ts-epoch-ns
+   * set in its configuration.
+   */
+  guint64 tsEpochNs;
 } NvDsEventMsgMeta;
 
 /**
@@ -221,6 +233,12 @@ typedef struct NvDsPayload {
   guint payloadSize;
   /** id of component who attached the payload (Optional) */
   guint componentId;
+  /** message key, e.g. partition key of kafka, owned by the payload.
+   * NULL if none (Optional). Added after the other fields, only read from
+   * converter libraries exporting nvds_msg2p_get_payload_version. */
+  gchar *key;
+  /** length of key */
+  guint keyLen;
 } NvDsPayload;
 
 #ifdef __cplusplus
@@ -12,12 +12,151 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <jansson.h>
 #include "nvds_logger.h"
 
 #define KAFKA_JSON_PARSER "KAKFA_JSON_PARSE"
 
-#define FREE_AND_RETURN(v,p) json_decref(p); return v
+/*
+ * Key lookup scans the message once without building a document: members
+ * which are not on the path are skipped, scan stops at the first member
+ * matching the path. Member names are compared as written, names with
+ * escape sequences don't match.
+ */
+
+static const char *skip_space(const char *p, const char *end)
+{
+  while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+    p++;
+  return p;
+}
+
+/* returns end of string starting at quote p, NULL if unterminated */
+static const char *skip_string(const char *p, const char *end)
+{
+  for (p++; p < end; p++) {
+    if (*p == '\\')
+      p++;
+    else if (*p == '"')
+      return p + 1;
+  }
+  return NULL;
+}
+
+/* returns end of value at p, NULL if malformed */
+static const char *skip_value(const char *p, const char *end)
+{
+  int depth = 0;
+
+  if (p >= end)
+    return NULL;
+
+  if (*p == '"')
+    return skip_string(p, end);
+
+  if (*p != '{' && *p != '[') {
+    while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' &&
+           *p != '\n' && *p != '\r' && *p != '\t')
+      p++;
+    return p;
+  }
+
+  for (; p < end; p++) {
+    if (*p == '"') {
+      p = skip_string(p, end);
+      if (!p)
+        return NULL;
+      p--;
+    } else if (*p == '{' || *p == '[') {
+      depth++;
+    } else if (*p == '}' || *p == ']') {
+      if (--depth == 0)
+        return p + 1;
+    }
+  }
+  return NULL;
+}
+
+static int hex_value(const char *p)
+{
+  int value = 0;
+  int i;
+
+  for (i = 0; i < 4; i++) {
+    value <<= 4;
+    if (p[i] >= '0' && p[i] <= '9')
+      value |= p[i] - '0';
+    else if (p[i] >= 'a' && p[i] <= 'f')
+      value |= p[i] - 'a' + 10;
+    else if (p[i] >= 'A' && p[i] <= 'F')
+      value |= p[i] - 'A' + 10;
+    else
+      return -1;
+  }
+  return value;
+}
+
+/*
+ * Copies unescaped string starting at quote p into value.
+ * Returns its length, 0 if it doesn't fit in nbuf bytes with terminating
+ * null or is malformed.
+ */
+static int copy_string(const char *p, const char *end, char *value, int nbuf)
+{
+  int len = 0;
+  int c;
+
+  for (p++; p < end && *p != '"'; p++) {
+    c = (unsigned char) *p;
+    if (c != '\\') {
+      // raw bytes, UTF-8 included, are copied as is
+      if (len + 1 >= nbuf)
+        return 0;
+      value[len++] = c;
+      continue;
+    }
+
+    if (++p >= end)
+      return 0;
+    switch (*p) {
+      case 'b': c = '\b'; break;
+      case 'f': c = '\f'; break;
+      case 'n': c = '\n'; break;
+      case 'r': c = '\r'; break;
+      case 't': c = '\t'; break;
+      case 'u':
+        // code points of the basic plane only
+        if (end - p < 5 || (c = hex_value(p + 1)) < 0 ||
+            (c >= 0xd800 && c < 0xe000))
+          return 0;
+        p += 4;
+        break;
+      default: c = *p; break;
+    }
+
+    // escape, UTF-8 encoded
+    if (c < 0x80) {
+      if (len + 1 >= nbuf)
+        return 0;
+      value[len++] = c;
+    } else if (c < 0x800) {
+      if (len + 2 >= nbuf)
+        return 0;
+      value[len++] = 0xc0 | (c >> 6);
+      value[len++] = 0x80 | (c & 0x3f);
+    } else {
+      if (len + 3 >= nbuf)
+        return 0;
+      value[len++] = 0xe0 | (c >> 12);
+      value[len++] = 0x80 | ((c >> 6) & 0x3f);
+      value[len++] = 0x80 | (c & 0x3f);
+    }
+  }
+
+  if (p >= end)
+    return 0;
+  value[len] = '\0';
+  return len;
+}
 
 /*
    Returns 0 if key was not found in json.
@@ -26,68 +165,63 @@
  */
 int json_get_key_value(const char *msg, int msglen, const char *path, char *value, int nbuf)
 {
-    json_t *root;
-    json_error_t error;
+  const char *p = msg;
+  const char *end = msg + msglen;
+  const char *name;
+  const char *dotptr;
+  size_t namelen;
+  int match;
+  int len;
 
-    root = json_loadb(msg, msglen, 0, &error);
+  p = skip_space(p, end);
+  if (p >= end || *p != '{')
+    return 0;
 
-    if (!root)
-    {
-      nvds_log(KAFKA_JSON_PARSER, LOG_ERR, "json error on line %d: %s\n", error.line, error.text);
-      return 0;
+  dotptr = strchr(path, '.');
+  namelen = dotptr ? (size_t)(dotptr - path) : strlen(path);
+
+  /* p is at '{' or ',' before next member of current object */
+  while (p < end) {
+    p = skip_space(p + 1, end);
+    if (p >= end || *p != '"')
+      break;
+
+    name = p + 1;
+    p = skip_string(p, end);
+    if (!p)
+      break;
+    match = ((size_t)(p - 1 - name) == namelen && !memcmp(name, path, namelen));
+    p = skip_space(p, end);
+    if (p >= end || *p != ':')
+      break;
+    p = skip_space(p + 1, end);
+    if (p >= end)
+      break;
+
+    if (match) {
+      if (!dotptr) {
+        len = (*p == '"') ? copy_string(p, end, value, nbuf) : 0;
+        if (len)
+          nvds_log(KAFKA_JSON_PARSER, LOG_DEBUG, "json value for id = %s\n", value);
+        return len;
+      }
+      if (*p != '{')
+        break;
+      // descend into member, continue with its first member
+      path = dotptr + 1;
+      dotptr = strchr(path, '.');
+      namelen = dotptr ? (size_t)(dotptr - path) : strlen(path);
+      continue;
     }
 
-   json_t *jvalue;
-   json_t *subroot = root;
-   char const *temp;
-   const char *remstr = path;
-   const char *dotptr;
-   char subpath[256]; /* stores remaining part of path to be processed at any time */
-
-   nvds_log(KAFKA_JSON_PARSER, LOG_DEBUG, "finding kafka key of %s within json message\n", path);
-
-   /* parse down the tree based on successive elements in the key*/
-   while ((dotptr = strchr(remstr, '.')) != NULL) {
-     unsigned int subpath_len = ((dotptr - remstr) < 0)? 0 : (unsigned int)(dotptr - remstr) ;
-
-     /* maximum size of each key is 256 */
-     if (subpath_len > sizeof(subpath)) {
-       nvds_log(KAFKA_JSON_PARSER, LOG_ERR, "provided json sub key length > 255. \
-                                        Error finding kafka key value.\n");
-       FREE_AND_RETURN(0,root);
-     }
-
-     memcpy(subpath, remstr, subpath_len);
-
-     subpath[subpath_len] = '\0';
-     
-     jvalue = json_object_get(subroot, subpath);
-     remstr = dotptr + 1;
-     if (remstr > (path + strlen(path))) { //nothing beyond the next .
-       nvds_log(KAFKA_JSON_PARSER, LOG_ERR, "kafka key not found; nothing beyond trailing .\n");
-       FREE_AND_RETURN(0,root);
-     }
-     if(json_is_object(jvalue)) {
-       subroot = jvalue;
-     } else {
-       nvds_log(KAFKA_JSON_PARSER, LOG_ERR, "provided path is not valid\n");
-       FREE_AND_RETURN(0,root);
-     }
-     
-     
-   }
-
-   // by the time we reach here we are at the last level object
-   json_t *idvalue = json_object_get(subroot, remstr);
-   if(json_is_string(idvalue)) {
-     temp = json_string_value(idvalue);
-     strncpy(value, temp, nbuf);
-     nvds_log(KAFKA_JSON_PARSER, LOG_DEBUG, "json value for id = %s\n", value);
-     FREE_AND_RETURN(strlen(value),root);
-   } else {
-     nvds_log(KAFKA_JSON_PARSER, LOG_ERR, "json entry corresponding to path \
-                               is not string or not found\n");
-     FREE_AND_RETURN(strlen(value),root);
-   }
-    
+    p = skip_value(p, end);
+    if (!p)
+      break;
+    p = skip_space(p, end);
+    if (p >= end || *p != ',')
+      break;
+  }
+
+  nvds_log(KAFKA_JSON_PARSER, LOG_DEBUG, "json entry corresponding to path %s not found\n", path);
+  return 0;
 }
@@ -52,6 +52,194 @@
 #include "nvds_logger.h"
 #include "kafka_client.h"
 
+/* completion of a send, the message opaque of rdkafka */
+typedef enum {
+  NVDS_KAFKA_COMPL_SYNC,
+  NVDS_KAFKA_COMPL_ASYNC,
+  NVDS_KAFKA_COMPL_BATCH
+} NvDsKafkaComplType;
+
+typedef struct {
+  NvDsKafkaComplType type;
+  int index;  /* slot in pool, -1 if allocated on pool exhaustion */
+  uint32_t next;  /* next free slot */
+  gint err;  /* status of sync send, first error of batch */
+  /* sync send, protected by sync_lock of handle */
+  int done;
+  int abandoned;  /* sender stopped waiting, released by delivery report */
+  /* async and batch send */
+  nvds_msgapi_send_cb_t cb;
+  void *user_ptr;
+  nvds_msgapi_release_cb_t release_cb;  /* payload of no copy send */
+  void *release_ptr;
+  gint pending;  /* messages of batch not reported yet */
+} NvDsKafkaSendCompl;
+
+#define COMPL_POOL_NIL 0xffffffffu
+
+/*
+ * Fixed set of completion slots, one per message the producer queue holds.
+ * Free slots form a lock-free stack; its head packs a change counter with
+ * the index of the top slot so that a slot popped and pushed back in
+ * between doesn't fool compare-and-swap. Slots never used yet are handed
+ * out from unused, so pages of the array are only touched when needed.
+ */
+typedef struct {
+  NvDsKafkaSendCompl *slots;
+  uint32_t capacity;
+  uint64_t free_head;  /* counter << 32 | index of top slot */
+  uint32_t unused;  /* first slot never taken */
+  uint64_t exhausted;  /* completions allocated when pool was empty */
+} NvDsKafkaComplPool;
+
+typedef struct {
+   rd_kafka_t *producer;         /* Producer instance handle */
+   rd_kafka_topic_t *topic;  /* Topic object of topic given at connect */
+   rd_kafka_conf_t *conf;  /* Temporary configuration object */
+   char topic_name[255];
+   GRWLock topics_lock;  /* protects topics */
+   GHashTable *topics;  /* other topic objects by name, created on first send */
+   uint64_t num_msgs;  /* messages enqueued */
+   uint64_t bytes_copied;  /* payload bytes copied by rd_kafka_produce */
+   GMutex sync_lock;  /* protects sync completions and polling */
+   GCond sync_cond;  /* signalled on sync completion or end of polling */
+   int polling;  /* a thread is polling for delivery reports */
+   int sync_timeout_ms;  /* max wait of sync send, 0 for no limit */
+   NvDsKafkaComplPool compl_pool;
+} NvDsKafkaClientHandle;
+
+/* max time a sync sender polls or waits before checking its timeout */
+#define SYNC_POLL_INTERVAL_MS 100
+
+/* pool size if queue.buffering.max.messages can't be read */
+#define DEFAULT_COMPL_POOL_SIZE 100000
+
+static int compl_pool_init(NvDsKafkaComplPool *pool, uint32_t capacity)
+{
+  // calloc leaves pages untouched until slots are used
+  pool->slots = (NvDsKafkaSendCompl *)calloc(capacity, sizeof(NvDsKafkaSendCompl));
+  if (!pool->slots)
+    return -1;
+  pool->capacity = capacity;
+  pool->free_head = COMPL_POOL_NIL;
+  pool->unused = 0;
+  pool->exhausted = 0;
+  return 0;
+}
+
+/* Returns cleared completion of given type */
+static NvDsKafkaSendCompl *compl_pool_get(NvDsKafkaComplPool *pool, NvDsKafkaComplType type)
+{
+  NvDsKafkaSendCompl *c;
+  uint64_t old, head;
+  uint32_t index;
+
+  do {
+    old = __atomic_load_n(&pool->free_head, __ATOMIC_ACQUIRE);
+    index = (uint32_t)old;
+    if (index == COMPL_POOL_NIL)
+      break;
+    // next may be stale if the slot was taken meanwhile, then the counter changed
+    head = (((old >> 32) + 1) << 32) | __atomic_load_n(&pool->slots[index].next, __ATOMIC_RELAXED);
+  } while (!__sync_bool_compare_and_swap(&pool->free_head, old, head));
+
+  if (index == COMPL_POOL_NIL && __atomic_load_n(&pool->unused, __ATOMIC_RELAXED) < pool->capacity) {
+    index = __sync_fetch_and_add(&pool->unused, 1);
+    if (index >= pool->capacity)
+      index = COMPL_POOL_NIL;
+  }
+
+  if (index == COMPL_POOL_NIL) {
+    if (__sync_fetch_and_add(&pool->exhausted, 1) == 0)
+      nvds_log(NVDS_KAFKA_LOG_CAT, LOG_WARNING, "completion pool of %u slots exhausted\n", pool->capacity);
+    c = (NvDsKafkaSendCompl *)calloc(1, sizeof(NvDsKafkaSendCompl));
+    if (!c)
+      return NULL;
+    c->index = -1;
+  } else {
+    // next isn't cleared, it may still be read by a concurrent get
+    c = &pool->slots[index];
+    c->index = index;
+  }
+  c->type = type;
+  c->err = NVDS_MSGAPI_OK;
+  c->done = 0;
+  c->abandoned = 0;
+  c->cb = NULL;
+  c->user_ptr = NULL;
+  c->release_cb = NULL;
+  c->release_ptr = NULL;
+  c->pending = 0;
+  return c;
+}
+
+static void compl_pool_put(NvDsKafkaComplPool *pool, NvDsKafkaSendCompl *c)
+{
+  uint64_t old, head;
+
+  if (c->index < 0) {
+    free(c);
+    return;
+  }
+
+  do {
+    old = __atomic_load_n(&pool->free_head, __ATOMIC_RELAXED);
+    __atomic_store_n(&c->next, (uint32_t)old, __ATOMIC_RELAXED);
+    head = (((old >> 32) + 1) << 32) | (uint32_t)c->index;
+  } while (!__sync_bool_compare_and_swap(&pool->free_head, old, head));
+}
+
+/*
+ * Completes count messages of batch; callback is called and completion
+ * released with the last one.
+ */
+static void batch_complete(NvDsKafkaClientHandle *kh, NvDsKafkaSendCompl *c, int count, NvDsMsgApiErrorType senderr)
+{
+  if (senderr != NVDS_MSGAPI_OK)
+    g_atomic_int_compare_and_exchange(&c->err, NVDS_MSGAPI_OK, senderr);
+
+  // g_atomic_int_add returns value before the add
+  if (g_atomic_int_add(&c->pending, -count) != count)
+    return;
+
+  if (c->cb)
+    c->cb(c->user_ptr, (NvDsMsgApiErrorType) g_atomic_int_get(&c->err));
+  compl_pool_put(&kh->compl_pool, c);
+}
+
+static void send_complete(NvDsKafkaClientHandle *kh, NvDsKafkaSendCompl *c, NvDsMsgApiErrorType senderr)
+{
+  int release;
+
+  switch (c->type) {
+    case NVDS_KAFKA_COMPL_SYNC:
+      // set the completion flag, sender releases it unless it stopped waiting
+      g_mutex_lock(&kh->sync_lock);
+      c->done = 1;
+      c->err = senderr;
+      release = c->abandoned;
+      g_cond_broadcast(&kh->sync_cond);
+      g_mutex_unlock(&kh->sync_lock);
+      if (release)
+        compl_pool_put(&kh->compl_pool, c);
+      break;
+
+    case NVDS_KAFKA_COMPL_ASYNC:
+      // simply call any registered callback
+      if (c->cb)
+        c->cb(c->user_ptr, senderr);
+      // rdkafka doesn't reference payload of no copy send anymore
+      if (c->release_cb)
+        c->release_cb(c->release_ptr);
+      compl_pool_put(&kh->compl_pool, c);
+      break;
+
+    case NVDS_KAFKA_COMPL_BATCH:
+      batch_complete(kh, c, 1, senderr);
+      break;
+  }
+}
+
 /**
  * @brief Message delivery report callback.
  *
@@ -61,7 +249,7 @@
  * failed delivery (rkmessage->err != RD_KAFKA_RESP_ERR_NO_ERROR).
  *
  * The callback is triggered from rd_kafka_poll() and executes on
- * the application's thread.
+ * the application's thread. opaque is the client handle.
  */
 static void dr_msg_cb (rd_kafka_t *rk,
                        const rd_kafka_message_t *rkmessage, void *opaque) {
@@ -87,60 +275,8 @@ static void dr_msg_cb (rd_kafka_t *rk,
         dserr = NVDS_MSGAPI_ERR;
         break;
   };
-  ((NvDsKafkaSendCompl *)(rkmessage->_private))->sendcomplete(dserr);
-
-  delete ((NvDsKafkaSendCompl *)(rkmessage->_private));
-
-}
-
-typedef struct {
-   rd_kafka_t *producer;         /* Producer instance handle */
-   rd_kafka_topic_t *topic;  /* Topic object */
-   rd_kafka_conf_t *conf;  /* Temporary configuration object */
-   char topic_name[255];
-} NvDsKafkaClientHandle;
-
-NvDsKafkaSyncSendCompl::NvDsKafkaSyncSendCompl(uint8_t *cflag) {
-  compl_flag = cflag;
-}
-
-/**
- * Method that gets invoked when sync send operation is completed
- */
-void NvDsKafkaSyncSendCompl::sendcomplete(NvDsMsgApiErrorType senderr) {
-  *compl_flag = 1;
-  err = senderr;
-}
-
-
-void NvDsKafkaSendCompl::sendcomplete(NvDsMsgApiErrorType senderr) {
-  printf("wrong class\n");
-}
-
-NvDsMsgApiErrorType NvDsKafkaSendCompl::get_err() {
-  return NVDS_MSGAPI_OK;
-}
-
-/**
- * Method that gets invoked when sync send operation is completed
- */
-NvDsMsgApiErrorType NvDsKafkaSyncSendCompl::get_err() {
-  return err;
-}
-
+  send_complete((NvDsKafkaClientHandle *)opaque, (NvDsKafkaSendCompl *)rkmessage->_private, dserr);
 
-NvDsKafkaAsyncSendCompl::NvDsKafkaAsyncSendCompl(void *ctx, nvds_msgapi_send_cb_t cb) {
-  user_ptr = ctx;
-  async_send_cb = cb;
-}
-
-/**
- * Method that gets invoked when async send operation is completed
- */
-void NvDsKafkaAsyncSendCompl::sendcomplete(NvDsMsgApiErrorType senderr) {
-  // simply call any registered callback
-  if (async_send_cb)
-    async_send_cb(user_ptr, senderr);
 }
 
 /*
@@ -202,41 +338,168 @@ void *nvds_kafka_client_init(char *brokers, char *topic) {
      kh->producer = NULL;
      kh->topic = NULL;
      kh->conf = conf;
+     kh->num_msgs = 0;
+     kh->bytes_copied = 0;
+     g_mutex_init(&kh->sync_lock);
+     g_cond_init(&kh->sync_cond);
+     kh->polling = 0;
+     kh->sync_timeout_ms = 0;
+     kh->compl_pool.slots = NULL;
+     g_rw_lock_init(&kh->topics_lock);
+     kh->topics = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                        (GDestroyNotify) rd_kafka_topic_destroy);
+     // handle is passed to delivery report callback
+     rd_kafka_conf_set_opaque(conf, kh);
      snprintf(kh->topic_name, sizeof(kh->topic_name), "%s",topic);
      return (void *)kh;
 }
 
+/*
+ * Returns topic object of topic name, NULL for topic of connect. Topic
+ * objects are long-lived, created once per topic and shared by all senders.
+ */
+static rd_kafka_topic_t *get_topic(NvDsKafkaClientHandle *kh, const char *name)
+{
+  rd_kafka_topic_t *rkt;
+
+  if (!name || !strcmp(name, kh->topic_name))
+    return kh->topic;
+
+  g_rw_lock_reader_lock(&kh->topics_lock);
+  rkt = (rd_kafka_topic_t *) g_hash_table_lookup(kh->topics, name);
+  g_rw_lock_reader_unlock(&kh->topics_lock);
+  if (rkt)
+    return rkt;
+
+  g_rw_lock_writer_lock(&kh->topics_lock);
+  // may have been created meanwhile
+  rkt = (rd_kafka_topic_t *) g_hash_table_lookup(kh->topics, name);
+  if (!rkt) {
+    rkt = rd_kafka_topic_new(kh->producer, name, NULL);
+    if (rkt) {
+      g_hash_table_insert(kh->topics, g_strdup(name), rkt);
+      nvds_log(NVDS_KAFKA_LOG_CAT, LOG_INFO, "created topic object for %s\n", name);
+    } else
+      nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR, "Failed to create topic object for %s: %s\n", name, \
+           rd_kafka_err2str(rd_kafka_last_error()));
+  }
+  g_rw_lock_writer_unlock(&kh->topics_lock);
+  return rkt;
+}
+
+/*
+ * Serves delivery reports, called with sync_lock held. Only one thread
+ * polls at a time: while a sync sender blocks in rd_kafka_poll no other
+ * thread may serve its report, or the sender would sleep until its poll
+ * times out. If another thread is polling, waits at most timeout_ms for
+ * it to finish or for a sync completion instead.
+ */
+static void poll_reports_locked(NvDsKafkaClientHandle *kh, int timeout_ms)
+{
+  if (kh->polling) {
+    if (timeout_ms > 0)
+      g_cond_wait_until(&kh->sync_cond, &kh->sync_lock,
+                        g_get_monotonic_time() + (gint64) timeout_ms * 1000);
+    return;
+  }
+
+  // rd_kafka_poll returns as soon as it served a delivery report
+  kh->polling = 1;
+  g_mutex_unlock(&kh->sync_lock);
+  rd_kafka_poll(kh->producer, timeout_ms);
+  g_mutex_lock(&kh->sync_lock);
+  kh->polling = 0;
+  g_cond_broadcast(&kh->sync_cond);
+}
+
+static void poll_reports(NvDsKafkaClientHandle *kh, int timeout_ms)
+{
+  g_mutex_lock(&kh->sync_lock);
+  poll_reports_locked(kh, timeout_ms);
+  g_mutex_unlock(&kh->sync_lock);
+}
+
+/*
+ * Waits for delivery report of sync send. Only one of the waiting senders
+ * polls at a time, others sleep until their completion is signalled by
+ * whichever thread serves it (a sync sender or do_work) or until polling
+ * is handed over to them.
+ * Returns NVDS_MSGAPI_ERR if the timeout expires; completion is then
+ * deleted by its delivery report.
+ */
+static NvDsMsgApiErrorType sync_send_wait(NvDsKafkaClientHandle *kh, NvDsKafkaSendCompl *sc)
+{
+  gint64 deadline = 0;
+  gint64 now;
+  int pollms;
+  NvDsMsgApiErrorType err;
+
+  if (kh->sync_timeout_ms > 0)
+    deadline = g_get_monotonic_time() + (gint64) kh->sync_timeout_ms * 1000;
+
+  g_mutex_lock(&kh->sync_lock);
+  while (!sc->done) {
+    now = g_get_monotonic_time();
+    if (deadline && now >= deadline) {
+      sc->abandoned = 1;
+      g_mutex_unlock(&kh->sync_lock);
+      nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR, "sync send timed out after %d ms\n", kh->sync_timeout_ms);
+      return NVDS_MSGAPI_ERR;
+    }
+
+    pollms = SYNC_POLL_INTERVAL_MS;
+    if (deadline && (deadline - now) / 1000 < pollms)
+      pollms = (deadline - now + 999) / 1000;
+    poll_reports_locked(kh, pollms);
+  }
+  g_mutex_unlock(&kh->sync_lock);
+
+  err = (NvDsMsgApiErrorType) sc->err;
+  compl_pool_put(&kh->compl_pool, sc);
+  return err;
+}
+
 //There could be several synchronous and asychronous send operations in flight.
 //Once a send operation callback is received the course of action  depends on if it's sync or async
 // -- if it's sync then the associated completion flag should  be set
 // -- if it's asynchronous then completion callback from the user should be called along with context
-NvDsMsgApiErrorType nvds_kafka_client_send(void *kv,  const uint8_t *payload, int len, int sync, void *ctx, nvds_msgapi_send_cb_t cb, char *key, int keylen)
+// With release_cb (async only) payload is not copied and released after the delivery report
+NvDsMsgApiErrorType nvds_kafka_client_send(void *kv, const char *topic, const uint8_t *payload, int len, int sync, void *ctx, nvds_msgapi_send_cb_t cb, char *key, int keylen,
+                                           nvds_msgapi_release_cb_t release_cb, void *release_ptr)
 {
   NvDsKafkaClientHandle *kh = (NvDsKafkaClientHandle *)kv;
-  uint8_t done = 0;
-
+  int msgflags = release_cb ? 0 : RD_KAFKA_MSG_F_COPY;
   NvDsKafkaSendCompl *scd;
-  if (sync) {
-    NvDsKafkaSyncSendCompl *sc= new NvDsKafkaSyncSendCompl(&done);
-    scd = sc;
-  } else {
-    NvDsKafkaAsyncSendCompl *sc= new NvDsKafkaAsyncSendCompl(ctx, cb);
-    scd = sc;
-  }
+  rd_kafka_topic_t *rkt;
 
   if (!kh) {
     nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR, "send called on NULL handle \n");
     return NVDS_MSGAPI_ERR;
   }
 
+  rkt = get_topic(kh, topic);
+  if (!rkt)
+    return NVDS_MSGAPI_ERR;
+
+  scd = compl_pool_get(&kh->compl_pool, sync ? NVDS_KAFKA_COMPL_SYNC : NVDS_KAFKA_COMPL_ASYNC);
+  if (!scd)
+    return NVDS_MSGAPI_ERR;
+  if (!sync) {
+    scd->cb = cb;
+    scd->user_ptr = ctx;
+    scd->release_cb = release_cb;
+    scd->release_ptr = release_ptr;
+  }
+
   retry:
   if (rd_kafka_produce(
           /* Topic object */
-          kh->topic,
+          rkt,
           /* Use builtin partitioner to select partition*/
           RD_KAFKA_PARTITION_UA,
-          /* Make a copy of the payload. */
-          RD_KAFKA_MSG_F_COPY,
+          /* Make a copy of the payload, unless owner releases it
+           * from delivery report. */
+          msgflags,
           /* Message payload (value) and length */
           (void *)payload, len,
           /* Optional key and its length */
@@ -258,7 +521,7 @@ NvDsMsgApiErrorType nvds_kafka_client_send(void *kv,  const uint8_t *payload, in
             * The internal queue is limited by the
             * configuration property
             * queue.buffering.max.messages */
-           rd_kafka_poll(kh->producer, 1000/*block for max 1000ms*/);
+           poll_reports(kh, 1000/*block for max 1000ms*/);
            goto retry;
        }
        else
@@ -266,28 +529,103 @@ NvDsMsgApiErrorType nvds_kafka_client_send(void *kv,  const uint8_t *payload, in
            /**
              * Failed to *enqueue* message for producing.
              */
-          nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR,"Failed to schedule kafka send: %s on topic <%s>\n", rd_kafka_err2str(rd_kafka_last_error()), rd_kafka_topic_name(kh->topic));			 
+          nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR,"Failed to schedule kafka send: %s on topic <%s>\n", rd_kafka_err2str(rd_kafka_last_error()), rd_kafka_topic_name(rkt));			 
+          compl_pool_put(&kh->compl_pool, scd);
           return NVDS_MSGAPI_ERR;
        }
 
      }
      else
      {
-       NvDsMsgApiErrorType err;
+       __sync_fetch_and_add(&kh->num_msgs, 1);
+       if (msgflags & RD_KAFKA_MSG_F_COPY)
+         __sync_fetch_and_add(&kh->bytes_copied, len);
+
        if  (!sync)
           return NVDS_MSGAPI_OK;
        else
-       {
-          while (sync && !done) {
-            usleep(1000);
-            rd_kafka_poll(kh->producer, 0/*non-blocking*/);
-          }
-          err = (scd)->get_err();
-	  return err;
-        }
+          return sync_send_wait(kh, scd);
      }
 }
 
+/*
+ * Enqueues all the messages with one rd_kafka_produce_batch call (more when
+ * the producer queue is full). Messages share one completion, which holds an
+ * extra count until all of them are enqueued so that it can't complete
+ * while produce is still in progress.
+ */
+NvDsMsgApiErrorType nvds_kafka_client_send_batch(void *kv, const char *topic, const NvDsMsgApiBatchMsg *msgs, int nmsgs, void *ctx, nvds_msgapi_send_cb_t cb)
+{
+  NvDsKafkaClientHandle *kh = (NvDsKafkaClientHandle *)kv;
+  NvDsKafkaSendCompl *bc;
+  rd_kafka_topic_t *rkt;
+  rd_kafka_message_t *rkmessages;
+  uint64_t bytes = 0;
+  int todo = nmsgs, enqueued = 0, failed = 0;
+  int i, j;
+
+  if (!kh) {
+    nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR, "send called on NULL handle \n");
+    return NVDS_MSGAPI_ERR;
+  }
+
+  rkt = get_topic(kh, topic);
+  if (!rkt)
+    return NVDS_MSGAPI_ERR;
+
+  rkmessages = (rd_kafka_message_t *)calloc(nmsgs, sizeof(rd_kafka_message_t));
+  if (!rkmessages)
+    return NVDS_MSGAPI_ERR;
+
+  bc = compl_pool_get(&kh->compl_pool, NVDS_KAFKA_COMPL_BATCH);
+  if (!bc) {
+    free(rkmessages);
+    return NVDS_MSGAPI_ERR;
+  }
+  bc->cb = cb;
+  bc->user_ptr = ctx;
+  bc->pending = nmsgs + 1;
+  for (i = 0; i < nmsgs; i++) {
+    rkmessages[i].payload = (void *)msgs[i].payload;
+    rkmessages[i].len = msgs[i].nbuf;
+    rkmessages[i].key = (void *)msgs[i].key;
+    rkmessages[i].key_len = msgs[i].key ? msgs[i].keylen : 0;
+    rkmessages[i]._private = bc;
+  }
+
+  retry:
+  enqueued += rd_kafka_produce_batch(rkt, RD_KAFKA_PARTITION_UA, RD_KAFKA_MSG_F_COPY, rkmessages, todo);
+
+  // move messages rejected for full queue to the front to retry them
+  for (i = 0, j = 0; i < todo; i++) {
+    if (rkmessages[i].err == RD_KAFKA_RESP_ERR__QUEUE_FULL) {
+      rkmessages[j] = rkmessages[i];
+      rkmessages[j++].err = RD_KAFKA_RESP_ERR_NO_ERROR;
+    } else if (rkmessages[i].err) {
+      nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR,"Failed to schedule kafka send: %s on topic <%s>\n", rd_kafka_err2str(rkmessages[i].err), rd_kafka_topic_name(rkt));
+      failed++;
+    } else {
+      bytes += rkmessages[i].len;
+    }
+  }
+  if (j) {
+    poll_reports(kh, 1000/*block for max 1000ms*/);
+    todo = j;
+    goto retry;
+  }
+  free(rkmessages);
+
+  __sync_fetch_and_add(&kh->num_msgs, enqueued);
+  __sync_fetch_and_add(&kh->bytes_copied, bytes);
+
+  if (!enqueued) {
+    compl_pool_put(&kh->compl_pool, bc);
+    return NVDS_MSGAPI_ERR;
+  }
+  batch_complete(kh, bc, failed + 1, failed ? NVDS_MSGAPI_ERR : NVDS_MSGAPI_OK);
+  return NVDS_MSGAPI_OK;
+}
+
 NvDsMsgApiErrorType nvds_kafka_client_setconf(void *kv, char *key, char *val)
 {
   char errstr[512];
@@ -303,6 +641,18 @@ NvDsMsgApiErrorType nvds_kafka_client_setconf(void *kv, char *key, char *val)
   }
 }
 
+/**
+  Sets max time sync send waits for delivery report, 0 to wait until
+  rdkafka reports (message.timeout.ms)
+ */
+void nvds_kafka_client_set_sync_timeout(void *kv, int timeout_ms)
+{
+  NvDsKafkaClientHandle *kh = (NvDsKafkaClientHandle *)kv;
+
+  kh->sync_timeout_ms = timeout_ms > 0 ? timeout_ms : 0;
+  nvds_log(NVDS_KAFKA_LOG_CAT, LOG_INFO, "sync send timeout set to %d ms\n", kh->sync_timeout_ms);
+}
+
 /**
   Instantiates the rd_kafka_t object, which initializes the protocol
  */
@@ -312,6 +662,19 @@ NvDsMsgApiErrorType nvds_kafka_client_launch(void *kv)
    rd_kafka_topic_t *rkt;  /* Topic object */
    NvDsKafkaClientHandle *kh = (NvDsKafkaClientHandle *)kv;
    char errstr[512];
+   char confval[32];
+   size_t confsize = sizeof(confval);
+   long poolsize = 0;
+
+   /* one completion slot per message producer queue can hold */
+   if (rd_kafka_conf_get(kh->conf, "queue.buffering.max.messages", confval, &confsize) == RD_KAFKA_CONF_OK)
+     poolsize = atol(confval);
+   if (poolsize <= 0)
+     poolsize = DEFAULT_COMPL_POOL_SIZE;
+   if (compl_pool_init(&kh->compl_pool, (uint32_t) poolsize)) {
+      nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR, "Failed to allocate %ld completions\n", poolsize);
+      return NVDS_MSGAPI_ERR;
+   }
 
    /*
       * Create producer instance.
@@ -322,6 +685,8 @@ NvDsMsgApiErrorType nvds_kafka_client_launch(void *kv)
    rk = rd_kafka_new(RD_KAFKA_PRODUCER, kh->conf, errstr, sizeof(errstr));
    if (!rk) {
       nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR, "Failed to create new producer: %s\n", errstr);
+      free(kh->compl_pool.slots);
+      kh->compl_pool.slots = NULL;
       return NVDS_MSGAPI_ERR;
    }
 
@@ -336,6 +701,8 @@ NvDsMsgApiErrorType nvds_kafka_client_launch(void *kv)
         nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR, "Failed to create topic object: %s\n", \
            rd_kafka_err2str(rd_kafka_last_error()));
         rd_kafka_destroy(rk);
+        free(kh->compl_pool.slots);
+        kh->compl_pool.slots = NULL;
         return NVDS_MSGAPI_ERR;
    }
    kh->producer = rk;
@@ -355,17 +722,44 @@ void nvds_kafka_client_finish(void *kv)
     
   rd_kafka_flush (kh->producer, 10000);
 
-  /* Destroy topic object */
+  nvds_log(NVDS_KAFKA_LOG_CAT, LOG_INFO, "%lu messages sent, %lu payload bytes copied (%.1f per message)\n",
+           (unsigned long) kh->num_msgs, (unsigned long) kh->bytes_copied,
+           kh->num_msgs ? (double) kh->bytes_copied / kh->num_msgs : 0.0);
+  nvds_log(NVDS_KAFKA_LOG_CAT, LOG_INFO, "completion pool: %u slots, peak %u in use, %lu allocations on exhaustion\n",
+           kh->compl_pool.capacity, kh->compl_pool.unused < kh->compl_pool.capacity ?
+           kh->compl_pool.unused : kh->compl_pool.capacity, (unsigned long) kh->compl_pool.exhausted);
+
+  /* Destroy topic objects */
   rd_kafka_topic_destroy(kh->topic);
+  g_hash_table_destroy(kh->topics);
+  g_rw_lock_clear(&kh->topics_lock);
 
   /* Destroy the producer instance */
   rd_kafka_destroy( kh->producer );
 
+  g_mutex_clear(&kh->sync_lock);
+  g_cond_clear(&kh->sync_cond);
+  free(kh->compl_pool.slots);
+  kh->compl_pool.slots = NULL;
+
+}
+
+/**
+  Returns size of completion pool and number of completions allocated
+  because it was exhausted
+ */
+void nvds_kafka_client_get_compl_stats(void *kv, uint32_t *capacity, uint64_t *exhausted)
+{
+  NvDsKafkaClientHandle *kh = (NvDsKafkaClientHandle *)kv;
+
+  *capacity = kh->compl_pool.capacity;
+  *exhausted = kh->compl_pool.exhausted;
 }
 
 void nvds_kafka_client_poll(void *kv)
 {
   NvDsKafkaClientHandle *kh = (NvDsKafkaClientHandle *)kv;
+  // skipped while a sync sender polls, it serves the reports itself
   if (kh)
-    rd_kafka_poll(kh->producer, 0/*non-blocking*/);
+    poll_reports(kh, 0/*non-blocking*/);
 }
@@ -11,38 +11,16 @@
 
 #include "nvds_msgapi.h"
 
-class NvDsKafkaSendCompl {
- public:
-  virtual void sendcomplete(NvDsMsgApiErrorType);
-  NvDsMsgApiErrorType get_err();
-};
-
-class NvDsKafkaSyncSendCompl: public NvDsKafkaSendCompl {
- private:
-  uint8_t *compl_flag;
-  NvDsMsgApiErrorType err;
-
- public:
-  NvDsKafkaSyncSendCompl(uint8_t *);
-  void sendcomplete(NvDsMsgApiErrorType);
-  NvDsMsgApiErrorType get_err();
-};
-
-class NvDsKafkaAsyncSendCompl: public NvDsKafkaSendCompl {
- private:
-  void *user_ptr;
-  nvds_msgapi_send_cb_t async_send_cb;
-
- public:
-  NvDsKafkaAsyncSendCompl(void *ctx, nvds_msgapi_send_cb_t cb);
-  void sendcomplete(NvDsMsgApiErrorType);
-};
-
 void *nvds_kafka_client_init(char *brokers, char *topic);
 NvDsMsgApiErrorType nvds_kafka_client_launch(void *kh);
-NvDsMsgApiErrorType nvds_kafka_client_send(void *kh, const uint8_t *payload, int len, int sync, void *ctx, nvds_msgapi_send_cb_t cb,  char *key, int keylen);
+// topic NULL for topic given at init
+NvDsMsgApiErrorType nvds_kafka_client_send(void *kh, const char *topic, const uint8_t *payload, int len, int sync, void *ctx, nvds_msgapi_send_cb_t cb,  char *key, int keylen,
+                                           nvds_msgapi_release_cb_t release_cb = NULL, void *release_ptr = NULL);
+NvDsMsgApiErrorType nvds_kafka_client_send_batch(void *kv, const char *topic, const NvDsMsgApiBatchMsg *msgs, int nmsgs, void *ctx, nvds_msgapi_send_cb_t cb);
 NvDsMsgApiErrorType nvds_kafka_client_setconf(void *kh, char *key, char *val);
+void nvds_kafka_client_set_sync_timeout(void *kv, int timeout_ms);
 void nvds_kafka_client_poll(void *kv);
 void nvds_kafka_client_finish(void *kv);
+void nvds_kafka_client_get_compl_stats(void *kv, uint32_t *capacity, uint64_t *exhausted);
 
 #define NVDS_KAFKA_LOG_CAT "NVDS_KAFKA_PROTO"
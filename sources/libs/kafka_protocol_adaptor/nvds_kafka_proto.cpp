@@ -33,6 +33,7 @@
 
 #define CONFIG_GROUP_MSG_BROKER "message-broker"
 #define CONFIG_GROUP_MSG_BROKER_RDKAFKA_CFG "proto-cfg"
+#define CONFIG_GROUP_MSG_BROKER_SYNC_TIMEOUT "sync-send-timeout"
 
 int json_get_key_value(const char *msg, int msglen, const char *key, char *value, int nbuf);
 
@@ -54,6 +55,7 @@ enable=1
 broker-proto-lib=/usr/local/deepstream/libnvds_kafka_proto.so
 broker-conn-str=kafka1.data.nvidiagrid.net;9092;metromind-test-1
 rdkafka-cfg="message.timeout.ms=2000"
+sync-send-timeout=5000   (optional max wait of sync send in ms)
 
  */
 static void nvds_kafka_read_config(void *kh, char *config_path)
@@ -77,6 +79,17 @@ static void nvds_kafka_read_config(void *kh, char *config_path)
      nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR,  "Error parsing config file. %s\n", error->message);
      return; 
   }
+
+  if (g_key_file_has_key(key_file, CONFIG_GROUP_MSG_BROKER, CONFIG_GROUP_MSG_BROKER_SYNC_TIMEOUT, NULL)) {
+    int timeout = g_key_file_get_integer(key_file, CONFIG_GROUP_MSG_BROKER,
+                                         CONFIG_GROUP_MSG_BROKER_SYNC_TIMEOUT, &error);
+    if (error) {
+      nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR,  "Error parsing "CONFIG_GROUP_MSG_BROKER_SYNC_TIMEOUT" entry. %s\n", error->message);
+      g_clear_error(&error);
+    } else
+      nvds_kafka_client_set_sync_timeout(kh, timeout);
+  }
+
   for (key = keys; *key; key++) {
     gchar *setvalquote; 
     
@@ -317,69 +330,145 @@ NvDsMsgApiHandle nvds_msgapi_connect(char *connection_str,  nvds_msgapi_connect_
   return (NvDsMsgApiHandle)(conn_ptr);
 }
 
+/**
+ * Returns key of message: @a key if given, else sensor.id field of json
+ * payload copied into @a idval, NULL if not found.
+ */
+static const char *kafka_message_key(const uint8_t *payload, size_t nbuf,
+                                     const char *key, size_t *keylen,
+                                     char *idval, int nbufid)
+{
+  int retval;
+
+  if (key)
+    return key;
+
+  //sensor.id json field indicating kafka msg key hard coded for now; can also be retrieved from config file
+  retval = json_get_key_value((const char *)payload, nbuf, "sensor.id" , idval, nbufid);
+  if (!retval) {
+    nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR, "no matching json field found \
+        based on kafka key config; using default partition\n");
+    *keylen = 0;
+    return NULL;
+  }
+  *keylen = retval;
+  return idval;
+}
+
+/**
+ * Messages can be sent to any topic, topic objects of topics other than the
+ * one of connect are created on first use.
+ */
+static int kafka_valid_topic(const char *topic, const char *fn)
+{
+  if (!topic || !topic[0] || strlen(topic) >= MAX_FIELD_LEN) {
+    nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR, "%s: invalid send topic\n", fn);
+    return 0;
+  }
+  return 1;
+}
+
 //There could be several synchronous and asychronous send operations in flight.
 //Once a send operation callback is received the course of action  depends on if it's synch or async
 // -- if it's sync then the associated complletion flag should  be set
 // -- if it's asynchronous then completion callback from the user should be called
-NvDsMsgApiErrorType nvds_msgapi_send(NvDsMsgApiHandle h_ptr, char *topic, const uint8_t *payload, size_t nbuf)
+NvDsMsgApiErrorType nvds_msgapi_send_with_key(NvDsMsgApiHandle h_ptr, char *topic, const uint8_t *payload, size_t nbuf, const char *key, size_t keylen)
 {
   char idval[100];
-  int retval;
 
   nvds_log(NVDS_KAFKA_LOG_CAT, LOG_DEBUG, \
     "nvds_msgapi_send: payload=%.*s, \n topic = %s, h->topic = %s\n"\
            , nbuf, payload, topic, (((NvDsKafkaProtoConn *) h_ptr)->topic));
 
-  if (strcmp(topic, (((NvDsKafkaProtoConn *) h_ptr)->topic))) {
-     nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR, "nvds_msgapi_send: send topic has \
-                                             to match topic defined at connect.\n");
-     return NVDS_MSGAPI_ERR;
-  }
-
-  //sensor.id json field indicating kafka msg key hard coded for now; can also be retrieved from config file
-  retval = json_get_key_value((const char *)payload, nbuf, "sensor.id" , idval, sizeof(idval));
-
+  if (!kafka_valid_topic(topic, "nvds_msgapi_send"))
+    return NVDS_MSGAPI_ERR;
 
-  if (retval)
-    return nvds_kafka_client_send(((NvDsKafkaProtoConn *) h_ptr)->kh, payload, nbuf, 1, NULL, NULL, idval, strlen(idval));
-  else {
-      nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR, "nvds_msgapi_send: \
-                  no matching json field found based on kafka key config; \
-                  using default partition\n");
+  key = kafka_message_key(payload, nbuf, key, &keylen, idval, sizeof(idval));
+  return nvds_kafka_client_send(((NvDsKafkaProtoConn *) h_ptr)->kh, topic, payload, nbuf, 1, NULL, NULL, (char *) key, keylen);
+}
 
-       return nvds_kafka_client_send(((NvDsKafkaProtoConn *) h_ptr)->kh, payload, nbuf, 1, NULL, NULL, NULL, 0);
-  }
+NvDsMsgApiErrorType nvds_msgapi_send(NvDsMsgApiHandle h_ptr, char *topic, const uint8_t *payload, size_t nbuf)
+{
+  return nvds_msgapi_send_with_key(h_ptr, topic, payload, nbuf, NULL, 0);
 }
 
-NvDsMsgApiErrorType nvds_msgapi_send_async(NvDsMsgApiHandle h_ptr, char *topic, const uint8_t *payload, size_t nbuf,  nvds_msgapi_send_cb_t send_callback, void *user_ptr)
+NvDsMsgApiErrorType nvds_msgapi_send_async_with_key(NvDsMsgApiHandle h_ptr, char *topic, const uint8_t *payload, size_t nbuf, const char *key, size_t keylen, nvds_msgapi_send_cb_t send_callback, void *user_ptr)
 {
   char idval[100];
-  int retval;
 
   nvds_log(NVDS_KAFKA_LOG_CAT, LOG_DEBUG, "nvds_msgapi_send_async: payload=%.*s, \
       \n topic = %s, h->topic = %s\n", nbuf, payload, topic, \
        (((NvDsKafkaProtoConn *) h_ptr)->topic));
 
-  if (strcmp(topic, (((NvDsKafkaProtoConn *) h_ptr)->topic))) {
-     nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR, "nvds_msgapi_send_async: \
-        send topic has to match topic defined at connect.\n");
-     return NVDS_MSGAPI_ERR;
-  }
+  if (!kafka_valid_topic(topic, "nvds_msgapi_send_async"))
+    return NVDS_MSGAPI_ERR;
 
-  //sensor.id json field indicating kafka msg key hard coded for now; can also be retrieved from config file
-  retval = json_get_key_value((const char *)payload, nbuf, "sensor.id" , idval, sizeof(idval));
+  key = kafka_message_key(payload, nbuf, key, &keylen, idval, sizeof(idval));
+  return nvds_kafka_client_send(((NvDsKafkaProtoConn *) h_ptr)->kh, topic, payload, nbuf, 0, user_ptr, \
+             send_callback, (char *) key, keylen);
+}
 
-  if (retval)
-    return nvds_kafka_client_send(((NvDsKafkaProtoConn *) h_ptr)->kh, payload, nbuf, 0, user_ptr, \
-             send_callback, idval, strlen(idval));
-  else {
-    nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR, "no matching json field found \
-        based on kafka key config; using default partition\n");
-    return nvds_kafka_client_send(((NvDsKafkaProtoConn *) h_ptr)->kh, payload, nbuf, 0, user_ptr, \
-                  send_callback, NULL, 0);
+NvDsMsgApiErrorType nvds_msgapi_send_async(NvDsMsgApiHandle h_ptr, char *topic, const uint8_t *payload, size_t nbuf,  nvds_msgapi_send_cb_t send_callback, void *user_ptr)
+{
+  return nvds_msgapi_send_async_with_key(h_ptr, topic, payload, nbuf, NULL, 0, send_callback, user_ptr);
+}
 
+//payload is handed to librdkafka without copy; release_cb is called once it's no longer referenced
+NvDsMsgApiErrorType nvds_msgapi_send_async_no_copy(NvDsMsgApiHandle h_ptr, char *topic, const uint8_t *payload, size_t nbuf, const char *key, size_t keylen,
+                                                   nvds_msgapi_send_cb_t send_callback, void *user_ptr, nvds_msgapi_release_cb_t release_cb, void *release_ptr)
+{
+  char idval[100];
+
+  if (!kafka_valid_topic(topic, "nvds_msgapi_send_async_no_copy"))
+    return NVDS_MSGAPI_ERR;
+
+  // key is copied by rd_kafka_produce, idval may live on the stack
+  key = kafka_message_key(payload, nbuf, key, &keylen, idval, sizeof(idval));
+  return nvds_kafka_client_send(((NvDsKafkaProtoConn *) h_ptr)->kh, topic, payload, nbuf, 0, user_ptr, \
+             send_callback, (char *) key, keylen, release_cb, release_ptr);
+}
+
+#define BATCH_KEY_LEN 100
+
+//all messages of batch are enqueued at once; keys missing are looked up in their payloads
+NvDsMsgApiErrorType nvds_msgapi_send_batch(NvDsMsgApiHandle h_ptr, char *topic, const NvDsMsgApiBatchMsg *msgs, size_t nmsgs, nvds_msgapi_send_cb_t send_callback, void *user_ptr)
+{
+  NvDsMsgApiBatchMsg *batch = NULL;
+  NvDsMsgApiErrorType err;
+  char *idval;
+  size_t i, nokey = 0;
+
+  if (!kafka_valid_topic(topic, "nvds_msgapi_send_batch"))
+    return NVDS_MSGAPI_ERR;
+
+  if (!nmsgs) {
+    nvds_log(NVDS_KAFKA_LOG_CAT, LOG_ERR, "nvds_msgapi_send_batch: empty batch\n");
+    return NVDS_MSGAPI_ERR;
+  }
+
+  for (i = 0; i < nmsgs; i++)
+    if (!msgs[i].key)
+      nokey++;
+
+  if (nokey) {
+    //copy of batch followed by buffers of keys found in payloads
+    batch = (NvDsMsgApiBatchMsg *)malloc(nmsgs * sizeof(NvDsMsgApiBatchMsg) + nokey * BATCH_KEY_LEN);
+    if (!batch)
+      return NVDS_MSGAPI_ERR;
+    idval = (char *)(batch + nmsgs);
+    for (i = 0; i < nmsgs; i++) {
+      batch[i] = msgs[i];
+      if (!msgs[i].key) {
+        batch[i].key = kafka_message_key(msgs[i].payload, msgs[i].nbuf, NULL, &batch[i].keylen, idval, BATCH_KEY_LEN);
+        idval += BATCH_KEY_LEN;
+      }
+    }
+    msgs = batch;
   }
 
+  err = nvds_kafka_client_send_batch(((NvDsKafkaProtoConn *) h_ptr)->kh, topic, msgs, nmsgs, user_ptr, send_callback);
+  free(batch);
+  return err;
 }
 
 void nvds_msgapi_do_work(NvDsMsgApiHandle h_ptr)
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Checks lookup of kafka message key in json payloads and reports its time
+ * for a full DeepStream schema message.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_COUNT 1000000
+
+int json_get_key_value(const char *msg, int msglen, const char *path, char *value, int nbuf);
+
+typedef struct {
+  const char *json;
+  const char *expected; /* NULL if not found */
+} KeyCase;
+
+static const KeyCase cases[] = {
+  {"{\"sensor\":{\"id\":\"CAM_0\"}}", "CAM_0"},
+  {" {\n \"sensor\" : { \"type\" : \"Camera\", \"id\" : \"CAM_1\" } }", "CAM_1"},
+  /* members before sensor with nested objects, arrays and tricky strings */
+  {"{\"a\":{\"sensor\":{\"id\":\"no\"}},\"b\":[1,{\"c\":\"}\"}],\"d\":\"\\\"{\","
+   "\"e\":-1.5e3,\"f\":true,\"g\":null,\"sensor\":{\"id\":\"CAM_2\"}}", "CAM_2"},
+  /* first match wins */
+  {"{\"sensor\":{\"id\":\"first\",\"id\":\"second\"}}", "first"},
+  {"{\"sensor\":{\"id\":\"A\\u00e9\\n\\\\\"}}", "A\xc3\xa9\n\\"},
+  /* raw UTF-8 is copied as is, same key as escaped form */
+  {"{\"sensor\":{\"id\":\"caf\xc3\xa9\"}}", "caf\xc3\xa9"},
+  {"{\"sensor\":{\"id\":\"\xe6\x91\x84\xe5\x83\x8f\\u00e9\"}}", "\xe6\x91\x84\xe5\x83\x8f\xc3\xa9"},
+  {"{\"sensor\":{\"id\":5}}", NULL},
+  {"{\"sensor\":\"CAM_0\"}", NULL},
+  {"{\"sensor\":{\"ids\":\"CAM_0\"},\"id\":\"x\"}", NULL},
+  {"{\"sensorx\":{\"id\":\"CAM_0\"}}", NULL},
+  {"[{\"sensor\":{\"id\":\"CAM_0\"}}]", NULL},
+  {"{\"sensor\":{\"id\":\"CAM_0", NULL},
+  {"{\"sensor\":{\"id\":\"0123456789012345678901234567890123456789\"}}", NULL},
+  {"NVZ\x01", NULL},
+  {"", NULL},
+};
+
+static const char *message =
+  "{\"messageid\":\"84a3a0ad-7eb8-49a2-9aa7-104ded6764d0\","
+  "\"mdsversion\":\"1.0\",\"@timestamp\":\"2018-04-11T04:59:59.828Z\","
+  "\"place\":{\"id\":\"1\",\"name\":\"XYZ\",\"type\":\"garage\","
+  "\"location\":{\"lat\":30.32,\"lon\":-40.55,\"alt\":100.0},"
+  "\"entrance\":{\"name\":\"walsh\",\"lane\":\"lane1\",\"level\":\"P2\","
+  "\"coordinate\":{\"x\":1.0,\"y\":2.0,\"z\":3.0}}},"
+  "\"sensor\":{\"id\":\"CAMERA_ID\",\"type\":\"Camera\","
+  "\"description\":\"Entrance of Garage Right Lane\","
+  "\"location\":{\"lat\":45.293701447,\"lon\":-75.8303914499,\"alt\":48.1557479338},"
+  "\"coordinate\":{\"x\":5.2,\"y\":10.1,\"z\":11.2}},"
+  "\"analyticsModule\":{\"id\":\"XYZ\",\"description\":\"Vehicle Detection\","
+  "\"source\":\"OpenALR\",\"version\":\"1.0\"},"
+  "\"object\":{\"id\":\"-1\",\"speed\":0.0,\"direction\":0.0,\"orientation\":0.0,"
+  "\"vehicle\":{\"type\":\"sedan\",\"make\":\"Bugatti\",\"model\":\"M\","
+  "\"color\":\"blue\",\"licenseState\":\"CA\",\"license\":\"XX1234\","
+  "\"confidence\":0.0},\"bbox\":{\"topleftx\":0,\"toplefty\":0,"
+  "\"bottomrightx\":0,\"bottomrighty\":0},\"location\":{},\"coordinate\":{}},"
+  "\"event\":{\"id\":\"4bb3b5d9-fa0e-4bf2-a4e3-3e4d9fe1d1f4\",\"type\":\"moving\"},"
+  "\"videoPath\":\"\"}";
+
+int main()
+{
+  char value[32];
+  struct timespec start, end;
+  unsigned int i;
+  int len;
+  int failed = 0;
+  double ns;
+
+  for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    memset(value, 0, sizeof(value));
+    len = json_get_key_value(cases[i].json, strlen(cases[i].json), "sensor.id",
+                             value, sizeof(value));
+    if (cases[i].expected ? (len != (int) strlen(cases[i].expected) ||
+                             strcmp(value, cases[i].expected)) : len != 0) {
+      printf("case %u: got %d \"%s\", expected %s\n", i, len, value,
+             cases[i].expected ? cases[i].expected : "no key");
+      failed = 1;
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (i = 0; i < BENCH_COUNT; i++)
+    json_get_key_value(message, strlen(message), "sensor.id", value, sizeof(value));
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / BENCH_COUNT;
+  printf("sensor.id of %zu byte message: %.1f ns\n", strlen(message), ns);
+
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+  return failed;
+}
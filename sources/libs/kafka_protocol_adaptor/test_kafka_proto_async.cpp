@@ -45,6 +45,8 @@ int main()
    NvDsMsgApiErrorType (*msgapi_send_ptr)(NvDsMsgApiHandle conn, char *topic, const uint8_t *payload, size_t nbuf);
    NvDsMsgApiErrorType (*msgapi_send_async_ptr)(NvDsMsgApiHandle h_ptr, char  *topic, const uint8_t *payload, \
 				        size_t nbuf, nvds_msgapi_send_cb_t send_callback, void *user_ptr);
+   NvDsMsgApiErrorType (*msgapi_send_batch_ptr)(NvDsMsgApiHandle h_ptr, char *topic, const NvDsMsgApiBatchMsg *msgs, \
+                                        size_t nmsgs, nvds_msgapi_send_cb_t send_callback, void *user_ptr);
    void (*msgapi_do_work_ptr) (NvDsMsgApiHandle h_ptr); 
    NvDsMsgApiErrorType (*msgapi_disconnect_ptr)(NvDsMsgApiHandle h_ptr);
    void *so_handle = dlopen(KAFKA_PROTO_PATH, RTLD_LAZY);
@@ -133,7 +135,25 @@ int main()
 	printf("sending [%d] asynchronously\n", i);
     }
 
-    while(g_cb_count < 5) {
+    // same messages in one batch with single callback, if adaptor supports it
+    int expected_cb_count = 5;
+    *(void **) (&msgapi_send_batch_ptr) = dlsym(so_handle, "nvds_msgapi_send_batch");
+    if (msgapi_send_batch_ptr) {
+      NvDsMsgApiBatchMsg batch[5];
+      for(int i = 0; i < 5; i++) {
+        batch[i].payload = (const uint8_t*) SEND_MSG;
+        batch[i].nbuf = strlen(SEND_MSG);
+        batch[i].key = NULL;
+        batch[i].keylen = 0;
+      }
+      if (msgapi_send_batch_ptr(conn_handle, (char *)"yourtopic", batch, 5, test_send_cb, \
+                                (void *) "Batch send of 5 messages complete") != NVDS_MSGAPI_OK)
+        printf("batch send failed\n");
+      else
+        expected_cb_count++;
+    }
+
+    while(g_cb_count < expected_cb_count) {
       sleep(1);
       msgapi_do_work_ptr(conn_handle); // need to continuously call do_work to process callbacks
     }      
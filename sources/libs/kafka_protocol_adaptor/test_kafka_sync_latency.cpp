@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Reports latency distribution of sync sends of the kafka client, from
+ * one or more sender threads.
+ *
+ * ./test_kafka_sync_latency [-w] [threads [brokers]]
+ *
+ * Without brokers the mock cluster of librdkafka (test.mock.num.brokers,
+ * librdkafka 1.4 or later) is used as local broker. With -w a thread polls
+ * the client every millisecond as do_work of an async sender would,
+ * serving delivery reports sync senders are waiting for.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include "nvds_logger.h"
+#include "kafka_client.h"
+
+#define SENDS_PER_THREAD 2000
+#define MAX_THREADS 16
+#define TOPIC "latency-test"
+#define DO_WORK_INTERVAL_US 1000
+
+static const char SEND_MSG[] =
+  "{\"messageid\":\"84a3a0ad-7eb8-49a2-9aa7-104ded6764d0\","
+  "\"mdsversion\":\"1.0\",\"@timestamp\":\"2018-04-11T04:59:59.828Z\","
+  "\"sensor\":{\"id\":\"CAMERA_ID\",\"type\":\"Camera\"},"
+  "\"event\":{\"id\":\"4bb3b5d9-fa0e-4bf2-a4e3-3e4d9fe1d1f4\",\"type\":\"moving\"}}";
+
+typedef struct {
+  void *kh;
+  double *latency;  /* us, one per send */
+  int failed;
+} SenderCtx;
+
+static double now_us()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static std::atomic<int> do_work_running;
+
+static void *do_work(void *data)
+{
+  while (do_work_running) {
+    nvds_kafka_client_poll(data);
+    usleep(DO_WORK_INTERVAL_US);
+  }
+  return NULL;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+  double x = *(const double *) a, y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+static void *sender(void *data)
+{
+  SenderCtx *ctx = (SenderCtx *) data;
+  char key[] = "CAMERA_ID";
+  double start;
+  int i;
+
+  for (i = 0; i < SENDS_PER_THREAD; i++) {
+    start = now_us();
+    if (nvds_kafka_client_send(ctx->kh, NULL, (const uint8_t *) SEND_MSG, strlen(SEND_MSG),
+                               1, NULL, NULL, key, strlen(key)) != NVDS_MSGAPI_OK)
+      ctx->failed++;
+    ctx->latency[i] = now_us() - start;
+  }
+  return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+  int with_do_work = argc > 1 && !strcmp(argv[1], "-w");
+  int threads;
+  char *brokers;
+  pthread_t tid[MAX_THREADS];
+  pthread_t do_work_tid;
+  SenderCtx ctx[MAX_THREADS];
+  double *latency;
+  double sum = 0;
+  uint32_t pool_size;
+  uint64_t pool_exhausted;
+  int total, failed = 0;
+  int i;
+  void *kh;
+
+  if (with_do_work) {
+    argc--;
+    argv++;
+  }
+  threads = argc > 1 ? atoi(argv[1]) : 1;
+  brokers = argc > 2 ? argv[2] : (char *) "localhost:9092";
+
+  if (threads < 1 || threads > MAX_THREADS) {
+    printf("threads must be 1 to %d\n", MAX_THREADS);
+    return 1;
+  }
+
+  nvds_log_open();
+  kh = nvds_kafka_client_init(brokers, (char *) TOPIC);
+  if (!kh) {
+    printf("init failed\n");
+    return 1;
+  }
+  if (argc <= 2 &&
+      nvds_kafka_client_setconf(kh, (char *) "test.mock.num.brokers", (char *) "1") != NVDS_MSGAPI_OK) {
+    printf("mock cluster not supported by librdkafka, give brokers\n");
+    return 1;
+  }
+  nvds_kafka_client_set_sync_timeout(kh, 5000);
+  if (nvds_kafka_client_launch(kh) != NVDS_MSGAPI_OK) {
+    printf("launch failed\n");
+    return 1;
+  }
+
+  total = threads * SENDS_PER_THREAD;
+  latency = (double *) malloc(total * sizeof(double));
+
+  // first send waits for topic metadata, not part of the measurement
+  nvds_kafka_client_send(kh, NULL, (const uint8_t *) SEND_MSG, strlen(SEND_MSG), 1, NULL, NULL, NULL, 0);
+
+  if (with_do_work) {
+    do_work_running = 1;
+    pthread_create(&do_work_tid, NULL, do_work, kh);
+  }
+  for (i = 0; i < threads; i++) {
+    ctx[i].kh = kh;
+    ctx[i].latency = latency + i * SENDS_PER_THREAD;
+    ctx[i].failed = 0;
+    pthread_create(&tid[i], NULL, sender, &ctx[i]);
+  }
+  for (i = 0; i < threads; i++) {
+    pthread_join(tid[i], NULL);
+    failed += ctx[i].failed;
+  }
+  if (with_do_work) {
+    do_work_running = 0;
+    pthread_join(do_work_tid, NULL);
+  }
+
+  qsort(latency, total, sizeof(double), compare_double);
+  for (i = 0; i < total; i++)
+    sum += latency[i];
+
+  printf("%d sync sends from %d threads%s, %d failed\n", total, threads,
+         with_do_work ? " with do_work" : "", failed);
+  printf("latency us: mean %.1f p50 %.1f p90 %.1f p99 %.1f max %.1f\n",
+         sum / total, latency[total / 2], latency[total * 90 / 100],
+         latency[total * 99 / 100], latency[total - 1]);
+  nvds_kafka_client_get_compl_stats(kh, &pool_size, &pool_exhausted);
+  printf("completion pool of %u, %lu allocations on exhaustion\n", pool_size,
+         (unsigned long) pool_exhausted);
+
+  free(latency);
+  nvds_kafka_client_finish(kh);
+  nvds_log_close();
+  return failed ? 1 : 0;
+}
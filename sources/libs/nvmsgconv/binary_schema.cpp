@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#include "binary_schema.h"
+#include "id_generator.h"
+#include <string.h>
+
+#define NVDS_BINARY_MAGIC0 'D'
+#define NVDS_BINARY_MAGIC1 'B'
+#define NVDS_BINARY_NULL_STRING 0xFFFFFFFF
+
+static inline void
+write_u32 (GString *buf, guint32 value)
+{
+  value = GUINT32_TO_LE (value);
+  g_string_append_len (buf, (const gchar *) &value, sizeof (value));
+}
+
+static inline void
+write_double (GString *buf, gdouble value)
+{
+  guint64 bits;
+
+  memcpy (&bits, &value, sizeof (bits));
+  bits = GUINT64_TO_LE (bits);
+  g_string_append_len (buf, (const gchar *) &bits, sizeof (bits));
+}
+
+static void
+write_string (GString *buf, const gchar *str)
+{
+  if (!str) {
+    write_u32 (buf, NVDS_BINARY_NULL_STRING);
+    return;
+  }
+
+  gsize len = strlen (str);
+  write_u32 (buf, len);
+  g_string_append_len (buf, str, len);
+}
+
+static void
+write_ext_object (GString *buf, NvDsEventMsgMeta *meta)
+{
+  switch (meta->objType) {
+    case NVDS_OBJECT_TYPE_VEHICLE:
+    {
+      NvDsVehicleObject *dsObj = (NvDsVehicleObject *) meta->extMsg;
+      write_string (buf, dsObj->type);
+      write_string (buf, dsObj->make);
+      write_string (buf, dsObj->model);
+      write_string (buf, dsObj->color);
+      write_string (buf, dsObj->region);
+      write_string (buf, dsObj->license);
+      break;
+    }
+    case NVDS_OBJECT_TYPE_PERSON:
+    {
+      NvDsPersonObject *dsObj = (NvDsPersonObject *) meta->extMsg;
+      write_u32 (buf, dsObj->age);
+      write_string (buf, dsObj->gender);
+      write_string (buf, dsObj->hair);
+      write_string (buf, dsObj->cap);
+      write_string (buf, dsObj->apparel);
+      break;
+    }
+    case NVDS_OBJECT_TYPE_FACE:
+    {
+      NvDsFaceObject *dsObj = (NvDsFaceObject *) meta->extMsg;
+      write_u32 (buf, dsObj->age);
+      write_string (buf, dsObj->gender);
+      write_string (buf, dsObj->hair);
+      write_string (buf, dsObj->cap);
+      write_string (buf, dsObj->glasses);
+      write_string (buf, dsObj->facialhair);
+      write_string (buf, dsObj->name);
+      write_string (buf, dsObj->eyecolor);
+      break;
+    }
+    default:
+      write_u32 (buf, meta->extMsgSize);
+      g_string_append_len (buf, (const gchar *) meta->extMsg,
+                           meta->extMsgSize);
+      break;
+  }
+}
+
+void
+nvds_binary_write_message (GString *buf, NvDsEventMsgMeta *meta,
+                           const gchar *ts, const guint8 *messageId,
+                           const guint8 *eventId)
+{
+  gsize start = buf->len;
+  guint8 flags = 0;
+  guint32 size;
+  guint i;
+
+  if (meta->extMsgSize && meta->extMsg)
+    flags |= NVDS_BINARY_FLAG_EXT_OBJECT;
+
+  g_string_append_c (buf, NVDS_BINARY_MAGIC0);
+  g_string_append_c (buf, NVDS_BINARY_MAGIC1);
+  g_string_append_c (buf, NVDS_BINARY_SCHEMA_VERSION);
+  g_string_append_c (buf, flags);
+  // size is updated once whole message is written.
+  write_u32 (buf, 0);
+
+  g_string_append_len (buf, (const gchar *) messageId, NVDS_ID_SIZE);
+  g_string_append_len (buf, (const gchar *) eventId, NVDS_ID_SIZE);
+
+  write_u32 (buf, meta->type);
+  write_u32 (buf, meta->objType);
+  write_u32 (buf, meta->sensorId);
+  write_u32 (buf, meta->placeId);
+  write_u32 (buf, meta->moduleId);
+  write_u32 (buf, meta->componentId);
+  write_u32 (buf, meta->objClassId);
+  write_u32 (buf, meta->trackingId);
+
+  write_u32 (buf, meta->bbox.top);
+  write_u32 (buf, meta->bbox.left);
+  write_u32 (buf, meta->bbox.width);
+  write_u32 (buf, meta->bbox.height);
+
+  write_double (buf, meta->location.lat);
+  write_double (buf, meta->location.lon);
+  write_double (buf, meta->location.alt);
+  write_double (buf, meta->coordinate.x);
+  write_double (buf, meta->coordinate.y);
+  write_double (buf, meta->coordinate.z);
+  write_double (buf, meta->confidence);
+
+  write_string (buf, ts);
+  write_string (buf, meta->objectId);
+  write_string (buf, meta->otherAttrs);
+  write_string (buf, meta->videoPath);
+
+  write_u32 (buf, meta->objSignature.size);
+  for (i = 0; i < meta->objSignature.size; i++)
+    write_double (buf, meta->objSignature.signature[i]);
+
+  if (flags & NVDS_BINARY_FLAG_EXT_OBJECT)
+    write_ext_object (buf, meta);
+
+  size = GUINT32_TO_LE ((guint32) (buf->len - start));
+  memcpy (buf->str + start + 4, &size, sizeof (size));
+}
+
+/**
+ * Bounds checked cursor over the message being decoded. Once a read goes
+ * past the end, @a error is set and all further reads return zeros.
+ */
+struct NvDsBinaryReader {
+  const guint8 *pos;
+  const guint8 *end;
+  gboolean error;
+};
+
+static gboolean
+read_bytes (NvDsBinaryReader *reader, void *out, gsize len)
+{
+  if (reader->error || (gsize) (reader->end - reader->pos) < len) {
+    reader->error = TRUE;
+    memset (out, 0, len);
+    return FALSE;
+  }
+  memcpy (out, reader->pos, len);
+  reader->pos += len;
+  return TRUE;
+}
+
+static guint32
+read_u32 (NvDsBinaryReader *reader)
+{
+  guint32 value;
+
+  read_bytes (reader, &value, sizeof (value));
+  return GUINT32_FROM_LE (value);
+}
+
+static gdouble
+read_double (NvDsBinaryReader *reader)
+{
+  guint64 bits;
+  gdouble value;
+
+  read_bytes (reader, &bits, sizeof (bits));
+  bits = GUINT64_FROM_LE (bits);
+  memcpy (&value, &bits, sizeof (value));
+  return value;
+}
+
+static gchar *
+read_string (NvDsBinaryReader *reader)
+{
+  guint32 len = read_u32 (reader);
+  gchar *str;
+
+  if (reader->error || len == NVDS_BINARY_NULL_STRING)
+    return NULL;
+
+  if ((gsize) (reader->end - reader->pos) < len) {
+    reader->error = TRUE;
+    return NULL;
+  }
+
+  str = g_strndup ((const gchar *) reader->pos, len);
+  reader->pos += len;
+  return str;
+}
+
+static void
+read_id (NvDsBinaryReader *reader, gchar *str)
+{
+  guint8 id[NVDS_ID_SIZE];
+
+  read_bytes (reader, id, sizeof (id));
+  id_format (id, str);
+  str[NVDS_ID_STR_LEN] = '\0';
+}
+
+static void
+read_ext_object (NvDsBinaryReader *reader, NvDsEventMsgMeta *meta)
+{
+  switch (meta->objType) {
+    case NVDS_OBJECT_TYPE_VEHICLE:
+    {
+      NvDsVehicleObject *dsObj = g_new0 (NvDsVehicleObject, 1);
+      dsObj->type = read_string (reader);
+      dsObj->make = read_string (reader);
+      dsObj->model = read_string (reader);
+      dsObj->color = read_string (reader);
+      dsObj->region = read_string (reader);
+      dsObj->license = read_string (reader);
+      meta->extMsg = dsObj;
+      meta->extMsgSize = sizeof (NvDsVehicleObject);
+      break;
+    }
+    case NVDS_OBJECT_TYPE_PERSON:
+    {
+      NvDsPersonObject *dsObj = g_new0 (NvDsPersonObject, 1);
+      dsObj->age = read_u32 (reader);
+      dsObj->gender = read_string (reader);
+      dsObj->hair = read_string (reader);
+      dsObj->cap = read_string (reader);
+      dsObj->apparel = read_string (reader);
+      meta->extMsg = dsObj;
+      meta->extMsgSize = sizeof (NvDsPersonObject);
+      break;
+    }
+    case NVDS_OBJECT_TYPE_FACE:
+    {
+      NvDsFaceObject *dsObj = g_new0 (NvDsFaceObject, 1);
+      dsObj->age = read_u32 (reader);
+      dsObj->gender = read_string (reader);
+      dsObj->hair = read_string (reader);
+      dsObj->cap = read_string (reader);
+      dsObj->glasses = read_string (reader);
+      dsObj->facialhair = read_string (reader);
+      dsObj->name = read_string (reader);
+      dsObj->eyecolor = read_string (reader);
+      meta->extMsg = dsObj;
+      meta->extMsgSize = sizeof (NvDsFaceObject);
+      break;
+    }
+    default:
+    {
+      guint32 size = read_u32 (reader);
+
+      if (reader->error || (gsize) (reader->end - reader->pos) < size) {
+        reader->error = TRUE;
+        break;
+      }
+      meta->extMsg = g_memdup (reader->pos, size);
+      meta->extMsgSize = size;
+      reader->pos += size;
+      break;
+    }
+  }
+}
+
+gsize
+nvds_binary_decode (const guint8 *data, gsize size, NvDsBinaryMessage *msg)
+{
+  NvDsEventMsgMeta *meta = &msg->meta;
+  NvDsBinaryReader reader;
+  guint32 msgSize;
+  guint8 flags;
+  guint i;
+
+  memset (msg, 0, sizeof (NvDsBinaryMessage));
+
+  if (size < NVDS_BINARY_HEADER_SIZE || data[0] != NVDS_BINARY_MAGIC0 ||
+      data[1] != NVDS_BINARY_MAGIC1 || data[2] != NVDS_BINARY_SCHEMA_VERSION)
+    return 0;
+
+  msg->version = data[2];
+  flags = data[3];
+  memcpy (&msgSize, data + 4, sizeof (msgSize));
+  msgSize = GUINT32_FROM_LE (msgSize);
+  if (msgSize < NVDS_BINARY_HEADER_SIZE || msgSize > size)
+    return 0;
+
+  reader.pos = data + NVDS_BINARY_HEADER_SIZE;
+  reader.end = data + msgSize;
+  reader.error = FALSE;
+
+  read_id (&reader, msg->messageId);
+  read_id (&reader, msg->eventId);
+
+  meta->type = (NvDsEventType) read_u32 (&reader);
+  meta->objType = (NvDsObjectType) read_u32 (&reader);
+  meta->sensorId = read_u32 (&reader);
+  meta->placeId = read_u32 (&reader);
+  meta->moduleId = read_u32 (&reader);
+  meta->componentId = read_u32 (&reader);
+  meta->objClassId = read_u32 (&reader);
+  meta->trackingId = read_u32 (&reader);
+
+  meta->bbox.top = read_u32 (&reader);
+  meta->bbox.left = read_u32 (&reader);
+  meta->bbox.width = read_u32 (&reader);
+  meta->bbox.height = read_u32 (&reader);
+
+  meta->location.lat = read_double (&reader);
+  meta->location.lon = read_double (&reader);
+  meta->location.alt = read_double (&reader);
+  meta->coordinate.x = read_double (&reader);
+  meta->coordinate.y = read_double (&reader);
+  meta->coordinate.z = read_double (&reader);
+  meta->confidence = read_double (&reader);
+
+  meta->ts = read_string (&reader);
+  meta->objectId = read_string (&reader);
+  meta->otherAttrs = read_string (&reader);
+  meta->videoPath = read_string (&reader);
+
+  meta->objSignature.size = read_u32 (&reader);
+  if (meta->objSignature.size) {
+    // each value needs 8 bytes, don't trust count of malformed message.
+    if ((gsize) (reader.end - reader.pos) / sizeof (guint64) <
+        meta->objSignature.size) {
+      reader.error = TRUE;
+      meta->objSignature.size = 0;
+    } else {
+      meta->objSignature.signature = g_new (gdouble, meta->objSignature.size);
+      for (i = 0; i < meta->objSignature.size; i++)
+        meta->objSignature.signature[i] = read_double (&reader);
+    }
+  }
+
+  if (!reader.error && (flags & NVDS_BINARY_FLAG_EXT_OBJECT))
+    read_ext_object (&reader, meta);
+
+  if (reader.error) {
+    nvds_binary_message_clear (msg);
+    return 0;
+  }
+
+  return msgSize;
+}
+
+void
+nvds_binary_message_clear (NvDsBinaryMessage *msg)
+{
+  NvDsEventMsgMeta *meta = &msg->meta;
+
+  g_free (meta->ts);
+  g_free (meta->objectId);
+  g_free (meta->otherAttrs);
+  g_free (meta->videoPath);
+  g_free (meta->objSignature.signature);
+
+  if (meta->extMsgSize) {
+    switch (meta->objType) {
+      case NVDS_OBJECT_TYPE_VEHICLE:
+      {
+        NvDsVehicleObject *dsObj = (NvDsVehicleObject *) meta->extMsg;
+        g_free (dsObj->type);
+        g_free (dsObj->make);
+        g_free (dsObj->model);
+        g_free (dsObj->color);
+        g_free (dsObj->region);
+        g_free (dsObj->license);
+        break;
+      }
+      case NVDS_OBJECT_TYPE_PERSON:
+      {
+        NvDsPersonObject *dsObj = (NvDsPersonObject *) meta->extMsg;
+        g_free (dsObj->gender);
+        g_free (dsObj->hair);
+        g_free (dsObj->cap);
+        g_free (dsObj->apparel);
+        break;
+      }
+      case NVDS_OBJECT_TYPE_FACE:
+      {
+        NvDsFaceObject *dsObj = (NvDsFaceObject *) meta->extMsg;
+        g_free (dsObj->gender);
+        g_free (dsObj->hair);
+        g_free (dsObj->cap);
+        g_free (dsObj->glasses);
+        g_free (dsObj->facialhair);
+        g_free (dsObj->name);
+        g_free (dsObj->eyecolor);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  g_free (meta->extMsg);
+
+  memset (msg, 0, sizeof (NvDsBinaryMessage));
+}
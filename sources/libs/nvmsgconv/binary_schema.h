@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/**
+ * @file
+ * <b>NVIDIA DeepStream: Compact binary schema</b>
+ *
+ * @b Description: Encoder and reference decoder of the payload generated
+ * for @ref NVDS_PAYLOAD_DEEPSTREAM_BINARY.
+ *
+ * Message carries all the fields of @ref NvDsEventMsgMeta. Sensor, place and
+ * analytics module are referenced by their id instead of strings from
+ * configuration file. All the values are little endian.
+ *
+ * @code
+ *   offset  size  field
+ *   0       2     magic "DB"
+ *   2       1     version (NVDS_BINARY_SCHEMA_VERSION)
+ *   3       1     flags (NVDS_BINARY_FLAG_*)
+ *   4       4     size of message including this header
+ *   8       16    message id (uuid)
+ *   24      16    event id (uuid)
+ *   40      4     event type
+ *   44      4     object type
+ *   48      24    sensorId, placeId, moduleId, componentId, objClassId,
+ *                 trackingId (int32 each)
+ *   72      16    bbox top, left, width, height (int32 each)
+ *   88      24    location lat, lon, alt (double each)
+ *   112     24    coordinate x, y, z (double each)
+ *   136     8     confidence (double)
+ *   144           ts, objectId, otherAttrs, videoPath strings
+ *                 signature: uint32 count followed by count doubles
+ *                 object fields, only if NVDS_BINARY_FLAG_EXT_OBJECT is set
+ * @endcode
+ *
+ * Strings are written as uint32 length followed by bytes without
+ * terminating null, length 0xFFFFFFFF stands for NULL string.
+ *
+ * Object fields depend on object type:
+ *   vehicle: type, make, model, color, region, license strings
+ *   person: uint32 age, gender, hair, cap, apparel strings
+ *   face: uint32 age, gender, hair, cap, glasses, facialhair, name,
+ *         eyecolor strings
+ *   others: uint32 size followed by raw bytes of extMsg
+ */
+
+#ifndef _NVDS_BINARY_SCHEMA_H_
+#define _NVDS_BINARY_SCHEMA_H_
+
+#include "nvdsmeta.h"
+#include <glib.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define NVDS_BINARY_SCHEMA_VERSION 1
+#define NVDS_BINARY_HEADER_SIZE 8
+
+/** extMsg object fields are present in message. */
+#define NVDS_BINARY_FLAG_EXT_OBJECT 0x1
+
+/**
+ * Holds message decoded by @ref nvds_binary_decode.
+ */
+typedef struct NvDsBinaryMessage {
+  guint8 version;
+  gchar messageId[37];
+  gchar eventId[37];
+  /** strings, signature and extMsg are allocated by decoder. */
+  NvDsEventMsgMeta meta;
+} NvDsBinaryMessage;
+
+/**
+ * Appends binary message for @a meta to @a buf.
+ *
+ * @param[in] ts time stamp written instead of ts of @a meta, NULL if none.
+ * @param[in] messageId 16 byte message id.
+ * @param[in] eventId 16 byte event id.
+ */
+void nvds_binary_write_message (GString *buf, NvDsEventMsgMeta *meta,
+                                const gchar *ts, const guint8 *messageId,
+                                const guint8 *eventId);
+
+/**
+ * Decodes message at start of @a data. Several messages written back to back
+ * can be decoded by advancing @a data by returned size.
+ *
+ * @param[in] data pointer to message.
+ * @param[in] size number of bytes available at @a data.
+ * @param[out] msg decoded message, should be cleared with
+ * @ref nvds_binary_message_clear.
+ *
+ * @return size of decoded message or 0 in case of malformed message.
+ */
+gsize nvds_binary_decode (const guint8 *data, gsize size,
+                          NvDsBinaryMessage *msg);
+
+/**
+ * Releases memory allocated by @ref nvds_binary_decode.
+ */
+void nvds_binary_message_clear (NvDsBinaryMessage *msg);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
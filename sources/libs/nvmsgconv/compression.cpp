@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#include "compression.h"
+#include <lz4.h>
+#include <zstd.h>
+#include <string.h>
+#include <iostream>
+
+using namespace std;
+
+#define DEFAULT_ZSTD_LEVEL 3
+/** max compression ratio of lz4. */
+#define LZ4_MAX_RATIO 255
+
+static const gchar compressionMagic[3] = {'N', 'V', 'Z'};
+
+struct NvDsCompressor {
+  NvDsCompression codec;
+  gint level;
+  /** digested zstd dictionary, NULL without dictionary. */
+  ZSTD_CDict *dict;
+  guint32 dictId;
+};
+
+/**
+ * Compression state of a thread, kept for all the contexts as it doesn't
+ * depend on codec parameters.
+ */
+struct NvDsCompressState {
+  /** buffer swapped with compressed payload. */
+  GString *scratch;
+  ZSTD_CCtx *zstdCtx;
+  void *lz4State;
+
+  ~NvDsCompressState ()
+  {
+    if (scratch)
+      g_string_free (scratch, TRUE);
+    if (zstdCtx)
+      ZSTD_freeCCtx (zstdCtx);
+    g_free (lz4State);
+  }
+};
+
+static thread_local NvDsCompressState compressState;
+
+static inline void
+write_le32 (gchar *dst, guint32 value)
+{
+  value = GUINT32_TO_LE (value);
+  memcpy (dst, &value, sizeof (value));
+}
+
+static inline guint32
+read_le32 (const guint8 *src)
+{
+  guint32 value;
+
+  memcpy (&value, src, sizeof (value));
+  return GUINT32_FROM_LE (value);
+}
+
+gboolean
+compression_from_string (const gchar *str, NvDsCompression *codec)
+{
+  if (!g_strcmp0 (str, "none"))
+    *codec = NVDS_COMPRESSION_NONE;
+  else if (!g_strcmp0 (str, "lz4"))
+    *codec = NVDS_COMPRESSION_LZ4;
+  else if (!g_strcmp0 (str, "zstd"))
+    *codec = NVDS_COMPRESSION_ZSTD;
+  else
+    return FALSE;
+
+  return TRUE;
+}
+
+NvDsCompressor*
+compressor_new (NvDsCompression codec, gint level, const gchar *dictFile)
+{
+  NvDsCompressor *comp = NULL;
+  GError *error = NULL;
+  gchar *data = NULL;
+  gsize len = 0;
+
+  if (dictFile && codec != NVDS_COMPRESSION_ZSTD) {
+    cout << "Compression dictionary needs zstd" << endl;
+    return NULL;
+  }
+
+  if (codec == NVDS_COMPRESSION_ZSTD && level &&
+      (level < ZSTD_minCLevel () || level > ZSTD_maxCLevel ())) {
+    cout << "Invalid zstd compression level " << level << ", range is "
+        << ZSTD_minCLevel () << " to " << ZSTD_maxCLevel () << endl;
+    return NULL;
+  }
+
+  comp = g_new0 (NvDsCompressor, 1);
+  comp->codec = codec;
+  comp->level = level ? level : DEFAULT_ZSTD_LEVEL;
+
+  if (dictFile) {
+    if (!g_file_get_contents (dictFile, &data, &len, &error)) {
+      cout << "Unable to read dictionary: " << error->message << endl;
+      g_error_free (error);
+      g_free (comp);
+      return NULL;
+    }
+    // dictionary is copied, data can be freed.
+    comp->dict = ZSTD_createCDict (data, len, comp->level);
+    comp->dictId = ZSTD_getDictID_fromDict (data, len);
+    g_free (data);
+    if (!comp->dict) {
+      cout << "Invalid dictionary " << dictFile << endl;
+      g_free (comp);
+      return NULL;
+    }
+  }
+
+  return comp;
+}
+
+void
+compressor_destroy (NvDsCompressor *comp)
+{
+  if (comp->dict)
+    ZSTD_freeCDict (comp->dict);
+  g_free (comp);
+}
+
+void
+compressor_compress (NvDsCompressor *comp, GString **buf)
+{
+  NvDsCompressState *state = &compressState;
+  NvDsCompression codec = comp->codec;
+  GString *src = *buf;
+  GString *dst = NULL;
+  gsize bound = 0;
+  gsize size = 0;
+  gint lz4Size;
+
+  if (!state->scratch)
+    state->scratch = g_string_sized_new (src->len + NVDS_COMPRESSION_HEADER_SIZE);
+  dst = state->scratch;
+
+  // decoders refuse bigger compressed payloads.
+  if (src->len > NVDS_COMPRESSION_MAX_SIZE)
+    codec = NVDS_COMPRESSION_NONE;
+
+  if (codec == NVDS_COMPRESSION_LZ4 && src->len <= LZ4_MAX_INPUT_SIZE) {
+    bound = LZ4_compressBound (src->len);
+    g_string_set_size (dst, NVDS_COMPRESSION_HEADER_SIZE + bound);
+    if (!state->lz4State)
+      state->lz4State = g_malloc (LZ4_sizeofState ());
+    lz4Size = LZ4_compress_fast_extState (state->lz4State, src->str,
+                  dst->str + NVDS_COMPRESSION_HEADER_SIZE, src->len, bound, 1);
+    size = lz4Size > 0 ? lz4Size : 0;
+  } else if (codec == NVDS_COMPRESSION_ZSTD) {
+    bound = ZSTD_compressBound (src->len);
+    g_string_set_size (dst, NVDS_COMPRESSION_HEADER_SIZE + bound);
+    if (!state->zstdCtx)
+      state->zstdCtx = ZSTD_createCCtx ();
+    if (comp->dict)
+      size = ZSTD_compress_usingCDict (state->zstdCtx,
+                 dst->str + NVDS_COMPRESSION_HEADER_SIZE, bound, src->str,
+                 src->len, comp->dict);
+    else
+      size = ZSTD_compressCCtx (state->zstdCtx,
+                 dst->str + NVDS_COMPRESSION_HEADER_SIZE, bound, src->str,
+                 src->len, comp->level);
+    if (ZSTD_isError (size))
+      size = 0;
+  }
+
+  // keep payload as is if it doesn't get smaller.
+  if (!size || size >= src->len) {
+    codec = NVDS_COMPRESSION_NONE;
+    size = src->len;
+    g_string_set_size (dst, NVDS_COMPRESSION_HEADER_SIZE + size);
+    memcpy (dst->str + NVDS_COMPRESSION_HEADER_SIZE, src->str, size);
+  } else {
+    g_string_set_size (dst, NVDS_COMPRESSION_HEADER_SIZE + size);
+  }
+
+  memcpy (dst->str, compressionMagic, sizeof (compressionMagic));
+  dst->str[3] = (gchar) codec;
+  write_le32 (dst->str + 4,
+              codec == NVDS_COMPRESSION_ZSTD ? comp->dictId : 0);
+  write_le32 (dst->str + 8, src->len);
+
+  *buf = dst;
+  state->scratch = src;
+}
+
+gboolean
+nvds_payload_is_compressed (const guint8 *data, gsize size)
+{
+  return size >= NVDS_COMPRESSION_HEADER_SIZE &&
+      !memcmp (data, compressionMagic, sizeof (compressionMagic));
+}
+
+gboolean
+nvds_payload_decompress (const guint8 *data, gsize size, const void *dict,
+                         gsize dictSize, GString *out)
+{
+  const guint8 *src = data + NVDS_COMPRESSION_HEADER_SIZE;
+  gsize srcSize = size - NVDS_COMPRESSION_HEADER_SIZE;
+  ZSTD_DCtx *dctx = NULL;
+  guint32 dictId;
+  guint32 rawSize;
+  gsize ret = 0;
+
+  if (!nvds_payload_is_compressed (data, size))
+    return FALSE;
+
+  dictId = read_le32 (data + 4);
+  rawSize = read_le32 (data + 8);
+
+  // size of header is checked against the data before allocation.
+  switch (data[3]) {
+    case NVDS_COMPRESSION_NONE:
+      if (srcSize != rawSize)
+        return FALSE;
+      g_string_set_size (out, rawSize);
+      memcpy (out->str, src, rawSize);
+      return TRUE;
+    case NVDS_COMPRESSION_LZ4:
+      if (rawSize > NVDS_COMPRESSION_MAX_SIZE ||
+          rawSize > (guint64) srcSize * LZ4_MAX_RATIO || srcSize > G_MAXINT)
+        return FALSE;
+      g_string_set_size (out, rawSize);
+      return LZ4_decompress_safe ((const char *) src, out->str, srcSize,
+                                  rawSize) == (gint) rawSize;
+    case NVDS_COMPRESSION_ZSTD:
+      if (rawSize > NVDS_COMPRESSION_MAX_SIZE ||
+          ZSTD_getFrameContentSize (src, srcSize) != rawSize)
+        return FALSE;
+      if (dictId && (!dict || ZSTD_getDictID_fromDict (dict, dictSize) != dictId))
+        return FALSE;
+      g_string_set_size (out, rawSize);
+      if (dict) {
+        dctx = ZSTD_createDCtx ();
+        ret = ZSTD_decompress_usingDict (dctx, out->str, rawSize, src, srcSize,
+                                         dict, dictSize);
+        ZSTD_freeDCtx (dctx);
+      } else {
+        ret = ZSTD_decompress (out->str, rawSize, src, srcSize);
+      }
+      return !ZSTD_isError (ret) && ret == rawSize;
+    default:
+      return FALSE;
+  }
+}
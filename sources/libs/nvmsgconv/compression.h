@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/**
+ * @file
+ * <b>NVIDIA DeepStream: Compressed payload</b>
+ *
+ * @b Description: Payload compression selected by compression key of
+ * [schema] group and reference decoder for consumers.
+ *
+ * Compressed payload starts with a header, values are little endian.
+ *
+ * @code
+ *   offset  size  field
+ *   0       3     magic "NVZ"
+ *   3       1     codec (NvDsCompression)
+ *   4       4     zstd dictionary id, 0 without dictionary
+ *   8       4     size of uncompressed payload
+ *   12            compressed payload, uncompressed one for
+ *                 NVDS_COMPRESSION_NONE
+ * @endcode
+ *
+ * Payloads which don't get smaller or are bigger than
+ * NVDS_COMPRESSION_MAX_SIZE are kept uncompressed with codec
+ * NVDS_COMPRESSION_NONE, so every payload of a context has the header.
+ */
+
+#ifndef _NVDS_COMPRESSION_H_
+#define _NVDS_COMPRESSION_H_
+
+#include <glib.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define NVDS_COMPRESSION_HEADER_SIZE 12
+/** max uncompressed size of compressed payloads, checked by decoder before
+ * allocating the payload. */
+#define NVDS_COMPRESSION_MAX_SIZE (64 << 20)
+
+typedef enum {
+  NVDS_COMPRESSION_NONE,
+  NVDS_COMPRESSION_LZ4,
+  NVDS_COMPRESSION_ZSTD
+} NvDsCompression;
+
+/**
+ * Checks for header of compressed payload.
+ *
+ * @return TRUE if @a data starts with "NVZ" header.
+ */
+gboolean nvds_payload_is_compressed (const guint8 *data, gsize size);
+
+/**
+ * Decompresses payload with header into @a out, replacing its contents.
+ *
+ * @param[in] dict zstd dictionary used by producer, NULL if none.
+ *
+ * @return FALSE for malformed payload, uncompressed size above
+ * NVDS_COMPRESSION_MAX_SIZE or not matching the compressed data, or missing /
+ * other dictionary.
+ */
+gboolean nvds_payload_decompress (const guint8 *data, gsize size,
+                                  const void *dict, gsize dictSize,
+                                  GString *out);
+
+#ifdef __cplusplus
+}
+
+struct NvDsCompressor;
+
+/**
+ * Creates compressor of @a codec. @a level is zstd compression level, 0 for
+ * default, ignored by lz4. @a dictFile is zstd dictionary, NULL for none.
+ * Returns NULL for level out of range of zstd.
+ */
+NvDsCompressor* compressor_new (NvDsCompression codec, gint level,
+                                const gchar *dictFile);
+
+void compressor_destroy (NvDsCompressor *comp);
+
+/**
+ * Replaces payload in @a *buf by compressed one with header. Compressed
+ * payload is written in per-thread buffer which is swapped with @a *buf,
+ * so buffers are reused without copy. Thread safe.
+ */
+void compressor_compress (NvDsCompressor *comp, GString **buf);
+
+gboolean compression_from_string (const gchar *str, NvDsCompression *codec);
+#endif
+
+#endif
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#include "csv_reader.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <iostream>
+
+using namespace std;
+
+static inline gboolean
+is_blank (gchar c)
+{
+  return c == ' ' || c == '\t';
+}
+
+static inline gboolean
+is_eol (gchar c)
+{
+  return c == '\n' || c == '\r';
+}
+
+/**
+ * Parses quoted field starting after the opening quote. Escaped quotes are
+ * collapsed in place, mapping is private so the file is not modified.
+ */
+static gchar *
+parse_quoted (gchar *p, gchar *end, NvDsCsvField *field)
+{
+  gchar *out = p;
+
+  field->str = p;
+  while (p < end) {
+    if (*p == '"') {
+      if (p + 1 < end && p[1] == '"') {
+        *out++ = '"';
+        p += 2;
+        continue;
+      }
+      field->len = out - field->str;
+      return p + 1;
+    }
+    if (out != p)
+      *out = *p;
+    out++;
+    p++;
+  }
+  // no closing quote
+  return NULL;
+}
+
+static gboolean
+parse_rows (gchar *p, gchar *end, guint maxFields, NvDsCsvRowFunc func,
+            gpointer userData)
+{
+  NvDsCsvField fields[NVDS_CSV_MAX_FIELDS];
+  NvDsCsvField field;
+  guint numFields;
+  guint row = 0;
+  gchar *start;
+
+  while (p < end) {
+    numFields = 0;
+
+    while (TRUE) {
+      while (p < end && is_blank (*p))
+        p++;
+
+      if (p < end && *p == '"') {
+        p = parse_quoted (p + 1, end, &field);
+        if (!p) {
+          cout << "Unterminated quoted field in CSV row " << row << endl;
+          return FALSE;
+        }
+        while (p < end && is_blank (*p))
+          p++;
+        if (p < end && *p != ',' && !is_eol (*p)) {
+          cout << "Unexpected character after quoted field in CSV row "
+               << row << endl;
+          return FALSE;
+        }
+      } else {
+        start = p;
+        while (p < end && *p != ',' && !is_eol (*p))
+          p++;
+        field.str = start;
+        field.len = p - start;
+        while (field.len && is_blank (start[field.len - 1]))
+          field.len--;
+      }
+
+      if (numFields < maxFields)
+        fields[numFields] = field;
+      numFields++;
+
+      if (p < end && *p == ',') {
+        p++;
+        continue;
+      }
+      break;
+    }
+
+    if (p < end && *p == '\r')
+      p++;
+    if (p < end && *p == '\n')
+      p++;
+
+    // skip empty lines
+    if (numFields == 1 && !field.len)
+      continue;
+
+    if (!func (row++, fields, MIN (numFields, maxFields), userData))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+gboolean
+csv_read_file (const gchar *file, guint maxFields, NvDsCsvRowFunc func,
+               gpointer userData)
+{
+  struct stat st;
+  gboolean ret = FALSE;
+  gchar *data = NULL;
+  gint fd;
+
+  maxFields = MIN (maxFields, (guint) NVDS_CSV_MAX_FIELDS);
+
+  fd = open (file, O_RDONLY | O_CLOEXEC);
+  if (fd < 0 || fstat (fd, &st) < 0) {
+    cout << "Couldn't open CSV file " << file << ": " << strerror (errno)
+         << endl;
+    goto done;
+  }
+
+  if (st.st_size == 0) {
+    ret = TRUE;
+    goto done;
+  }
+
+  data = (gchar *) mmap (NULL, st.st_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    cout << "Couldn't map CSV file " << file << ": " << strerror (errno)
+         << endl;
+    data = NULL;
+    goto done;
+  }
+  madvise (data, st.st_size, MADV_SEQUENTIAL);
+
+  ret = parse_rows (data, data + st.st_size, maxFields, func, userData);
+
+done:
+  if (data)
+    munmap (data, st.st_size);
+  if (fd >= 0)
+    close (fd);
+  return ret;
+}
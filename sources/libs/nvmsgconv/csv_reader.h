@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#ifndef _NVDS_CSV_READER_H_
+#define _NVDS_CSV_READER_H_
+
+#include <glib.h>
+
+#define NVDS_CSV_MAX_FIELDS 32
+
+/**
+ * Field of a row, points into mapped file and is not null terminated.
+ */
+struct NvDsCsvField {
+  const gchar *str;
+  gsize len;
+};
+
+/**
+ * Called for every non empty row, header row included. Fields are only
+ * valid during the call. Returning FALSE stops reading.
+ */
+typedef gboolean (*NvDsCsvRowFunc) (guint row, const NvDsCsvField *fields,
+                                    guint numFields, gpointer userData);
+
+/**
+ * Reads CSV @a file through a private memory mapping without copying rows.
+ * Unquoted fields are trimmed, quoted fields can have commas, line breaks
+ * and "" for a quote. Fields beyond @a maxFields (at most
+ * NVDS_CSV_MAX_FIELDS) are ignored.
+ *
+ * @return FALSE if file can't be read, is malformed or @a func failed.
+ */
+gboolean csv_read_file (const gchar *file, guint maxFields,
+                        NvDsCsvRowFunc func, gpointer userData);
+
+#endif
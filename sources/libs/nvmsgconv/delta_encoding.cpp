@@ -0,0 +1,484 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#include "delta_encoding.h"
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#define NVDS_TRACK_NONE G_MAXUINT
+
+/**
+ * Last message of a track, entries are linked in LRU order.
+ */
+struct NvDsTrackState {
+  guint64 key;
+  guint32 seq;
+  /** number of deltas since last keyframe. */
+  guint sinceKeyframe;
+  NvDsObjectType objType;
+  gint placeId;
+  gint moduleId;
+  NvDsRect bbox;
+  NvDsGeoLocation location;
+  NvDsCoordinate coordinate;
+  gint classId;
+  gdouble confidence;
+  std::vector<gdouble> signature;
+  /** attributes of vehicle / person / face object. */
+  std::string ext;
+  guint prev;
+  guint next;
+};
+
+struct NvDsDeltaEncoder {
+  GMutex lock;
+  guint maxTracks;
+  guint keyframeInterval;
+  std::vector<NvDsTrackState> tracks;
+  /** index in tracks of (sensor id, tracking id). */
+  std::unordered_map<guint64, guint> index;
+  /** most and least recently used tracks. */
+  guint head;
+  guint tail;
+};
+
+NvDsDeltaEncoder*
+delta_encoder_new (guint maxTracks, guint keyframeInterval)
+{
+  NvDsDeltaEncoder *encoder = new NvDsDeltaEncoder;
+
+  g_mutex_init (&encoder->lock);
+  encoder->maxTracks = MAX (maxTracks, 1);
+  encoder->keyframeInterval = MAX (keyframeInterval, 1);
+  encoder->head = NVDS_TRACK_NONE;
+  encoder->tail = NVDS_TRACK_NONE;
+  return encoder;
+}
+
+void
+delta_encoder_destroy (NvDsDeltaEncoder *encoder)
+{
+  g_mutex_clear (&encoder->lock);
+  delete encoder;
+}
+
+static void
+lru_unlink (NvDsDeltaEncoder *encoder, guint i)
+{
+  NvDsTrackState *track = &encoder->tracks[i];
+
+  if (track->prev != NVDS_TRACK_NONE)
+    encoder->tracks[track->prev].next = track->next;
+  else
+    encoder->head = track->next;
+
+  if (track->next != NVDS_TRACK_NONE)
+    encoder->tracks[track->next].prev = track->prev;
+  else
+    encoder->tail = track->prev;
+}
+
+static void
+lru_push_front (NvDsDeltaEncoder *encoder, guint i)
+{
+  NvDsTrackState *track = &encoder->tracks[i];
+
+  track->prev = NVDS_TRACK_NONE;
+  track->next = encoder->head;
+  if (encoder->head != NVDS_TRACK_NONE)
+    encoder->tracks[encoder->head].prev = i;
+  else
+    encoder->tail = i;
+  encoder->head = i;
+}
+
+static void
+append_attribute (std::string *key, const gchar *value)
+{
+  // NULL differs from empty string
+  if (value)
+    key->append (value);
+  else
+    key->push_back ('\1');
+  key->push_back ('\0');
+}
+
+/** Builds in @a key all the attributes of object of @a meta but confidence. */
+static void
+ext_object_key (const NvDsEventMsgMeta *meta, std::string *key)
+{
+  key->clear ();
+  if (!meta->extMsgSize || !meta->extMsg)
+    return;
+
+  key->push_back ((gchar) meta->objType);
+  switch (meta->objType) {
+    case NVDS_OBJECT_TYPE_VEHICLE: {
+      NvDsVehicleObject *obj = (NvDsVehicleObject *) meta->extMsg;
+      append_attribute (key, obj->type);
+      append_attribute (key, obj->make);
+      append_attribute (key, obj->model);
+      append_attribute (key, obj->color);
+      append_attribute (key, obj->region);
+      append_attribute (key, obj->license);
+      break;
+    }
+    case NVDS_OBJECT_TYPE_PERSON: {
+      NvDsPersonObject *obj = (NvDsPersonObject *) meta->extMsg;
+      key->append (std::to_string (obj->age));
+      append_attribute (key, obj->gender);
+      append_attribute (key, obj->hair);
+      append_attribute (key, obj->cap);
+      append_attribute (key, obj->apparel);
+      break;
+    }
+    case NVDS_OBJECT_TYPE_FACE: {
+      NvDsFaceObject *obj = (NvDsFaceObject *) meta->extMsg;
+      key->append (std::to_string (obj->age));
+      append_attribute (key, obj->gender);
+      append_attribute (key, obj->hair);
+      append_attribute (key, obj->cap);
+      append_attribute (key, obj->glasses);
+      append_attribute (key, obj->facialhair);
+      append_attribute (key, obj->name);
+      append_attribute (key, obj->eyecolor);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void
+delta_encoder_next (NvDsDeltaEncoder *encoder, const NvDsEventMsgMeta *meta,
+                    NvDsDeltaFrame *frame)
+{
+  guint64 key = ((guint64) (guint32) meta->sensorId << 32) |
+      (guint32) meta->trackingId;
+  NvDsTrackState *track = NULL;
+  const NvDsObjectSignature *signature = &meta->objSignature;
+  gboolean newTrack = FALSE;
+  std::string ext;
+  guint i;
+
+  ext_object_key (meta, &ext);
+
+  g_mutex_lock (&encoder->lock);
+
+  auto it = encoder->index.find (key);
+  if (it == encoder->index.end ()) {
+    if (encoder->tracks.size () < encoder->maxTracks) {
+      i = encoder->tracks.size ();
+      encoder->tracks.emplace_back ();
+    } else {
+      // evicted track starts again with a keyframe.
+      i = encoder->tail;
+      lru_unlink (encoder, i);
+      encoder->index.erase (encoder->tracks[i].key);
+    }
+    encoder->index[key] = i;
+    encoder->tracks[i].key = key;
+    newTrack = TRUE;
+  } else {
+    i = it->second;
+    lru_unlink (encoder, i);
+  }
+  lru_push_front (encoder, i);
+  track = &encoder->tracks[i];
+
+  frame->keyframe = newTrack ||
+      ++track->sinceKeyframe >= encoder->keyframeInterval ||
+      track->objType != meta->objType || track->placeId != meta->placeId ||
+      track->moduleId != meta->moduleId || track->ext != ext ||
+      track->signature.empty () != !signature->size;
+  if (frame->keyframe)
+    track->sinceKeyframe = 0;
+
+  track->seq = newTrack ? 0 : track->seq + 1;
+  frame->seq = track->seq;
+  frame->bbox = track->bbox;
+  frame->location = track->location;
+  frame->coordinate = track->coordinate;
+  frame->classId = track->classId;
+  frame->confidence = track->confidence;
+  frame->signatureChanged = track->signature.size () != signature->size ||
+      (signature->size && memcmp (track->signature.data (),
+                                  signature->signature,
+                                  signature->size * sizeof (gdouble)));
+
+  track->objType = meta->objType;
+  track->placeId = meta->placeId;
+  track->moduleId = meta->moduleId;
+  track->bbox = meta->bbox;
+  track->location = meta->location;
+  track->coordinate = meta->coordinate;
+  track->classId = meta->objClassId;
+  track->confidence = meta->confidence;
+  if (frame->signatureChanged)
+    track->signature.assign (signature->signature,
+                             signature->signature + signature->size);
+  track->ext.swap (ext);
+
+  g_mutex_unlock (&encoder->lock);
+}
+
+/**
+ * Json value of reference decoder. Strings and numbers are kept as text so
+ * that untouched values are written back unchanged.
+ */
+struct NvDsJsonNode {
+  std::string name;
+  /** '{', '[' or 0 for a string / number / literal in text. */
+  gchar type;
+  std::string text;
+  std::vector<NvDsJsonNode> members;
+};
+
+struct NvDsDecodedTrack {
+  guint32 seq;
+  NvDsJsonNode message;
+};
+
+struct NvDsDeltaDecoder {
+  std::unordered_map<std::string, NvDsDecodedTrack> tracks;
+};
+
+static const gchar*
+skip_space (const gchar *p, const gchar *end)
+{
+  while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+    p++;
+  return p;
+}
+
+/** Parses string at @a p, @a text gets it with quotes and escapes. */
+static const gchar*
+parse_string (const gchar *p, const gchar *end, std::string *text)
+{
+  const gchar *start = p++;
+
+  while (p < end && *p != '"')
+    p += *p == '\\' ? 2 : 1;
+  if (p >= end)
+    return NULL;
+  text->assign (start, ++p - start);
+  return p;
+}
+
+static const gchar*
+parse_value (const gchar *p, const gchar *end, NvDsJsonNode *node)
+{
+  gchar close;
+
+  p = skip_space (p, end);
+  if (p >= end)
+    return NULL;
+
+  node->type = 0;
+  if (*p == '"')
+    return parse_string (p, end, &node->text);
+
+  if (*p != '{' && *p != '[') {
+    const gchar *start = p;
+    while (p < end && !strchr (",}] \n\r\t", *p))
+      p++;
+    node->text.assign (start, p - start);
+    return p > start ? p : NULL;
+  }
+
+  node->type = *p;
+  close = *p == '{' ? '}' : ']';
+  p = skip_space (p + 1, end);
+  if (p < end && *p == close)
+    return p + 1;
+
+  while (p && p < end) {
+    NvDsJsonNode member;
+
+    if (node->type == '{') {
+      p = skip_space (p, end);
+      if (p >= end || *p != '"' || !(p = parse_string (p, end, &member.name)))
+        return NULL;
+      member.name = member.name.substr (1, member.name.size () - 2);
+      p = skip_space (p, end);
+      if (p >= end || *p != ':')
+        return NULL;
+      p++;
+    }
+    p = parse_value (p, end, &member);
+    if (!p)
+      return NULL;
+    node->members.push_back (std::move (member));
+
+    p = skip_space (p, end);
+    if (p < end && *p == close)
+      return p + 1;
+    if (p >= end || *p != ',')
+      return NULL;
+    p++;
+  }
+  return NULL;
+}
+
+static void
+write_node (const NvDsJsonNode &node, GString *out, gboolean named)
+{
+  guint i;
+
+  if (named) {
+    g_string_append_c (out, '"');
+    g_string_append_len (out, node.name.data (), node.name.size ());
+    g_string_append (out, "\":");
+  }
+
+  if (!node.type) {
+    g_string_append_len (out, node.text.data (), node.text.size ());
+    return;
+  }
+
+  g_string_append_c (out, node.type);
+  for (i = 0; i < node.members.size (); i++) {
+    if (i)
+      g_string_append_c (out, ',');
+    write_node (node.members[i], out, node.type == '{');
+  }
+  g_string_append_c (out, node.type == '{' ? '}' : ']');
+}
+
+static NvDsJsonNode*
+find_member (NvDsJsonNode *node, const gchar *name)
+{
+  if (!node || node->type != '{')
+    return NULL;
+  for (NvDsJsonNode &member : node->members) {
+    if (member.name == name)
+      return &member;
+  }
+  return NULL;
+}
+
+/** Applies bbox differences of @a diff to bbox object @a bbox. */
+static gboolean
+apply_bbox (NvDsJsonNode *bbox, const NvDsJsonNode &diff)
+{
+  guint i;
+
+  if (bbox->type != '{' || bbox->members.size () != 4 ||
+      diff.members.size () != 4)
+    return FALSE;
+
+  for (i = 0; i < 4; i++) {
+    gint64 value = g_ascii_strtoll (bbox->members[i].text.c_str (), NULL, 10) +
+        g_ascii_strtoll (diff.members[i].text.c_str (), NULL, 10);
+    bbox->members[i].text = std::to_string (value);
+  }
+  return TRUE;
+}
+
+/** Overwrites members of @a dst by the ones of delta @a src. */
+static gboolean
+merge_node (NvDsJsonNode *dst, const NvDsJsonNode &src)
+{
+  for (const NvDsJsonNode &member : src.members) {
+    NvDsJsonNode *target = find_member (dst, member.name.c_str ());
+
+    if (!target) {
+      dst->members.push_back (member);
+    } else if (member.name == "bbox" && member.type == '[') {
+      if (!apply_bbox (target, member))
+        return FALSE;
+    } else if (member.type == '{' && target->type == '{') {
+      if (!merge_node (target, member))
+        return FALSE;
+    } else {
+      *target = member;
+    }
+  }
+  return TRUE;
+}
+
+NvDsDeltaDecoder*
+nvds_delta_decoder_new (void)
+{
+  return new NvDsDeltaDecoder;
+}
+
+void
+nvds_delta_decoder_free (NvDsDeltaDecoder *decoder)
+{
+  delete decoder;
+}
+
+NvDsDeltaStatus
+nvds_delta_decoder_decode (NvDsDeltaDecoder *decoder, const gchar *payload,
+                           gsize len, GString *out)
+{
+  NvDsJsonNode message;
+  NvDsJsonNode *delta = NULL;
+  NvDsJsonNode *seq = NULL;
+  NvDsJsonNode *frame = NULL;
+  NvDsJsonNode *sensorId = NULL;
+  NvDsJsonNode *objectId = NULL;
+  std::string key;
+  guint32 seqNum;
+
+  g_string_truncate (out, 0);
+
+  if (!parse_value (payload, payload + len, &message) || message.type != '{')
+    return NVDS_DELTA_MALFORMED;
+
+  delta = find_member (&message, "delta");
+  if (!delta) {
+    g_string_append_len (out, payload, len);
+    return NVDS_DELTA_PASSTHROUGH;
+  }
+
+  seq = find_member (delta, "seq");
+  frame = find_member (delta, "frame");
+  sensorId = find_member (find_member (&message, "sensor"), "id");
+  objectId = find_member (find_member (&message, "object"), "id");
+  if (!seq || !frame || !sensorId || !objectId)
+    return NVDS_DELTA_MALFORMED;
+
+  seqNum = strtoul (seq->text.c_str (), NULL, 10);
+  key = sensorId->text + "/" + objectId->text;
+
+  if (frame->text == "\"key\"") {
+    message.members.erase (message.members.begin () +
+                           (delta - &message.members[0]));
+    NvDsDecodedTrack &track = decoder->tracks[key];
+    track.seq = seqNum;
+    track.message = std::move (message);
+    write_node (track.message, out, FALSE);
+    return NVDS_DELTA_DECODED;
+  }
+
+  auto it = decoder->tracks.find (key);
+  if (it == decoder->tracks.end () || it->second.seq + 1 != seqNum) {
+    // track is broken until next keyframe.
+    if (it != decoder->tracks.end ())
+      decoder->tracks.erase (it);
+    return NVDS_DELTA_GAP;
+  }
+
+  message.members.erase (message.members.begin () +
+                         (delta - &message.members[0]));
+  if (!merge_node (&it->second.message, message)) {
+    decoder->tracks.erase (it);
+    return NVDS_DELTA_MALFORMED;
+  }
+  it->second.seq = seqNum;
+  write_node (it->second.message, out, FALSE);
+  return NVDS_DELTA_DECODED;
+}
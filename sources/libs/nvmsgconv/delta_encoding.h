@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/**
+ * @file
+ * <b>NVIDIA DeepStream: Delta encoded track messages</b>
+ *
+ * @b Description: With delta-encoding key of [schema] group, messages of
+ * NVDS_EVENT_MOVING events are sent per track (sensor id, tracking id) as
+ * keyframes carrying the full message and deltas in between. Both have a
+ * "delta" member with the sequence number of the message in its track,
+ * incremented by one for each message, and the frame type:
+ *
+ * @code
+ *   "delta":{"seq":41,"frame":"key"}
+ * @endcode
+ *
+ * Delta message only has messageid, @timestamp, sensor.id, object.id,
+ * event.id and event.type, and members which changed since previous
+ * message of the track:
+ *   object.bbox: array of differences of topleftx, toplefty, bottomrightx,
+ *         bottomrighty
+ *   object.location, object.coordinate: new object
+ *   object.classId, object.confidence, object.signature: new value
+ *   analyticsModule.confidence, confidence of object.vehicle /
+ *         object.person / object.face: new value in object with only it
+ *
+ * @code
+ *   {"messageid":"..","@timestamp":"..","sensor":{"id":"CAM_0"},
+ *    "object":{"id":"7","bbox":[4,0,4,1]},"event":{"id":"..","type":"moving"},
+ *    "delta":{"seq":42,"frame":"delta"}}
+ * @endcode
+ *
+ * Keyframe is sent for first message of a track, every
+ * delta-keyframe-interval messages, when object type, place, analytics
+ * module, other attributes of vehicle / person / face object or presence of
+ * signature change and when the track was evicted from table of
+ * delta-max-tracks tracks. Consumer which misses a sequence number should
+ * drop the track until next keyframe. Fields outside of projection are not
+ * written in deltas either. Events of untracked objects (tracking id 0 or
+ * less) are sent as plain messages without "delta" member.
+ */
+
+#ifndef _NVDS_DELTA_ENCODING_H_
+#define _NVDS_DELTA_ENCODING_H_
+
+#include "nvdsmeta.h"
+#include <glib.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct NvDsDeltaDecoder NvDsDeltaDecoder;
+
+typedef enum {
+  /** keyframe or delta, full message is returned. */
+  NVDS_DELTA_DECODED,
+  /** message without delta member, returned as is. */
+  NVDS_DELTA_PASSTHROUGH,
+  /** delta without previous message of the track, dropped. */
+  NVDS_DELTA_GAP,
+  NVDS_DELTA_MALFORMED
+} NvDsDeltaStatus;
+
+/**
+ * Creates reference decoder of compact (pretty-print=0) json payloads of
+ * single events. It keeps last message of every track seen.
+ */
+NvDsDeltaDecoder* nvds_delta_decoder_new (void);
+
+void nvds_delta_decoder_free (NvDsDeltaDecoder *decoder);
+
+/**
+ * Decodes @a payload into @a out, replacing its contents. Decoded message
+ * is the one that would have been sent without delta-encoding, without
+ * "delta" member.
+ */
+NvDsDeltaStatus nvds_delta_decoder_decode (NvDsDeltaDecoder *decoder,
+                                           const gchar *payload, gsize len,
+                                           GString *out);
+
+#ifdef __cplusplus
+}
+
+struct NvDsDeltaEncoder;
+
+/**
+ * State of previous message of a track, returned for delta frames.
+ */
+struct NvDsDeltaFrame {
+  gboolean keyframe;
+  guint32 seq;
+  NvDsRect bbox;
+  NvDsGeoLocation location;
+  NvDsCoordinate coordinate;
+  gint classId;
+  gdouble confidence;
+  /** signature differs from the one of previous message. */
+  gboolean signatureChanged;
+};
+
+NvDsDeltaEncoder* delta_encoder_new (guint maxTracks, guint keyframeInterval);
+
+void delta_encoder_destroy (NvDsDeltaEncoder *encoder);
+
+/**
+ * Updates track of @a meta and returns whether its message should be a
+ * keyframe or a delta against @a frame. Thread safe, but sequence numbers
+ * follow the order of calls.
+ */
+void delta_encoder_next (NvDsDeltaEncoder *encoder, const NvDsEventMsgMeta *meta,
+                         NvDsDeltaFrame *frame);
+#endif
+
+#endif
@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#include "id_generator.h"
+#include <uuid/uuid.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <string.h>
+#include <iostream>
+
+// getrandom() is available from glibc 2.25, /dev/urandom is read otherwise.
+#if defined (__GLIBC__) && __GLIBC_PREREQ (2, 25)
+#define HAVE_GETRANDOM 1
+#include <sys/random.h>
+#endif
+
+using namespace std;
+
+#define CHACHA_BLOCK_SIZE 64
+
+/**
+ * ChaCha20 keystream used as per-thread random generator. Seeded once per
+ * thread from the kernel, ids don't need any syscall after that. Seeded
+ * again in a forked child, which would repeat the keystream of the parent.
+ */
+struct NvDsIdRng {
+  guint32 state[16];
+  guint8 block[CHACHA_BLOCK_SIZE];
+  guint used;
+  gboolean seeded;
+  /** forkGeneration at seeding. */
+  guint generation;
+};
+
+static thread_local NvDsIdRng idRng;
+
+/** incremented in child after each fork, only the forking thread runs. */
+static volatile guint forkGeneration;
+static pthread_once_t atforkOnce = PTHREAD_ONCE_INIT;
+
+static void
+fork_child (void)
+{
+  forkGeneration++;
+}
+
+static void
+register_atfork (void)
+{
+  pthread_atfork (NULL, NULL, fork_child);
+}
+
+static const gchar hexDigits[] = "0123456789abcdef";
+
+#define ROTL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define QUARTER_ROUND(a, b, c, d) \
+    a += b; d ^= a; d = ROTL32 (d, 16); \
+    c += d; b ^= c; b = ROTL32 (b, 12); \
+    a += b; d ^= a; d = ROTL32 (d, 8); \
+    c += d; b ^= c; b = ROTL32 (b, 7);
+
+static void
+chacha20_block (guint32 state[16], guint8 out[CHACHA_BLOCK_SIZE])
+{
+  guint32 x[16];
+  guint32 value;
+  gint i;
+
+  memcpy (x, state, sizeof (x));
+
+  for (i = 0; i < 10; i++) {
+    QUARTER_ROUND (x[0], x[4], x[8], x[12]);
+    QUARTER_ROUND (x[1], x[5], x[9], x[13]);
+    QUARTER_ROUND (x[2], x[6], x[10], x[14]);
+    QUARTER_ROUND (x[3], x[7], x[11], x[15]);
+    QUARTER_ROUND (x[0], x[5], x[10], x[15]);
+    QUARTER_ROUND (x[1], x[6], x[11], x[12]);
+    QUARTER_ROUND (x[2], x[7], x[8], x[13]);
+    QUARTER_ROUND (x[3], x[4], x[9], x[14]);
+  }
+
+  for (i = 0; i < 16; i++) {
+    value = GUINT32_TO_LE (x[i] + state[i]);
+    memcpy (out + i * 4, &value, sizeof (value));
+  }
+
+  // block counter
+  state[12]++;
+}
+
+static gboolean
+read_urandom (void *buf, gsize len)
+{
+  gint fd = open ("/dev/urandom", O_RDONLY | O_CLOEXEC);
+  gssize ret;
+
+  if (fd < 0)
+    return FALSE;
+  ret = read (fd, buf, len);
+  close (fd);
+
+  return ret == (gssize) len;
+}
+
+static void
+rng_seed (NvDsIdRng *rng)
+{
+  // "expand 32-byte k"
+  static const guint32 constants[4] =
+      {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+  guint32 seed[12];
+  gboolean ok = FALSE;
+
+  pthread_once (&atforkOnce, register_atfork);
+
+  // key and nonce, block counter starts from 0.
+#ifdef HAVE_GETRANDOM
+  ok = getrandom (seed, sizeof (seed), 0) == (gssize) sizeof (seed);
+#endif
+  if (!ok && !read_urandom (seed, sizeof (seed))) {
+    cout << "Unable to seed id generator from kernel" << endl;
+    seed[0] ^= (guint32) g_get_real_time ();
+    seed[1] ^= (guint32) (g_get_monotonic_time () >> 32);
+    seed[2] ^= (guint32) (gsize) rng;
+  }
+
+  memcpy (rng->state, constants, sizeof (constants));
+  memcpy (rng->state + 4, seed, sizeof (guint32) * 8);
+  rng->state[12] = 0;
+  memcpy (rng->state + 13, seed + 8, sizeof (guint32) * 3);
+  rng->used = CHACHA_BLOCK_SIZE;
+  rng->seeded = TRUE;
+  rng->generation = forkGeneration;
+}
+
+static void
+rng_bytes (guint8 *out, gsize len)
+{
+  NvDsIdRng *rng = &idRng;
+  gsize count;
+
+  if (!rng->seeded || rng->generation != forkGeneration)
+    rng_seed (rng);
+
+  while (len) {
+    if (rng->used == CHACHA_BLOCK_SIZE) {
+      // 256 GiB of keystream with same key, take new one.
+      if (rng->state[12] == G_MAXUINT32)
+        rng_seed (rng);
+      chacha20_block (rng->state, rng->block);
+      rng->used = 0;
+    }
+    count = MIN (len, (gsize) (CHACHA_BLOCK_SIZE - rng->used));
+    memcpy (out, rng->block + rng->used, count);
+    // don't keep used keystream around.
+    memset (rng->block + rng->used, 0, count);
+    rng->used += count;
+    out += count;
+    len -= count;
+  }
+}
+
+static inline void
+set_version (guint8 id[NVDS_ID_SIZE], guint8 version)
+{
+  id[6] = (id[6] & 0x0F) | (version << 4);
+  // RFC 4122 variant
+  id[8] = (id[8] & 0x3F) | 0x80;
+}
+
+void
+id_generator_init (NvDsIdGenerator *gen, NvDsIdMode mode)
+{
+  gen->mode = mode;
+  gen->counter = 0;
+  rng_bytes ((guint8 *) &gen->instance, sizeof (gen->instance));
+}
+
+void
+id_generator_next (NvDsIdGenerator *gen, gint sensorId,
+                   guint8 id[NVDS_ID_SIZE])
+{
+  guint64 value;
+  gint i;
+
+  switch (gen->mode) {
+    case NVDS_ID_MODE_LIBUUID:
+      uuid_generate_random (id);
+      break;
+    case NVDS_ID_MODE_V4:
+      rng_bytes (id, NVDS_ID_SIZE);
+      set_version (id, 4);
+      break;
+    case NVDS_ID_MODE_V7:
+      value = g_get_real_time () / 1000;
+      for (i = 5; i >= 0; i--) {
+        id[i] = value & 0xFF;
+        value >>= 8;
+      }
+      rng_bytes (id + 6, NVDS_ID_SIZE - 6);
+      set_version (id, 7);
+      break;
+    case NVDS_ID_MODE_COUNTER:
+      /* sensor id (32 bits), version, instance (28 bits), variant and
+       * 56 bit counter. */
+      value = (guint32) sensorId;
+      for (i = 3; i >= 0; i--) {
+        id[i] = value & 0xFF;
+        value >>= 8;
+      }
+      id[4] = gen->instance >> 24;
+      id[5] = gen->instance >> 16;
+      id[6] = gen->instance >> 8;
+      id[7] = gen->instance;
+      value = gen->counter.fetch_add (1, std::memory_order_relaxed);
+      for (i = 15; i >= 9; i--) {
+        id[i] = value & 0xFF;
+        value >>= 8;
+      }
+      id[8] = 0;
+      set_version (id, 8);
+      break;
+  }
+}
+
+void
+id_format (const guint8 id[NVDS_ID_SIZE], gchar *out)
+{
+  gint i;
+
+  for (i = 0; i < NVDS_ID_SIZE; i++) {
+    if (i == 4 || i == 6 || i == 8 || i == 10)
+      *out++ = '-';
+    *out++ = hexDigits[id[i] >> 4];
+    *out++ = hexDigits[id[i] & 0x0F];
+  }
+}
+
+gboolean
+id_mode_from_string (const gchar *str, NvDsIdMode *mode)
+{
+  if (!g_strcmp0 (str, "libuuid"))
+    *mode = NVDS_ID_MODE_LIBUUID;
+  else if (!g_strcmp0 (str, "v4"))
+    *mode = NVDS_ID_MODE_V4;
+  else if (!g_strcmp0 (str, "v7"))
+    *mode = NVDS_ID_MODE_V7;
+  else if (!g_strcmp0 (str, "counter"))
+    *mode = NVDS_ID_MODE_COUNTER;
+  else
+    return FALSE;
+
+  return TRUE;
+}
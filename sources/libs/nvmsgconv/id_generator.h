@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#ifndef _NVDS_ID_GENERATOR_H_
+#define _NVDS_ID_GENERATOR_H_
+
+#include <glib.h>
+#include <atomic>
+
+#define NVDS_ID_SIZE 16
+/** length of formatted id, without terminating null. */
+#define NVDS_ID_STR_LEN 36
+
+/**
+ * Method used to generate message and event ids.
+ */
+enum NvDsIdMode {
+  /** uuid_generate_random of libuuid. */
+  NVDS_ID_MODE_LIBUUID,
+  /** RFC 4122 version 4 from per-thread ChaCha20 generator. */
+  NVDS_ID_MODE_V4,
+  /**
+   * Time ordered, 48 bit unix time in milliseconds followed by random bits
+   * (version 7 layout).
+   */
+  NVDS_ID_MODE_V7,
+  /**
+   * Sensor id, random instance id and a per-context counter (version 8
+   * layout). Unique within context, cheapest to generate.
+   */
+  NVDS_ID_MODE_COUNTER
+};
+
+struct NvDsIdGenerator {
+  NvDsIdMode mode;
+  /** random per-context value of counter mode. */
+  guint32 instance;
+  std::atomic<guint64> counter;
+};
+
+void id_generator_init (NvDsIdGenerator *gen, NvDsIdMode mode);
+
+/**
+ * Generates next id. Can be called from multiple threads, random bits
+ * come from generator of the calling thread.
+ */
+void id_generator_next (NvDsIdGenerator *gen, gint sensorId,
+                        guint8 id[NVDS_ID_SIZE]);
+
+/**
+ * Writes id in lower case 8-4-4-4-12 form to @a out which should have
+ * space for NVDS_ID_STR_LEN characters. No null is written.
+ */
+void id_format (const guint8 id[NVDS_ID_SIZE], gchar *out);
+
+/** Parses "libuuid", "v4", "v7" or "counter". */
+gboolean id_mode_from_string (const gchar *str, NvDsIdMode *mode);
+
+#endif
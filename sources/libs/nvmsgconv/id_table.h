@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#ifndef _NVDS_ID_TABLE_H_
+#define _NVDS_ID_TABLE_H_
+
+#include <glib.h>
+#include <vector>
+
+/** dense index is used if it has at most this many slots per entry. */
+#define NVDS_ID_TABLE_MAX_SPARSENESS 4
+/** small tables are always dense, whatever their ids are. */
+#define NVDS_ID_TABLE_MIN_DENSE 64
+
+/**
+ * Table of configuration entries looked up by sensor / place / module id.
+ *
+ * Entries are stored contiguously in insertion order. While table is built
+ * ids are indexed by an open addressing hash table, freeze() replaces it by
+ * a direct array indexed by id when ids are dense enough, which is the
+ * common case of ids 0..N-1. Sparse ids keep the hash table.
+ * Lookups are not synchronized, table should not change once it's shared.
+ */
+template <typename T>
+struct NvDsIdTable {
+  /** entries and their ids, same order. */
+  std::vector<T> entries;
+  std::vector<gint> ids;
+
+  /** index of entry for id (base + i), -1 for no entry. */
+  std::vector<gint32> dense;
+  gint base = 0;
+  gboolean isDense = FALSE;
+
+  /** open addressing table of entry index + 1, 0 for empty slot. */
+  std::vector<guint32> slots;
+
+  gsize size () const
+  {
+    return entries.size ();
+  }
+
+  T *find (gint id)
+  {
+    gsize off;
+    gsize mask;
+    gsize i;
+
+    if (isDense) {
+      off = (gsize) ((gint64) id - base);
+      if (off < dense.size () && dense[off] >= 0)
+        return &entries[dense[off]];
+      return NULL;
+    }
+
+    if (slots.empty ())
+      return NULL;
+
+    mask = slots.size () - 1;
+    for (i = hash (id) & mask; slots[i]; i = (i + 1) & mask) {
+      if (ids[slots[i] - 1] == id)
+        return &entries[slots[i] - 1];
+    }
+    return NULL;
+  }
+
+  /** Adds entry, FALSE if there is already one for @a id. */
+  gboolean insert (gint id, const T &entry)
+  {
+    gsize mask;
+    gsize i;
+
+    if (isDense)
+      return FALSE;
+    if (find (id))
+      return FALSE;
+
+    entries.push_back (entry);
+    ids.push_back (id);
+
+    // load factor below 1/2
+    if (entries.size () * 2 > slots.size ())
+      rehash (MAX (slots.size () * 2, (gsize) 16));
+    else {
+      mask = slots.size () - 1;
+      for (i = hash (id) & mask; slots[i]; i = (i + 1) & mask);
+      slots[i] = entries.size ();
+    }
+    return TRUE;
+  }
+
+  /** Chooses lookup structure once all the entries are inserted. */
+  void freeze ()
+  {
+    gint64 minId = G_MAXINT;
+    gint64 maxId = G_MININT;
+    gsize range;
+    gsize i;
+
+    for (gint id : ids) {
+      minId = MIN (minId, id);
+      maxId = MAX (maxId, id);
+    }
+    if (ids.empty ())
+      return;
+
+    range = maxId - minId + 1;
+    if (range > MAX ((gsize) NVDS_ID_TABLE_MIN_DENSE,
+                     entries.size () * NVDS_ID_TABLE_MAX_SPARSENESS))
+      return;
+
+    base = minId;
+    dense.assign (range, -1);
+    for (i = 0; i < ids.size (); i++)
+      dense[ids[i] - base] = i;
+    isDense = TRUE;
+    std::vector<guint32> ().swap (slots);
+  }
+
+private:
+  static gsize hash (gint id)
+  {
+    // Fibonacci hashing, spreads sequential ids
+    return (gsize) (((guint64) (guint32) id * 0x9e3779b97f4a7c15ULL) >> 32);
+  }
+
+  void rehash (gsize numSlots)
+  {
+    gsize mask = numSlots - 1;
+    gsize i, j;
+
+    slots.assign (numSlots, 0);
+    for (j = 0; j < ids.size (); j++) {
+      for (i = hash (ids[j]) & mask; slots[i]; i = (i + 1) & mask);
+      slots[i] = j + 1;
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#include "json_writer.h"
+#include "number_format.h"
+#include <string.h>
+
+// indent of json-glib generator
+#define JSON_WRITER_INDENT 2
+
+static const gchar spaces[] = "                                ";
+
+static inline void
+append_indent (NvDsJsonWriter *writer)
+{
+  gsize count = writer->level * JSON_WRITER_INDENT;
+
+  while (count) {
+    gsize len = MIN (count, sizeof (spaces) - 1);
+    g_string_append_len (writer->buf, spaces, len);
+    count -= len;
+  }
+}
+
+/**
+ * Writes separator from previous member.
+ * json-glib emits ",\n" after every member except the last one, here it is
+ * emitted before every member except the first one which gives same output.
+ */
+static inline void
+append_separator (NvDsJsonWriter *writer)
+{
+  if (writer->level) {
+    guint64 bit = 1ULL << writer->level;
+
+    if (writer->hasMember & bit) {
+      g_string_append_c (writer->buf, ',');
+      if (writer->pretty)
+        g_string_append_c (writer->buf, '\n');
+    } else {
+      writer->hasMember |= bit;
+    }
+  }
+}
+
+/**
+ * Writes separator, indentation and member name.
+ */
+static void
+append_prefix (NvDsJsonWriter *writer, const gchar *name)
+{
+  append_separator (writer);
+
+  if (writer->pretty)
+    append_indent (writer);
+
+  if (name) {
+    g_string_append_c (writer->buf, '"');
+    g_string_append (writer->buf, name);
+    if (writer->pretty)
+      g_string_append_len (writer->buf, "\" : ", 4);
+    else
+      g_string_append_len (writer->buf, "\":", 2);
+  }
+}
+
+/**
+ * Same escaping rules as json_strescape() of json-glib generator.
+ */
+void
+json_append_escaped (GString *buf, const gchar *str)
+{
+  const gchar *p = str;
+  const gchar *run = str;
+
+  for (; *p; p++) {
+    gchar c = *p;
+
+    if (c != '\\' && c != '"' && !((c > 0 && c < 0x1f) || c == 0x7f))
+      continue;
+
+    if (p > run)
+      g_string_append_len (buf, run, p - run);
+    run = p + 1;
+
+    switch (c) {
+      case '\\':
+        g_string_append_len (buf, "\\\\", 2);
+        break;
+      case '"':
+        g_string_append_len (buf, "\\\"", 2);
+        break;
+      case '\b':
+        g_string_append_len (buf, "\\b", 2);
+        break;
+      case '\f':
+        g_string_append_len (buf, "\\f", 2);
+        break;
+      case '\n':
+        g_string_append_len (buf, "\\n", 2);
+        break;
+      case '\r':
+        g_string_append_len (buf, "\\r", 2);
+        break;
+      case '\t':
+        g_string_append_len (buf, "\\t", 2);
+        break;
+      default:
+        g_string_append_printf (buf, "\\u00%02x", (guint) c);
+        break;
+    }
+  }
+
+  if (p > run)
+    g_string_append_len (buf, run, p - run);
+}
+
+void
+json_writer_init (NvDsJsonWriter *writer, GString *buf, gboolean pretty)
+{
+  writer->buf = buf;
+  writer->pretty = pretty;
+  writer->level = 0;
+  writer->hasMember = 0;
+}
+
+void
+json_writer_init_fragment (NvDsJsonWriter *writer, GString *buf,
+                           gboolean pretty, guint level)
+{
+  json_writer_init (writer, buf, pretty);
+  writer->level = level;
+}
+
+void
+json_writer_raw_member (NvDsJsonWriter *writer, const gchar *raw, gsize len)
+{
+  append_separator (writer);
+  g_string_append_len (writer->buf, raw, len);
+}
+
+void
+json_writer_raw_begin_object (NvDsJsonWriter *writer, const gchar *raw,
+                              gsize len)
+{
+  json_writer_raw_member (writer, raw, len);
+  writer->level++;
+  g_assert (writer->level < 64);
+  writer->hasMember |= (1ULL << writer->level);
+}
+
+static void
+begin_container (NvDsJsonWriter *writer, const gchar *name, gchar open)
+{
+  append_prefix (writer, name);
+  g_string_append_c (writer->buf, open);
+  if (writer->pretty)
+    g_string_append_c (writer->buf, '\n');
+
+  writer->level++;
+  g_assert (writer->level < 64);
+  writer->hasMember &= ~(1ULL << writer->level);
+}
+
+static void
+end_container (NvDsJsonWriter *writer, gchar close)
+{
+  if (writer->pretty && (writer->hasMember & (1ULL << writer->level)))
+    g_string_append_c (writer->buf, '\n');
+
+  writer->level--;
+  if (writer->pretty)
+    append_indent (writer);
+  g_string_append_c (writer->buf, close);
+}
+
+void
+json_writer_begin_object (NvDsJsonWriter *writer, const gchar *name)
+{
+  begin_container (writer, name, '{');
+}
+
+void
+json_writer_end_object (NvDsJsonWriter *writer)
+{
+  end_container (writer, '}');
+}
+
+void
+json_writer_begin_array (NvDsJsonWriter *writer, const gchar *name)
+{
+  begin_container (writer, name, '[');
+}
+
+void
+json_writer_end_array (NvDsJsonWriter *writer)
+{
+  end_container (writer, ']');
+}
+
+void
+json_writer_string (NvDsJsonWriter *writer, const gchar *name,
+                    const gchar *value)
+{
+  if (!value) {
+    json_writer_null (writer, name);
+    return;
+  }
+
+  append_prefix (writer, name);
+  g_string_append_c (writer->buf, '"');
+  json_append_escaped (writer->buf, value);
+  g_string_append_c (writer->buf, '"');
+}
+
+void
+json_writer_double (NvDsJsonWriter *writer, const gchar *name, gdouble value)
+{
+  gchar str[G_ASCII_DTOSTR_BUF_SIZE];
+
+  append_prefix (writer, name);
+  g_ascii_dtostr (str, sizeof (str), value);
+  g_string_append (writer->buf, str);
+  // json-glib makes sure doubles don't become ints
+  if (!strchr (str, '.'))
+    g_string_append_len (writer->buf, ".0", 2);
+}
+
+void
+json_writer_number_array (NvDsJsonWriter *writer, const gchar *name,
+                          const gdouble *values, guint count,
+                          NvDsNumberFormat format)
+{
+  gchar str[NVDS_NUMBER_BUF_SIZE + 2];
+  guint len;
+  guint i;
+
+  json_writer_begin_array (writer, name);
+  for (i = 0; i < count; i++) {
+    if (format == NVDS_NUMBER_FORMAT_DTOSTR) {
+      json_writer_double (writer, NULL, values[i]);
+      continue;
+    }
+    append_prefix (writer, NULL);
+    if (format == NVDS_NUMBER_FORMAT_FLOAT)
+      len = format_float ((gfloat) values[i], str);
+    else
+      len = format_double (values[i], str);
+    // keep them doubles, as json_writer_double does
+    if (!memchr (str, '.', len) && !memchr (str, 'e', len)) {
+      str[len++] = '.';
+      str[len++] = '0';
+    }
+    g_string_append_len (writer->buf, str, len);
+  }
+  json_writer_end_array (writer);
+}
+
+void
+json_writer_int (NvDsJsonWriter *writer, const gchar *name, gint64 value)
+{
+  gchar str[24];
+  gchar *p = str + sizeof (str);
+  guint64 uval = value < 0 ? -(guint64) value : (guint64) value;
+
+  append_prefix (writer, name);
+  do {
+    *--p = '0' + (uval % 10);
+    uval /= 10;
+  } while (uval);
+
+  if (value < 0)
+    *--p = '-';
+
+  g_string_append_len (writer->buf, p, str + sizeof (str) - p);
+}
+
+void
+json_writer_null (NvDsJsonWriter *writer, const gchar *name)
+{
+  append_prefix (writer, name);
+  g_string_append_len (writer->buf, "null", 4);
+}
+
+gchar*
+json_writer_string_reserve (NvDsJsonWriter *writer, const gchar *name,
+                            gsize len)
+{
+  gsize pos;
+
+  append_prefix (writer, name);
+  g_string_append_c (writer->buf, '"');
+  pos = writer->buf->len;
+  g_string_set_size (writer->buf, pos + len);
+  g_string_append_c (writer->buf, '"');
+
+  return writer->buf->str + pos;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#ifndef _NVDS_JSON_WRITER_H_
+#define _NVDS_JSON_WRITER_H_
+
+#include <glib.h>
+
+/**
+ * Streaming JSON writer which appends directly to a caller owned GString.
+ *
+ * Layout of the output (indentation, separators, number formatting and
+ * string escaping) follows the json-glib generator so that payloads are
+ * byte-identical to the ones generated through JsonNode + json_to_string.
+ * Member names are written as is and must not need escaping.
+ */
+struct NvDsJsonWriter {
+  GString *buf;
+  gboolean pretty;
+  /** number of open objects / arrays. */
+  guint level;
+  /** bit n is set once container at level n has at least one member. */
+  guint64 hasMember;
+};
+
+/** Text of numbers written by json_writer_number_array. */
+enum NvDsNumberFormat {
+  /** g_ascii_dtostr, same as json_writer_double and json-glib. */
+  NVDS_NUMBER_FORMAT_DTOSTR,
+  /** shortest text which reads back to the same double. */
+  NVDS_NUMBER_FORMAT_SHORTEST,
+  /** shortest text which reads back to the same float. */
+  NVDS_NUMBER_FORMAT_FLOAT
+};
+
+void json_writer_init (NvDsJsonWriter *writer, GString *buf, gboolean pretty);
+
+/**
+ * Initializes writer to render a member of container at @a level in
+ * isolation. Rendered text can be spliced later with json_writer_raw_*
+ * into a message at same level.
+ */
+void json_writer_init_fragment (NvDsJsonWriter *writer, GString *buf,
+                                gboolean pretty, guint level);
+
+/** Splices pre-rendered member (indentation, name and value). */
+void json_writer_raw_member (NvDsJsonWriter *writer, const gchar *raw,
+                             gsize len);
+
+/**
+ * Splices pre-rendered opening of an object including its first members.
+ * More members can be written before json_writer_end_object.
+ */
+void json_writer_raw_begin_object (NvDsJsonWriter *writer, const gchar *raw,
+                                   gsize len);
+
+void json_writer_begin_object (NvDsJsonWriter *writer, const gchar *name);
+void json_writer_end_object (NvDsJsonWriter *writer);
+
+void json_writer_begin_array (NvDsJsonWriter *writer, const gchar *name);
+void json_writer_end_array (NvDsJsonWriter *writer);
+
+/** NULL value is written as json null, same as json-glib. */
+void json_writer_string (NvDsJsonWriter *writer, const gchar *name,
+                         const gchar *value);
+void json_writer_double (NvDsJsonWriter *writer, const gchar *name,
+                         gdouble value);
+void json_writer_int (NvDsJsonWriter *writer, const gchar *name, gint64 value);
+
+/**
+ * Writes array of @a count numbers in @a format. Only
+ * NVDS_NUMBER_FORMAT_DTOSTR matches json-glib formatting.
+ */
+void json_writer_number_array (NvDsJsonWriter *writer, const gchar *name,
+                               const gdouble *values, guint count,
+                               NvDsNumberFormat format);
+void json_writer_null (NvDsJsonWriter *writer, const gchar *name);
+
+/**
+ * Writes string member of @a len characters and returns pointer to them,
+ * caller fills the characters in place. Those are not escaped.
+ */
+gchar* json_writer_string_reserve (NvDsJsonWriter *writer, const gchar *name,
+                                   gsize len);
+
+/** Appends @a str json escaped, without quotes. */
+void json_append_escaped (GString *buf, const gchar *str);
+
+#endif
@@ -0,0 +1,415 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Shortest round-trip number formatting based on Grisu2 of
+ * Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately
+ * with Integers" (PLDI 2010). Value and its rounding boundaries are scaled by
+ * a cached power of ten into a 64 bit fixed point range where digits are
+ * generated with integer arithmetic only, stopping as soon as the digits
+ * identify the value.
+ */
+
+#include "number_format.h"
+#include <math.h>
+#include <string.h>
+
+/** floating point number f * 2^e with 64 bit significand. */
+struct NvDsDiyFp {
+  guint64 f;
+  gint e;
+};
+
+struct NvDsCachedPower {
+  guint64 f;
+  gint e;
+  gint k;
+};
+
+// range of binary exponent of scaled value, digits are generated from it.
+#define GRISU_ALPHA -60
+#define GRISU_GAMMA -32
+
+#define CACHED_POWERS_MIN_DEC_EXP -300
+#define CACHED_POWERS_DEC_STEP 8
+
+/** normalized 10^k for k = -300, -292, ... 324, rounded to nearest. */
+static const NvDsCachedPower cachedPowers[] = {
+  {0xAB70FE17C79AC6CAULL, -1060, -300},
+  {0xFF77B1FCBEBCDC4FULL, -1034, -292},
+  {0xBE5691EF416BD60CULL, -1007, -284},
+  {0x8DD01FAD907FFC3CULL,  -980, -276},
+  {0xD3515C2831559A83ULL,  -954, -268},
+  {0x9D71AC8FADA6C9B5ULL,  -927, -260},
+  {0xEA9C227723EE8BCBULL,  -901, -252},
+  {0xAECC49914078536DULL,  -874, -244},
+  {0x823C12795DB6CE57ULL,  -847, -236},
+  {0xC21094364DFB5637ULL,  -821, -228},
+  {0x9096EA6F3848984FULL,  -794, -220},
+  {0xD77485CB25823AC7ULL,  -768, -212},
+  {0xA086CFCD97BF97F4ULL,  -741, -204},
+  {0xEF340A98172AACE5ULL,  -715, -196},
+  {0xB23867FB2A35B28EULL,  -688, -188},
+  {0x84C8D4DFD2C63F3BULL,  -661, -180},
+  {0xC5DD44271AD3CDBAULL,  -635, -172},
+  {0x936B9FCEBB25C996ULL,  -608, -164},
+  {0xDBAC6C247D62A584ULL,  -582, -156},
+  {0xA3AB66580D5FDAF6ULL,  -555, -148},
+  {0xF3E2F893DEC3F126ULL,  -529, -140},
+  {0xB5B5ADA8AAFF80B8ULL,  -502, -132},
+  {0x87625F056C7C4A8BULL,  -475, -124},
+  {0xC9BCFF6034C13053ULL,  -449, -116},
+  {0x964E858C91BA2655ULL,  -422, -108},
+  {0xDFF9772470297EBDULL,  -396, -100},
+  {0xA6DFBD9FB8E5B88FULL,  -369,  -92},
+  {0xF8A95FCF88747D94ULL,  -343,  -84},
+  {0xB94470938FA89BCFULL,  -316,  -76},
+  {0x8A08F0F8BF0F156BULL,  -289,  -68},
+  {0xCDB02555653131B6ULL,  -263,  -60},
+  {0x993FE2C6D07B7FACULL,  -236,  -52},
+  {0xE45C10C42A2B3B06ULL,  -210,  -44},
+  {0xAA242499697392D3ULL,  -183,  -36},
+  {0xFD87B5F28300CA0EULL,  -157,  -28},
+  {0xBCE5086492111AEBULL,  -130,  -20},
+  {0x8CBCCC096F5088CCULL,  -103,  -12},
+  {0xD1B71758E219652CULL,   -77,   -4},
+  {0x9C40000000000000ULL,   -50,    4},
+  {0xE8D4A51000000000ULL,   -24,   12},
+  {0xAD78EBC5AC620000ULL,     3,   20},
+  {0x813F3978F8940984ULL,    30,   28},
+  {0xC097CE7BC90715B3ULL,    56,   36},
+  {0x8F7E32CE7BEA5C70ULL,    83,   44},
+  {0xD5D238A4ABE98068ULL,   109,   52},
+  {0x9F4F2726179A2245ULL,   136,   60},
+  {0xED63A231D4C4FB27ULL,   162,   68},
+  {0xB0DE65388CC8ADA8ULL,   189,   76},
+  {0x83C7088E1AAB65DBULL,   216,   84},
+  {0xC45D1DF942711D9AULL,   242,   92},
+  {0x924D692CA61BE758ULL,   269,  100},
+  {0xDA01EE641A708DEAULL,   295,  108},
+  {0xA26DA3999AEF774AULL,   322,  116},
+  {0xF209787BB47D6B85ULL,   348,  124},
+  {0xB454E4A179DD1877ULL,   375,  132},
+  {0x865B86925B9BC5C2ULL,   402,  140},
+  {0xC83553C5C8965D3DULL,   428,  148},
+  {0x952AB45CFA97A0B3ULL,   455,  156},
+  {0xDE469FBD99A05FE3ULL,   481,  164},
+  {0xA59BC234DB398C25ULL,   508,  172},
+  {0xF6C69A72A3989F5CULL,   534,  180},
+  {0xB7DCBF5354E9BECEULL,   561,  188},
+  {0x88FCF317F22241E2ULL,   588,  196},
+  {0xCC20CE9BD35C78A5ULL,   614,  204},
+  {0x98165AF37B2153DFULL,   641,  212},
+  {0xE2A0B5DC971F303AULL,   667,  220},
+  {0xA8D9D1535CE3B396ULL,   694,  228},
+  {0xFB9B7CD9A4A7443CULL,   720,  236},
+  {0xBB764C4CA7A44410ULL,   747,  244},
+  {0x8BAB8EEFB6409C1AULL,   774,  252},
+  {0xD01FEF10A657842CULL,   800,  260},
+  {0x9B10A4E5E9913129ULL,   827,  268},
+  {0xE7109BFBA19C0C9DULL,   853,  276},
+  {0xAC2820D9623BF429ULL,   880,  284},
+  {0x80444B5E7AA7CF85ULL,   907,  292},
+  {0xBF21E44003ACDD2DULL,   933,  300},
+  {0x8E679C2F5E44FF8FULL,   960,  308},
+  {0xD433179D9C8CB841ULL,   986,  316},
+  {0x9E19DB92B4E31BA9ULL,  1013,  324},
+};
+
+static const gchar base64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static inline NvDsDiyFp
+diyfp (guint64 f, gint e)
+{
+  NvDsDiyFp x = {f, e};
+  return x;
+}
+
+/** product rounded to 64 bits. */
+static inline NvDsDiyFp
+diyfp_mul (NvDsDiyFp x, NvDsDiyFp y)
+{
+  unsigned __int128 p = (unsigned __int128) x.f * y.f;
+
+  p += (unsigned __int128) 1 << 63;
+  return diyfp ((guint64) (p >> 64), x.e + y.e + 64);
+}
+
+static inline NvDsDiyFp
+diyfp_normalize (NvDsDiyFp x)
+{
+  gint shift = __builtin_clzll (x.f);
+
+  return diyfp (x.f << shift, x.e - shift);
+}
+
+/**
+ * Splits IEEE value with @a precision bits of significand (including hidden
+ * bit) into normalized value and its lower / upper rounding boundaries
+ * having the same exponent.
+ */
+static void
+compute_boundaries (guint64 bits, gint precision, gint exponentBits,
+                    NvDsDiyFp *v, NvDsDiyFp *minus, NvDsDiyFp *plus)
+{
+  const guint64 hiddenBit = 1ULL << (precision - 1);
+  const gint bias = (1 << (exponentBits - 1)) - 1 + (precision - 1);
+  const guint64 fraction = bits & (hiddenBit - 1);
+  const guint64 exponent = bits >> (precision - 1);
+  NvDsDiyFp w;
+  NvDsDiyFp m;
+  gboolean lowerCloser;
+
+  if (exponent == 0)
+    w = diyfp (fraction, 1 - bias);
+  else
+    w = diyfp (fraction + hiddenBit, (gint) exponent - bias);
+
+  // boundary below is closer at powers of two, except for the smallest one
+  lowerCloser = fraction == 0 && exponent > 1;
+
+  *plus = diyfp_normalize (diyfp (2 * w.f + 1, w.e - 1));
+  if (lowerCloser)
+    m = diyfp (4 * w.f - 1, w.e - 2);
+  else
+    m = diyfp (2 * w.f - 1, w.e - 1);
+  *minus = diyfp (m.f << (m.e - plus->e), plus->e);
+  *v = diyfp_normalize (w);
+}
+
+/** cached power c = 10^-k such that exponent of c * 2^e is in range. */
+static const NvDsCachedPower *
+get_cached_power (gint e)
+{
+  // k = ceil((alpha - e - 1) * log10(2))
+  const gint f = GRISU_ALPHA - e - 1;
+  const gint k = (f * 78913) / (1 << 18) + (f > 0);
+  const gint index = (-CACHED_POWERS_MIN_DEC_EXP + k +
+                      (CACHED_POWERS_DEC_STEP - 1)) / CACHED_POWERS_DEC_STEP;
+
+  return &cachedPowers[index];
+}
+
+/**
+ * Moves last digit towards the value while still inside the boundaries,
+ * picks the closest of the shortest candidates.
+ */
+static inline void
+grisu_round (gchar *buf, guint len, guint64 dist, guint64 delta,
+             guint64 rest, guint64 tenK)
+{
+  while (rest < dist && delta - rest >= tenK &&
+         (rest + tenK < dist || dist - rest > rest + tenK - dist)) {
+    buf[len - 1]--;
+    rest += tenK;
+  }
+}
+
+static inline guint
+largest_pow10 (guint32 n, guint32 *pow10)
+{
+  static const guint32 powers[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+    1000000000
+  };
+  guint digits = 10;
+
+  while (digits > 1 && n < powers[digits - 1])
+    digits--;
+  *pow10 = powers[digits - 1];
+  return digits;
+}
+
+/**
+ * Generates digits of @a w in [minus, plus], all scaled to the same
+ * exponent in [GRISU_ALPHA, GRISU_GAMMA].
+ */
+static guint
+grisu_digit_gen (gchar *buf, gint *decExp, NvDsDiyFp minus, NvDsDiyFp w,
+                 NvDsDiyFp plus)
+{
+  const NvDsDiyFp one = diyfp (1ULL << -plus.e, plus.e);
+  guint64 delta = plus.f - minus.f;
+  guint64 dist = plus.f - w.f;
+  guint32 p1 = (guint32) (plus.f >> -one.e);
+  guint64 p2 = plus.f & (one.f - 1);
+  guint64 rest;
+  guint32 pow10;
+  guint len = 0;
+  guint n;
+  gint m = 0;
+
+  // integral part
+  n = largest_pow10 (p1, &pow10);
+  while (n > 0) {
+    buf[len++] = '0' + p1 / pow10;
+    p1 %= pow10;
+    n--;
+
+    rest = ((guint64) p1 << -one.e) + p2;
+    if (rest <= delta) {
+      *decExp += n;
+      grisu_round (buf, len, dist, delta, rest, (guint64) pow10 << -one.e);
+      return len;
+    }
+    pow10 /= 10;
+  }
+
+  // fractional part
+  do {
+    p2 *= 10;
+    buf[len++] = '0' + (p2 >> -one.e);
+    p2 &= one.f - 1;
+    m++;
+    delta *= 10;
+    dist *= 10;
+  } while (p2 > delta);
+
+  *decExp -= m;
+  grisu_round (buf, len, dist, delta, p2, one.f);
+  return len;
+}
+
+/** digits * 10^decExp in "%.17g" layout. */
+static guint
+format_digits (gchar *out, const gchar *digits, guint len, gint decExp)
+{
+  gint exp10 = (gint) len + decExp - 1;
+  gchar *p = out;
+  guint i;
+
+  if (exp10 < -4 || exp10 >= 17) {
+    *p++ = digits[0];
+    if (len > 1) {
+      *p++ = '.';
+      memcpy (p, digits + 1, len - 1);
+      p += len - 1;
+    }
+    *p++ = 'e';
+    *p++ = exp10 < 0 ? '-' : '+';
+    exp10 = ABS (exp10);
+    if (exp10 >= 100)
+      *p++ = '0' + exp10 / 100;
+    *p++ = '0' + exp10 / 10 % 10;
+    *p++ = '0' + exp10 % 10;
+  } else if (decExp >= 0) {
+    memcpy (p, digits, len);
+    p += len;
+    for (i = 0; i < (guint) decExp; i++)
+      *p++ = '0';
+  } else if (exp10 >= 0) {
+    memcpy (p, digits, exp10 + 1);
+    p += exp10 + 1;
+    *p++ = '.';
+    memcpy (p, digits + exp10 + 1, len - exp10 - 1);
+    p += len - exp10 - 1;
+  } else {
+    *p++ = '0';
+    *p++ = '.';
+    for (i = 0; i < (guint) -exp10 - 1; i++)
+      *p++ = '0';
+    memcpy (p, digits, len);
+    p += len;
+  }
+
+  return p - out;
+}
+
+static guint
+format_ieee (guint64 bits, gint precision, gint exponentBits, gboolean negative,
+             gchar *buf)
+{
+  NvDsDiyFp v, minus, plus;
+  const NvDsCachedPower *cached;
+  NvDsDiyFp c;
+  gchar digits[20];
+  gint decExp;
+  guint len;
+  gchar *p = buf;
+
+  if (negative)
+    *p++ = '-';
+
+  if (bits == 0) {
+    *p++ = '0';
+    return p - buf;
+  }
+
+  compute_boundaries (bits, precision, exponentBits, &v, &minus, &plus);
+
+  cached = get_cached_power (plus.e);
+  c = diyfp (cached->f, cached->e);
+  v = diyfp_mul (v, c);
+  minus = diyfp_mul (minus, c);
+  plus = diyfp_mul (plus, c);
+  // boundaries are only known within 1 ulp after scaling, stay inside
+  minus.f++;
+  plus.f--;
+
+  decExp = -cached->k;
+  len = grisu_digit_gen (digits, &decExp, minus, v, plus);
+
+  return (p - buf) + format_digits (p, digits, len, decExp);
+}
+
+guint
+format_double (gdouble value, gchar buf[NVDS_NUMBER_BUF_SIZE])
+{
+  guint64 bits;
+
+  if (!isfinite (value)) {
+    g_ascii_dtostr (buf, NVDS_NUMBER_BUF_SIZE, value);
+    return strlen (buf);
+  }
+
+  memcpy (&bits, &value, sizeof (bits));
+  return format_ieee (bits & ~(1ULL << 63), 53, 11, bits >> 63, buf);
+}
+
+guint
+format_float (gfloat value, gchar buf[NVDS_NUMBER_BUF_SIZE])
+{
+  guint32 bits;
+
+  if (!isfinite (value)) {
+    g_ascii_dtostr (buf, NVDS_NUMBER_BUF_SIZE, value);
+    return strlen (buf);
+  }
+
+  memcpy (&bits, &value, sizeof (bits));
+  return format_ieee (bits & ~(1U << 31), 24, 8, bits >> 31, buf);
+}
+
+void
+base64_encode (const guint8 *data, gsize len, gchar *out)
+{
+  guint32 triple;
+  gsize i;
+
+  for (i = 0; i + 3 <= len; i += 3) {
+    triple = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+    *out++ = base64Chars[triple >> 18];
+    *out++ = base64Chars[(triple >> 12) & 0x3F];
+    *out++ = base64Chars[(triple >> 6) & 0x3F];
+    *out++ = base64Chars[triple & 0x3F];
+  }
+
+  if (i < len) {
+    triple = data[i] << 16;
+    if (i + 1 < len)
+      triple |= data[i + 1] << 8;
+    *out++ = base64Chars[triple >> 18];
+    *out++ = base64Chars[(triple >> 12) & 0x3F];
+    *out++ = i + 1 < len ? base64Chars[(triple >> 6) & 0x3F] : '=';
+    *out++ = '=';
+  }
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#ifndef _NVDS_NUMBER_FORMAT_H_
+#define _NVDS_NUMBER_FORMAT_H_
+
+#include <glib.h>
+
+/** enough for any formatted double, including sign and exponent. */
+#define NVDS_NUMBER_BUF_SIZE 32
+
+/**
+ * Formats @a value with the fewest significant digits that read back to the
+ * same double (Grisu2, almost always the shortest). Locale independent, same
+ * layout as "%.17g": exponent form for exponents below -4 or from 17.
+ * Non finite values are formatted by g_ascii_dtostr.
+ *
+ * @return number of characters written to @a buf, no null is written.
+ */
+guint format_double (gdouble value, gchar buf[NVDS_NUMBER_BUF_SIZE]);
+
+/** Same as format_double for a float, text reads back to the same float. */
+guint format_float (gfloat value, gchar buf[NVDS_NUMBER_BUF_SIZE]);
+
+/** length of base64 text for @a len bytes, without padding removal. */
+#define NVDS_BASE64_LEN(len) ((((len) + 2) / 3) * 4)
+
+/**
+ * Standard base64 with padding. Writes NVDS_BASE64_LEN(@a len) characters,
+ * no null is written.
+ */
+void base64_encode (const guint8 *data, gsize len, gchar *out);
+
+#endif
@@ -10,14 +10,30 @@
  */
 
 #include "nvmsgconv.h"
+#include "json_writer.h"
+#include "binary_schema.h"
+#include "payload_pool.h"
+#include "id_generator.h"
+#include "string_pool.h"
+#include "csv_reader.h"
+#include "id_table.h"
+#include "number_format.h"
+#include "projection.h"
+#include "compression.h"
+#include "delta_encoding.h"
+#include "payload_template.h"
+#include "nvds_timestamp.h"
 #include <json-glib/json-glib.h>
-#include <uuid/uuid.h>
 #include <stdlib.h>
 #include <iostream>
-#include <fstream>
 #include <cstring>
 #include <vector>
-#include <unordered_map>
+#include <atomic>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
 
 using namespace std;
 
@@ -25,6 +41,7 @@ using namespace std;
 #define CONFIG_GROUP_SENSOR "sensor"
 #define CONFIG_GROUP_PLACE "place"
 #define CONFIG_GROUP_ANALYTICS "analytics"
+#define CONFIG_GROUP_SCHEMA "schema"
 
 #define CONFIG_KEY_COORDINATE "coordinate"
 #define CONFIG_KEY_DESCRIPTION "description"
@@ -43,7 +60,31 @@ using namespace std;
 #define CONFIG_KEY_PLACE_SUB_FIELD2 "place-sub-field2"
 #define CONFIG_KEY_PLACE_SUB_FIELD3 "place-sub-field3"
 
+#define CONFIG_KEY_PRETTY_PRINT "pretty-print"
+#define CONFIG_KEY_DIRECT_WRITER "direct-writer"
+#define CONFIG_KEY_PAYLOAD_POOL_SIZE "payload-pool-size"
+#define CONFIG_KEY_ID_MODE "id-mode"
+#define CONFIG_KEY_WATCH_CONFIG "watch-config"
+#define CONFIG_KEY_SIGNATURE_FORMAT "signature-format"
+#define CONFIG_KEY_PROJECTION "projection"
+#define CONFIG_KEY_COMPRESSION "compression"
+#define CONFIG_KEY_COMPRESSION_LEVEL "compression-level"
+#define CONFIG_KEY_COMPRESSION_DICTIONARY "compression-dictionary"
+#define CONFIG_KEY_DELTA_ENCODING "delta-encoding"
+#define CONFIG_KEY_DELTA_KEYFRAME_INTERVAL "delta-keyframe-interval"
+#define CONFIG_KEY_DELTA_MAX_TRACKS "delta-max-tracks"
+#define CONFIG_KEY_TEMPLATE "template"
+#define CONFIG_KEY_TIMESTAMP_FORMAT "timestamp-format"
+#define CONFIG_KEY_TS_EPOCH_NS "ts-epoch-ns"
+
+#define DEFAULT_DELTA_KEYFRAME_INTERVAL 30
+#define DEFAULT_DELTA_MAX_TRACKS 4096
+
 #define DEFAULT_CSV_FIELDS 10
+#define DEFAULT_PAYLOAD_POOL_SIZE 16
+#define MAX_PAYLOAD_POOL_SIZE 4096
+// floats per base64 chunk, 48 bytes encode without padding
+#define SIGNATURE_CHUNK_SIZE 12
 
 
 #define CHECK_ERROR(error) \
@@ -58,77 +99,335 @@ using namespace std;
  * e.g. field1 will be 'id' and 'name' for spot and entrance respectively.
  */
 struct NvDsPlaceSubObject {
-  string field1;
-  string field2;
-  string field3;
+  const gchar *field1 = "";
+  const gchar *field2 = "";
+  const gchar *field3 = "";
+};
+
+/**
+ * Sub object of place depends on event type, see get_place_variant().
+ */
+enum NvDsPlaceVariant {
+  NVDS_PLACE_VARIANT_NONE,
+  NVDS_PLACE_VARIANT_AISLE,
+  NVDS_PLACE_VARIANT_PARKING_SPOT,
+  NVDS_PLACE_VARIANT_ENTRANCE,
+  NVDS_PLACE_VARIANT_MAX
+};
+
+/**
+ * Encoding of object signature in json payload.
+ */
+enum NvDsSignatureFormat {
+  /** array of numbers formatted as json-glib does (17 digits). */
+  NVDS_SIGNATURE_FORMAT_DOUBLE,
+  /** array of numbers, shortest text reading back to the same double. */
+  NVDS_SIGNATURE_FORMAT_SHORTEST,
+  /** array of numbers, shortest text reading back to the same float. */
+  NVDS_SIGNATURE_FORMAT_FLOAT,
+  /** string, base64 of little endian float32 values. */
+  NVDS_SIGNATURE_FORMAT_BASE64
+};
+
+/**
+ * Encoding of @timestamp of messages.
+ */
+enum NvDsTimestampFormat {
+  /** RFC 3339 string, ts of event or formatted from tsEpochNs. */
+  NVDS_TIMESTAMP_FORMAT_ISO,
+  /** number of milliseconds since epoch. */
+  NVDS_TIMESTAMP_FORMAT_EPOCH_MS
 };
 
+/*
+ * Strings of configuration objects are interned in the string pool of
+ * NvDsConfigTables, entries sharing values (e.g. all the CSV rows) don't
+ * keep their own copies.
+ */
 struct NvDsSensorObject {
-  string id;
-  string type;
-  string desc;
+  const gchar *id = "";
+  const gchar *type = "";
+  const gchar *desc = "";
   gdouble location[3];
   gdouble coordinate[3];
+  /** pre-rendered "sensor" member used by direct writer. */
+  NvDsStr fragment = {};
 };
 
 struct NvDsPlaceObject {
-  string id;
-  string name;
-  string type;
+  const gchar *id = "";
+  const gchar *name = "";
+  const gchar *type = "";
   gdouble location[3];
   gdouble coordinate[3];
   NvDsPlaceSubObject subObj;
+  /** pre-rendered "place" member for each NvDsPlaceVariant. */
+  NvDsStr fragment[NVDS_PLACE_VARIANT_MAX] = {};
 };
 
 struct NvDsAnalyticsObject {
-  string id;
-  string desc;
-  string source;
-  string version;
+  const gchar *id = "";
+  const gchar *desc = "";
+  const gchar *source = "";
+  const gchar *version = "";
+  /** pre-rendered "analyticsModule" member without closing brace. */
+  NvDsStr fragment = {};
+};
+
+/**
+ * Sensor, place and analytics module entries of configuration file.
+ * Tables are immutable once published, reload builds new ones and swaps
+ * the pointer (see config_tables_swap).
+ */
+struct NvDsConfigTables {
+  NvDsIdTable<NvDsSensorObject> sensorObj;
+  NvDsIdTable<NvDsPlaceObject> placeObj;
+  NvDsIdTable<NvDsAnalyticsObject> analyticsObj;
+  /** strings and fragments referenced by objects above. */
+  NvDsStringPool strings;
 };
 
 struct NvDsPayloadPriv {
-  unordered_map<int, NvDsSensorObject> sensorObj;
-  unordered_map<int, NvDsPlaceObject> placeObj;
-  unordered_map<int, NvDsAnalyticsObject> analyticsObj;
+  /** current tables, read inside config_tables_read_lock / unlock. */
+  std::atomic<NvDsConfigTables *> tables;
+  /**
+   * Grace period tracking of readers. Readers register in the counter of
+   * current epoch parity, swap waits for both counters to drain in turn.
+   */
+  std::atomic<guint> tablesEpoch;
+  std::atomic<gint> tablesReaders[2];
+  /** serializes reloads, never taken by readers. */
+  GMutex reloadLock;
+  NvDsMsg2pReloadStats reloadStats;
+  /** configuration file, re-read by nvds_msg2p_reload. */
+  gchar *configFile;
+  /** reload when configuration file changes. */
+  gboolean watchConfig;
+  GThread *watchThread;
+  /** write end wakes up and stops watch thread. */
+  gint watchStopFd[2];
+  /** generate indented (json_to_string pretty) or compact json. */
+  gboolean prettyPrint;
+  /** write json directly to payload buffer instead of building json-glib tree. */
+  gboolean directWriter;
+  /** max number of released payload buffers kept for reuse. */
+  guint payloadPoolSize;
+  /** payload buffers, messages are generated in place. */
+  NvDsPayloadPool *payloadPool;
+  /** generator of message and event ids. */
+  NvDsIdGenerator idGen;
+  /** encoding of object signature. */
+  NvDsSignatureFormat signatureFormat;
+  NvDsTimestampFormat timestampFormat;
+  /** producers set tsEpochNs, read only then (field of later nvdsmeta.h). */
+  gboolean tsEpochNs;
+  /** fields written by direct writer. */
+  NvDsProjection projection;
+  /** codec, level and dictionary file of compression key. */
+  NvDsCompression compression;
+  gint compressionLevel;
+  gchar *compressionDict;
+  /** compresses generated payloads, NULL without compression. */
+  NvDsCompressor *compressor;
+  /** send moving events as keyframes and deltas per track. */
+  gboolean deltaEncoding;
+  guint deltaKeyframeInterval;
+  guint deltaMaxTracks;
+  /** track states, NULL without delta encoding. */
+  NvDsDeltaEncoder *deltaEncoder;
+  /** template file of NVDS_PAYLOAD_CUSTOM payloads. */
+  gchar *templateFile;
+  NvDsPayloadTemplate payloadTemplate;
 };
 
+/**
+ * Generates message / event id as per id-mode of context.
+ */
+static inline void
+generate_id (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta,
+             guint8 id[NVDS_ID_SIZE])
+{
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
+
+  id_generator_next (&privObj->idGen, meta->sensorId, id);
+}
+
 static void
-get_csv_tokens (const string &text, vector<string> &tokens)
+generate_id_string (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta,
+                    gchar str[NVDS_ID_STR_LEN + 1])
 {
-  /* This is based on assumption that fields and their locations
-   * are fixed in CSV file. This should be updated accordingly if
-   * that is not the case.
-   */
-  gint count = 0;
+  guint8 id[NVDS_ID_SIZE];
+
+  generate_id (ctx, meta, id);
+  id_format (id, str);
+  str[NVDS_ID_STR_LEN] = '\0';
+}
+
+/**
+ * Returns tsEpochNs of @a meta, 0 unless producers declared with
+ * ts-epoch-ns that they set it. Producers built against nvdsmeta.h without
+ * the field allocate smaller event meta.
+ */
+static inline guint64
+get_epoch_ns (NvDsPayloadPriv *privObj, NvDsEventMsgMeta *meta)
+{
+  return privObj->tsEpochNs ? meta->tsEpochNs : 0;
+}
+
+/**
+ * Returns ts of @a meta, formatted into @a buf from tsEpochNs if ts is not
+ * set. NULL if neither is set.
+ */
+static const gchar *
+get_timestamp (NvDsPayloadPriv *privObj, NvDsEventMsgMeta *meta,
+               gchar buf[NVDS_TIMESTAMP_LEN + 1])
+{
+  guint64 epochNs;
+
+  if (meta->ts || !(epochNs = get_epoch_ns (privObj, meta)))
+    return meta->ts;
+
+  nvds_format_timestamp (epochNs, buf);
+  return buf;
+}
+
+/**
+ * Returns milliseconds since epoch of @a meta, parsed from ts if tsEpochNs
+ * is not set. ts is expected in UTC as generated by nvds_format_timestamp.
+ */
+static gint64
+get_epoch_ms (NvDsPayloadPriv *privObj, NvDsEventMsgMeta *meta)
+{
+  struct tm tm = {};
+  gint ms = 0;
+  gint digits = 0;
+  const gchar *frac;
+  guint64 epochNs = get_epoch_ns (privObj, meta);
+
+  if (epochNs)
+    return epochNs / 1000000;
+
+  if (!meta->ts ||
+      sscanf (meta->ts, "%d-%d-%dT%d:%d:%d", &tm.tm_year, &tm.tm_mon,
+              &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6)
+    return 0;
+
+  frac = strchr (meta->ts, '.');
+  for (frac = frac ? frac + 1 : NULL; frac && g_ascii_isdigit (*frac) &&
+       digits < 3; frac++, digits++)
+    ms = ms * 10 + (*frac - '0');
+  for (; digits && digits < 3; digits++)
+    ms *= 10;
+
+  tm.tm_year -= 1900;
+  tm.tm_mon -= 1;
+  return (gint64) timegm (&tm) * 1000 + ms;
+}
+
+static void
+write_timestamp (NvDsPayloadPriv *privObj, NvDsEventMsgMeta *meta,
+                 NvDsJsonWriter *writer)
+{
+  gchar buf[NVDS_TIMESTAMP_LEN + 1];
+
+  if (privObj->timestampFormat == NVDS_TIMESTAMP_FORMAT_EPOCH_MS)
+    json_writer_int (writer, "@timestamp", get_epoch_ms (privObj, meta));
+  else
+    json_writer_string (writer, "@timestamp",
+                        get_timestamp (privObj, meta, buf));
+}
+
+/**
+ * Encodes signature as base64 of little endian float32 values into @a out
+ * which should have space for NVDS_BASE64_LEN (4 * size) characters.
+ */
+static void
+encode_signature_base64 (const NvDsObjectSignature *sig, gchar *out)
+{
+  guint8 chunk[SIGNATURE_CHUNK_SIZE * 4];
+  gfloat value;
+  guint32 bits;
+  guint count;
+  guint i, j;
+
+  for (i = 0; i < sig->size; i += count) {
+    count = MIN (SIGNATURE_CHUNK_SIZE, sig->size - i);
+    for (j = 0; j < count; j++) {
+      value = (gfloat) sig->signature[i + j];
+      memcpy (&bits, &value, sizeof (bits));
+      bits = GUINT32_TO_LE (bits);
+      memcpy (chunk + j * 4, &bits, sizeof (bits));
+    }
+    base64_encode (chunk, count * 4, out);
+    out += NVDS_BASE64_LEN (count * 4);
+  }
+}
+
+/**
+ * Returns interned copy of @a str, NULL is stored as empty string.
+ */
+static const gchar *
+intern_string (NvDsConfigTables *tables, const gchar *str)
+{
+  return str ? string_pool_intern (&tables->strings, str, -1).str : "";
+}
+
+/**
+ * Registers calling thread as reader of config tables. Tables loaded
+ * after this call stay valid until config_tables_read_unlock with the
+ * returned slot. Readers never block.
+ */
+static inline guint
+config_tables_read_lock (NvDsPayloadPriv *privObj)
+{
+  guint slot = privObj->tablesEpoch.load () & 1;
 
-  gchar **csv_tokens = g_strsplit (text.c_str(), ",", -1);
-  gchar **temp = csv_tokens;
-  gchar *token;
+  privObj->tablesReaders[slot].fetch_add (1);
+  return slot;
+}
+
+static inline void
+config_tables_read_unlock (NvDsPayloadPriv *privObj, guint slot)
+{
+  privObj->tablesReaders[slot].fetch_sub (1, std::memory_order_release);
+}
 
-  while (*temp && count < DEFAULT_CSV_FIELDS) {
-    token = *temp++;
-    tokens.push_back (string(g_strstrip(token)));
-    count++;
+/**
+ * Publishes @a tables and returns previous tables once no reader can
+ * access those anymore. reloadLock should be held.
+ */
+static NvDsConfigTables *
+config_tables_swap (NvDsPayloadPriv *privObj, NvDsConfigTables *tables)
+{
+  NvDsConfigTables *old = privObj->tables.exchange (tables);
+  guint slot;
+  gint i;
+
+  /* Readers which registered before the flip may still use old tables.
+   * Counter of the other parity can have readers of old tables which
+   * read epoch just before previous flip, so wait for both. Counters are
+   * read seq_cst so that the load isn't ordered before the pointer exchange,
+   * a reader either shows up in counter or already sees new tables. */
+  for (i = 0; i < 2; i++) {
+    slot = privObj->tablesEpoch.fetch_add (1) & 1;
+    while (privObj->tablesReaders[slot].load (std::memory_order_seq_cst))
+      g_thread_yield ();
   }
-  g_strfreev (csv_tokens);
+
+  return old;
 }
 
 static JsonObject*
-generate_place_object (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
+generate_place_object (NvDsConfigTables *tables, NvDsEventMsgMeta *meta)
 {
-  NvDsPayloadPriv *privObj = NULL;
   NvDsPlaceObject *dsPlaceObj = NULL;
   JsonObject *placeObj;
   JsonObject *jobject;
   JsonObject *jobject2;
 
-  privObj = (NvDsPayloadPriv *) ctx->privData;
-  auto idMap = privObj->placeObj.find (meta->placeId);
+  dsPlaceObj = tables->placeObj.find (meta->placeId);
 
-  if (idMap != privObj->placeObj.end()) {
-    dsPlaceObj = &idMap->second;
-  } else {
+  if (!dsPlaceObj) {
     cout << "No entry for " CONFIG_GROUP_PLACE << meta->placeId
         << " in configuration file" << endl;
     return NULL;
@@ -159,9 +458,9 @@ generate_place_object (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
    */
 
   placeObj = json_object_new ();
-  json_object_set_string_member (placeObj, "id", dsPlaceObj->id.c_str());
-  json_object_set_string_member (placeObj, "name", dsPlaceObj->name.c_str());
-  json_object_set_string_member (placeObj, "type", dsPlaceObj->type.c_str());
+  json_object_set_string_member (placeObj, "id", dsPlaceObj->id);
+  json_object_set_string_member (placeObj, "name", dsPlaceObj->name);
+  json_object_set_string_member (placeObj, "type", dsPlaceObj->type);
 
   // location sub object
   jobject = json_object_new ();
@@ -176,29 +475,29 @@ generate_place_object (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
   switch (meta->type) {
     case NVDS_EVENT_MOVING:
     case NVDS_EVENT_STOPPED:
-      json_object_set_string_member (jobject, "id", dsPlaceObj->subObj.field1.c_str());
-      json_object_set_string_member (jobject, "name", dsPlaceObj->subObj.field2.c_str());
-      json_object_set_string_member (jobject, "level", dsPlaceObj->subObj.field3.c_str());
+      json_object_set_string_member (jobject, "id", dsPlaceObj->subObj.field1);
+      json_object_set_string_member (jobject, "name", dsPlaceObj->subObj.field2);
+      json_object_set_string_member (jobject, "level", dsPlaceObj->subObj.field3);
       json_object_set_object_member (placeObj, "aisle", jobject);
       break;
     case NVDS_EVENT_EMPTY:
     case NVDS_EVENT_PARKED:
-      json_object_set_string_member (jobject, "id", dsPlaceObj->subObj.field1.c_str());
-      json_object_set_string_member (jobject, "type", dsPlaceObj->subObj.field2.c_str());
-      json_object_set_string_member (jobject, "level", dsPlaceObj->subObj.field3.c_str());
+      json_object_set_string_member (jobject, "id", dsPlaceObj->subObj.field1);
+      json_object_set_string_member (jobject, "type", dsPlaceObj->subObj.field2);
+      json_object_set_string_member (jobject, "level", dsPlaceObj->subObj.field3);
       json_object_set_object_member (placeObj, "parkingSpot", jobject);
       break;
     case NVDS_EVENT_ENTRY:
     case NVDS_EVENT_EXIT:
       if (meta->objType == NVDS_OBJECT_TYPE_VEHICLE) {
-        json_object_set_string_member (jobject, "id", dsPlaceObj->subObj.field1.c_str());
-        json_object_set_string_member (jobject, "name", dsPlaceObj->subObj.field2.c_str());
-        json_object_set_string_member (jobject, "level", dsPlaceObj->subObj.field3.c_str());
+        json_object_set_string_member (jobject, "id", dsPlaceObj->subObj.field1);
+        json_object_set_string_member (jobject, "name", dsPlaceObj->subObj.field2);
+        json_object_set_string_member (jobject, "level", dsPlaceObj->subObj.field3);
         json_object_set_object_member (placeObj, "aisle", jobject);
       } else {
-        json_object_set_string_member (jobject, "name", dsPlaceObj->subObj.field1.c_str());
-        json_object_set_string_member (jobject, "lane", dsPlaceObj->subObj.field2.c_str());
-        json_object_set_string_member (jobject, "level", dsPlaceObj->subObj.field3.c_str());
+        json_object_set_string_member (jobject, "name", dsPlaceObj->subObj.field1);
+        json_object_set_string_member (jobject, "lane", dsPlaceObj->subObj.field2);
+        json_object_set_string_member (jobject, "level", dsPlaceObj->subObj.field3);
         json_object_set_object_member (placeObj, "entrance", jobject);
       }
       break;
@@ -218,19 +517,15 @@ generate_place_object (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
 }
 
 static JsonObject*
-generate_sensor_object (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
+generate_sensor_object (NvDsConfigTables *tables, NvDsEventMsgMeta *meta)
 {
-  NvDsPayloadPriv *privObj = NULL;
   NvDsSensorObject *dsSensorObj = NULL;
   JsonObject *sensorObj;
   JsonObject *jobject;
 
-  privObj = (NvDsPayloadPriv *) ctx->privData;
-  auto idMap = privObj->sensorObj.find (meta->sensorId);
+  dsSensorObj = tables->sensorObj.find (meta->sensorId);
 
-  if (idMap != privObj->sensorObj.end()) {
-    dsSensorObj = &idMap->second;
-  } else {
+  if (!dsSensorObj) {
     cout << "No entry for " CONFIG_GROUP_SENSOR << meta->sensorId
          << " in configuration file" << endl;
     return NULL;
@@ -256,9 +551,9 @@ generate_sensor_object (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
 
   // sensor object
   sensorObj = json_object_new ();
-  json_object_set_string_member (sensorObj, "id", dsSensorObj->id.c_str());
-  json_object_set_string_member (sensorObj, "type", dsSensorObj->type.c_str());
-  json_object_set_string_member (sensorObj, "description", dsSensorObj->desc.c_str());
+  json_object_set_string_member (sensorObj, "id", dsSensorObj->id);
+  json_object_set_string_member (sensorObj, "type", dsSensorObj->type);
+  json_object_set_string_member (sensorObj, "description", dsSensorObj->desc);
 
   // location sub object
   jobject = json_object_new ();
@@ -278,19 +573,15 @@ generate_sensor_object (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
 }
 
 static JsonObject*
-generate_analytics_module_object (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
+generate_analytics_module_object (NvDsConfigTables *tables,
+                                  NvDsEventMsgMeta *meta)
 {
-  NvDsPayloadPriv *privObj = NULL;
   NvDsAnalyticsObject *dsObj = NULL;
   JsonObject *analyticsObj;
 
-  privObj = (NvDsPayloadPriv *) ctx->privData;
-
-  auto idMap = privObj->analyticsObj.find (meta->moduleId);
+  dsObj = tables->analyticsObj.find (meta->moduleId);
 
-  if (idMap != privObj->analyticsObj.end()) {
-    dsObj = &idMap->second;
-  } else {
+  if (!dsObj) {
     cout << "No entry for " CONFIG_GROUP_ANALYTICS << meta->moduleId
         << " in configuration file" << endl;
     return NULL;
@@ -308,10 +599,10 @@ generate_analytics_module_object (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
 
   // analytics object
   analyticsObj = json_object_new ();
-  json_object_set_string_member (analyticsObj, "id", dsObj->id.c_str());
-  json_object_set_string_member (analyticsObj, "description", dsObj->desc.c_str());
-  json_object_set_string_member (analyticsObj, "source", dsObj->source.c_str());
-  json_object_set_string_member (analyticsObj, "version", dsObj->version.c_str());
+  json_object_set_string_member (analyticsObj, "id", dsObj->id);
+  json_object_set_string_member (analyticsObj, "description", dsObj->desc);
+  json_object_set_string_member (analyticsObj, "source", dsObj->source);
+  json_object_set_string_member (analyticsObj, "version", dsObj->version);
   json_object_set_double_member (analyticsObj, "confidence", meta->confidence);
 
   return analyticsObj;
@@ -321,8 +612,7 @@ static JsonObject*
 generate_event_object (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
 {
   JsonObject *eventObj;
-  uuid_t uuid;
-  gchar uuidStr[37];
+  gchar idStr[NVDS_ID_STR_LEN + 1];
 
   /*
    * "event": {
@@ -331,11 +621,10 @@ generate_event_object (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
      }
    */
 
-  uuid_generate_random (uuid);
-  uuid_unparse_lower(uuid, uuidStr);
+  generate_id_string (ctx, meta, idStr);
 
   eventObj = json_object_new ();
-  json_object_set_string_member (eventObj, "id", uuidStr);
+  json_object_set_string_member (eventObj, "id", idStr);
 
   switch (meta->type) {
     case NVDS_EVENT_ENTRY:
@@ -370,6 +659,7 @@ generate_event_object (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
 static JsonObject*
 generate_object_object (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
 {
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
   JsonObject *objectObj;
   JsonObject *jobject;
   guint i;
@@ -482,7 +772,16 @@ generate_object_object (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
   json_object_set_object_member (objectObj, "bbox", jobject);
 
   // signature sub array
-  if (meta->objSignature.size) {
+  if (meta->objSignature.size &&
+      privObj->signatureFormat == NVDS_SIGNATURE_FORMAT_BASE64) {
+    gsize len = NVDS_BASE64_LEN (meta->objSignature.size * 4);
+    gchar *str = (gchar *) g_malloc (len + 1);
+
+    encode_signature_base64 (&meta->objSignature, str);
+    str[len] = '\0';
+    json_object_set_string_member (objectObj, "signature", str);
+    g_free (str);
+  } else if (meta->objSignature.size) {
     JsonArray *jArray = json_array_sized_new (meta->objSignature.size);
 
     for (i = 0; i < meta->objSignature.size; i++) {
@@ -509,7 +808,8 @@ generate_object_object (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
 }
 
 static gchar*
-generate_schema_message (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
+generate_schema_message (NvDsMsg2pCtx *ctx, NvDsConfigTables *tables,
+                         NvDsEventMsgMeta *meta)
 {
   JsonNode *rootNode;
   JsonObject *rootObj;
@@ -518,22 +818,21 @@ generate_schema_message (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
   JsonObject *analyticsObj;
   JsonObject *eventObj;
   JsonObject *objectObj;
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
   gchar *message;
+  gchar msgIdStr[NVDS_ID_STR_LEN + 1];
+  gchar ts[NVDS_TIMESTAMP_LEN + 1];
 
-  uuid_t msgId;
-  gchar msgIdStr[37];
-
-  uuid_generate_random (msgId);
-  uuid_unparse_lower(msgId, msgIdStr);
+  generate_id_string (ctx, meta, msgIdStr);
 
   // place object
-  placeObj = generate_place_object (ctx, meta);
+  placeObj = generate_place_object (tables, meta);
 
   // sensor object
-  sensorObj = generate_sensor_object (ctx, meta);
+  sensorObj = generate_sensor_object (tables, meta);
 
   // analytics object
-  analyticsObj = generate_analytics_module_object (ctx, meta);
+  analyticsObj = generate_analytics_module_object (tables, meta);
 
   // object object
   objectObj = generate_object_object (ctx, meta);
@@ -545,7 +844,12 @@ generate_schema_message (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
   rootObj = json_object_new ();
   json_object_set_string_member (rootObj, "messageid", msgIdStr);
   json_object_set_string_member (rootObj, "mdsversion", "1.0");
-  json_object_set_string_member (rootObj, "@timestamp", meta->ts);
+  if (privObj->timestampFormat == NVDS_TIMESTAMP_FORMAT_EPOCH_MS)
+    json_object_set_int_member (rootObj, "@timestamp",
+                                get_epoch_ms (privObj, meta));
+  else
+    json_object_set_string_member (rootObj, "@timestamp",
+                                   get_timestamp (privObj, meta, ts));
   json_object_set_object_member (rootObj, "place", placeObj);
   json_object_set_object_member (rootObj, "sensor", sensorObj);
   json_object_set_object_member (rootObj, "analyticsModule", analyticsObj);
@@ -560,158 +864,1124 @@ generate_schema_message (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
   rootNode = json_node_new (JSON_NODE_OBJECT);
   json_node_set_object (rootNode, rootObj);
 
-  message = json_to_string (rootNode, TRUE);
+  message = json_to_string (rootNode,
+                            ((NvDsPayloadPriv *) ctx->privData)->prettyPrint);
   json_node_free (rootNode);
   json_object_unref (rootObj);
 
   return message;
 }
 
-static bool
-nvds_msg2p_parse_sensor (NvDsMsg2pCtx *ctx, GKeyFile *key_file, gchar *group)
+/*
+ * Direct writer counterparts of generate_*_object functions.
+ * Members are written in the same order as they are added to json-glib
+ * objects above so that generated payloads are byte-identical.
+ *
+ * place, sensor and analytics objects only depend on configuration so those
+ * are rendered once at context creation (see nvds_msg2p_render_fragments)
+ * and spliced into each message.
+ */
+static NvDsPlaceVariant
+get_place_variant (NvDsEventMsgMeta *meta)
 {
-  bool ret = false;
-  bool isEnabled = false;
-  gchar **keys = NULL;
-  gchar **key = NULL;
-  GError *error = NULL;
-  NvDsPayloadPriv *privObj = NULL;
-  NvDsSensorObject sensorObj;
-  gint sensorId;
-  gchar *keyVal;
+  switch (meta->type) {
+    case NVDS_EVENT_MOVING:
+    case NVDS_EVENT_STOPPED:
+      return NVDS_PLACE_VARIANT_AISLE;
+    case NVDS_EVENT_EMPTY:
+    case NVDS_EVENT_PARKED:
+      return NVDS_PLACE_VARIANT_PARKING_SPOT;
+    case NVDS_EVENT_ENTRY:
+    case NVDS_EVENT_EXIT:
+      if (meta->objType == NVDS_OBJECT_TYPE_VEHICLE)
+        return NVDS_PLACE_VARIANT_AISLE;
+      else
+        return NVDS_PLACE_VARIANT_ENTRANCE;
+    default:
+      return NVDS_PLACE_VARIANT_NONE;
+  }
+}
 
+static void
+render_place_object (NvDsPlaceObject *dsPlaceObj, NvDsPlaceVariant variant,
+                     const NvDsProjection *proj, NvDsJsonWriter *writer)
+{
+  const gchar *subObjName = NULL;
+  const gchar *subKeys[3];
+
+  json_writer_begin_object (writer, "place");
+  if (projection_has (proj, NVDS_FIELD_PLACE_ID))
+    json_writer_string (writer, "id", dsPlaceObj->id);
+  if (projection_has (proj, NVDS_FIELD_PLACE_NAME))
+    json_writer_string (writer, "name", dsPlaceObj->name);
+  if (projection_has (proj, NVDS_FIELD_PLACE_TYPE))
+    json_writer_string (writer, "type", dsPlaceObj->type);
+
+  if (projection_has (proj, NVDS_FIELD_PLACE_LOCATION)) {
+    json_writer_begin_object (writer, "location");
+    json_writer_double (writer, "lat", dsPlaceObj->location[0]);
+    json_writer_double (writer, "lon", dsPlaceObj->location[1]);
+    json_writer_double (writer, "alt", dsPlaceObj->location[2]);
+    json_writer_end_object (writer);
+  }
 
-  if (sscanf (group, CONFIG_GROUP_SENSOR "%u", &sensorId) < 1) {
-    cout << "Wrong sensor group name " << group << endl;
-    return ret;
+  switch (variant) {
+    case NVDS_PLACE_VARIANT_AISLE:
+      if (!projection_has (proj, NVDS_FIELD_PLACE_AISLE))
+        break;
+      subObjName = "aisle";
+      subKeys[0] = "id";
+      subKeys[1] = "name";
+      break;
+    case NVDS_PLACE_VARIANT_PARKING_SPOT:
+      if (!projection_has (proj, NVDS_FIELD_PLACE_PARKING_SPOT))
+        break;
+      subObjName = "parkingSpot";
+      subKeys[0] = "id";
+      subKeys[1] = "type";
+      break;
+    case NVDS_PLACE_VARIANT_ENTRANCE:
+      if (!projection_has (proj, NVDS_FIELD_PLACE_ENTRANCE))
+        break;
+      subObjName = "entrance";
+      subKeys[0] = "name";
+      subKeys[1] = "lane";
+      break;
+    default:
+      break;
   }
+  subKeys[2] = "level";
 
-  privObj = (NvDsPayloadPriv *) ctx->privData;
+  // parkingSpot / aisle /entrance sub object
+  if (subObjName) {
+    json_writer_begin_object (writer, subObjName);
+    json_writer_string (writer, subKeys[0], dsPlaceObj->subObj.field1);
+    json_writer_string (writer, subKeys[1], dsPlaceObj->subObj.field2);
+    json_writer_string (writer, subKeys[2], dsPlaceObj->subObj.field3);
+
+    json_writer_begin_object (writer, "coordinate");
+    json_writer_double (writer, "x", dsPlaceObj->coordinate[0]);
+    json_writer_double (writer, "y", dsPlaceObj->coordinate[1]);
+    json_writer_double (writer, "z", dsPlaceObj->coordinate[2]);
+    json_writer_end_object (writer);
+
+    json_writer_end_object (writer);
+  }
 
-  auto idMap = privObj->sensorObj.find (sensorId);
-  if (idMap != privObj->sensorObj.end()) {
-    cout << "Duplicate entries for " << group << endl;
-    return ret;
+  json_writer_end_object (writer);
+}
+
+static void
+render_sensor_object (NvDsSensorObject *dsSensorObj,
+                      const NvDsProjection *proj, NvDsJsonWriter *writer)
+{
+  json_writer_begin_object (writer, "sensor");
+  if (projection_has (proj, NVDS_FIELD_SENSOR_ID))
+    json_writer_string (writer, "id", dsSensorObj->id);
+  if (projection_has (proj, NVDS_FIELD_SENSOR_TYPE))
+    json_writer_string (writer, "type", dsSensorObj->type);
+  if (projection_has (proj, NVDS_FIELD_SENSOR_DESCRIPTION))
+    json_writer_string (writer, "description", dsSensorObj->desc);
+
+  if (projection_has (proj, NVDS_FIELD_SENSOR_LOCATION)) {
+    json_writer_begin_object (writer, "location");
+    json_writer_double (writer, "lat", dsSensorObj->location[0]);
+    json_writer_double (writer, "lon", dsSensorObj->location[1]);
+    json_writer_double (writer, "alt", dsSensorObj->location[2]);
+    json_writer_end_object (writer);
   }
 
-  isEnabled = g_key_file_get_boolean (key_file, group, CONFIG_KEY_ENABLE,
-                                      &error);
-  if (!isEnabled) {
-    // Not enabled, skip the parsing of keys.
-    ret = true;
-    goto done;
-  } else {
-    g_key_file_remove_key (key_file, group, CONFIG_KEY_ENABLE,
-                           &error);
-    CHECK_ERROR (error);
+  if (projection_has (proj, NVDS_FIELD_SENSOR_COORDINATE)) {
+    json_writer_begin_object (writer, "coordinate");
+    json_writer_double (writer, "x", dsSensorObj->coordinate[0]);
+    json_writer_double (writer, "y", dsSensorObj->coordinate[1]);
+    json_writer_double (writer, "z", dsSensorObj->coordinate[2]);
+    json_writer_end_object (writer);
   }
 
-  keys = g_key_file_get_keys (key_file, group, NULL, &error);
-  CHECK_ERROR (error);
+  json_writer_end_object (writer);
+}
 
-  for (key = keys; *key; key++) {
-    keyVal = NULL;
-    if (!g_strcmp0 (*key, CONFIG_KEY_ID)) {
-      keyVal = g_key_file_get_string (key_file, group,
-                                      CONFIG_KEY_ID, &error);
-      sensorObj.id = keyVal;
-      CHECK_ERROR (error);
-    } else if (!g_strcmp0 (*key, CONFIG_KEY_TYPE)) {
-      keyVal = g_key_file_get_string (key_file, group,
-                                      CONFIG_KEY_TYPE, &error);
-      sensorObj.type = keyVal;
-      CHECK_ERROR (error);
-    } else if (!g_strcmp0 (*key, CONFIG_KEY_DESCRIPTION)) {
-      keyVal = g_key_file_get_string (key_file, group,
-                                      CONFIG_KEY_DESCRIPTION, &error);
-      sensorObj.desc = keyVal;
-      CHECK_ERROR (error);
-    } else if (!g_strcmp0 (*key, CONFIG_KEY_LOCATION)) {
-      gsize length;
-      gdouble *location = g_key_file_get_double_list (key_file, group,
-                                                      CONFIG_KEY_LOCATION,
-                                                      &length, &error);
-      if (length != 3) {
-        cout << "Wrong values provided, it should be like lat;lon;alt" << endl;
-        g_free (location);
-        goto done;
-      }
+/**
+ * Renders analytics object except confidence which comes from event
+ * metadata, object is left open.
+ */
+static void
+render_analytics_module_object (NvDsAnalyticsObject *dsObj,
+                                const NvDsProjection *proj,
+                                NvDsJsonWriter *writer)
+{
+  json_writer_begin_object (writer, "analyticsModule");
+  if (projection_has (proj, NVDS_FIELD_ANALYTICS_ID))
+    json_writer_string (writer, "id", dsObj->id);
+  if (projection_has (proj, NVDS_FIELD_ANALYTICS_DESCRIPTION))
+    json_writer_string (writer, "description", dsObj->desc);
+  if (projection_has (proj, NVDS_FIELD_ANALYTICS_SOURCE))
+    json_writer_string (writer, "source", dsObj->source);
+  if (projection_has (proj, NVDS_FIELD_ANALYTICS_VERSION))
+    json_writer_string (writer, "version", dsObj->version);
+}
 
-      memcpy (sensorObj.location, location, length * sizeof (gdouble));
-      g_free (location);
-      CHECK_ERROR (error);
-    } else if (!g_strcmp0 (*key, CONFIG_KEY_COORDINATE)) {
-      gsize length;
-      gdouble *coordinate = g_key_file_get_double_list (key_file, group,
-                                                      CONFIG_KEY_COORDINATE,
-                                                      &length, &error);
-      if (length != 3) {
-        cout << "Wrong values provided, it should be like x;y;z" << endl;
-        g_free (coordinate);
-        goto done;
-      }
+static void
+begin_fragment (NvDsJsonWriter *writer, GString *buf, gboolean pretty)
+{
+  g_string_truncate (buf, 0);
+  // fragments are members of root object.
+  json_writer_init_fragment (writer, buf, pretty, 1);
+}
 
-      memcpy (sensorObj.coordinate, coordinate, length * sizeof (gdouble));
-      g_free (coordinate);
-      CHECK_ERROR (error);
-    } else {
-      cout << "Unknown key " << *key << " for group [" << group <<"]\n";
+/**
+ * Renders fragments of all entries with members selected by @a proj, so
+ * projection costs nothing while generating.
+ */
+static void
+nvds_msg2p_render_fragments (NvDsConfigTables *tables,
+                             const NvDsProjection *proj, gboolean pretty)
+{
+  GString *buf = g_string_new (NULL);
+  NvDsJsonWriter writer;
+  gint variant;
+
+  for (auto &it : tables->sensorObj.entries) {
+    begin_fragment (&writer, buf, pretty);
+    render_sensor_object (&it, proj, &writer);
+    it.fragment = string_pool_intern (&tables->strings, buf->str,
+                                             buf->len);
+  }
+
+  for (auto &it : tables->placeObj.entries) {
+    for (variant = 0; variant < NVDS_PLACE_VARIANT_MAX; variant++) {
+      begin_fragment (&writer, buf, pretty);
+      render_place_object (&it, (NvDsPlaceVariant) variant, proj, &writer);
+      it.fragment[variant] =
+          string_pool_intern (&tables->strings, buf->str, buf->len);
     }
+  }
 
-    if (keyVal)
-      g_free (keyVal);
+  for (auto &it : tables->analyticsObj.entries) {
+    begin_fragment (&writer, buf, pretty);
+    render_analytics_module_object (&it, proj, &writer);
+    it.fragment = string_pool_intern (&tables->strings, buf->str,
+                                             buf->len);
   }
 
-  privObj->sensorObj.insert (make_pair (sensorId, sensorObj));
+  g_string_free (buf, TRUE);
+}
+
+static void
+write_place_object (NvDsConfigTables *tables, NvDsEventMsgMeta *meta,
+                    NvDsJsonWriter *writer)
+{
+  NvDsPlaceVariant variant = get_place_variant (meta);
 
-  ret = true;
+  NvDsPlaceObject *obj = tables->placeObj.find (meta->placeId);
 
-done:
-  if (error) {
-    g_error_free (error);
-  }
-  if (keys) {
-    g_strfreev (keys);
+  if (!obj) {
+    cout << "No entry for " CONFIG_GROUP_PLACE << meta->placeId
+        << " in configuration file" << endl;
+    json_writer_null (writer, "place");
+    return;
   }
 
-  return ret;
+  if (variant == NVDS_PLACE_VARIANT_NONE)
+    cout << "Event type not implemented " << endl;
+
+  const NvDsStr &fragment = obj->fragment[variant];
+  json_writer_raw_member (writer, fragment.str, fragment.len);
 }
 
-static bool
-nvds_msg2p_parse_place (NvDsMsg2pCtx *ctx, GKeyFile *key_file, gchar *group)
+static void
+write_sensor_object (NvDsConfigTables *tables, NvDsEventMsgMeta *meta,
+                     NvDsJsonWriter *writer)
 {
-  bool ret = false;
-  bool isEnabled = false;
-  gchar **keys = NULL;
-  gchar **key = NULL;
-  GError *error = NULL;
-  NvDsPayloadPriv *privObj = NULL;
-  NvDsPlaceObject placeObj;
-  gint placeId;
-  gchar *keyVal;
+  NvDsSensorObject *obj = tables->sensorObj.find (meta->sensorId);
 
-  if (sscanf (group, CONFIG_GROUP_PLACE "%u", &placeId) < 1) {
-    cout << "Wrong place group name " << group << endl;
-    return ret;
+  if (!obj) {
+    cout << "No entry for " CONFIG_GROUP_SENSOR << meta->sensorId
+         << " in configuration file" << endl;
+    json_writer_null (writer, "sensor");
+    return;
   }
 
-  privObj = (NvDsPayloadPriv *) ctx->privData;
+  const NvDsStr &fragment = obj->fragment;
+  json_writer_raw_member (writer, fragment.str, fragment.len);
+}
 
-  auto idMap = privObj->placeObj.find (placeId);
-  if (idMap != privObj->placeObj.end()) {
-    cout << "Duplicate entries for " << group << endl;
-    return ret;
+static void
+write_analytics_module_object (NvDsConfigTables *tables,
+                               const NvDsProjection *proj,
+                               NvDsEventMsgMeta *meta, NvDsJsonWriter *writer)
+{
+  NvDsAnalyticsObject *obj = tables->analyticsObj.find (meta->moduleId);
+
+  if (!obj) {
+    cout << "No entry for " CONFIG_GROUP_ANALYTICS << meta->moduleId
+        << " in configuration file" << endl;
+    json_writer_null (writer, "analyticsModule");
+    return;
   }
 
-  isEnabled = g_key_file_get_boolean (key_file, group, CONFIG_KEY_ENABLE,
-                                      &error);
-  if (!isEnabled) {
-    // Not enabled, skip the parsing of keys.
-    ret = true;
-    goto done;
-  } else {
-    g_key_file_remove_key (key_file, group, CONFIG_KEY_ENABLE,
-                           &error);
+  const NvDsStr &fragment = obj->fragment;
+  json_writer_raw_begin_object (writer, fragment.str, fragment.len);
+  if (projection_has (proj, NVDS_FIELD_ANALYTICS_CONFIDENCE))
+    json_writer_double (writer, "confidence", meta->confidence);
+  json_writer_end_object (writer);
+}
+
+/** Name of event type, NULL for unknown one. */
+static const gchar *
+get_event_type_name (NvDsEventType type)
+{
+  switch (type) {
+    case NVDS_EVENT_ENTRY:
+      return "entry";
+    case NVDS_EVENT_EXIT:
+      return "exit";
+    case NVDS_EVENT_MOVING:
+      return "moving";
+    case NVDS_EVENT_STOPPED:
+      return "stopped";
+    case NVDS_EVENT_PARKED:
+      return "parked";
+    case NVDS_EVENT_EMPTY:
+      return "empty";
+    case NVDS_EVENT_RESET:
+      return "reset";
+    default:
+      return NULL;
+  }
+}
+
+static void
+write_event_type (NvDsEventMsgMeta *meta, NvDsJsonWriter *writer)
+{
+  const gchar *name = get_event_type_name (meta->type);
+
+  if (name)
+    json_writer_string (writer, "type", name);
+  else
+    cout << "Unknown event type " << endl;
+}
+
+/** Field of the vehicle / person / face member for type of object. */
+static NvDsField
+get_ext_object_field (NvDsEventMsgMeta *meta)
+{
+  switch (meta->objType) {
+    case NVDS_OBJECT_TYPE_VEHICLE:
+      return NVDS_FIELD_OBJECT_VEHICLE;
+    case NVDS_OBJECT_TYPE_PERSON:
+      return NVDS_FIELD_OBJECT_PERSON;
+    case NVDS_OBJECT_TYPE_FACE:
+      return NVDS_FIELD_OBJECT_FACE;
+    default:
+      return NVDS_FIELD_MAX;
+  }
+}
+
+static void
+write_ext_object (NvDsEventMsgMeta *meta, NvDsJsonWriter *writer)
+{
+  switch (meta->objType) {
+    case NVDS_OBJECT_TYPE_VEHICLE:
+      json_writer_begin_object (writer, "vehicle");
+      if (meta->extMsgSize) {
+        NvDsVehicleObject *dsObj = (NvDsVehicleObject *) meta->extMsg;
+        if (dsObj) {
+          json_writer_string (writer, "type", dsObj->type);
+          json_writer_string (writer, "make", dsObj->make);
+          json_writer_string (writer, "model", dsObj->model);
+          json_writer_string (writer, "color", dsObj->color);
+          json_writer_string (writer, "licenseState", dsObj->region);
+          json_writer_string (writer, "license", dsObj->license);
+          json_writer_double (writer, "confidence", meta->confidence);
+        }
+      } else {
+        json_writer_string (writer, "type", "");
+        json_writer_string (writer, "make", "");
+        json_writer_string (writer, "model", "");
+        json_writer_string (writer, "color", "");
+        json_writer_string (writer, "licenseState", "");
+        json_writer_string (writer, "license", "");
+        json_writer_double (writer, "confidence", 1.0);
+      }
+      json_writer_end_object (writer);
+      break;
+    case NVDS_OBJECT_TYPE_PERSON:
+      json_writer_begin_object (writer, "person");
+      if (meta->extMsgSize) {
+        NvDsPersonObject *dsObj = (NvDsPersonObject *) meta->extMsg;
+        if (dsObj) {
+          json_writer_int (writer, "age", dsObj->age);
+          json_writer_string (writer, "gender", dsObj->gender);
+          json_writer_string (writer, "hair", dsObj->hair);
+          json_writer_string (writer, "cap", dsObj->cap);
+          json_writer_string (writer, "apparel", dsObj->apparel);
+          json_writer_double (writer, "confidence", meta->confidence);
+        }
+      } else {
+        json_writer_int (writer, "age", 0);
+        json_writer_string (writer, "gender", "");
+        json_writer_string (writer, "hair", "");
+        json_writer_string (writer, "cap", "");
+        json_writer_string (writer, "apparel", "");
+        json_writer_double (writer, "confidence", 1.0);
+      }
+      json_writer_end_object (writer);
+      break;
+    case NVDS_OBJECT_TYPE_FACE:
+      json_writer_begin_object (writer, "face");
+      if (meta->extMsgSize) {
+        NvDsFaceObject *dsObj = (NvDsFaceObject *) meta->extMsg;
+        if (dsObj) {
+          json_writer_int (writer, "age", dsObj->age);
+          json_writer_string (writer, "gender", dsObj->gender);
+          json_writer_string (writer, "hair", dsObj->hair);
+          json_writer_string (writer, "cap", dsObj->cap);
+          json_writer_string (writer, "glasses", dsObj->glasses);
+          json_writer_string (writer, "facialhair", dsObj->facialhair);
+          json_writer_string (writer, "name", dsObj->name);
+          json_writer_string (writer, "eyecolor", dsObj->eyecolor);
+          json_writer_double (writer, "confidence", meta->confidence);
+        }
+      } else {
+        json_writer_int (writer, "age", 0);
+        json_writer_string (writer, "gender", "");
+        json_writer_string (writer, "hair", "");
+        json_writer_string (writer, "cap", "");
+        json_writer_string (writer, "glasses", "");
+        json_writer_string (writer, "facialhair", "");
+        json_writer_string (writer, "name", "");
+        json_writer_string (writer, "eyecolor", "");
+        json_writer_double (writer, "confidence", 1.0);
+      }
+      json_writer_end_object (writer);
+      break;
+    default:
+      break;
+  }
+}
+
+static void
+write_signature (NvDsPayloadPriv *privObj, NvDsEventMsgMeta *meta,
+                 NvDsJsonWriter *writer)
+{
+  if (!meta->objSignature.size)
+    return;
+
+  if (privObj->signatureFormat == NVDS_SIGNATURE_FORMAT_BASE64) {
+    gchar *str = json_writer_string_reserve (writer, "signature",
+        NVDS_BASE64_LEN (meta->objSignature.size * 4));
+    encode_signature_base64 (&meta->objSignature, str);
+  } else {
+    NvDsNumberFormat format = NVDS_NUMBER_FORMAT_DTOSTR;
+
+    if (privObj->signatureFormat == NVDS_SIGNATURE_FORMAT_SHORTEST)
+      format = NVDS_NUMBER_FORMAT_SHORTEST;
+    else if (privObj->signatureFormat == NVDS_SIGNATURE_FORMAT_FLOAT)
+      format = NVDS_NUMBER_FORMAT_FLOAT;
+    json_writer_number_array (writer, "signature",
+        meta->objSignature.signature, meta->objSignature.size, format);
+  }
+}
+
+static void
+write_tracking_id (NvDsEventMsgMeta *meta, NvDsJsonWriter *writer)
+{
+  gchar tracking_id[64];
+
+  if (snprintf (tracking_id, sizeof(tracking_id), "%d",
+                meta->trackingId) >= (gint) sizeof(tracking_id))
+    g_warning("Not enough space to copy trackingId");
+  json_writer_string (writer, "id", tracking_id);
+}
+
+static void
+write_delta_member (const NvDsDeltaFrame *frame, NvDsJsonWriter *writer)
+{
+  json_writer_begin_object (writer, "delta");
+  json_writer_int (writer, "seq", frame->seq);
+  json_writer_string (writer, "frame", frame->keyframe ? "key" : "delta");
+  json_writer_end_object (writer);
+}
+
+static const gchar *get_object_type_name (NvDsObjectType type);
+
+/**
+ * Writes delta of moving event against previous message of its track,
+ * see delta_encoding.h.
+ */
+static void
+write_delta_message (NvDsMsg2pCtx *ctx, NvDsConfigTables *tables,
+                     NvDsEventMsgMeta *meta, const NvDsDeltaFrame *frame,
+                     NvDsJsonWriter *writer)
+{
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
+  const NvDsProjection *proj = &privObj->projection;
+  NvDsSensorObject *sensor = tables->sensorObj.find (meta->sensorId);
+  const NvDsRect *prev = &frame->bbox;
+  const NvDsRect *bbox = &meta->bbox;
+  NvDsField extField = get_ext_object_field (meta);
+  gboolean confidenceChanged = meta->confidence != frame->confidence;
+  guint8 id[NVDS_ID_SIZE];
+  gint diff[4];
+  guint i;
+
+  json_writer_begin_object (writer, NULL);
+
+  if (projection_has (proj, NVDS_FIELD_MESSAGE_ID)) {
+    generate_id (ctx, meta, id);
+    id_format (id, json_writer_string_reserve (writer, "messageid",
+                                               NVDS_ID_STR_LEN));
+  }
+  if (projection_has (proj, NVDS_FIELD_TIMESTAMP))
+    write_timestamp (privObj, meta, writer);
+
+  // same as keyframe for missing sensor entry.
+  if (sensor) {
+    json_writer_begin_object (writer, "sensor");
+    json_writer_string (writer, "id", sensor->id);
+    json_writer_end_object (writer);
+  } else {
+    json_writer_null (writer, "sensor");
+  }
+
+  if (confidenceChanged &&
+      projection_has (proj, NVDS_FIELD_ANALYTICS_CONFIDENCE) &&
+      tables->analyticsObj.find (meta->moduleId)) {
+    json_writer_begin_object (writer, "analyticsModule");
+    json_writer_double (writer, "confidence", meta->confidence);
+    json_writer_end_object (writer);
+  }
+
+  json_writer_begin_object (writer, "object");
+  write_tracking_id (meta, writer);
+
+  // other attributes of the object force a keyframe.
+  if (confidenceChanged && extField != NVDS_FIELD_MAX &&
+      projection_has (proj, extField) && meta->extMsgSize && meta->extMsg) {
+    json_writer_begin_object (writer, get_object_type_name (meta->objType));
+    json_writer_double (writer, "confidence", meta->confidence);
+    json_writer_end_object (writer);
+  }
+
+  diff[0] = bbox->left - prev->left;
+  diff[1] = bbox->top - prev->top;
+  diff[2] = bbox->left + bbox->width - prev->left - prev->width;
+  diff[3] = bbox->top + bbox->height - prev->top - prev->height;
+  if (projection_has (proj, NVDS_FIELD_OBJECT_BBOX) &&
+      (diff[0] || diff[1] || diff[2] || diff[3])) {
+    json_writer_begin_array (writer, "bbox");
+    for (i = 0; i < 4; i++)
+      json_writer_int (writer, NULL, diff[i]);
+    json_writer_end_array (writer);
+  }
+
+  if (projection_has (proj, NVDS_FIELD_OBJECT_LOCATION) &&
+      (meta->location.lat != frame->location.lat ||
+       meta->location.lon != frame->location.lon ||
+       meta->location.alt != frame->location.alt)) {
+    json_writer_begin_object (writer, "location");
+    json_writer_double (writer, "lat", meta->location.lat);
+    json_writer_double (writer, "lon", meta->location.lon);
+    json_writer_double (writer, "alt", meta->location.alt);
+    json_writer_end_object (writer);
+  }
+
+  if (projection_has (proj, NVDS_FIELD_OBJECT_COORDINATE) &&
+      (meta->coordinate.x != frame->coordinate.x ||
+       meta->coordinate.y != frame->coordinate.y ||
+       meta->coordinate.z != frame->coordinate.z)) {
+    json_writer_begin_object (writer, "coordinate");
+    json_writer_double (writer, "x", meta->coordinate.x);
+    json_writer_double (writer, "y", meta->coordinate.y);
+    json_writer_double (writer, "z", meta->coordinate.z);
+    json_writer_end_object (writer);
+  }
+
+  if (projection_has (proj, NVDS_FIELD_OBJECT_SIGNATURE) &&
+      frame->signatureChanged)
+    write_signature (privObj, meta, writer);
+  if (projection_has (proj, NVDS_FIELD_OBJECT_CLASS_ID) &&
+      meta->objClassId != frame->classId)
+    json_writer_int (writer, "classId", meta->objClassId);
+  if (projection_has (proj, NVDS_FIELD_OBJECT_CONFIDENCE) && confidenceChanged)
+    json_writer_double (writer, "confidence", meta->confidence);
+  json_writer_end_object (writer);
+
+  if (projection_has (proj, NVDS_FIELD_EVENT)) {
+    json_writer_begin_object (writer, "event");
+    if (projection_has (proj, NVDS_FIELD_EVENT_ID)) {
+      generate_id (ctx, meta, id);
+      id_format (id, json_writer_string_reserve (writer, "id",
+                                                 NVDS_ID_STR_LEN));
+    }
+    if (projection_has (proj, NVDS_FIELD_EVENT_TYPE))
+      write_event_type (meta, writer);
+    json_writer_end_object (writer);
+  }
+
+  write_delta_member (frame, writer);
+  json_writer_end_object (writer);
+}
+
+/**
+ * Appends the same message as generate_schema_message() to @a buf without
+ * building json-glib tree. Only members in emit plan of projection of
+ * context are written, in plan order.
+ */
+static void
+write_schema_message (NvDsMsg2pCtx *ctx, NvDsConfigTables *tables,
+                      NvDsEventMsgMeta *meta, GString *buf)
+{
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
+  const NvDsProjection *proj = &privObj->projection;
+  NvDsJsonWriter writer;
+  NvDsDeltaFrame frame;
+  // untracked objects would all share one track
+  gboolean delta = privObj->deltaEncoder && meta->type == NVDS_EVENT_MOVING &&
+      meta->trackingId > 0;
+  guint8 id[NVDS_ID_SIZE];
+
+  json_writer_init (&writer, buf, privObj->prettyPrint);
+
+  if (delta) {
+    delta_encoder_next (privObj->deltaEncoder, meta, &frame);
+    if (!frame.keyframe) {
+      write_delta_message (ctx, tables, meta, &frame, &writer);
+      return;
+    }
+  }
+
+  json_writer_begin_object (&writer, NULL);
+
+  for (guint8 field : proj->plan) {
+    switch (field) {
+      case NVDS_FIELD_MESSAGE_ID:
+        generate_id (ctx, meta, id);
+        id_format (id, json_writer_string_reserve (&writer, "messageid",
+                                                   NVDS_ID_STR_LEN));
+        break;
+      case NVDS_FIELD_MDS_VERSION:
+        json_writer_string (&writer, "mdsversion", "1.0");
+        break;
+      case NVDS_FIELD_TIMESTAMP:
+        write_timestamp (privObj, meta, &writer);
+        break;
+      case NVDS_FIELD_PLACE:
+        write_place_object (tables, meta, &writer);
+        break;
+      case NVDS_FIELD_SENSOR:
+        write_sensor_object (tables, meta, &writer);
+        break;
+      case NVDS_FIELD_ANALYTICS:
+        write_analytics_module_object (tables, proj, meta, &writer);
+        break;
+      case NVDS_FIELD_OBJECT:
+        json_writer_begin_object (&writer, "object");
+        if (get_ext_object_field (meta) == NVDS_FIELD_MAX &&
+            (projection_has (proj, NVDS_FIELD_OBJECT_VEHICLE) ||
+             projection_has (proj, NVDS_FIELD_OBJECT_PERSON) ||
+             projection_has (proj, NVDS_FIELD_OBJECT_FACE)))
+          cout << "Object type not implemented" << endl;
+        break;
+      case NVDS_FIELD_OBJECT_ID:
+        write_tracking_id (meta, &writer);
+        break;
+      case NVDS_FIELD_OBJECT_SPEED:
+        json_writer_double (&writer, "speed", 0);
+        break;
+      case NVDS_FIELD_OBJECT_DIRECTION:
+        json_writer_double (&writer, "direction", 0);
+        break;
+      case NVDS_FIELD_OBJECT_ORIENTATION:
+        json_writer_double (&writer, "orientation", 0);
+        break;
+      case NVDS_FIELD_OBJECT_VEHICLE:
+      case NVDS_FIELD_OBJECT_PERSON:
+      case NVDS_FIELD_OBJECT_FACE:
+        if (get_ext_object_field (meta) == field)
+          write_ext_object (meta, &writer);
+        break;
+      case NVDS_FIELD_OBJECT_BBOX:
+        json_writer_begin_object (&writer, "bbox");
+        json_writer_int (&writer, "topleftx", meta->bbox.left);
+        json_writer_int (&writer, "toplefty", meta->bbox.top);
+        json_writer_int (&writer, "bottomrightx",
+                         meta->bbox.left + meta->bbox.width);
+        json_writer_int (&writer, "bottomrighty",
+                         meta->bbox.top + meta->bbox.height);
+        json_writer_end_object (&writer);
+        break;
+      case NVDS_FIELD_OBJECT_SIGNATURE:
+        write_signature (privObj, meta, &writer);
+        break;
+      case NVDS_FIELD_OBJECT_LOCATION:
+        json_writer_begin_object (&writer, "location");
+        json_writer_double (&writer, "lat", meta->location.lat);
+        json_writer_double (&writer, "lon", meta->location.lon);
+        json_writer_double (&writer, "alt", meta->location.alt);
+        json_writer_end_object (&writer);
+        break;
+      case NVDS_FIELD_OBJECT_COORDINATE:
+        json_writer_begin_object (&writer, "coordinate");
+        json_writer_double (&writer, "x", meta->coordinate.x);
+        json_writer_double (&writer, "y", meta->coordinate.y);
+        json_writer_double (&writer, "z", meta->coordinate.z);
+        json_writer_end_object (&writer);
+        break;
+      case NVDS_FIELD_OBJECT_CLASS_ID:
+        json_writer_int (&writer, "classId", meta->objClassId);
+        break;
+      case NVDS_FIELD_OBJECT_CONFIDENCE:
+        json_writer_double (&writer, "confidence", meta->confidence);
+        break;
+      case NVDS_FIELD_EVENT:
+        json_writer_begin_object (&writer, "event");
+        break;
+      case NVDS_FIELD_EVENT_ID:
+        generate_id (ctx, meta, id);
+        // id is formatted directly into output buffer.
+        id_format (id, json_writer_string_reserve (&writer, "id",
+                                                   NVDS_ID_STR_LEN));
+        break;
+      case NVDS_FIELD_EVENT_TYPE:
+        write_event_type (meta, &writer);
+        break;
+      case NVDS_FIELD_END:
+        json_writer_end_object (&writer);
+        break;
+      case NVDS_FIELD_VIDEO_PATH:
+        if (meta->videoPath)
+          json_writer_string (&writer, "videoPath", meta->videoPath);
+        else
+          json_writer_string (&writer, "videoPath", "");
+        break;
+      default:
+        break;
+    }
+  }
+
+  if (delta)
+    write_delta_member (&frame, &writer);
+  json_writer_end_object (&writer);
+}
+
+static const gchar *
+get_object_type_name (NvDsObjectType type)
+{
+  switch (type) {
+    case NVDS_OBJECT_TYPE_VEHICLE:
+      return "vehicle";
+    case NVDS_OBJECT_TYPE_PERSON:
+      return "person";
+    case NVDS_OBJECT_TYPE_FACE:
+      return "face";
+    case NVDS_OBJECT_TYPE_CUSTOM:
+      return "custom";
+    default:
+      return "";
+  }
+}
+
+static inline void
+append_int (GString *buf, gint64 value)
+{
+  gchar str[24];
+
+  g_string_append_len (buf, str, g_snprintf (str, sizeof (str),
+                                             "%" G_GINT64_FORMAT, value));
+}
+
+static inline void
+append_double (GString *buf, gdouble value)
+{
+  gchar str[NVDS_NUMBER_BUF_SIZE];
+
+  g_string_append_len (buf, str, format_double (value, str));
+}
+
+/**
+ * Appends message of custom payload template to @a buf. Missing sensor,
+ * place or module entries give empty strings and zeros.
+ */
+static void
+write_template_message (NvDsMsg2pCtx *ctx, NvDsConfigTables *tables,
+                        NvDsEventMsgMeta *meta, GString *buf)
+{
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
+  const NvDsPayloadTemplate *tpl = &privObj->payloadTemplate;
+  static const NvDsSensorObject noSensor = {};
+  static const NvDsPlaceObject noPlace = {};
+  static const NvDsAnalyticsObject noModule = {};
+  const NvDsSensorObject *sensor = &noSensor;
+  const NvDsPlaceObject *place = &noPlace;
+  const NvDsAnalyticsObject *module = &noModule;
+  const gchar *text = tpl->text.data ();
+  gchar idStr[NVDS_ID_STR_LEN + 1];
+  gchar ts[NVDS_TIMESTAMP_LEN + 1];
+  const gchar *tsStr;
+
+  if ((tpl->needs & NVDS_TPL_NEEDS_SENSOR) &&
+      !(sensor = tables->sensorObj.find (meta->sensorId))) {
+    cout << "No entry for " CONFIG_GROUP_SENSOR << meta->sensorId
+         << " in configuration file" << endl;
+    sensor = &noSensor;
+  }
+  if ((tpl->needs & NVDS_TPL_NEEDS_PLACE) &&
+      !(place = tables->placeObj.find (meta->placeId))) {
+    cout << "No entry for " CONFIG_GROUP_PLACE << meta->placeId
+         << " in configuration file" << endl;
+    place = &noPlace;
+  }
+  if ((tpl->needs & NVDS_TPL_NEEDS_ANALYTICS) &&
+      !(module = tables->analyticsObj.find (meta->moduleId))) {
+    cout << "No entry for " CONFIG_GROUP_ANALYTICS << meta->moduleId
+         << " in configuration file" << endl;
+    module = &noModule;
+  }
+
+  for (const NvDsTemplateOp &op : tpl->ops) {
+    switch (op.field) {
+      case NVDS_TPL_LITERAL:
+        g_string_append_len (buf, text + op.start, op.len);
+        break;
+      case NVDS_TPL_MESSAGE_ID:
+      case NVDS_TPL_EVENT_ID:
+        generate_id_string (ctx, meta, idStr);
+        g_string_append_len (buf, idStr, NVDS_ID_STR_LEN);
+        break;
+      case NVDS_TPL_TIMESTAMP:
+        if (privObj->timestampFormat == NVDS_TIMESTAMP_FORMAT_EPOCH_MS)
+          append_int (buf, get_epoch_ms (privObj, meta));
+        else if ((tsStr = get_timestamp (privObj, meta, ts)))
+          json_append_escaped (buf, tsStr);
+        break;
+      case NVDS_TPL_EVENT_TYPE:
+        if (get_event_type_name (meta->type))
+          g_string_append (buf, get_event_type_name (meta->type));
+        break;
+      case NVDS_TPL_SENSOR_ID:
+        append_int (buf, meta->sensorId);
+        break;
+      case NVDS_TPL_PLACE_ID:
+        append_int (buf, meta->placeId);
+        break;
+      case NVDS_TPL_MODULE_ID:
+        append_int (buf, meta->moduleId);
+        break;
+      case NVDS_TPL_COMPONENT_ID:
+        append_int (buf, meta->componentId);
+        break;
+      case NVDS_TPL_OBJECT_ID:
+        append_int (buf, meta->trackingId);
+        break;
+      case NVDS_TPL_OBJECT_OBJECT_ID:
+        if (meta->objectId)
+          json_append_escaped (buf, meta->objectId);
+        break;
+      case NVDS_TPL_OBJECT_TYPE:
+        g_string_append (buf, get_object_type_name (meta->objType));
+        break;
+      case NVDS_TPL_OBJECT_CLASS_ID:
+        append_int (buf, meta->objClassId);
+        break;
+      case NVDS_TPL_OBJECT_CONFIDENCE:
+        append_double (buf, meta->confidence);
+        break;
+      case NVDS_TPL_OBJECT_BBOX_LEFT:
+        append_int (buf, meta->bbox.left);
+        break;
+      case NVDS_TPL_OBJECT_BBOX_TOP:
+        append_int (buf, meta->bbox.top);
+        break;
+      case NVDS_TPL_OBJECT_BBOX_RIGHT:
+        append_int (buf, meta->bbox.left + meta->bbox.width);
+        break;
+      case NVDS_TPL_OBJECT_BBOX_BOTTOM:
+        append_int (buf, meta->bbox.top + meta->bbox.height);
+        break;
+      case NVDS_TPL_OBJECT_BBOX_WIDTH:
+        append_int (buf, meta->bbox.width);
+        break;
+      case NVDS_TPL_OBJECT_BBOX_HEIGHT:
+        append_int (buf, meta->bbox.height);
+        break;
+      case NVDS_TPL_OBJECT_LAT:
+        append_double (buf, meta->location.lat);
+        break;
+      case NVDS_TPL_OBJECT_LON:
+        append_double (buf, meta->location.lon);
+        break;
+      case NVDS_TPL_OBJECT_ALT:
+        append_double (buf, meta->location.alt);
+        break;
+      case NVDS_TPL_OBJECT_X:
+        append_double (buf, meta->coordinate.x);
+        break;
+      case NVDS_TPL_OBJECT_Y:
+        append_double (buf, meta->coordinate.y);
+        break;
+      case NVDS_TPL_OBJECT_Z:
+        append_double (buf, meta->coordinate.z);
+        break;
+      case NVDS_TPL_OTHER_ATTRS:
+        if (meta->otherAttrs)
+          json_append_escaped (buf, meta->otherAttrs);
+        break;
+      case NVDS_TPL_VIDEO_PATH:
+        if (meta->videoPath)
+          json_append_escaped (buf, meta->videoPath);
+        break;
+      case NVDS_TPL_SENSOR_STR_ID:
+        json_append_escaped (buf, sensor->id);
+        break;
+      case NVDS_TPL_SENSOR_TYPE:
+        json_append_escaped (buf, sensor->type);
+        break;
+      case NVDS_TPL_SENSOR_DESCRIPTION:
+        json_append_escaped (buf, sensor->desc);
+        break;
+      case NVDS_TPL_SENSOR_LAT:
+      case NVDS_TPL_SENSOR_LON:
+      case NVDS_TPL_SENSOR_ALT:
+        append_double (buf, sensor->location[op.field - NVDS_TPL_SENSOR_LAT]);
+        break;
+      case NVDS_TPL_SENSOR_X:
+      case NVDS_TPL_SENSOR_Y:
+      case NVDS_TPL_SENSOR_Z:
+        append_double (buf, sensor->coordinate[op.field - NVDS_TPL_SENSOR_X]);
+        break;
+      case NVDS_TPL_PLACE_STR_ID:
+        json_append_escaped (buf, place->id);
+        break;
+      case NVDS_TPL_PLACE_NAME:
+        json_append_escaped (buf, place->name);
+        break;
+      case NVDS_TPL_PLACE_TYPE:
+        json_append_escaped (buf, place->type);
+        break;
+      case NVDS_TPL_PLACE_LAT:
+      case NVDS_TPL_PLACE_LON:
+      case NVDS_TPL_PLACE_ALT:
+        append_double (buf, place->location[op.field - NVDS_TPL_PLACE_LAT]);
+        break;
+      case NVDS_TPL_PLACE_X:
+      case NVDS_TPL_PLACE_Y:
+      case NVDS_TPL_PLACE_Z:
+        append_double (buf, place->coordinate[op.field - NVDS_TPL_PLACE_X]);
+        break;
+      case NVDS_TPL_PLACE_SUB_FIELD1:
+        json_append_escaped (buf, place->subObj.field1);
+        break;
+      case NVDS_TPL_PLACE_SUB_FIELD2:
+        json_append_escaped (buf, place->subObj.field2);
+        break;
+      case NVDS_TPL_PLACE_SUB_FIELD3:
+        json_append_escaped (buf, place->subObj.field3);
+        break;
+      case NVDS_TPL_ANALYTICS_ID:
+        json_append_escaped (buf, module->id);
+        break;
+      case NVDS_TPL_ANALYTICS_DESCRIPTION:
+        json_append_escaped (buf, module->desc);
+        break;
+      case NVDS_TPL_ANALYTICS_SOURCE:
+        json_append_escaped (buf, module->source);
+        break;
+      case NVDS_TPL_ANALYTICS_VERSION:
+        json_append_escaped (buf, module->version);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+/**
+ * Appends message for one event to @a buf as per payload type of context.
+ */
+static void
+append_message (NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta, GString *buf)
+{
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
+  NvDsConfigTables *tables = NULL;
+  gchar *message = NULL;
+  guint slot;
+
+  if (ctx->payloadType == NVDS_PAYLOAD_DEEPSTREAM) {
+    // same tables for the whole message even if reload happens meanwhile.
+    slot = config_tables_read_lock (privObj);
+    tables = privObj->tables.load ();
+
+    if (privObj->directWriter) {
+      write_schema_message (ctx, tables, meta, buf);
+    } else {
+      message = generate_schema_message (ctx, tables, meta);
+      if (message) {
+        g_string_append (buf, message);
+        g_free (message);
+      }
+    }
+
+    config_tables_read_unlock (privObj, slot);
+  } else if (ctx->payloadType == NVDS_PAYLOAD_DEEPSTREAM_BINARY) {
+    guint8 msgId[NVDS_ID_SIZE];
+    guint8 eventId[NVDS_ID_SIZE];
+    gchar ts[NVDS_TIMESTAMP_LEN + 1];
+
+    generate_id (ctx, meta, msgId);
+    generate_id (ctx, meta, eventId);
+    // ts is formatted from tsEpochNs so decoders only deal with ts
+    nvds_binary_write_message (buf, meta, get_timestamp (privObj, meta, ts),
+                               msgId, eventId);
+  } else if (ctx->payloadType == NVDS_PAYLOAD_CUSTOM) {
+    slot = config_tables_read_lock (privObj);
+    tables = privObj->tables.load ();
+    write_template_message (ctx, tables, meta, buf);
+    config_tables_read_unlock (privObj, slot);
+  }
+}
+
+static bool
+nvds_msg2p_parse_sensor (NvDsConfigTables *tables, GKeyFile *key_file,
+                         gchar *group)
+{
+  bool ret = false;
+  bool isEnabled = false;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+  NvDsSensorObject sensorObj;
+  gint sensorId;
+  gchar *keyVal;
+
+
+  if (sscanf (group, CONFIG_GROUP_SENSOR "%u", &sensorId) < 1) {
+    cout << "Wrong sensor group name " << group << endl;
+    return ret;
+  }
+
+  if (tables->sensorObj.find (sensorId)) {
+    cout << "Duplicate entries for " << group << endl;
+    return ret;
+  }
+
+  isEnabled = g_key_file_get_boolean (key_file, group, CONFIG_KEY_ENABLE,
+                                      &error);
+  if (!isEnabled) {
+    // Not enabled, skip the parsing of keys.
+    ret = true;
+    goto done;
+  } else {
+    g_key_file_remove_key (key_file, group, CONFIG_KEY_ENABLE,
+                           &error);
+    CHECK_ERROR (error);
+  }
+
+  keys = g_key_file_get_keys (key_file, group, NULL, &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    keyVal = NULL;
+    if (!g_strcmp0 (*key, CONFIG_KEY_ID)) {
+      keyVal = g_key_file_get_string (key_file, group,
+                                      CONFIG_KEY_ID, &error);
+      sensorObj.id = intern_string (tables, keyVal);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_TYPE)) {
+      keyVal = g_key_file_get_string (key_file, group,
+                                      CONFIG_KEY_TYPE, &error);
+      sensorObj.type = intern_string (tables, keyVal);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_DESCRIPTION)) {
+      keyVal = g_key_file_get_string (key_file, group,
+                                      CONFIG_KEY_DESCRIPTION, &error);
+      sensorObj.desc = intern_string (tables, keyVal);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_LOCATION)) {
+      gsize length;
+      gdouble *location = g_key_file_get_double_list (key_file, group,
+                                                      CONFIG_KEY_LOCATION,
+                                                      &length, &error);
+      if (length != 3) {
+        cout << "Wrong values provided, it should be like lat;lon;alt" << endl;
+        g_free (location);
+        goto done;
+      }
+
+      memcpy (sensorObj.location, location, length * sizeof (gdouble));
+      g_free (location);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_COORDINATE)) {
+      gsize length;
+      gdouble *coordinate = g_key_file_get_double_list (key_file, group,
+                                                      CONFIG_KEY_COORDINATE,
+                                                      &length, &error);
+      if (length != 3) {
+        cout << "Wrong values provided, it should be like x;y;z" << endl;
+        g_free (coordinate);
+        goto done;
+      }
+
+      memcpy (sensorObj.coordinate, coordinate, length * sizeof (gdouble));
+      g_free (coordinate);
+      CHECK_ERROR (error);
+    } else {
+      cout << "Unknown key " << *key << " for group [" << group <<"]\n";
+    }
+
+    if (keyVal)
+      g_free (keyVal);
+  }
+
+  tables->sensorObj.insert (sensorId, sensorObj);
+
+  ret = true;
+
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+
+  return ret;
+}
+
+static bool
+nvds_msg2p_parse_place (NvDsConfigTables *tables, GKeyFile *key_file,
+                        gchar *group)
+{
+  bool ret = false;
+  bool isEnabled = false;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+  NvDsPlaceObject placeObj;
+  gint placeId;
+  gchar *keyVal;
+
+  if (sscanf (group, CONFIG_GROUP_PLACE "%u", &placeId) < 1) {
+    cout << "Wrong place group name " << group << endl;
+    return ret;
+  }
+
+  if (tables->placeObj.find (placeId)) {
+    cout << "Duplicate entries for " << group << endl;
+    return ret;
+  }
+
+  isEnabled = g_key_file_get_boolean (key_file, group, CONFIG_KEY_ENABLE,
+                                      &error);
+  if (!isEnabled) {
+    // Not enabled, skip the parsing of keys.
+    ret = true;
+    goto done;
+  } else {
+    g_key_file_remove_key (key_file, group, CONFIG_KEY_ENABLE,
+                           &error);
     CHECK_ERROR (error);
   }
 
@@ -722,19 +1992,19 @@ nvds_msg2p_parse_place (NvDsMsg2pCtx *ctx, GKeyFile *key_file, gchar *group)
     if (!g_strcmp0 (*key, CONFIG_KEY_ID)) {
       keyVal = g_key_file_get_string (key_file, group,
                                       CONFIG_KEY_ID, &error);
-      placeObj.id = keyVal;
+      placeObj.id = intern_string (tables, keyVal);
       g_free (keyVal);
       CHECK_ERROR (error);
     } else if (!g_strcmp0 (*key, CONFIG_KEY_TYPE)) {
       keyVal = g_key_file_get_string (key_file, group,
                                       CONFIG_KEY_TYPE, &error);
-      placeObj.type = keyVal;
+      placeObj.type = intern_string (tables, keyVal);
       g_free (keyVal);
       CHECK_ERROR (error);
     } else if (!g_strcmp0 (*key, CONFIG_KEY_NAME)) {
       keyVal = g_key_file_get_string (key_file, group,
                                       CONFIG_KEY_NAME, &error);
-      placeObj.name = keyVal;
+      placeObj.name = intern_string (tables, keyVal);
       g_free (keyVal);
       CHECK_ERROR (error);
     } else if (!g_strcmp0 (*key, CONFIG_KEY_LOCATION)) {
@@ -768,19 +2038,19 @@ nvds_msg2p_parse_place (NvDsMsg2pCtx *ctx, GKeyFile *key_file, gchar *group)
     } else if (!g_strcmp0 (*key, CONFIG_KEY_PLACE_SUB_FIELD1)) {
       keyVal = g_key_file_get_string (key_file, group,
                                         CONFIG_KEY_PLACE_SUB_FIELD1, &error);
-      placeObj.subObj.field1 = keyVal;
+      placeObj.subObj.field1 = intern_string (tables, keyVal);
       g_free (keyVal);
       CHECK_ERROR (error);
     } else if (!g_strcmp0 (*key, CONFIG_KEY_PLACE_SUB_FIELD2)) {
       keyVal = g_key_file_get_string (key_file, group,
                                         CONFIG_KEY_PLACE_SUB_FIELD2, &error);
-      placeObj.subObj.field2 = keyVal;
+      placeObj.subObj.field2 = intern_string (tables, keyVal);
       g_free (keyVal);
       CHECK_ERROR (error);
     } else if (!g_strcmp0 (*key, CONFIG_KEY_PLACE_SUB_FIELD3)) {
       keyVal = g_key_file_get_string (key_file, group,
                                         CONFIG_KEY_PLACE_SUB_FIELD3, &error);
-      placeObj.subObj.field3 = keyVal;
+      placeObj.subObj.field3 = intern_string (tables, keyVal);
       g_free (keyVal);
       CHECK_ERROR (error);
     } else {
@@ -788,7 +2058,7 @@ nvds_msg2p_parse_place (NvDsMsg2pCtx *ctx, GKeyFile *key_file, gchar *group)
     }
   }
 
-  privObj->placeObj.insert (pair<int, NvDsPlaceObject> (placeId, placeObj));
+  tables->placeObj.insert (placeId, placeObj);
 
   ret = true;
 
@@ -804,14 +2074,14 @@ done:
 }
 
 static bool
-nvds_msg2p_parse_analytics (NvDsMsg2pCtx *ctx, GKeyFile *key_file, gchar *group)
+nvds_msg2p_parse_analytics (NvDsConfigTables *tables, GKeyFile *key_file,
+                            gchar *group)
 {
   bool ret = false;
   bool isEnabled = false;
   gchar **keys = NULL;
   gchar **key = NULL;
   GError *error = NULL;
-  NvDsPayloadPriv *privObj = NULL;
   NvDsAnalyticsObject analyticsObj;
   gint moduleId;
   gchar *keyVal;
@@ -821,10 +2091,7 @@ nvds_msg2p_parse_analytics (NvDsMsg2pCtx *ctx, GKeyFile *key_file, gchar *group)
     return ret;
   }
 
-  privObj = (NvDsPayloadPriv *) ctx->privData;
-
-  auto idMap = privObj->analyticsObj.find (moduleId);
-  if (idMap != privObj->analyticsObj.end()) {
+  if (tables->analyticsObj.find (moduleId)) {
     cout << "Duplicate entries for " << group << endl;
     return ret;
   }
@@ -849,22 +2116,22 @@ nvds_msg2p_parse_analytics (NvDsMsg2pCtx *ctx, GKeyFile *key_file, gchar *group)
     if (!g_strcmp0 (*key, CONFIG_KEY_ID)) {
       keyVal = g_key_file_get_string (key_file, group,
                                       CONFIG_KEY_ID, &error);
-      analyticsObj.id = keyVal;
+      analyticsObj.id = intern_string (tables, keyVal);
       CHECK_ERROR (error);
     } else if (!g_strcmp0 (*key, CONFIG_KEY_SOURCE)) {
       keyVal = g_key_file_get_string (key_file, group,
                                       CONFIG_KEY_SOURCE, &error);
-      analyticsObj.source = keyVal;
+      analyticsObj.source = intern_string (tables, keyVal);
       CHECK_ERROR (error);
     } else if (!g_strcmp0 (*key, CONFIG_KEY_DESCRIPTION)) {
       keyVal = g_key_file_get_string (key_file, group,
                                       CONFIG_KEY_DESCRIPTION, &error);
-      analyticsObj.desc = keyVal;
+      analyticsObj.desc = intern_string (tables, keyVal);
       CHECK_ERROR (error);
     } else if (!g_strcmp0 (*key, CONFIG_KEY_VERSION)) {
       keyVal = g_key_file_get_string (key_file, group,
                                       CONFIG_KEY_VERSION, &error);
-      analyticsObj.version = keyVal;
+      analyticsObj.version = intern_string (tables, keyVal);
       CHECK_ERROR (error);
     } else {
       cout << "Unknown key " << *key << " for group [" << group <<"]\n";
@@ -874,7 +2141,7 @@ nvds_msg2p_parse_analytics (NvDsMsg2pCtx *ctx, GKeyFile *key_file, gchar *group)
       g_free (keyVal);
   }
 
-  privObj->analyticsObj.insert (make_pair (moduleId, analyticsObj));
+  tables->analyticsObj.insert (moduleId, analyticsObj);
 
   ret = true;
 
@@ -890,93 +2157,283 @@ done:
 }
 
 static bool
-nvds_msg2p_parse_csv (NvDsMsg2pCtx *ctx, const gchar *file)
+nvds_msg2p_parse_schema (NvDsMsg2pCtx *ctx, GKeyFile *key_file, gchar *group)
 {
+  bool ret = false;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
   NvDsPayloadPriv *privObj = NULL;
-  NvDsAnalyticsObject analyticsObj;
+
+  privObj = (NvDsPayloadPriv *) ctx->privData;
+
+  keys = g_key_file_get_keys (key_file, group, NULL, &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_KEY_PRETTY_PRINT)) {
+      privObj->prettyPrint = g_key_file_get_boolean (key_file, group,
+                                                     CONFIG_KEY_PRETTY_PRINT,
+                                                     &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_DIRECT_WRITER)) {
+      privObj->directWriter = g_key_file_get_boolean (key_file, group,
+                                                      CONFIG_KEY_DIRECT_WRITER,
+                                                      &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_PAYLOAD_POOL_SIZE)) {
+      gint poolSize = g_key_file_get_integer (key_file, group,
+                                              CONFIG_KEY_PAYLOAD_POOL_SIZE,
+                                              &error);
+      CHECK_ERROR (error);
+      if (poolSize < 1 || poolSize > MAX_PAYLOAD_POOL_SIZE) {
+        cout << "Invalid " CONFIG_KEY_PAYLOAD_POOL_SIZE " " << poolSize
+            << ", must be 1 to " << MAX_PAYLOAD_POOL_SIZE << endl;
+        goto done;
+      }
+      privObj->payloadPoolSize = poolSize;
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_ID_MODE)) {
+      gchar *mode = g_key_file_get_string (key_file, group,
+                                           CONFIG_KEY_ID_MODE, &error);
+      CHECK_ERROR (error);
+      if (!id_mode_from_string (mode, &privObj->idGen.mode)) {
+        cout << "Unknown " CONFIG_KEY_ID_MODE " " << mode << endl;
+        g_free (mode);
+        goto done;
+      }
+      g_free (mode);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_SIGNATURE_FORMAT)) {
+      gchar *format = g_key_file_get_string (key_file, group,
+                                             CONFIG_KEY_SIGNATURE_FORMAT,
+                                             &error);
+      CHECK_ERROR (error);
+      if (!g_strcmp0 (format, "double")) {
+        privObj->signatureFormat = NVDS_SIGNATURE_FORMAT_DOUBLE;
+      } else if (!g_strcmp0 (format, "shortest")) {
+        privObj->signatureFormat = NVDS_SIGNATURE_FORMAT_SHORTEST;
+      } else if (!g_strcmp0 (format, "float")) {
+        privObj->signatureFormat = NVDS_SIGNATURE_FORMAT_FLOAT;
+      } else if (!g_strcmp0 (format, "base64")) {
+        privObj->signatureFormat = NVDS_SIGNATURE_FORMAT_BASE64;
+      } else {
+        cout << "Unknown " CONFIG_KEY_SIGNATURE_FORMAT " " << format << endl;
+        g_free (format);
+        goto done;
+      }
+      g_free (format);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_TIMESTAMP_FORMAT)) {
+      gchar *format = g_key_file_get_string (key_file, group,
+                                             CONFIG_KEY_TIMESTAMP_FORMAT,
+                                             &error);
+      CHECK_ERROR (error);
+      if (!g_strcmp0 (format, "iso")) {
+        privObj->timestampFormat = NVDS_TIMESTAMP_FORMAT_ISO;
+      } else if (!g_strcmp0 (format, "epoch-ms")) {
+        privObj->timestampFormat = NVDS_TIMESTAMP_FORMAT_EPOCH_MS;
+      } else {
+        cout << "Unknown " CONFIG_KEY_TIMESTAMP_FORMAT " " << format << endl;
+        g_free (format);
+        goto done;
+      }
+      g_free (format);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_TS_EPOCH_NS)) {
+      privObj->tsEpochNs = g_key_file_get_boolean (key_file, group,
+                                                   CONFIG_KEY_TS_EPOCH_NS,
+                                                   &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_PROJECTION)) {
+      gchar **fields = g_key_file_get_string_list (key_file, group,
+                                                   CONFIG_KEY_PROJECTION,
+                                                   NULL, &error);
+      CHECK_ERROR (error);
+      if (!projection_compile (&privObj->projection, fields)) {
+        g_strfreev (fields);
+        goto done;
+      }
+      g_strfreev (fields);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_COMPRESSION)) {
+      gchar *codec = g_key_file_get_string (key_file, group,
+                                            CONFIG_KEY_COMPRESSION, &error);
+      CHECK_ERROR (error);
+      if (!compression_from_string (codec, &privObj->compression)) {
+        cout << "Unknown " CONFIG_KEY_COMPRESSION " " << codec << endl;
+        g_free (codec);
+        goto done;
+      }
+      g_free (codec);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_COMPRESSION_LEVEL)) {
+      privObj->compressionLevel = g_key_file_get_integer (key_file, group,
+                                                  CONFIG_KEY_COMPRESSION_LEVEL,
+                                                  &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_COMPRESSION_DICTIONARY)) {
+      g_free (privObj->compressionDict);
+      privObj->compressionDict = g_key_file_get_string (key_file, group,
+                                             CONFIG_KEY_COMPRESSION_DICTIONARY,
+                                             &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_TEMPLATE)) {
+      g_free (privObj->templateFile);
+      privObj->templateFile = g_key_file_get_string (key_file, group,
+                                                     CONFIG_KEY_TEMPLATE,
+                                                     &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_DELTA_ENCODING)) {
+      privObj->deltaEncoding = g_key_file_get_boolean (key_file, group,
+                                                    CONFIG_KEY_DELTA_ENCODING,
+                                                    &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_DELTA_KEYFRAME_INTERVAL)) {
+      gint interval = g_key_file_get_integer (key_file, group,
+                                         CONFIG_KEY_DELTA_KEYFRAME_INTERVAL,
+                                         &error);
+      CHECK_ERROR (error);
+      if (interval < 1) {
+        cout << "Invalid " CONFIG_KEY_DELTA_KEYFRAME_INTERVAL " " << interval
+            << endl;
+        goto done;
+      }
+      privObj->deltaKeyframeInterval = interval;
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_DELTA_MAX_TRACKS)) {
+      gint maxTracks = g_key_file_get_integer (key_file, group,
+                                               CONFIG_KEY_DELTA_MAX_TRACKS,
+                                               &error);
+      CHECK_ERROR (error);
+      if (maxTracks < 1) {
+        cout << "Invalid " CONFIG_KEY_DELTA_MAX_TRACKS " " << maxTracks << endl;
+        goto done;
+      }
+      privObj->deltaMaxTracks = maxTracks;
+    } else if (!g_strcmp0 (*key, CONFIG_KEY_WATCH_CONFIG)) {
+      privObj->watchConfig = g_key_file_get_boolean (key_file, group,
+                                                     CONFIG_KEY_WATCH_CONFIG,
+                                                     &error);
+      CHECK_ERROR (error);
+    } else {
+      cout << "Unknown key " << *key << " for group [" << group <<"]\n";
+    }
+  }
+
+  if (privObj->projection.custom && !privObj->directWriter) {
+    cout << CONFIG_KEY_PROJECTION " needs " CONFIG_KEY_DIRECT_WRITER << endl;
+    goto done;
+  }
+
+  // json-glib formats every number with g_ascii_dtostr
+  if ((privObj->signatureFormat == NVDS_SIGNATURE_FORMAT_SHORTEST ||
+       privObj->signatureFormat == NVDS_SIGNATURE_FORMAT_FLOAT) &&
+      !privObj->directWriter) {
+    cout << CONFIG_KEY_SIGNATURE_FORMAT "=shortest / float needs "
+        CONFIG_KEY_DIRECT_WRITER << endl;
+    goto done;
+  }
+
+  if (privObj->deltaEncoding &&
+      (!privObj->directWriter ||
+       !projection_has (&privObj->projection, NVDS_FIELD_SENSOR_ID) ||
+       !projection_has (&privObj->projection, NVDS_FIELD_OBJECT_ID))) {
+    cout << CONFIG_KEY_DELTA_ENCODING " needs " CONFIG_KEY_DIRECT_WRITER
+        ", sensor.id and object.id" << endl;
+    goto done;
+  }
+
+  ret = true;
+
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+
+  return ret;
+}
+
+/**
+ * Holds values shared by all the CSV rows, interned once per load.
+ */
+struct NvDsCsvLoader {
+  NvDsConfigTables *tables;
   NvDsSensorObject sensorObj;
   NvDsPlaceObject placeObj;
-  bool retVal = true;
-  bool firstRow = true;
-  string line;
-  gint i, index = 0;
+  NvDsAnalyticsObject analyticsObj;
+};
+
+static NvDsStr
+intern_field (NvDsConfigTables *tables, const NvDsCsvField &field)
+{
+  return string_pool_intern (&tables->strings, field.str, field.len);
+}
 
-  ifstream inputFile (file);
-  if (!inputFile.is_open()) {
-    cout << "Couldn't open CSV file " << file << endl;
-    return false;
+static gboolean
+nvds_msg2p_add_csv_row (guint row, const NvDsCsvField *fields,
+                        guint numFields, gpointer userData)
+{
+  NvDsCsvLoader *loader = (NvDsCsvLoader *) userData;
+  NvDsConfigTables *tables = loader->tables;
+  /* This is based on assumption that fields and their locations
+   * are fixed in CSV file. This should be updated accordingly if
+   * that is not the case.
+   * cameraId, sensor id, sensor description, cameraIDstring, place
+   * sub-fields 1 - 3. */
+  gint index = row - 1;
+
+  // Discard first row as it will have header fields.
+  if (row == 0)
+    return TRUE;
+
+  if (numFields < 7) {
+    cout << "Out of Range error: CSV row " << row << " has " << numFields
+         << " fields" << endl;
+    return FALSE;
   }
 
-  privObj = (NvDsPayloadPriv *) ctx->privData;
+  loader->sensorObj.id = intern_field (tables, fields[1]).str;
+  loader->sensorObj.desc = intern_field (tables, fields[2]).str;
+  loader->placeObj.subObj.field1 = intern_field (tables, fields[4]).str;
+  loader->placeObj.subObj.field2 = intern_field (tables, fields[5]).str;
+  loader->placeObj.subObj.field3 = intern_field (tables, fields[6]).str;
 
-  try {
+  tables->sensorObj.insert (index, loader->sensorObj);
+  tables->placeObj.insert (index, loader->placeObj);
+  tables->analyticsObj.insert (index, loader->analyticsObj);
 
-    while (getline (inputFile, line)) {
+  return TRUE;
+}
 
-      if (firstRow) {
-        // Discard first row as it will have header fields.
-        firstRow = false;
-        continue;
-      }
+static bool
+nvds_msg2p_parse_csv (NvDsConfigTables *tables, const gchar *file)
+{
+  NvDsCsvLoader loader;
 
-      vector<string> tokens;
-      get_csv_tokens (line, tokens);
-      // Ignore first cameraId field.
-      i = 1;
-
-      // sensor object fields
-      sensorObj.id = tokens.at(i++);
-      sensorObj.type = "Camera";
-      sensorObj.desc = tokens.at(i++);
-
-      //Hard coded values but can be read from CSV file.
-      sensorObj.location[0] = 0; //atof (tokens.at(i++).c_str ());
-      sensorObj.location[1] = 0;
-      sensorObj.location[2] = 0;
-      sensorObj.coordinate[0] = 0;
-      sensorObj.coordinate[1] = 0;
-      sensorObj.coordinate[2] = 0;
-
-      // place object fields
-      placeObj.id = "Id";
-      placeObj.type = "building/garage";
-      placeObj.name = "endeavor";
-      placeObj.location[0] = 0;
-      placeObj.location[1] = 0;
-      placeObj.location[2] = 0;
-      placeObj.coordinate[0] = 0;
-      placeObj.coordinate[1] = 0;
-      placeObj.coordinate[2] = 0;
-      //Ignore cameraIDstring
-      i++;
-      placeObj.subObj.field1 = tokens.at(i++);
-      placeObj.subObj.field2 = tokens.at(i++);
-      placeObj.subObj.field3 = tokens.at(i++);
-
-      // analytics object fields
-      // hard coded values but can be read from CSV file.
-      analyticsObj.id = "";
-      analyticsObj.source = "";
-      analyticsObj.desc = "";
-      analyticsObj.version = "1.0";
-
-      privObj->sensorObj.insert (make_pair (index, sensorObj));
-      privObj->placeObj.insert (make_pair (index, placeObj));
-      privObj->analyticsObj.insert (make_pair (index, analyticsObj));
-
-      index++;
-    }
-  } catch (const std::out_of_range& oor) {
-    std::cerr << "Out of Range error: " << oor.what() << '\n';
-    retVal = false;
-  }
+  loader.tables = tables;
 
-  inputFile.close ();
-  return retVal;
+  //Hard coded values but can be read from CSV file.
+  loader.sensorObj.type = intern_string (tables, "Camera");
+  memset (loader.sensorObj.location, 0, sizeof (loader.sensorObj.location));
+  memset (loader.sensorObj.coordinate, 0,
+          sizeof (loader.sensorObj.coordinate));
+
+  loader.placeObj.id = intern_string (tables, "Id");
+  loader.placeObj.type = intern_string (tables, "building/garage");
+  loader.placeObj.name = intern_string (tables, "endeavor");
+  memset (loader.placeObj.location, 0, sizeof (loader.placeObj.location));
+  memset (loader.placeObj.coordinate, 0, sizeof (loader.placeObj.coordinate));
+
+  loader.analyticsObj.version = intern_string (tables, "1.0");
+
+  return csv_read_file (file, DEFAULT_CSV_FIELDS, nvds_msg2p_add_csv_row,
+                        &loader);
 }
 
+/**
+ * Parses key-value configuration file into @a tables. [schema] group is
+ * only parsed if @a ctx is not NULL, it can't be changed by reload.
+ */
 static bool
-nvds_msg2p_parse_key_value (NvDsMsg2pCtx *ctx, const gchar *file)
+nvds_msg2p_parse_key_value (NvDsMsg2pCtx *ctx, NvDsConfigTables *tables,
+                            const gchar *file)
 {
   bool retVal = true;
   GKeyFile *cfgFile = NULL;
@@ -995,11 +2452,14 @@ nvds_msg2p_parse_key_value (NvDsMsg2pCtx *ctx, const gchar *file)
 
   for (group = groups; *group; group++) {
     if (!strncmp (*group, CONFIG_GROUP_SENSOR, strlen (CONFIG_GROUP_SENSOR))) {
-      retVal = nvds_msg2p_parse_sensor (ctx, cfgFile, *group);
+      retVal = nvds_msg2p_parse_sensor (tables, cfgFile, *group);
     } else if (!strncmp (*group, CONFIG_GROUP_PLACE, strlen (CONFIG_GROUP_PLACE))) {
-      retVal = nvds_msg2p_parse_place (ctx, cfgFile, *group);
+      retVal = nvds_msg2p_parse_place (tables, cfgFile, *group);
     } else if (!strncmp (*group, CONFIG_GROUP_ANALYTICS, strlen (CONFIG_GROUP_ANALYTICS))) {
-      retVal = nvds_msg2p_parse_analytics (ctx, cfgFile, *group);
+      retVal = nvds_msg2p_parse_analytics (tables, cfgFile, *group);
+    } else if (!g_strcmp0 (*group, CONFIG_GROUP_SCHEMA)) {
+      if (ctx)
+        retVal = nvds_msg2p_parse_schema (ctx, cfgFile, *group);
     } else {
       cout << "Unknown group " << *group << endl;
     }
@@ -1020,71 +2480,444 @@ done:
   return retVal;
 }
 
+/**
+ * Builds new tables from configuration file of context. Fragments are
+ * rendered here as well so that swap publishes complete tables.
+ */
+static NvDsConfigTables *
+nvds_msg2p_load_tables (NvDsMsg2pCtx *ctx, gboolean parseSchema)
+{
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
+  NvDsConfigTables *tables = new NvDsConfigTables;
+  const gchar *file = privObj->configFile;
+  bool retVal = true;
+
+  if (g_str_has_suffix (file, ".csv")) {
+    retVal = nvds_msg2p_parse_csv (tables, file);
+  } else {
+    retVal = nvds_msg2p_parse_key_value (parseSchema ? ctx : NULL, tables,
+                                         file);
+  }
+
+  if (!retVal) {
+    delete tables;
+    return NULL;
+  }
+
+  tables->sensorObj.freeze ();
+  tables->placeObj.freeze ();
+  tables->analyticsObj.freeze ();
+
+  if (privObj->directWriter && ctx->payloadType == NVDS_PAYLOAD_DEEPSTREAM)
+    nvds_msg2p_render_fragments (tables, &privObj->projection,
+                                 privObj->prettyPrint);
+
+  return tables;
+}
+
+static void
+update_reload_stats (NvDsPayloadPriv *privObj, NvDsConfigTables *tables,
+                     gint64 startTime)
+{
+  NvDsMsg2pReloadStats *stats = &privObj->reloadStats;
+
+  stats->lastReloadTime = g_get_monotonic_time () - startTime;
+  stats->numSensors = tables->sensorObj.size ();
+  stats->numPlaces = tables->placeObj.size ();
+  stats->numModules = tables->analyticsObj.size ();
+}
+
+static gpointer
+config_watch_thread (gpointer data)
+{
+  NvDsMsg2pCtx *ctx = (NvDsMsg2pCtx *) data;
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
+  gchar *dir = g_path_get_dirname (privObj->configFile);
+  gchar *name = g_path_get_basename (privObj->configFile);
+  gchar events[4096]
+      __attribute__ ((aligned (__alignof__ (struct inotify_event))));
+  const struct inotify_event *event;
+  struct pollfd fds[2];
+  gboolean changed;
+  gssize len;
+  gchar *ptr;
+  gint fd;
+
+  fd = inotify_init1 (IN_CLOEXEC);
+  // editors often replace the file, so watch directory for new versions.
+  if (fd < 0 || inotify_add_watch (fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+    cout << "Unable to watch " << privObj->configFile << ": "
+         << strerror (errno) << endl;
+    goto done;
+  }
+
+  fds[0].fd = fd;
+  fds[0].events = POLLIN;
+  fds[1].fd = privObj->watchStopFd[0];
+  fds[1].events = POLLIN;
+
+  while (TRUE) {
+    if (poll (fds, 2, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    if (fds[1].revents)
+      break;
+
+    len = read (fd, events, sizeof (events));
+    if (len <= 0)
+      continue;
+
+    changed = FALSE;
+    for (ptr = events; ptr < events + len;
+         ptr += sizeof (struct inotify_event) + event->len) {
+      event = (const struct inotify_event *) ptr;
+      if (event->len && !strcmp (event->name, name))
+        changed = TRUE;
+    }
+
+    if (changed)
+      nvds_msg2p_reload (ctx);
+  }
+
+done:
+  if (fd >= 0)
+    close (fd);
+  g_free (dir);
+  g_free (name);
+  return NULL;
+}
+
+/**
+ * Reads and compiles template file, fields are validated once here instead
+ * of per payload.
+ */
+static gboolean
+nvds_msg2p_load_template (NvDsPayloadPriv *privObj)
+{
+  GError *error = NULL;
+  gchar *text = NULL;
+  gboolean ret;
+
+  if (!privObj->templateFile) {
+    cout << "Custom payload needs " CONFIG_KEY_TEMPLATE " in [schema]" << endl;
+    return FALSE;
+  }
+
+  if (!g_file_get_contents (privObj->templateFile, &text, NULL, &error)) {
+    cout << "Unable to read template: " << error->message << endl;
+    g_error_free (error);
+    return FALSE;
+  }
+
+  ret = template_compile (&privObj->payloadTemplate, text,
+                          privObj->templateFile);
+  g_free (text);
+  return ret;
+}
+
 NvDsMsg2pCtx* nvds_msg2p_ctx_create (const gchar *file, NvDsPayloadType type)
 {
   NvDsMsg2pCtx *ctx = NULL;
-  string str;
-  bool retVal = true;
+  NvDsPayloadPriv *privObj = NULL;
+  NvDsConfigTables *tables = NULL;
+  gint64 startTime = g_get_monotonic_time ();
 
   g_return_val_if_fail (file, NULL);
 
   ctx = new NvDsMsg2pCtx;
-  ctx->privData = (void *) new NvDsPayloadPriv;
+  privObj = new NvDsPayloadPriv;
+  privObj->tables = NULL;
+  privObj->tablesEpoch = 0;
+  privObj->tablesReaders[0] = 0;
+  privObj->tablesReaders[1] = 0;
+  g_mutex_init (&privObj->reloadLock);
+  memset (&privObj->reloadStats, 0, sizeof (privObj->reloadStats));
+  privObj->configFile = g_strdup (file);
+  privObj->watchConfig = FALSE;
+  privObj->watchThread = NULL;
+  privObj->prettyPrint = TRUE;
+  privObj->directWriter = TRUE;
+  privObj->payloadPoolSize = DEFAULT_PAYLOAD_POOL_SIZE;
+  privObj->payloadPool = NULL;
+  id_generator_init (&privObj->idGen, NVDS_ID_MODE_V4);
+  privObj->signatureFormat = NVDS_SIGNATURE_FORMAT_DOUBLE;
+  privObj->timestampFormat = NVDS_TIMESTAMP_FORMAT_ISO;
+  privObj->tsEpochNs = FALSE;
+  projection_compile (&privObj->projection, NULL);
+  privObj->compression = NVDS_COMPRESSION_NONE;
+  privObj->compressionLevel = 0;
+  privObj->compressionDict = NULL;
+  privObj->compressor = NULL;
+  privObj->deltaEncoding = FALSE;
+  privObj->deltaKeyframeInterval = DEFAULT_DELTA_KEYFRAME_INTERVAL;
+  privObj->deltaMaxTracks = DEFAULT_DELTA_MAX_TRACKS;
+  privObj->deltaEncoder = NULL;
+  privObj->templateFile = NULL;
+  ctx->privData = (void *) privObj;
+  ctx->payloadType = type;
 
-  if (g_str_has_suffix (file, ".csv")) {
-    retVal = nvds_msg2p_parse_csv (ctx, file);
-  } else {
-    retVal = nvds_msg2p_parse_key_value (ctx, file);
+  tables = nvds_msg2p_load_tables (ctx, TRUE);
+
+  privObj->payloadPool = payload_pool_new (privObj->payloadPoolSize);
+
+  if (!tables) {
+    cout << "Error in creating instance" << endl;
+    nvds_msg2p_ctx_destroy (ctx);
+    return NULL;
   }
 
-  ctx->payloadType = type;
+  privObj->tables = tables;
+  update_reload_stats (privObj, tables, startTime);
 
-  if (!retVal) {
+  if (privObj->deltaEncoding && type == NVDS_PAYLOAD_DEEPSTREAM)
+    privObj->deltaEncoder = delta_encoder_new (privObj->deltaMaxTracks,
+                                               privObj->deltaKeyframeInterval);
+
+  if (type == NVDS_PAYLOAD_CUSTOM && !nvds_msg2p_load_template (privObj)) {
     cout << "Error in creating instance" << endl;
+    nvds_msg2p_ctx_destroy (ctx);
+    return NULL;
+  }
 
-    if (ctx && ctx->privData)
-      delete (NvDsPayloadPriv *) ctx->privData;
+  if (privObj->compression != NVDS_COMPRESSION_NONE) {
+    privObj->compressor = compressor_new (privObj->compression,
+                                          privObj->compressionLevel,
+                                          privObj->compressionDict);
+    if (!privObj->compressor) {
+      cout << "Error in creating instance" << endl;
+      nvds_msg2p_ctx_destroy (ctx);
+      return NULL;
+    }
+  }
 
-    if (ctx) {
-      delete ctx;
-      ctx = NULL;
+  if (privObj->watchConfig) {
+    if (pipe2 (privObj->watchStopFd, O_CLOEXEC) < 0) {
+      cout << "Unable to watch " << file << ": " << strerror (errno) << endl;
+    } else {
+      privObj->watchThread = g_thread_new ("nvmsgconv-watch",
+                                           config_watch_thread, ctx);
     }
   }
+
   return ctx;
 }
 
 void nvds_msg2p_ctx_destroy (NvDsMsg2pCtx *ctx)
 {
-  delete (NvDsPayloadPriv *) ctx->privData;
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
+
+  if (privObj->watchThread) {
+    if (write (privObj->watchStopFd[1], "q", 1) != 1)
+      cout << "Unable to stop config watch" << endl;
+    g_thread_join (privObj->watchThread);
+    close (privObj->watchStopFd[0]);
+    close (privObj->watchStopFd[1]);
+  }
+
+  if (privObj->payloadPool)
+    payload_pool_destroy (privObj->payloadPool);
+  if (privObj->compressor)
+    compressor_destroy (privObj->compressor);
+  if (privObj->deltaEncoder)
+    delta_encoder_destroy (privObj->deltaEncoder);
+  g_free (privObj->compressionDict);
+  g_free (privObj->templateFile);
+  delete privObj->tables.load ();
+  g_mutex_clear (&privObj->reloadLock);
+  g_free (privObj->configFile);
+  delete privObj;
   delete ctx;
 }
 
+gboolean
+nvds_msg2p_reload (NvDsMsg2pCtx *ctx)
+{
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
+  NvDsMsg2pReloadStats *stats = &privObj->reloadStats;
+  NvDsConfigTables *tables = NULL;
+  gint64 startTime = g_get_monotonic_time ();
+
+  g_mutex_lock (&privObj->reloadLock);
+
+  tables = nvds_msg2p_load_tables (ctx, FALSE);
+  if (!tables) {
+    stats->failures++;
+    g_mutex_unlock (&privObj->reloadLock);
+    cout << "Failed to reload " << privObj->configFile
+         << ", keeping previous configuration" << endl;
+    return FALSE;
+  }
+
+  // generation in progress keeps using old tables until it is done.
+  delete config_tables_swap (privObj, tables);
+
+  stats->reloads++;
+  update_reload_stats (privObj, tables, startTime);
+  cout << "Reloaded " << privObj->configFile << ": " << stats->numSensors
+       << " sensors, " << stats->numPlaces << " places, "
+       << stats->numModules << " analytics modules in "
+       << stats->lastReloadTime << " us" << endl;
+
+  g_mutex_unlock (&privObj->reloadLock);
+  return TRUE;
+}
+
+void
+nvds_msg2p_get_reload_stats (NvDsMsg2pCtx *ctx, NvDsMsg2pReloadStats *stats)
+{
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
+
+  g_mutex_lock (&privObj->reloadLock);
+  *stats = privObj->reloadStats;
+  g_mutex_unlock (&privObj->reloadLock);
+}
+
+/**
+ * Sets key of payload to sensor id of its events, so that brokers don't
+ * have to parse the payload for it. No key if events are from different
+ * sensors or sensor has no entry.
+ */
+static void
+set_payload_key (NvDsMsg2pCtx *ctx, NvDsPooledPayload *pooled,
+                 NvDsEvent *events, guint size)
+{
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
+  NvDsSensorObject *sensor = NULL;
+  gint sensorId = events[0].metadata->sensorId;
+  guint slot;
+  guint i;
+
+  for (i = 1; i < size; i++) {
+    if (events[i].metadata->sensorId != sensorId)
+      return;
+  }
+
+  slot = config_tables_read_lock (privObj);
+  sensor = privObj->tables.load ()->sensorObj.find (sensorId);
+  if (sensor && *sensor->id)
+    payload_pool_set_key (pooled, sensor->id);
+  config_tables_read_unlock (privObj, slot);
+}
+
 NvDsPayload*
 nvds_msg2p_generate (NvDsMsg2pCtx *ctx, NvDsEvent *events, guint size)
 {
-  gchar *message = NULL;
-  gint len = 0;
-  NvDsPayload *payload = (NvDsPayload *) g_malloc0 (sizeof (NvDsPayload));
-  if (ctx->payloadType == NVDS_PAYLOAD_DEEPSTREAM) {
-    message = generate_schema_message (ctx, events->metadata);
-    if (message) {
-      len = strlen (message);
-      // Remove '\0' character at the end of string and just copy the content.
-      payload->payload = g_memdup (message, len);
-      payload->payloadSize = len;
-      g_free (message);
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
+  NvDsPooledPayload *pooled = NULL;
+
+  // only first event is used, batches go through nvds_msg2p_generate_batch.
+  // message is written in place, payload points to pooled buffer.
+  pooled = payload_pool_acquire (privObj->payloadPool);
+  append_message (ctx, events->metadata, pooled->buf);
+  if (privObj->compressor)
+    compressor_compress (privObj->compressor, &pooled->buf);
+
+  set_payload_key (ctx, pooled, events, 1);
+  return payload_pool_finish (pooled);
+}
+
+NvDsPayload*
+nvds_msg2p_generate_batch (NvDsMsg2pCtx *ctx, NvDsEvent *events, guint size,
+                           NvDsMsg2pBatchFormat format)
+{
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
+  NvDsPooledPayload *pooled = NULL;
+  GString *buf = NULL;
+  gsize headerSize;
+  guint32 value;
+  guint i;
+
+  g_return_val_if_fail (events && size, NULL);
+
+  if (format == NVDS_MSG2P_BATCH_NONE)
+    return nvds_msg2p_generate (ctx, events, 1);
+
+  if (format == NVDS_MSG2P_BATCH_JSON_ARRAY &&
+      ctx->payloadType == NVDS_PAYLOAD_DEEPSTREAM_BINARY) {
+    cout << "json-array batch format is not supported for binary payload"
+        << endl;
+    return NULL;
+  }
+
+  if (format != NVDS_MSG2P_BATCH_JSON_ARRAY &&
+      format != NVDS_MSG2P_BATCH_FRAMED) {
+    cout << "Unknown batch format " << format << endl;
+    return NULL;
+  }
+
+  pooled = payload_pool_acquire (privObj->payloadPool);
+  buf = pooled->buf;
+
+  if (format == NVDS_MSG2P_BATCH_JSON_ARRAY) {
+    /* Elements are identical to the payloads generated for single event,
+     * those are not re-indented as per nesting level of array. */
+    g_string_append_c (buf, '[');
+    for (i = 0; i < size; i++) {
+      if (i)
+        g_string_append_c (buf, ',');
+      if (privObj->prettyPrint)
+        g_string_append_c (buf, '\n');
+      append_message (ctx, events[i].metadata, buf);
     }
-  } else if (ctx->payloadType == NVDS_PAYLOAD_CUSTOM) {
-    payload->payload = (gpointer) g_strdup ("CUSTOM Schema");
-  } else
-    payload->payload = NULL;
+    if (privObj->prettyPrint)
+      g_string_append_c (buf, '\n');
+    g_string_append_c (buf, ']');
+  } else {
+    // count followed by offset table, see NvDsMsg2pBatchFormat.
+    headerSize = sizeof (guint32) * (size + 2);
+    g_string_set_size (buf, headerSize);
+
+    value = GUINT32_TO_LE (size);
+    memcpy (buf->str, &value, sizeof (value));
+
+    for (i = 0; i <= size; i++) {
+      value = GUINT32_TO_LE ((guint32) buf->len);
+      memcpy (buf->str + sizeof (guint32) * (i + 1), &value, sizeof (value));
+      if (i < size)
+        append_message (ctx, events[i].metadata, buf);
+    }
+  }
+
+  // whole batch is compressed, including offset table of framed format.
+  if (privObj->compressor)
+    compressor_compress (privObj->compressor, &pooled->buf);
 
-  return payload;
+  set_payload_key (ctx, pooled, events, size);
+  return payload_pool_finish (pooled);
+}
+
+NvDsPayload*
+nvds_msg2p_payload_ref (NvDsMsg2pCtx *ctx, NvDsPayload *payload)
+{
+  return payload_pool_ref (payload);
 }
 
 void
 nvds_msg2p_release (NvDsMsg2pCtx *ctx, NvDsPayload *payload)
 {
-  g_free (payload->payload);
-  g_free (payload);
+  payload_pool_unref (payload);
+}
+
+void
+nvds_msg2p_get_pool_stats (NvDsMsg2pCtx *ctx, NvDsMsg2pPoolStats *stats)
+{
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
+
+  payload_pool_get_stats (privObj->payloadPool, &stats->hits, &stats->misses);
+}
+
+gboolean
+nvds_msg2p_needs_ordered_generation (NvDsMsg2pCtx *ctx)
+{
+  NvDsPayloadPriv *privObj = (NvDsPayloadPriv *) ctx->privData;
+
+  return privObj->deltaEncoder != NULL;
+}
+
+guint
+nvds_msg2p_get_payload_version (void)
+{
+  return NVDS_MSG2P_PAYLOAD_VERSION;
 }
@@ -29,6 +29,51 @@ extern "C"
 {
 #endif
 
+/**
+ * Format of payload generated for multiple events by
+ * @ref nvds_msg2p_generate_batch.
+ */
+typedef enum {
+  /** One payload per event, only first event is used. */
+  NVDS_MSG2P_BATCH_NONE,
+  /** Single json array having message of each event as element. */
+  NVDS_MSG2P_BATCH_JSON_ARRAY,
+  /**
+   * Messages stored back to back after an offset table. All fields are
+   * 32 bit little endian integers:
+   *   count, offset[0] ... offset[count], message data
+   * Offsets are from start of payload, message i spans from offset[i] to
+   * offset[i + 1] and offset[count] is size of payload.
+   */
+  NVDS_MSG2P_BATCH_FRAMED
+} NvDsMsg2pBatchFormat;
+
+/**
+ * Holds statistics of payload buffer pool of a context.
+ */
+typedef struct NvDsMsg2pPoolStats {
+  /** number of payloads generated in a released buffer. */
+  guint64 hits;
+  /** number of payloads which needed new buffer. */
+  guint64 misses;
+} NvDsMsg2pPoolStats;
+
+/**
+ * Holds configuration reload statistics of a context.
+ */
+typedef struct NvDsMsg2pReloadStats {
+  /** number of successful reloads. */
+  guint64 reloads;
+  /** number of failed reloads, previous configuration is kept. */
+  guint64 failures;
+  /** time to parse and publish last loaded configuration in microseconds. */
+  gint64 lastReloadTime;
+  /** number of sensor, place and analytics module entries in use. */
+  guint numSensors;
+  guint numPlaces;
+  guint numModules;
+} NvDsMsg2pReloadStats;
+
 /**
  * @ref NvDsMsg2pCtx is structure for library context.
  */
@@ -69,6 +114,16 @@ void nvds_msg2p_ctx_destroy (NvDsMsg2pCtx *ctx);
  * Payload will be generated based on the @ref NvDsPayloadType type provided
  * in context creation (e.g. Deepstream, Custom etc.).
  *
+ * Payload is generated for the first event only, several events are
+ * combined into one payload with @ref nvds_msg2p_generate_batch.
+ *
+ * Key of payload is the sensor id (sensor.id of the message), for brokers
+ * to partition messages without parsing the payload.
+ *
+ * Can be called from multiple threads with the same context, as well as
+ * @ref nvds_msg2p_generate_batch. Custom converter libraries should do the
+ * same to be used with "worker-threads" of nvmsgconv element.
+ *
  * @param[in] ctx pointer to library context.
  * @param[in] events pointer to array of event objects.
  * @param[in] size number of objects in array.
@@ -79,14 +134,98 @@ void nvds_msg2p_ctx_destroy (NvDsMsg2pCtx *ctx);
 NvDsPayload*
 nvds_msg2p_generate (NvDsMsg2pCtx *ctx, NvDsEvent *events, guint size);
 
+/**
+ * This function generates single payload for all the events in array.
+ * Message generated for each event is same as the one generated by
+ * @ref nvds_msg2p_generate for that event alone.
+ *
+ * @param[in] ctx pointer to library context.
+ * @param[in] events pointer to array of event objects.
+ * @param[in] size number of objects in array.
+ * @param[in] format layout of messages in payload.
+ *
+ * @return pointer to @ref NvDsPayload generated or NULL in case of error.
+ * This payload should be freed with @ref nvds_msg2p_release
+ */
+NvDsPayload*
+nvds_msg2p_generate_batch (NvDsMsg2pCtx *ctx, NvDsEvent *events, guint size,
+                           NvDsMsg2pBatchFormat format);
+
+/**
+ * Adds a reference to payload instead of copying it. Each reference should
+ * be released with @ref nvds_msg2p_release.
+ *
+ * @param[in] ctx pointer to library context.
+ * @param[in] payload pointer to payload generated by this library.
+ *
+ * @return @a payload itself.
+ */
+NvDsPayload* nvds_msg2p_payload_ref (NvDsMsg2pCtx *ctx, NvDsPayload *payload);
+
 /**
  * This function should be called to release memory allocated for payload.
+ * Payload buffer is returned to the pool of context once all the references
+ * are released. Payloads can be released after context is destroyed.
  *
  * @param[in] ctx pointer to library context.
  * @param[in] payload pointer to object that needs to be released.
  */
 void nvds_msg2p_release (NvDsMsg2pCtx *ctx, NvDsPayload *payload);
 
+/**
+ * Gets hit / miss counters of payload buffer pool.
+ *
+ * @param[in] ctx pointer to library context.
+ * @param[out] stats pool statistics.
+ */
+void nvds_msg2p_get_pool_stats (NvDsMsg2pCtx *ctx, NvDsMsg2pPoolStats *stats);
+
+/**
+ * Reads configuration file of context again. Sensor, place and analytics
+ * entries are replaced atomically, payloads being generated meanwhile use
+ * either old or new entries and generation never waits for reload.
+ * [schema] group is not reloaded.
+ * It is called automatically on file change if "watch-config" is set.
+ *
+ * @param[in] ctx pointer to library context.
+ *
+ * @return TRUE on success. Previous configuration is kept in case of error.
+ */
+gboolean nvds_msg2p_reload (NvDsMsg2pCtx *ctx);
+
+/**
+ * Gets configuration load / reload statistics.
+ *
+ * @param[in] ctx pointer to library context.
+ * @param[out] stats reload statistics.
+ */
+void nvds_msg2p_get_reload_stats (NvDsMsg2pCtx *ctx,
+                                  NvDsMsg2pReloadStats *stats);
+
+/**
+ * Whether payloads of context have to be generated in the order they are
+ * sent, e.g. with delta-encoding sequence numbers of a track follow
+ * generation order. Events of such context can't be converted by several
+ * threads at once (worker-threads of nvmsgconv element).
+ *
+ * @param[in] ctx pointer to library context.
+ *
+ * @return TRUE if generation has to be serial.
+ */
+gboolean nvds_msg2p_needs_ordered_generation (NvDsMsg2pCtx *ctx);
+
+/** Layout of @ref NvDsPayload, 2 added key and keyLen. */
+#define NVDS_MSG2P_PAYLOAD_VERSION 2
+
+/**
+ * Gets layout of payloads generated by the library. Custom converter
+ * libraries export it if their payloads have key and keyLen, nvmsgconv
+ * element doesn't read them from libraries without it.
+ *
+ * @return @ref NVDS_MSG2P_PAYLOAD_VERSION the library is built with.
+ */
+guint nvds_msg2p_get_payload_version (void);
+
 #ifdef __cplusplus
 }
 #endif
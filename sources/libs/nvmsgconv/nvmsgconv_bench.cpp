@@ -0,0 +1,602 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * CPU only throughput benchmark of nvmsgconv library.
+ *
+ * Synthesizes NvDsEventMsgMeta streams with configurable event types,
+ * object type mix, signature lengths and sensor table size, and drives
+ * nvds_msg2p_generate (nvds_msg2p_generate_batch with --batch) /
+ * nvds_msg2p_release from one or more threads sharing a context. Reports
+ * messages/sec, bytes/sec, p50 / p99 latency of generate calls and heap
+ * allocations per message, as text or one
+ * json object per run for tracking across releases.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include <glib.h>
+#include "nvmsgconv.h"
+#include "nvds_version.h"
+
+#define NUM_METAS 1024
+#define MAX_SIGNATURE_LEN 4096
+
+typedef struct {
+  const gchar *name;
+  gint value;
+} NvDsBenchName;
+
+static const NvDsBenchName eventNames[] = {
+  {"entry", NVDS_EVENT_ENTRY},
+  {"exit", NVDS_EVENT_EXIT},
+  {"moving", NVDS_EVENT_MOVING},
+  {"stopped", NVDS_EVENT_STOPPED},
+  {"empty", NVDS_EVENT_EMPTY},
+  {"parked", NVDS_EVENT_PARKED},
+  {"reset", NVDS_EVENT_RESET},
+};
+
+static const NvDsBenchName objectNames[] = {
+  {"vehicle", NVDS_OBJECT_TYPE_VEHICLE},
+  {"person", NVDS_OBJECT_TYPE_PERSON},
+  {"face", NVDS_OBJECT_TYPE_FACE},
+};
+
+/** Results of one thread. */
+typedef struct {
+  guint64 messages;
+  guint64 bytes;
+  guint64 allocs;
+  guint64 failures;
+  /** latency of each nvds_msg2p_generate call in ns. */
+  std::vector<guint32> latency;
+} NvDsBenchResult;
+
+typedef struct {
+  NvDsMsg2pCtx *ctx;
+  NvDsEvent *events;
+  guint iterations;
+  guint batch;
+  volatile gint *start;
+  NvDsBenchResult result;
+} NvDsBenchThread;
+
+static gchar *configFile = NULL;
+static gint numSensors = 1000;
+static gchar *eventMix = NULL;
+static gchar *objectMix = NULL;
+static gchar *signatureLen = NULL;
+static gchar *payloadTypeName = NULL;
+static gchar *threadCounts = NULL;
+static gchar **schemaOptions = NULL;
+static gint numMessages = 100000;
+static gint batchSize = 1;
+static gboolean epochTs = FALSE;
+static gboolean jsonOutput = FALSE;
+
+static GOptionEntry entries[] = {
+  {"config", 'c', 0, G_OPTION_ARG_FILENAME, &configFile,
+      "Configuration file, generated for --sensors entries if not set", NULL},
+  {"sensors", 's', 0, G_OPTION_ARG_INT, &numSensors,
+      "Number of sensor / place / analytics entries (default 1000)", "N"},
+  {"events", 'e', 0, G_OPTION_ARG_STRING, &eventMix,
+      "Event type mix (default entry,exit,moving)", "TYPE[:WEIGHT],..."},
+  {"objects", 'o', 0, G_OPTION_ARG_STRING, &objectMix,
+      "Object type mix (default vehicle:6,person:3,face:1)",
+      "TYPE[:WEIGHT],..."},
+  {"signature", 'g', 0, G_OPTION_ARG_STRING, &signatureLen,
+      "Object signature length (default 0)", "MIN[-MAX]"},
+  {"payload", 'p', 0, G_OPTION_ARG_STRING, &payloadTypeName,
+      "Payload type, deepstream or binary (default deepstream)", "TYPE"},
+  {"schema", 0, 0, G_OPTION_ARG_STRING_ARRAY, &schemaOptions,
+      "[schema] option of generated configuration", "KEY=VALUE"},
+  {"threads", 't', 0, G_OPTION_ARG_STRING, &threadCounts,
+      "Thread counts to run with (default 1,4)", "N,..."},
+  {"messages", 'n', 0, G_OPTION_ARG_INT, &numMessages,
+      "Messages generated per thread (default 100000)", "N"},
+  {"batch", 'b', 0, G_OPTION_ARG_INT, &batchSize,
+      "Events per nvds_msg2p_generate_batch call (default 1)", "N"},
+  {"epoch-ts", 0, 0, G_OPTION_ARG_NONE, &epochTs,
+      "Events carry tsEpochNs instead of ts string", NULL},
+  {"json", 'j', 0, G_OPTION_ARG_NONE, &jsonOutput,
+      "Print one json object per run", NULL},
+  {NULL},
+};
+
+/*
+ * Heap allocations are counted by interposing glibc allocation functions,
+ * library and glib allocations resolve to these too.
+ */
+#ifdef __GLIBC__
+#define COUNT_ALLOCS 1
+
+extern "C" {
+void *__libc_malloc (size_t size);
+void *__libc_calloc (size_t num, size_t size);
+void *__libc_realloc (void *ptr, size_t size);
+void *__libc_memalign (size_t alignment, size_t size);
+}
+
+static __thread guint64 allocCount;
+
+extern "C" void *
+malloc (size_t size)
+{
+  allocCount++;
+  return __libc_malloc (size);
+}
+
+extern "C" void *
+calloc (size_t num, size_t size)
+{
+  allocCount++;
+  return __libc_calloc (num, size);
+}
+
+extern "C" void *
+realloc (void *ptr, size_t size)
+{
+  allocCount++;
+  return __libc_realloc (ptr, size);
+}
+
+extern "C" int
+posix_memalign (void **ptr, size_t alignment, size_t size)
+{
+  allocCount++;
+  *ptr = __libc_memalign (alignment, size);
+  return *ptr ? 0 : ENOMEM;
+}
+
+extern "C" void *
+aligned_alloc (size_t alignment, size_t size)
+{
+  allocCount++;
+  return __libc_memalign (alignment, size);
+}
+#else
+#define COUNT_ALLOCS 0
+static guint64 allocCount;
+#endif
+
+static inline guint64
+now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Parses "name[:weight],..." into a table where each value appears weight
+ * times, so a uniformly random element follows the mix.
+ */
+static gboolean
+parse_mix (const gchar *str, const NvDsBenchName *names, guint numNames,
+           std::vector<gint> &table)
+{
+  gchar **items = g_strsplit (str, ",", -1);
+  gboolean ret = FALSE;
+  gchar **item;
+  gchar *sep;
+  gint weight;
+  guint i;
+
+  for (item = items; *item; item++) {
+    weight = 1;
+    sep = strchr (*item, ':');
+    if (sep) {
+      *sep = '\0';
+      weight = atoi (sep + 1);
+    }
+    g_strstrip (*item);
+
+    for (i = 0; i < numNames; i++) {
+      if (!g_strcmp0 (*item, names[i].name))
+        break;
+    }
+    if (i == numNames || weight < 0 || weight > 1000) {
+      fprintf (stderr, "Invalid mix entry %s\n", *item);
+      goto done;
+    }
+    table.insert (table.end (), weight, names[i].value);
+  }
+  ret = !table.empty ();
+
+done:
+  g_strfreev (items);
+  return ret;
+}
+
+static gboolean
+write_config (const gchar *file)
+{
+  FILE *fp = fopen (file, "w");
+  gint i;
+
+  if (!fp)
+    return FALSE;
+
+  fprintf (fp, "[schema]\n");
+  if (epochTs)
+    fprintf (fp, "ts-epoch-ns=1\n");
+  for (i = 0; schemaOptions && schemaOptions[i]; i++)
+    fprintf (fp, "%s\n", schemaOptions[i]);
+
+  for (i = 0; i < numSensors; i++) {
+    fprintf (fp, "\n[sensor%d]\nenable=1\ntype=Camera\nid=CAM_%d\n"
+             "location=45.293701447;-75.8303914499;48.1557479338\n"
+             "description=Entrance of garage lane %d\n"
+             "coordinate=5.2;10.1;11.2\n", i, i, i);
+    fprintf (fp, "\n[place%d]\nenable=1\nid=%d\ntype=garage\nname=XYZ\n"
+             "location=30.32;-40.55;100.0\ncoordinate=1.0;2.0;3.0\n"
+             "place-sub-field1=walsh\nplace-sub-field2=lane%d\n"
+             "place-sub-field3=P2\n", i, i, i % 8);
+    fprintf (fp, "\n[analytics%d]\nenable=1\nid=XYZ_%d\n"
+             "description=Vehicle Detection and License Plate Recognition\n"
+             "source=OpenALR\nversion=1.0\n", i, i);
+  }
+
+  return fclose (fp) == 0;
+}
+
+static NvDsVehicleObject vehicle = {
+  (gchar *) "sedan", (gchar *) "Bugatti", (gchar *) "M",
+  (gchar *) "blue", (gchar *) "CA", (gchar *) "XX1234"
+};
+
+static NvDsPersonObject person = {
+  (gchar *) "female", (gchar *) "black", (gchar *) "none",
+  (gchar *) "formal", 35
+};
+
+static NvDsFaceObject face = {
+  (gchar *) "male", (gchar *) "black", (gchar *) "none", (gchar *) "none",
+  (gchar *) "none", (gchar *) "John", (gchar *) "brown", 42
+};
+
+static void
+init_metas (NvDsEventMsgMeta *metas, NvDsEvent *events,
+            const std::vector<gint> &eventTable,
+            const std::vector<gint> &objectTable, guint minSig, guint maxSig)
+{
+  NvDsEventMsgMeta *meta;
+  guint i, j;
+
+  for (i = 0; i < NUM_METAS; i++) {
+    meta = &metas[i];
+    memset (meta, 0, sizeof (NvDsEventMsgMeta));
+
+    meta->type = (NvDsEventType) eventTable[rand () % eventTable.size ()];
+    meta->objType = (NvDsObjectType) objectTable[rand () % objectTable.size ()];
+    meta->sensorId = rand () % numSensors;
+    meta->placeId = meta->sensorId;
+    meta->moduleId = meta->sensorId;
+    meta->trackingId = i;
+    meta->confidence = (rand () % 1000) / 1000.0;
+    meta->bbox.top = rand () % 1080;
+    meta->bbox.left = rand () % 1920;
+    meta->bbox.width = 32 + rand () % 256;
+    meta->bbox.height = 32 + rand () % 256;
+    meta->location.lat = 45.29 + (rand () % 1000) / 1e5;
+    meta->location.lon = -75.83 + (rand () % 1000) / 1e5;
+    meta->coordinate.x = rand () % 100 / 7.0;
+    meta->coordinate.y = rand () % 100 / 7.0;
+    if (epochTs)
+      meta->tsEpochNs = G_GUINT64_CONSTANT (1536577200000000000) +
+          (guint64) i * 1000000 * 1037;
+    else
+      meta->ts = g_strdup_printf ("2018-09-10T11:%02u:%02u.%03uZ",
+                                  (i / 60) % 60, i % 60, (i * 37) % 1000);
+    meta->objectId = g_strdup_printf ("%u", i);
+
+    meta->objSignature.size = minSig + rand () % (maxSig - minSig + 1);
+    if (meta->objSignature.size) {
+      meta->objSignature.signature = g_new (gdouble, meta->objSignature.size);
+      for (j = 0; j < meta->objSignature.size; j++)
+        meta->objSignature.signature[j] = rand () / (gdouble) RAND_MAX - 0.5;
+    }
+
+    switch (meta->objType) {
+      case NVDS_OBJECT_TYPE_VEHICLE:
+        meta->extMsg = &vehicle;
+        meta->extMsgSize = sizeof (vehicle);
+        break;
+      case NVDS_OBJECT_TYPE_PERSON:
+        meta->extMsg = &person;
+        meta->extMsgSize = sizeof (person);
+        break;
+      case NVDS_OBJECT_TYPE_FACE:
+        meta->extMsg = &face;
+        meta->extMsgSize = sizeof (face);
+        break;
+      default:
+        break;
+    }
+
+    events[i].eventType = meta->type;
+    events[i].metadata = meta;
+  }
+}
+
+static void
+free_metas (NvDsEventMsgMeta *metas)
+{
+  guint i;
+
+  for (i = 0; i < NUM_METAS; i++) {
+    g_free (metas[i].ts);
+    g_free (metas[i].objectId);
+    g_free (metas[i].objSignature.signature);
+  }
+}
+
+static gpointer
+bench_thread (gpointer data)
+{
+  NvDsBenchThread *thread = (NvDsBenchThread *) data;
+  NvDsBenchResult *result = &thread->result;
+  NvDsPayload *payload;
+  NvDsMsg2pBatchFormat format = NVDS_MSG2P_BATCH_JSON_ARRAY;
+  guint64 allocs;
+  guint64 start;
+  guint64 end;
+  guint offset = 0;
+  guint i;
+
+  result->latency.resize (thread->iterations);
+  if (thread->ctx->payloadType == NVDS_PAYLOAD_DEEPSTREAM_BINARY)
+    format = NVDS_MSG2P_BATCH_FRAMED;
+
+  while (!g_atomic_int_get (thread->start))
+    g_thread_yield ();
+
+  allocs = allocCount;
+  for (i = 0; i < thread->iterations; i++) {
+    start = now_ns ();
+    if (thread->batch > 1)
+      payload = nvds_msg2p_generate_batch (thread->ctx,
+                                           &thread->events[offset],
+                                           thread->batch, format);
+    else
+      payload = nvds_msg2p_generate (thread->ctx, &thread->events[offset], 1);
+    if (payload) {
+      result->bytes += payload->payloadSize;
+      nvds_msg2p_release (thread->ctx, payload);
+    } else {
+      result->failures++;
+    }
+    end = now_ns ();
+
+    result->latency[i] = MIN (end - start, (guint64) G_MAXUINT32);
+    offset += thread->batch;
+    if (offset + thread->batch > NUM_METAS)
+      offset = 0;
+  }
+  result->allocs = allocCount - allocs;
+  result->messages = (guint64) thread->iterations * thread->batch;
+
+  return NULL;
+}
+
+/** Generates numMessages per thread, warm up round isn't reported. */
+static gboolean
+run (NvDsMsg2pCtx *ctx, NvDsEvent *events, guint numThreads, gboolean report)
+{
+  std::vector<NvDsBenchThread> threads (numThreads);
+  std::vector<GThread *> handles (numThreads);
+  std::vector<guint32> latency;
+  guint64 messages = 0;
+  guint64 bytes = 0;
+  guint64 allocs = 0;
+  guint64 failures = 0;
+  guint64 start;
+  gdouble elapsed;
+  gdouble p50, p99;
+  volatile gint go = 0;
+  guint i;
+
+  for (i = 0; i < numThreads; i++) {
+    threads[i].ctx = ctx;
+    threads[i].events = events;
+    threads[i].iterations = MAX (numMessages / batchSize, 1);
+    threads[i].batch = batchSize;
+    threads[i].start = &go;
+    threads[i].result.messages = 0;
+    threads[i].result.bytes = 0;
+    threads[i].result.allocs = 0;
+    threads[i].result.failures = 0;
+    handles[i] = g_thread_new ("bench", bench_thread, &threads[i]);
+  }
+
+  start = now_ns ();
+  g_atomic_int_set (&go, 1);
+  for (i = 0; i < numThreads; i++)
+    g_thread_join (handles[i]);
+  elapsed = (now_ns () - start) / 1e9;
+
+  for (i = 0; i < numThreads; i++) {
+    NvDsBenchResult *result = &threads[i].result;
+
+    messages += result->messages;
+    bytes += result->bytes;
+    allocs += result->allocs;
+    failures += result->failures;
+    latency.insert (latency.end (), result->latency.begin (),
+                    result->latency.end ());
+  }
+
+  if (failures) {
+    fprintf (stderr, "%lu of %lu payloads were not generated\n",
+             (gulong) failures, (gulong) (failures + messages / batchSize));
+    return FALSE;
+  }
+  if (!report)
+    return TRUE;
+
+  std::nth_element (latency.begin (), latency.begin () + latency.size () / 2,
+                    latency.end ());
+  p50 = latency[latency.size () / 2] / 1000.0;
+  std::nth_element (latency.begin (),
+                    latency.begin () + latency.size () * 99 / 100,
+                    latency.end ());
+  p99 = latency[latency.size () * 99 / 100] / 1000.0;
+
+  if (jsonOutput) {
+    printf ("{\"version\": \"%d.%d\", \"payload\": \"%s\", \"threads\": %u, "
+            "\"batch\": %d, \"sensors\": %d, \"events\": \"%s\", "
+            "\"objects\": \"%s\", \"signature\": \"%s\", "
+            "\"messages\": %lu, \"seconds\": %.6f, \"msgs_per_sec\": %.1f, "
+            "\"bytes_per_sec\": %.1f, \"bytes_per_msg\": %.1f, "
+            "\"p50_us\": %.3f, \"p99_us\": %.3f, \"allocs_per_msg\": %.3f}\n",
+            NVDS_VERSION_MAJOR, NVDS_VERSION_MINOR, payloadTypeName,
+            numThreads, batchSize, numSensors, eventMix, objectMix,
+            signatureLen, (gulong) messages, elapsed, messages / elapsed,
+            bytes / elapsed, (gdouble) bytes / messages, p50, p99,
+            COUNT_ALLOCS ? (gdouble) allocs / messages : -1.0);
+  } else {
+    printf ("%2u thread(s) %10.0f msgs/sec %8.1f MB/sec %7.1f bytes/msg "
+            "p50 %7.2f us p99 %7.2f us", numThreads, messages / elapsed,
+            bytes / elapsed / 1e6, (gdouble) bytes / messages, p50, p99);
+    if (COUNT_ALLOCS)
+      printf (" %6.2f allocs/msg", (gdouble) allocs / messages);
+    printf ("\n");
+  }
+  fflush (stdout);
+  return TRUE;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *optCtx = NULL;
+  GError *error = NULL;
+  NvDsMsg2pCtx *ctx = NULL;
+  NvDsPayloadType payloadType;
+  NvDsEventMsgMeta *metas = NULL;
+  NvDsEvent *events = NULL;
+  std::vector<gint> eventTable;
+  std::vector<gint> objectTable;
+  gchar tmpFile[] = "/tmp/nvmsgconv_bench_XXXXXX";
+  gchar **counts = NULL;
+  guint minSig = 0, maxSig = 0;
+  gint numThreads;
+  gint fd = -1;
+  gint ret = -1;
+  guint i;
+
+  optCtx = g_option_context_new ("- nvmsgconv throughput benchmark");
+  g_option_context_add_main_entries (optCtx, entries, NULL);
+  if (!g_option_context_parse (optCtx, &argc, &argv, &error)) {
+    fprintf (stderr, "%s\n", error ? error->message : "Invalid arguments");
+    goto done;
+  }
+
+  if (!eventMix)
+    eventMix = g_strdup ("entry,exit,moving");
+  if (!objectMix)
+    objectMix = g_strdup ("vehicle:6,person:3,face:1");
+  if (!signatureLen)
+    signatureLen = g_strdup ("0");
+  if (!payloadTypeName)
+    payloadTypeName = g_strdup ("deepstream");
+  if (!threadCounts)
+    threadCounts = g_strdup ("1,4");
+
+  if (!parse_mix (eventMix, eventNames, G_N_ELEMENTS (eventNames),
+                  eventTable) ||
+      !parse_mix (objectMix, objectNames, G_N_ELEMENTS (objectNames),
+                  objectTable))
+    goto done;
+
+  if (sscanf (signatureLen, "%u-%u", &minSig, &maxSig) == 1)
+    maxSig = minSig;
+  if (maxSig < minSig || maxSig > MAX_SIGNATURE_LEN) {
+    fprintf (stderr, "Invalid signature length %s\n", signatureLen);
+    goto done;
+  }
+
+  if (!g_strcmp0 (payloadTypeName, "deepstream")) {
+    payloadType = NVDS_PAYLOAD_DEEPSTREAM;
+  } else if (!g_strcmp0 (payloadTypeName, "binary")) {
+    payloadType = NVDS_PAYLOAD_DEEPSTREAM_BINARY;
+  } else {
+    fprintf (stderr, "Unknown payload type %s\n", payloadTypeName);
+    goto done;
+  }
+
+  if (numSensors <= 0 || numMessages <= 0 || batchSize <= 0 ||
+      batchSize > NUM_METAS) {
+    fprintf (stderr, "Invalid sensor, message or batch count\n");
+    goto done;
+  }
+
+  if (!configFile) {
+    fd = mkstemp (tmpFile);
+    if (fd < 0) {
+      fprintf (stderr, "Unable to create configuration file\n");
+      goto done;
+    }
+    close (fd);
+    if (!write_config (tmpFile)) {
+      fprintf (stderr, "Unable to write configuration file\n");
+      goto done;
+    }
+  }
+
+  ctx = nvds_msg2p_ctx_create (configFile ? configFile : tmpFile, payloadType);
+  if (!ctx) {
+    fprintf (stderr, "Failed to create context\n");
+    goto done;
+  }
+
+  metas = g_new (NvDsEventMsgMeta, NUM_METAS);
+  events = g_new (NvDsEvent, NUM_METAS);
+  init_metas (metas, events, eventTable, objectTable, minSig, maxSig);
+
+  counts = g_strsplit (threadCounts, ",", -1);
+  for (i = 0; counts[i]; i++) {
+    numThreads = atoi (counts[i]);
+    if (numThreads <= 0 || numThreads > 1024) {
+      fprintf (stderr, "Invalid thread count %s\n", counts[i]);
+      goto done;
+    }
+    // warm up payload pool and caches
+    if (!run (ctx, events, numThreads, FALSE) ||
+        !run (ctx, events, numThreads, TRUE))
+      goto done;
+  }
+  ret = 0;
+
+done:
+  if (ctx)
+    nvds_msg2p_ctx_destroy (ctx);
+  if (metas) {
+    free_metas (metas);
+    g_free (metas);
+  }
+  g_free (events);
+  if (fd >= 0)
+    unlink (tmpFile);
+  g_strfreev (counts);
+  if (error)
+    g_error_free (error);
+  if (optCtx)
+    g_option_context_free (optCtx);
+  return ret;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Trains zstd dictionary for compression-dictionary key of nvmsgconv
+ * configuration from sample payloads, e.g. captured from the broker with one
+ * payload per line. Payloads with pretty-print should be given as one file
+ * each with --files.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <glib.h>
+#include <zdict.h>
+
+#define DEFAULT_DICT_SIZE 16384
+
+static gchar *outputFile = NULL;
+static gint dictSize = DEFAULT_DICT_SIZE;
+static gboolean wholeFiles = FALSE;
+static gchar **sampleFiles = NULL;
+
+static GOptionEntry entries[] = {
+  {"output", 'o', 0, G_OPTION_ARG_FILENAME, &outputFile,
+      "Dictionary file to write", "FILE"},
+  {"size", 's', 0, G_OPTION_ARG_INT, &dictSize,
+      "Max dictionary size in bytes (default 16384)", "N"},
+  {"files", 'f', 0, G_OPTION_ARG_NONE, &wholeFiles,
+      "Each file is one sample instead of one sample per line", NULL},
+  {G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &sampleFiles,
+      NULL, "SAMPLE_FILE..."},
+  {NULL},
+};
+
+/**
+ * Appends samples of @a data to @a samples, sizes to @a sizes.
+ */
+static void
+add_samples (const gchar *data, gsize len, std::vector<gchar> &samples,
+             std::vector<size_t> &sizes)
+{
+  const gchar *end = data + len;
+  const gchar *line = NULL;
+
+  if (wholeFiles) {
+    samples.insert (samples.end (), data, end);
+    sizes.push_back (len);
+    return;
+  }
+
+  while (data < end) {
+    line = (const gchar *) memchr (data, '\n', end - data);
+    if (!line)
+      line = end;
+    if (line > data) {
+      samples.insert (samples.end (), data, line);
+      sizes.push_back (line - data);
+    }
+    data = line + 1;
+  }
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *optCtx = NULL;
+  GError *error = NULL;
+  std::vector<gchar> samples;
+  std::vector<size_t> sizes;
+  std::vector<gchar> dict;
+  gchar *data = NULL;
+  gsize len = 0;
+  size_t ret;
+  gint i;
+  int status = -1;
+
+  optCtx = g_option_context_new ("SAMPLE_FILE... - train zstd dictionary "
+                                 "for nvmsgconv payloads");
+  g_option_context_add_main_entries (optCtx, entries, NULL);
+  if (!g_option_context_parse (optCtx, &argc, &argv, &error)) {
+    fprintf (stderr, "%s\n", error ? error->message : "Invalid arguments");
+    goto done;
+  }
+
+  if (!outputFile || !sampleFiles || dictSize <= 0) {
+    fprintf (stderr, "Output file and sample files are required\n");
+    goto done;
+  }
+
+  for (i = 0; sampleFiles[i]; i++) {
+    if (!g_file_get_contents (sampleFiles[i], &data, &len, &error)) {
+      fprintf (stderr, "%s\n", error->message);
+      goto done;
+    }
+    add_samples (data, len, samples, sizes);
+    g_free (data);
+  }
+
+  if (sizes.empty ()) {
+    fprintf (stderr, "No samples\n");
+    goto done;
+  }
+
+  dict.resize (dictSize);
+  ret = ZDICT_trainFromBuffer (dict.data (), dict.size (), samples.data (),
+                               sizes.data (), sizes.size ());
+  if (ZDICT_isError (ret)) {
+    fprintf (stderr, "Training failed: %s\n", ZDICT_getErrorName (ret));
+    goto done;
+  }
+
+  if (!g_file_set_contents (outputFile, dict.data (), ret, &error)) {
+    fprintf (stderr, "%s\n", error->message);
+    goto done;
+  }
+
+  printf ("%zu byte dictionary from %zu samples (%zu bytes) written to %s\n",
+          ret, sizes.size (), samples.size (), outputFile);
+  status = 0;
+
+done:
+  if (error)
+    g_error_free (error);
+  g_option_context_free (optCtx);
+  g_free (outputFile);
+  g_strfreev (sampleFiles);
+  return status;
+}
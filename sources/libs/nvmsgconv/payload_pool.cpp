@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#include "payload_pool.h"
+#include <vector>
+
+using namespace std;
+
+#define PAYLOAD_POOL_BUF_SIZE 4096
+#define PAYLOAD_POOL_KEY_SIZE 32
+
+struct NvDsPayloadPool {
+  GMutex lock;
+  vector<NvDsPooledPayload *> freeList;
+  guint maxFree;
+  /** payloads given out and not yet released. */
+  guint outstanding;
+  /** owner has released the pool. */
+  gboolean destroyed;
+  guint64 hits;
+  guint64 misses;
+};
+
+static void
+pooled_payload_free (NvDsPooledPayload *pooled)
+{
+  g_string_free (pooled->buf, TRUE);
+  g_string_free (pooled->key, TRUE);
+  g_free (pooled);
+}
+
+static void
+payload_pool_free (NvDsPayloadPool *pool)
+{
+  for (auto pooled : pool->freeList)
+    pooled_payload_free (pooled);
+
+  g_mutex_clear (&pool->lock);
+  delete pool;
+}
+
+NvDsPayloadPool*
+payload_pool_new (guint maxFree)
+{
+  NvDsPayloadPool *pool = new NvDsPayloadPool;
+
+  g_mutex_init (&pool->lock);
+  pool->freeList.reserve (maxFree);
+  pool->maxFree = maxFree;
+  pool->outstanding = 0;
+  pool->destroyed = FALSE;
+  pool->hits = 0;
+  pool->misses = 0;
+
+  return pool;
+}
+
+void
+payload_pool_destroy (NvDsPayloadPool *pool)
+{
+  gboolean canFree;
+
+  g_mutex_lock (&pool->lock);
+  pool->destroyed = TRUE;
+  canFree = (pool->outstanding == 0);
+  g_mutex_unlock (&pool->lock);
+
+  if (canFree)
+    payload_pool_free (pool);
+}
+
+NvDsPooledPayload*
+payload_pool_acquire (NvDsPayloadPool *pool)
+{
+  NvDsPooledPayload *pooled = NULL;
+
+  g_mutex_lock (&pool->lock);
+  if (!pool->freeList.empty ()) {
+    pooled = pool->freeList.back ();
+    pool->freeList.pop_back ();
+    pool->hits++;
+  } else {
+    pool->misses++;
+  }
+  pool->outstanding++;
+  g_mutex_unlock (&pool->lock);
+
+  if (!pooled) {
+    pooled = g_new0 (NvDsPooledPayload, 1);
+    pooled->buf = g_string_sized_new (PAYLOAD_POOL_BUF_SIZE);
+    pooled->key = g_string_sized_new (PAYLOAD_POOL_KEY_SIZE);
+    pooled->pool = pool;
+  }
+
+  g_string_truncate (pooled->buf, 0);
+  pooled->payload.payload = NULL;
+  pooled->payload.payloadSize = 0;
+  pooled->payload.componentId = 0;
+  pooled->payload.key = NULL;
+  pooled->payload.keyLen = 0;
+  pooled->refCount = 1;
+
+  return pooled;
+}
+
+void
+payload_pool_set_key (NvDsPooledPayload *pooled, const gchar *key)
+{
+  g_string_assign (pooled->key, key);
+  pooled->payload.key = pooled->key->str;
+  pooled->payload.keyLen = pooled->key->len;
+}
+
+NvDsPayload*
+payload_pool_finish (NvDsPooledPayload *pooled)
+{
+  pooled->payload.payload = pooled->buf->str;
+  pooled->payload.payloadSize = pooled->buf->len;
+  return &pooled->payload;
+}
+
+NvDsPayload*
+payload_pool_ref (NvDsPayload *payload)
+{
+  NvDsPooledPayload *pooled = (NvDsPooledPayload *) payload;
+
+  g_atomic_int_inc (&pooled->refCount);
+  return payload;
+}
+
+void
+payload_pool_unref (NvDsPayload *payload)
+{
+  NvDsPooledPayload *pooled = (NvDsPooledPayload *) payload;
+  NvDsPayloadPool *pool = pooled->pool;
+  gboolean canFree;
+
+  if (!g_atomic_int_dec_and_test (&pooled->refCount))
+    return;
+
+  g_mutex_lock (&pool->lock);
+  if (!pool->destroyed && pool->freeList.size () < pool->maxFree) {
+    pool->freeList.push_back (pooled);
+    pooled = NULL;
+  }
+  pool->outstanding--;
+  canFree = (pool->destroyed && pool->outstanding == 0);
+  g_mutex_unlock (&pool->lock);
+
+  if (pooled)
+    pooled_payload_free (pooled);
+
+  if (canFree)
+    payload_pool_free (pool);
+}
+
+void
+payload_pool_get_stats (NvDsPayloadPool *pool, guint64 *hits, guint64 *misses)
+{
+  g_mutex_lock (&pool->lock);
+  *hits = pool->hits;
+  *misses = pool->misses;
+  g_mutex_unlock (&pool->lock);
+}
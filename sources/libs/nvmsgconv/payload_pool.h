@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#ifndef _NVDS_PAYLOAD_POOL_H_
+#define _NVDS_PAYLOAD_POOL_H_
+
+#include "nvdsmeta.h"
+#include <glib.h>
+
+struct NvDsPayloadPool;
+
+/**
+ * Refcounted payload whose data is the pooled buffer itself, messages are
+ * written in place and @a payload points to the buffer contents.
+ */
+struct NvDsPooledPayload {
+  /** must be first, NvDsPayload pointers given out are cast back. */
+  NvDsPayload payload;
+  GString *buf;
+  /** storage of payload key, reused with the buffer. */
+  GString *key;
+  gint refCount;
+  NvDsPayloadPool *pool;
+};
+
+/**
+ * Creates pool which keeps at most @a maxFree released buffers for reuse.
+ */
+NvDsPayloadPool* payload_pool_new (guint maxFree);
+
+/**
+ * Releases reference of the owner. Pool is freed once all the payloads
+ * acquired from it are released, those can outlive the owner.
+ */
+void payload_pool_destroy (NvDsPayloadPool *pool);
+
+/** Returns payload with one reference and empty buffer. */
+NvDsPooledPayload* payload_pool_acquire (NvDsPayloadPool *pool);
+
+/** Sets key of payload to a copy of @a key. */
+void payload_pool_set_key (NvDsPooledPayload *pooled, const gchar *key);
+
+/** Updates payload fields once message is written to the buffer. */
+NvDsPayload* payload_pool_finish (NvDsPooledPayload *pooled);
+
+NvDsPayload* payload_pool_ref (NvDsPayload *payload);
+
+/** Buffer goes back to pool when last reference is released. */
+void payload_pool_unref (NvDsPayload *payload);
+
+void payload_pool_get_stats (NvDsPayloadPool *pool, guint64 *hits,
+                             guint64 *misses);
+
+#endif
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#include "payload_template.h"
+#include <string.h>
+#include <iostream>
+
+using namespace std;
+
+/** placeholder names, indexed by NvDsTemplateField. */
+static const gchar *templateFields[NVDS_TPL_MAX] = {
+  NULL,
+  "messageid",
+  "@timestamp",
+  "event.id",
+  "event.type",
+  "sensorId",
+  "placeId",
+  "moduleId",
+  "componentId",
+  "object.id",
+  "object.objectId",
+  "object.type",
+  "object.classId",
+  "object.confidence",
+  "object.bbox.topleftx",
+  "object.bbox.toplefty",
+  "object.bbox.bottomrightx",
+  "object.bbox.bottomrighty",
+  "object.bbox.width",
+  "object.bbox.height",
+  "object.location.lat",
+  "object.location.lon",
+  "object.location.alt",
+  "object.coordinate.x",
+  "object.coordinate.y",
+  "object.coordinate.z",
+  "otherAttrs",
+  "videoPath",
+  "sensor.id",
+  "sensor.type",
+  "sensor.description",
+  "sensor.location.lat",
+  "sensor.location.lon",
+  "sensor.location.alt",
+  "sensor.coordinate.x",
+  "sensor.coordinate.y",
+  "sensor.coordinate.z",
+  "place.id",
+  "place.name",
+  "place.type",
+  "place.location.lat",
+  "place.location.lon",
+  "place.location.alt",
+  "place.coordinate.x",
+  "place.coordinate.y",
+  "place.coordinate.z",
+  "place.subField1",
+  "place.subField2",
+  "place.subField3",
+  "analyticsModule.id",
+  "analyticsModule.description",
+  "analyticsModule.source",
+  "analyticsModule.version",
+};
+
+static guint
+get_field_needs (gint field)
+{
+  if (field >= NVDS_TPL_SENSOR_STR_ID && field <= NVDS_TPL_SENSOR_Z)
+    return NVDS_TPL_NEEDS_SENSOR;
+  if (field >= NVDS_TPL_PLACE_STR_ID && field <= NVDS_TPL_PLACE_SUB_FIELD3)
+    return NVDS_TPL_NEEDS_PLACE;
+  if (field >= NVDS_TPL_ANALYTICS_ID && field <= NVDS_TPL_ANALYTICS_VERSION)
+    return NVDS_TPL_NEEDS_ANALYTICS;
+  return 0;
+}
+
+/** Appends literal, merged with previous one if any. */
+static void
+add_literal (NvDsPayloadTemplate *tpl, const gchar *str, gsize len)
+{
+  NvDsTemplateOp op;
+
+  if (!len)
+    return;
+
+  if (!tpl->ops.empty () && tpl->ops.back ().field == NVDS_TPL_LITERAL) {
+    tpl->ops.back ().len += len;
+  } else {
+    op.field = NVDS_TPL_LITERAL;
+    op.start = tpl->text.size ();
+    op.len = len;
+    tpl->ops.push_back (op);
+  }
+  tpl->text.append (str, len);
+}
+
+static guint
+get_line (const gchar *text, const gchar *p)
+{
+  guint line = 1;
+
+  for (; text < p; text++)
+    line += *text == '\n';
+  return line;
+}
+
+gboolean
+template_compile (NvDsPayloadTemplate *tpl, const gchar *text,
+                  const gchar *name)
+{
+  const gchar *p = text;
+  const gchar *open = NULL;
+  const gchar *close = NULL;
+  gchar *field = NULL;
+  NvDsTemplateOp op;
+  gint i;
+
+  tpl->text.clear ();
+  tpl->ops.clear ();
+  tpl->needs = 0;
+
+  while ((open = strstr (p, "{{"))) {
+    add_literal (tpl, p, open - p);
+
+    close = strstr (open + 2, "}}");
+    if (!close) {
+      cout << "Unterminated placeholder in " << name << " line "
+           << get_line (text, open) << endl;
+      return FALSE;
+    }
+
+    field = g_strstrip (g_strndup (open + 2, close - open - 2));
+    for (i = NVDS_TPL_LITERAL + 1; i < NVDS_TPL_MAX; i++) {
+      if (!strcmp (field, templateFields[i]))
+        break;
+    }
+    if (i == NVDS_TPL_MAX) {
+      cout << "Unknown field " << field << " in " << name << " line "
+           << get_line (text, open) << endl;
+      g_free (field);
+      return FALSE;
+    }
+    g_free (field);
+
+    op.field = (NvDsTemplateField) i;
+    op.start = 0;
+    op.len = 0;
+    tpl->ops.push_back (op);
+    tpl->needs |= get_field_needs (i);
+    p = close + 2;
+  }
+  add_literal (tpl, p, strlen (p));
+
+  return TRUE;
+}
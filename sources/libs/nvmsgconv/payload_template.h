@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#ifndef _NVDS_PAYLOAD_TEMPLATE_H_
+#define _NVDS_PAYLOAD_TEMPLATE_H_
+
+#include <glib.h>
+#include <string>
+#include <vector>
+
+/**
+ * Values which can be referenced by {{name}} placeholders of custom payload
+ * template, see templateFields for their names.
+ */
+enum NvDsTemplateField {
+  /** literal text between placeholders. */
+  NVDS_TPL_LITERAL,
+  NVDS_TPL_MESSAGE_ID,
+  NVDS_TPL_TIMESTAMP,
+  NVDS_TPL_EVENT_ID,
+  NVDS_TPL_EVENT_TYPE,
+  NVDS_TPL_SENSOR_ID,
+  NVDS_TPL_PLACE_ID,
+  NVDS_TPL_MODULE_ID,
+  NVDS_TPL_COMPONENT_ID,
+  NVDS_TPL_OBJECT_ID,
+  NVDS_TPL_OBJECT_OBJECT_ID,
+  NVDS_TPL_OBJECT_TYPE,
+  NVDS_TPL_OBJECT_CLASS_ID,
+  NVDS_TPL_OBJECT_CONFIDENCE,
+  NVDS_TPL_OBJECT_BBOX_LEFT,
+  NVDS_TPL_OBJECT_BBOX_TOP,
+  NVDS_TPL_OBJECT_BBOX_RIGHT,
+  NVDS_TPL_OBJECT_BBOX_BOTTOM,
+  NVDS_TPL_OBJECT_BBOX_WIDTH,
+  NVDS_TPL_OBJECT_BBOX_HEIGHT,
+  NVDS_TPL_OBJECT_LAT,
+  NVDS_TPL_OBJECT_LON,
+  NVDS_TPL_OBJECT_ALT,
+  NVDS_TPL_OBJECT_X,
+  NVDS_TPL_OBJECT_Y,
+  NVDS_TPL_OBJECT_Z,
+  NVDS_TPL_OTHER_ATTRS,
+  NVDS_TPL_VIDEO_PATH,
+  /** fields of [sensorN] entry of sensorId. */
+  NVDS_TPL_SENSOR_STR_ID,
+  NVDS_TPL_SENSOR_TYPE,
+  NVDS_TPL_SENSOR_DESCRIPTION,
+  NVDS_TPL_SENSOR_LAT,
+  NVDS_TPL_SENSOR_LON,
+  NVDS_TPL_SENSOR_ALT,
+  NVDS_TPL_SENSOR_X,
+  NVDS_TPL_SENSOR_Y,
+  NVDS_TPL_SENSOR_Z,
+  /** fields of [placeN] entry of placeId. */
+  NVDS_TPL_PLACE_STR_ID,
+  NVDS_TPL_PLACE_NAME,
+  NVDS_TPL_PLACE_TYPE,
+  NVDS_TPL_PLACE_LAT,
+  NVDS_TPL_PLACE_LON,
+  NVDS_TPL_PLACE_ALT,
+  NVDS_TPL_PLACE_X,
+  NVDS_TPL_PLACE_Y,
+  NVDS_TPL_PLACE_Z,
+  NVDS_TPL_PLACE_SUB_FIELD1,
+  NVDS_TPL_PLACE_SUB_FIELD2,
+  NVDS_TPL_PLACE_SUB_FIELD3,
+  /** fields of [analyticsN] entry of moduleId. */
+  NVDS_TPL_ANALYTICS_ID,
+  NVDS_TPL_ANALYTICS_DESCRIPTION,
+  NVDS_TPL_ANALYTICS_SOURCE,
+  NVDS_TPL_ANALYTICS_VERSION,
+  NVDS_TPL_MAX
+};
+
+/** configuration tables referenced by a template. */
+#define NVDS_TPL_NEEDS_SENSOR (1 << 0)
+#define NVDS_TPL_NEEDS_PLACE (1 << 1)
+#define NVDS_TPL_NEEDS_ANALYTICS (1 << 2)
+
+struct NvDsTemplateOp {
+  NvDsTemplateField field;
+  /** text of NVDS_TPL_LITERAL in NvDsPayloadTemplate::text. */
+  guint start;
+  guint len;
+};
+
+/**
+ * Custom payload template compiled for generation: payload is the
+ * concatenation of ops, each appending a literal or a value of the event.
+ */
+struct NvDsPayloadTemplate {
+  /** literal text, referenced by ops. */
+  std::string text;
+  std::vector<NvDsTemplateOp> ops;
+  /** NVDS_TPL_NEEDS_* of ops, tables are only looked up when needed. */
+  guint needs;
+};
+
+/**
+ * Compiles template text, e.g.
+ *
+ * @code
+ *   {"id":"{{messageid}}","camera":"{{sensor.id}}","track":{{object.id}}}
+ * @endcode
+ *
+ * Placeholders are {{name}} with optional spaces around name. String
+ * values are json escaped, numbers written as is, so quotes belong to the
+ * template. Text outside placeholders is copied unchanged.
+ *
+ * @return FALSE for unknown field or unterminated placeholder, reported
+ * with its line in @a name.
+ */
+gboolean template_compile (NvDsPayloadTemplate *tpl, const gchar *text,
+                           const gchar *name);
+
+#endif
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#include "projection.h"
+#include <iostream>
+
+using namespace std;
+
+struct NvDsFieldDesc {
+  const gchar *path;
+  /** containing object, NVDS_FIELD_MAX for root members. */
+  NvDsField parent;
+  /** written without projection profile. */
+  gboolean isDefault;
+};
+
+/** indexed by NvDsField. */
+static const NvDsFieldDesc fieldDescs[NVDS_FIELD_MAX] = {
+  {"messageid", NVDS_FIELD_MAX, TRUE},
+  {"mdsversion", NVDS_FIELD_MAX, TRUE},
+  {"@timestamp", NVDS_FIELD_MAX, TRUE},
+  {"place", NVDS_FIELD_MAX, TRUE},
+  {"place.id", NVDS_FIELD_PLACE, TRUE},
+  {"place.name", NVDS_FIELD_PLACE, TRUE},
+  {"place.type", NVDS_FIELD_PLACE, TRUE},
+  {"place.location", NVDS_FIELD_PLACE, TRUE},
+  {"place.aisle", NVDS_FIELD_PLACE, TRUE},
+  {"place.parkingSpot", NVDS_FIELD_PLACE, TRUE},
+  {"place.entrance", NVDS_FIELD_PLACE, TRUE},
+  {"sensor", NVDS_FIELD_MAX, TRUE},
+  {"sensor.id", NVDS_FIELD_SENSOR, TRUE},
+  {"sensor.type", NVDS_FIELD_SENSOR, TRUE},
+  {"sensor.description", NVDS_FIELD_SENSOR, TRUE},
+  {"sensor.location", NVDS_FIELD_SENSOR, TRUE},
+  {"sensor.coordinate", NVDS_FIELD_SENSOR, TRUE},
+  {"analyticsModule", NVDS_FIELD_MAX, TRUE},
+  {"analyticsModule.id", NVDS_FIELD_ANALYTICS, TRUE},
+  {"analyticsModule.description", NVDS_FIELD_ANALYTICS, TRUE},
+  {"analyticsModule.source", NVDS_FIELD_ANALYTICS, TRUE},
+  {"analyticsModule.version", NVDS_FIELD_ANALYTICS, TRUE},
+  {"analyticsModule.confidence", NVDS_FIELD_ANALYTICS, TRUE},
+  {"object", NVDS_FIELD_MAX, TRUE},
+  {"object.id", NVDS_FIELD_OBJECT, TRUE},
+  {"object.speed", NVDS_FIELD_OBJECT, TRUE},
+  {"object.direction", NVDS_FIELD_OBJECT, TRUE},
+  {"object.orientation", NVDS_FIELD_OBJECT, TRUE},
+  {"object.vehicle", NVDS_FIELD_OBJECT, TRUE},
+  {"object.person", NVDS_FIELD_OBJECT, TRUE},
+  {"object.face", NVDS_FIELD_OBJECT, TRUE},
+  {"object.bbox", NVDS_FIELD_OBJECT, TRUE},
+  {"object.signature", NVDS_FIELD_OBJECT, TRUE},
+  {"object.location", NVDS_FIELD_OBJECT, TRUE},
+  {"object.coordinate", NVDS_FIELD_OBJECT, TRUE},
+  {"object.classId", NVDS_FIELD_OBJECT, FALSE},
+  {"object.confidence", NVDS_FIELD_OBJECT, FALSE},
+  {"event", NVDS_FIELD_MAX, TRUE},
+  {"event.id", NVDS_FIELD_EVENT, TRUE},
+  {"event.type", NVDS_FIELD_EVENT, TRUE},
+  {"videoPath", NVDS_FIELD_MAX, TRUE},
+};
+
+static void
+select_field (guint64 *fields, gint field)
+{
+  gint i;
+
+  *fields |= NVDS_FIELD_BIT (field);
+
+  // all default members of an object
+  for (i = 0; i < NVDS_FIELD_MAX; i++) {
+    if (fieldDescs[i].parent == field && fieldDescs[i].isDefault)
+      *fields |= NVDS_FIELD_BIT (i);
+  }
+
+  if (fieldDescs[field].parent != NVDS_FIELD_MAX)
+    *fields |= NVDS_FIELD_BIT (fieldDescs[field].parent);
+}
+
+gboolean
+projection_compile (NvDsProjection *proj, const gchar * const *paths)
+{
+  guint64 fields = 0;
+  gint field;
+  gint i;
+
+  if (!paths) {
+    for (field = 0; field < NVDS_FIELD_MAX; field++) {
+      if (fieldDescs[field].isDefault)
+        fields |= NVDS_FIELD_BIT (field);
+    }
+  }
+
+  for (i = 0; paths && paths[i]; i++) {
+    for (field = 0; field < NVDS_FIELD_MAX; field++) {
+      if (!g_strcmp0 (paths[i], fieldDescs[field].path))
+        break;
+    }
+    if (field == NVDS_FIELD_MAX) {
+      cout << "Unknown field " << paths[i] << " in projection" << endl;
+      return FALSE;
+    }
+    select_field (&fields, field);
+  }
+
+  proj->fields = fields;
+  proj->custom = paths != NULL;
+  proj->plan.clear ();
+
+  for (field = 0; field < NVDS_FIELD_MAX; field++) {
+    if (fieldDescs[field].parent != NVDS_FIELD_MAX ||
+        !(fields & NVDS_FIELD_BIT (field)))
+      continue;
+
+    proj->plan.push_back (field);
+
+    // members of place, sensor and analyticsModule are rendered in fragments
+    if (field != NVDS_FIELD_OBJECT && field != NVDS_FIELD_EVENT)
+      continue;
+
+    for (i = field + 1; i < NVDS_FIELD_MAX; i++) {
+      if (fieldDescs[i].parent == field && (fields & NVDS_FIELD_BIT (i)))
+        proj->plan.push_back (i);
+    }
+    proj->plan.push_back (NVDS_FIELD_END);
+  }
+
+  return TRUE;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#ifndef _NVDS_PROJECTION_H_
+#define _NVDS_PROJECTION_H_
+
+#include <glib.h>
+#include <vector>
+
+/**
+ * Members of DeepStream schema message which can be selected, in the order
+ * they are written. Members of place, sensor and analyticsModule objects are
+ * selected as a whole (e.g. place.location), so are bbox, location and
+ * coordinate of object.
+ */
+enum NvDsField {
+  NVDS_FIELD_MESSAGE_ID,
+  NVDS_FIELD_MDS_VERSION,
+  NVDS_FIELD_TIMESTAMP,
+  NVDS_FIELD_PLACE,
+  NVDS_FIELD_PLACE_ID,
+  NVDS_FIELD_PLACE_NAME,
+  NVDS_FIELD_PLACE_TYPE,
+  NVDS_FIELD_PLACE_LOCATION,
+  NVDS_FIELD_PLACE_AISLE,
+  NVDS_FIELD_PLACE_PARKING_SPOT,
+  NVDS_FIELD_PLACE_ENTRANCE,
+  NVDS_FIELD_SENSOR,
+  NVDS_FIELD_SENSOR_ID,
+  NVDS_FIELD_SENSOR_TYPE,
+  NVDS_FIELD_SENSOR_DESCRIPTION,
+  NVDS_FIELD_SENSOR_LOCATION,
+  NVDS_FIELD_SENSOR_COORDINATE,
+  NVDS_FIELD_ANALYTICS,
+  NVDS_FIELD_ANALYTICS_ID,
+  NVDS_FIELD_ANALYTICS_DESCRIPTION,
+  NVDS_FIELD_ANALYTICS_SOURCE,
+  NVDS_FIELD_ANALYTICS_VERSION,
+  NVDS_FIELD_ANALYTICS_CONFIDENCE,
+  NVDS_FIELD_OBJECT,
+  NVDS_FIELD_OBJECT_ID,
+  NVDS_FIELD_OBJECT_SPEED,
+  NVDS_FIELD_OBJECT_DIRECTION,
+  NVDS_FIELD_OBJECT_ORIENTATION,
+  NVDS_FIELD_OBJECT_VEHICLE,
+  NVDS_FIELD_OBJECT_PERSON,
+  NVDS_FIELD_OBJECT_FACE,
+  NVDS_FIELD_OBJECT_BBOX,
+  NVDS_FIELD_OBJECT_SIGNATURE,
+  NVDS_FIELD_OBJECT_LOCATION,
+  NVDS_FIELD_OBJECT_COORDINATE,
+  /** only written if selected explicitly. */
+  NVDS_FIELD_OBJECT_CLASS_ID,
+  NVDS_FIELD_OBJECT_CONFIDENCE,
+  NVDS_FIELD_EVENT,
+  NVDS_FIELD_EVENT_ID,
+  NVDS_FIELD_EVENT_TYPE,
+  NVDS_FIELD_VIDEO_PATH,
+  NVDS_FIELD_MAX,
+  /** plan step closing object / event. */
+  NVDS_FIELD_END = NVDS_FIELD_MAX
+};
+
+#define NVDS_FIELD_BIT(field) (1ULL << (field))
+
+/**
+ * Fields of a projection profile compiled for generation.
+ */
+struct NvDsProjection {
+  /** NVDS_FIELD_BIT of each selected field. */
+  guint64 fields;
+  /**
+   * Selected members of root, object and event in the order to be written,
+   * place, sensor and analyticsModule are single steps as their selected
+   * members are rendered in pre-rendered fragments. Objects are closed by
+   * NVDS_FIELD_END.
+   */
+  std::vector<guint8> plan;
+  /** FALSE if all default fields are selected. */
+  gboolean custom;
+};
+
+/**
+ * Compiles list of field paths, e.g. "messageid", "object.bbox", "sensor.id".
+ * Selecting an object selects its default members, selecting a member
+ * selects the objects containing it. NULL @a paths selects default fields.
+ *
+ * @return FALSE if a path is unknown.
+ */
+gboolean projection_compile (NvDsProjection *proj, const gchar * const *paths);
+
+static inline gboolean
+projection_has (const NvDsProjection *proj, NvDsField field)
+{
+  return (proj->fields & NVDS_FIELD_BIT (field)) != 0;
+}
+
+#endif
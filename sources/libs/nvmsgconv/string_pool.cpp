@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#include "string_pool.h"
+#include <string.h>
+
+#define STRING_POOL_CHUNK_SIZE (64 * 1024)
+#define STRING_POOL_MIN_SLOTS 256
+
+NvDsStringPool::NvDsStringPool ()
+  : next (NULL), available (0), count (0), bytes (0)
+{
+}
+
+NvDsStringPool::~NvDsStringPool ()
+{
+  for (gchar *chunk : chunks)
+    g_free (chunk);
+}
+
+static inline guint64
+mix (guint64 value)
+{
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  return value;
+}
+
+/**
+ * Hashes 8 bytes per step, fragments are a few hundred bytes long and
+ * byte-wise hashing would dominate loading of large configurations.
+ */
+static inline guint64
+hash_string (const gchar *str, gsize len)
+{
+  guint64 hash = 0x9e3779b97f4a7c15ULL ^ len;
+  guint64 word;
+
+  while (len >= sizeof (word)) {
+    memcpy (&word, str, sizeof (word));
+    hash = (hash ^ mix (word)) * 0x9e3779b97f4a7c15ULL;
+    str += sizeof (word);
+    len -= sizeof (word);
+  }
+  if (len) {
+    word = 0;
+    memcpy (&word, str, len);
+    hash = (hash ^ mix (word)) * 0x9e3779b97f4a7c15ULL;
+  }
+  return mix (hash);
+}
+
+static gchar *
+pool_alloc (NvDsStringPool *pool, gsize size)
+{
+  gchar *mem;
+
+  // large strings get a chunk of their own, current chunk stays in use.
+  if (size > STRING_POOL_CHUNK_SIZE / 4) {
+    mem = (gchar *) g_malloc (size);
+    pool->chunks.push_back (mem);
+    return mem;
+  }
+
+  if (size > pool->available) {
+    pool->next = (gchar *) g_malloc (STRING_POOL_CHUNK_SIZE);
+    pool->available = STRING_POOL_CHUNK_SIZE;
+    pool->chunks.push_back (pool->next);
+  }
+
+  mem = pool->next;
+  pool->next += size;
+  pool->available -= size;
+  return mem;
+}
+
+static void
+pool_rehash (NvDsStringPool *pool, gsize numSlots)
+{
+  std::vector<NvDsStringSlot> slots (numSlots, NvDsStringSlot {NULL, 0, 0});
+  gsize mask = numSlots - 1;
+  gsize i;
+
+  for (const NvDsStringSlot &it : pool->slots) {
+    if (!it.str)
+      continue;
+    i = it.hash & mask;
+    while (slots[i].str)
+      i = (i + 1) & mask;
+    slots[i] = it;
+  }
+  pool->slots.swap (slots);
+}
+
+NvDsStr
+string_pool_intern (NvDsStringPool *pool, const gchar *str, gssize len)
+{
+  gsize size = len < 0 ? strlen (str) : (gsize) len;
+  guint32 hash = (guint32) hash_string (str, size);
+  NvDsStringSlot *slot;
+  gsize mask;
+  gsize i;
+  gchar *copy;
+
+  // keep load factor below 1/2
+  if ((pool->count + 1) * 2 > pool->slots.size ())
+    pool_rehash (pool, MAX (pool->slots.size () * 2,
+                            (gsize) STRING_POOL_MIN_SLOTS));
+
+  mask = pool->slots.size () - 1;
+  i = hash & mask;
+  while (pool->slots[i].str) {
+    slot = &pool->slots[i];
+    if (slot->hash == hash && slot->len == size &&
+        !memcmp (slot->str, str, size))
+      return NvDsStr {slot->str, slot->len};
+    i = (i + 1) & mask;
+  }
+
+  copy = pool_alloc (pool, size + 1);
+  memcpy (copy, str, size);
+  copy[size] = '\0';
+
+  slot = &pool->slots[i];
+  slot->str = copy;
+  slot->len = size;
+  slot->hash = hash;
+  pool->count++;
+  pool->bytes += size + 1;
+  return NvDsStr {slot->str, slot->len};
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+#ifndef _NVDS_STRING_POOL_H_
+#define _NVDS_STRING_POOL_H_
+
+#include <glib.h>
+#include <vector>
+
+/**
+ * Interned string, @a str is null terminated and stays valid as long as
+ * the pool it came from.
+ */
+struct NvDsStr {
+  const gchar *str;
+  guint32 len;
+};
+
+/** hash table entry, hash is kept for rehashing. */
+struct NvDsStringSlot {
+  const gchar *str;
+  guint32 len;
+  guint32 hash;
+};
+
+/**
+ * Stores each distinct string once. Strings are packed into large chunks
+ * which are never moved, so interned strings can be referenced directly.
+ * Not thread safe, configuration tables fill the pool while being built and
+ * only read it afterwards.
+ */
+struct NvDsStringPool {
+  NvDsStringPool ();
+  ~NvDsStringPool ();
+  NvDsStringPool (const NvDsStringPool &) = delete;
+  NvDsStringPool &operator= (const NvDsStringPool &) = delete;
+
+  std::vector<gchar *> chunks;
+  /** free space of last chunk. */
+  gchar *next;
+  gsize available;
+  /** open addressing hash table, str is NULL for empty slot. */
+  std::vector<NvDsStringSlot> slots;
+  guint count;
+  /** bytes of string data including terminating nulls. */
+  gsize bytes;
+};
+
+/**
+ * Returns interned copy of @a len bytes at @a str, @a len -1 for null
+ * terminated @a str.
+ */
+NvDsStr string_pool_intern (NvDsStringPool *pool, const gchar *str,
+                            gssize len);
+
+#endif
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Round trip test of NVDS_PAYLOAD_DEEPSTREAM_BINARY payload.
+ * Events are encoded to binary, decoded back and json generated for the
+ * decoded event should be same as json generated for the original event.
+ * Only message and event ids (random uuids) are allowed to differ. Fields
+ * which json doesn't carry as is are compared on the decoded event.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include "nvmsgconv.h"
+#include "binary_schema.h"
+
+/* MODIFY: to reflect your own path */
+#define CFG_FILE "../../apps/sample_apps/deepstream-test4/dstest4_msgconv_config.txt"
+
+#define UUID_STR_LEN 36
+
+/* Replaces all the uuids in string with zeros. */
+static void mask_uuids(char *str, size_t len)
+{
+  static const char pattern[] = "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx";
+  size_t i, j;
+
+  for (i = 0; i + UUID_STR_LEN <= len; i++) {
+    for (j = 0; j < UUID_STR_LEN; j++) {
+      if (pattern[j] == '-' ? str[i + j] != '-' : !isxdigit(str[i + j]))
+        break;
+    }
+    if (j == UUID_STR_LEN) {
+      for (j = 0; j < UUID_STR_LEN; j++) {
+        if (pattern[j] != '-')
+          str[i + j] = '0';
+      }
+      i += UUID_STR_LEN - 1;
+    }
+  }
+}
+
+static char *generate_json(NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
+{
+  NvDsEvent event;
+  NvDsPayload *payload;
+  char *json;
+
+  event.eventType = meta->type;
+  event.metadata = meta;
+  payload = nvds_msg2p_generate(ctx, &event, 1);
+  if (!payload)
+    return NULL;
+
+  json = g_strndup((const gchar *) payload->payload, payload->payloadSize);
+  mask_uuids(json, payload->payloadSize);
+  nvds_msg2p_release(ctx, payload);
+  return json;
+}
+
+/* Compares fields of decoded event with the original event. */
+static int check_fields(const NvDsEventMsgMeta *meta,
+                        const NvDsEventMsgMeta *decoded, const char *name)
+{
+  int ret = 0;
+
+  if (g_strcmp0(decoded->objectId, meta->objectId)) {
+    printf("%s: objectId %s, expected %s\n", name, decoded->objectId,
+           meta->objectId);
+    ret = -1;
+  }
+  if (g_strcmp0(decoded->otherAttrs, meta->otherAttrs)) {
+    printf("%s: otherAttrs %s, expected %s\n", name, decoded->otherAttrs,
+           meta->otherAttrs);
+    ret = -1;
+  }
+  if (decoded->componentId != meta->componentId) {
+    printf("%s: componentId %d, expected %d\n", name, decoded->componentId,
+           meta->componentId);
+    ret = -1;
+  }
+  if (decoded->objClassId != meta->objClassId) {
+    printf("%s: objClassId %d, expected %d\n", name, decoded->objClassId,
+           meta->objClassId);
+    ret = -1;
+  }
+  return ret;
+}
+
+static int test_round_trip(NvDsMsg2pCtx *jsonCtx, NvDsMsg2pCtx *binCtx,
+                           NvDsEventMsgMeta *meta, const char *name)
+{
+  NvDsEvent event;
+  NvDsPayload *payload;
+  NvDsBinaryMessage msg;
+  NvDsBinaryMessage truncated;
+  char *expected = NULL;
+  char *actual = NULL;
+  size_t binSize;
+  int ret = -1;
+
+  event.eventType = meta->type;
+  event.metadata = meta;
+  payload = nvds_msg2p_generate(binCtx, &event, 1);
+  if (!payload) {
+    printf("%s: binary payload not generated\n", name);
+    return -1;
+  }
+
+  binSize = payload->payloadSize;
+  if (nvds_binary_decode((const guint8 *) payload->payload,
+                         payload->payloadSize, &msg) != binSize) {
+    printf("%s: decoding of binary payload failed\n", name);
+    nvds_msg2p_release(binCtx, payload);
+    return -1;
+  }
+  nvds_msg2p_release(binCtx, payload);
+
+  // truncated message shouldn't be decoded.
+  payload = nvds_msg2p_generate(binCtx, &event, 1);
+  if (nvds_binary_decode((const guint8 *) payload->payload,
+                         payload->payloadSize - 1, &truncated) != 0) {
+    printf("%s: truncated message decoded\n", name);
+    nvds_binary_message_clear(&truncated);
+    goto done;
+  }
+
+  if (check_fields(meta, &msg.meta, name))
+    goto done;
+
+  expected = generate_json(jsonCtx, meta);
+  actual = generate_json(jsonCtx, &msg.meta);
+  if (!expected || !actual || strcmp(expected, actual)) {
+    printf("%s: json mismatch\nexpected:\n%s\nactual:\n%s\n", name,
+           expected, actual);
+    goto done;
+  }
+
+  printf("%s: OK, json %zu bytes, binary %zu bytes\n", name,
+         strlen(expected), binSize);
+  ret = 0;
+
+done:
+  nvds_msg2p_release(binCtx, payload);
+  nvds_binary_message_clear(&msg);
+  g_free(expected);
+  g_free(actual);
+  return ret;
+}
+
+static void init_meta(NvDsEventMsgMeta *meta, NvDsEventType type,
+                      NvDsObjectType objType)
+{
+  memset(meta, 0, sizeof(NvDsEventMsgMeta));
+  meta->type = type;
+  meta->objType = objType;
+  meta->bbox.top = 120;
+  meta->bbox.left = 340;
+  meta->bbox.width = 64;
+  meta->bbox.height = 48;
+  meta->location.lat = 45.293701447;
+  meta->location.lon = -75.8303914499;
+  meta->location.alt = 48.1557479338;
+  meta->coordinate.x = 5.2;
+  meta->coordinate.y = 10.1;
+  meta->coordinate.z = 0.1;
+  meta->objClassId = 2;
+  meta->componentId = 3;
+  meta->sensorId = 0;
+  meta->placeId = 0;
+  meta->moduleId = 0;
+  meta->confidence = 0.875;
+  meta->trackingId = 4242;
+  meta->ts = (gchar *) "2018-09-10T11:12:13.456Z";
+  meta->objectId = (gchar *) "obj-\"quoted\"";
+  meta->otherAttrs = (gchar *) "lane=2;speed=\"12\"";
+  meta->videoPath = (gchar *) "/tmp/video.mp4";
+}
+
+int main(int argc, char *argv[])
+{
+  const char *cfgFile = argc > 1 ? argv[1] : CFG_FILE;
+  NvDsMsg2pCtx *jsonCtx;
+  NvDsMsg2pCtx *binCtx;
+  NvDsEventMsgMeta meta;
+  gdouble signature[] = {0.1, -2.5, 1e-9, 123456.789};
+  NvDsVehicleObject vehicle = {(gchar *) "sedan", (gchar *) "Bugatti",
+      (gchar *) "M", (gchar *) "blue", (gchar *) "CA", (gchar *) "XX1234"};
+  NvDsPersonObject person = {(gchar *) "male", (gchar *) "black",
+      (gchar *) "none", (gchar *) "formal", 45};
+  NvDsFaceObject face = {(gchar *) "female", NULL, (gchar *) "none",
+      (gchar *) "round", (gchar *) "", (gchar *) "name\twith\ttabs",
+      (gchar *) "brown", 30};
+  int failed = 0;
+
+  jsonCtx = nvds_msg2p_ctx_create(cfgFile, NVDS_PAYLOAD_DEEPSTREAM);
+  binCtx = nvds_msg2p_ctx_create(cfgFile, NVDS_PAYLOAD_DEEPSTREAM_BINARY);
+  if (!jsonCtx || !binCtx) {
+    printf("Failed to create context with %s\n", cfgFile);
+    return -1;
+  }
+
+  init_meta(&meta, NVDS_EVENT_ENTRY, NVDS_OBJECT_TYPE_VEHICLE);
+  meta.extMsg = &vehicle;
+  meta.extMsgSize = sizeof(vehicle);
+  meta.objSignature.signature = signature;
+  meta.objSignature.size = G_N_ELEMENTS(signature);
+  failed |= test_round_trip(jsonCtx, binCtx, &meta, "vehicle");
+
+  init_meta(&meta, NVDS_EVENT_MOVING, NVDS_OBJECT_TYPE_PERSON);
+  meta.extMsg = &person;
+  meta.extMsgSize = sizeof(person);
+  meta.videoPath = NULL;
+  failed |= test_round_trip(jsonCtx, binCtx, &meta, "person");
+
+  init_meta(&meta, NVDS_EVENT_EXIT, NVDS_OBJECT_TYPE_FACE);
+  meta.extMsg = &face;
+  meta.extMsgSize = sizeof(face);
+  failed |= test_round_trip(jsonCtx, binCtx, &meta, "face");
+
+  init_meta(&meta, NVDS_EVENT_PARKED, NVDS_OBJECT_TYPE_VEHICLE);
+  meta.objClassId = 0;
+  meta.otherAttrs = NULL;
+  failed |= test_round_trip(jsonCtx, binCtx, &meta, "no object");
+
+  nvds_msg2p_ctx_destroy(jsonCtx);
+  nvds_msg2p_ctx_destroy(binCtx);
+
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+  return failed ? -1 : 0;
+}
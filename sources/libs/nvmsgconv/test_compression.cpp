@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Round trip of compressed payloads through nvds_payload_decompress for lz4,
+ * zstd and zstd with a dictionary trained on sample payloads, for single and
+ * framed batch payloads. Reports average payload size and generation time of
+ * each codec.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include <zdict.h>
+#include "nvmsgconv.h"
+#include "compression.h"
+#include "test_helpers.h"
+
+#define NUM_EVENTS 2000
+#define NUM_SAMPLES 1000
+#define DICT_SIZE 16384
+
+typedef struct {
+  const char *name;
+  const char *schema;
+  NvDsCompression codec;
+} Codec;
+
+static const Codec codecs[] = {
+  {"none", "", NVDS_COMPRESSION_NONE},
+  {"lz4", "compression=lz4", NVDS_COMPRESSION_LZ4},
+  {"zstd", "compression=zstd", NVDS_COMPRESSION_ZSTD},
+  {"zstd+dict", "compression=zstd\ncompression-dictionary=%s",
+      NVDS_COMPRESSION_ZSTD},
+};
+
+static NvDsVehicleObject vehicle = {
+  (gchar *) "sedan", (gchar *) "Bugatti", (gchar *) "M",
+  (gchar *) "blue", (gchar *) "CA", (gchar *) "XX1234"
+};
+
+static NvDsEventMsgMeta metas[NUM_EVENTS];
+static NvDsEvent events[NUM_EVENTS];
+static gchar timestamps[NUM_EVENTS][32];
+
+static void init_events(void)
+{
+  int i;
+
+  for (i = 0; i < NUM_EVENTS; i++) {
+    memset(&metas[i], 0, sizeof(NvDsEventMsgMeta));
+    metas[i].type = (NvDsEventType) (i % 3);
+    metas[i].objType = NVDS_OBJECT_TYPE_VEHICLE;
+    metas[i].trackingId = i;
+    metas[i].bbox.left = rand() % 1920;
+    metas[i].bbox.top = rand() % 1080;
+    metas[i].bbox.width = rand() % 200;
+    metas[i].bbox.height = rand() % 200;
+    metas[i].confidence = rand() / (double) RAND_MAX;
+    snprintf(timestamps[i], sizeof(timestamps[i]),
+             "2018-09-10T11:%02d:%02d.%03dZ", i / 6000 % 60, i / 100 % 60,
+             i * 10 % 1000);
+    metas[i].ts = timestamps[i];
+    metas[i].objectId = (gchar *) "obj";
+    metas[i].extMsg = &vehicle;
+    metas[i].extMsgSize = sizeof(vehicle);
+    events[i].eventType = metas[i].type;
+    events[i].metadata = &metas[i];
+  }
+}
+
+static int train_dict(NvDsMsg2pCtx *ctx, const char *file)
+{
+  std::vector<char> samples;
+  std::vector<size_t> sizes;
+  std::vector<char> dict(DICT_SIZE);
+  NvDsPayload *payload;
+  const char *data;
+  size_t ret;
+  int i;
+
+  // samples from other events than the measured ones.
+  for (i = 0; i < NUM_SAMPLES; i++) {
+    payload = nvds_msg2p_generate(ctx, &events[NUM_EVENTS - 1 - i], 1);
+    data = (const char *) payload->payload;
+    samples.insert(samples.end(), data, data + payload->payloadSize);
+    sizes.push_back(payload->payloadSize);
+    nvds_msg2p_release(ctx, payload);
+  }
+
+  ret = ZDICT_trainFromBuffer(dict.data(), dict.size(), samples.data(),
+                              sizes.data(), sizes.size());
+  if (ZDICT_isError(ret)) {
+    printf("dictionary training failed: %s\n", ZDICT_getErrorName(ret));
+    return -1;
+  }
+  return g_file_set_contents(file, dict.data(), ret, NULL) ? 0 : -1;
+}
+
+static int check_codec(const char *file, const Codec *codec,
+                       const char *dictFile, NvDsMsg2pCtx *plainCtx)
+{
+  NvDsMsg2pCtx *ctx;
+  NvDsPayload *payload;
+  NvDsPayload *plain;
+  GString *out;
+  gchar *dict = NULL;
+  gsize dictSize = 0;
+  gchar *schema;
+  gchar *expected;
+  guint64 bytes = 0;
+  gint64 start, elapsed = 0;
+  int failed = 0;
+  int i;
+
+  schema = g_strdup_printf(codec->schema, dictFile);
+  ctx = create_ctx(file, schema);
+  g_free(schema);
+  if (!ctx) {
+    printf("%s: failed to create context\n", codec->name);
+    return -1;
+  }
+  out = g_string_new(NULL);
+  if (strstr(codec->schema, "dictionary"))
+    g_file_get_contents(dictFile, &dict, &dictSize, NULL);
+
+  for (i = 0; i < NUM_EVENTS - NUM_SAMPLES && !failed; i++) {
+    start = g_get_monotonic_time();
+    payload = nvds_msg2p_generate(ctx, &events[i], 1);
+    elapsed += g_get_monotonic_time() - start;
+    bytes += payload->payloadSize;
+
+    plain = nvds_msg2p_generate(plainCtx, &events[i], 1);
+    expected = g_strndup((const gchar *) plain->payload, plain->payloadSize);
+    nvds_msg2p_release(plainCtx, plain);
+
+    if (codec->codec == NVDS_COMPRESSION_NONE) {
+      g_string_truncate(out, 0);
+      g_string_append_len(out, (const gchar *) payload->payload,
+                          payload->payloadSize);
+    } else if (!nvds_payload_decompress((const guint8 *) payload->payload,
+                   payload->payloadSize, dict, dictSize, out) ||
+               ((const guint8 *) payload->payload)[3] != codec->codec) {
+      printf("%s: unable to decompress payload %d\n", codec->name, i);
+      failed = -1;
+    }
+
+    mask_ids(expected);
+    mask_ids(out->str);
+    if (!failed && strcmp(expected, out->str)) {
+      printf("%s: payload %d differs:\n%s\n%s\n", codec->name, i, expected,
+             out->str);
+      failed = -1;
+    }
+    g_free(expected);
+
+    // brokers get sensor id as key of compressed payloads too.
+    if (!failed && (g_strcmp0(payload->key, "CAM_0") || payload->keyLen != 5)) {
+      printf("%s: payload %d has key %s\n", codec->name, i, payload->key);
+      failed = -1;
+    }
+
+    // payload of zstd dictionary can't be read without it.
+    if (!failed && dict && nvds_payload_decompress((const guint8 *)
+            payload->payload, payload->payloadSize, NULL, 0, out)) {
+      printf("%s: decompressed without dictionary\n", codec->name);
+      failed = -1;
+    }
+    nvds_msg2p_release(ctx, payload);
+  }
+
+  // framed batch is compressed as a whole.
+  payload = nvds_msg2p_generate_batch(ctx, events, 10, NVDS_MSG2P_BATCH_FRAMED);
+  if (codec->codec != NVDS_COMPRESSION_NONE &&
+      (!nvds_payload_decompress((const guint8 *) payload->payload,
+           payload->payloadSize, dict, dictSize, out) ||
+       out->len < 4 || GUINT32_FROM_LE(*(guint32 *) out->str) != 10)) {
+    printf("%s: unable to decompress batch\n", codec->name);
+    failed = -1;
+  }
+  if (g_strcmp0(payload->key, "CAM_0")) {
+    printf("%s: batch has key %s\n", codec->name, payload->key);
+    failed = -1;
+  }
+  nvds_msg2p_release(ctx, payload);
+
+  // no key for events of different sensors.
+  metas[1].sensorId = 1;
+  payload = nvds_msg2p_generate_batch(ctx, events, 10, NVDS_MSG2P_BATCH_FRAMED);
+  metas[1].sensorId = 0;
+  if (payload->key || payload->keyLen) {
+    printf("%s: batch of two sensors has key %s\n", codec->name, payload->key);
+    failed = -1;
+  }
+  nvds_msg2p_release(ctx, payload);
+
+  printf("%-10s %7.1f bytes/msg %6.2f us/msg\n", codec->name,
+         (double) bytes / (NUM_EVENTS - NUM_SAMPLES),
+         (double) elapsed / (NUM_EVENTS - NUM_SAMPLES));
+
+  g_free(dict);
+  g_string_free(out, TRUE);
+  nvds_msg2p_ctx_destroy(ctx);
+  return failed;
+}
+
+/** Header claiming 4 GiB payload for 4 bytes of data should be rejected. */
+static int check_forged_size()
+{
+  guint8 forged[NVDS_COMPRESSION_HEADER_SIZE + 4] = {
+    'N', 'V', 'Z', 0, 0, 0, 0, 0, 0xff, 0xff, 0xff, 0xff, 1, 2, 3, 4
+  };
+  GString *out = g_string_new(NULL);
+  int failed = 0;
+  guint8 codec;
+
+  for (codec = NVDS_COMPRESSION_NONE; codec <= NVDS_COMPRESSION_ZSTD; codec++) {
+    forged[3] = codec;
+    if (nvds_payload_decompress(forged, sizeof(forged), NULL, 0, out) ||
+        out->allocated_len > 1024) {
+      printf("codec %u: forged size accepted or allocated\n", codec);
+      failed = -1;
+    }
+  }
+  g_string_free(out, TRUE);
+  return failed;
+}
+
+int main(int argc, char *argv[])
+{
+  char file[] = "/tmp/nvmsgconv_compression_XXXXXX";
+  char dictFile[] = "/tmp/nvmsgconv_dict_XXXXXX";
+  NvDsMsg2pCtx *plainCtx;
+  NvDsMsg2pCtx *ctx;
+  gchar *schema;
+  int failed = 0;
+  unsigned i;
+  int fd;
+
+  fd = mkstemp(file);
+  if (fd < 0) {
+    printf("Unable to create configuration file\n");
+    return -1;
+  }
+  close(fd);
+  fd = mkstemp(dictFile);
+  if (fd < 0) {
+    printf("Unable to create dictionary file\n");
+    unlink(file);
+    return -1;
+  }
+  close(fd);
+
+  init_events();
+  plainCtx = create_ctx(file, "");
+  if (!plainCtx || train_dict(plainCtx, dictFile)) {
+    printf("Failed to train dictionary\n");
+    failed = -1;
+    goto done;
+  }
+
+  for (i = 0; i < G_N_ELEMENTS(codecs); i++)
+    failed |= check_codec(file, &codecs[i], dictFile, plainCtx);
+
+  ctx = create_ctx(file, "compression=brotli");
+  if (ctx) {
+    printf("unknown codec accepted\n");
+    nvds_msg2p_ctx_destroy(ctx);
+    failed = -1;
+  }
+  schema = g_strdup_printf("compression=lz4\ncompression-dictionary=%s",
+                           dictFile);
+  ctx = create_ctx(file, schema);
+  g_free(schema);
+  if (ctx) {
+    printf("dictionary accepted for lz4\n");
+    nvds_msg2p_ctx_destroy(ctx);
+    failed = -1;
+  }
+  ctx = create_ctx(file, "compression=zstd\ncompression-level=100");
+  if (ctx) {
+    printf("invalid zstd level accepted\n");
+    nvds_msg2p_ctx_destroy(ctx);
+    failed = -1;
+  }
+  failed |= check_forged_size();
+
+done:
+  if (plainCtx)
+    nvds_msg2p_ctx_destroy(plainCtx);
+  unlink(file);
+  unlink(dictFile);
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+  return failed ? -1 : 0;
+}
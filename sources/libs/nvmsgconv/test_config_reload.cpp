@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Reloads configuration while payloads are generated from several threads.
+ * Each payload should carry sensor description of either the old or the new
+ * configuration. Also checks that "watch-config" picks up a changed file
+ * and reports reload time for a large configuration.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include "nvmsgconv.h"
+
+#define GENERATE_THREADS 4
+#define RELOAD_COUNT 50
+#define NUM_SENSORS 1000
+
+static std::atomic<bool> stop;
+static std::atomic<int> failures;
+
+static int write_config(const char *file, int numSensors, int version,
+                        bool watch)
+{
+  FILE *fp = fopen(file, "w");
+  int i;
+
+  if (!fp)
+    return -1;
+
+  fprintf(fp, "[schema]\nwatch-config=%d\n\n", watch ? 1 : 0);
+  for (i = 0; i < numSensors; i++) {
+    fprintf(fp, "[sensor%d]\nenable=1\ntype=Camera\nid=CAM_%d\n"
+            "location=45.29;-75.83;48.15\ndescription=version%d\n"
+            "coordinate=5.2;10.1;11.2\n\n", i, i, version);
+  }
+  fprintf(fp, "[place0]\nenable=1\nid=1\ntype=garage\nname=XYZ\n"
+          "location=30.32;-40.55;100.0\ncoordinate=1.0;2.0;3.0\n"
+          "place-sub-field1=walsh\nplace-sub-field2=lane1\n"
+          "place-sub-field3=P2\n\n");
+  fprintf(fp, "[analytics0]\nenable=1\nid=XYZ\ndescription=detection\n"
+          "source=OpenALR\nversion=1.0\n");
+  fclose(fp);
+  return 0;
+}
+
+static void init_meta(NvDsEventMsgMeta *meta, int sensorId)
+{
+  memset(meta, 0, sizeof(NvDsEventMsgMeta));
+  meta->type = NVDS_EVENT_ENTRY;
+  meta->objType = NVDS_OBJECT_TYPE_VEHICLE;
+  meta->sensorId = sensorId;
+  meta->ts = (gchar *) "2018-09-10T11:12:13.456Z";
+  meta->objectId = (gchar *) "obj";
+}
+
+static gpointer generate_thread(gpointer data)
+{
+  NvDsMsg2pCtx *ctx = (NvDsMsg2pCtx *) data;
+  NvDsEventMsgMeta meta;
+  NvDsEvent event;
+  NvDsPayload *payload;
+  int i = 0;
+
+  event.eventType = NVDS_EVENT_ENTRY;
+  event.metadata = &meta;
+
+  while (!stop) {
+    init_meta(&meta, i++ % NUM_SENSORS);
+    payload = nvds_msg2p_generate(ctx, &event, 1);
+    if (!payload ||
+        (!g_strstr_len((const gchar *) payload->payload,
+                       payload->payloadSize, "\"version0\"") &&
+         !g_strstr_len((const gchar *) payload->payload,
+                       payload->payloadSize, "\"version1\""))) {
+      printf("payload without valid sensor description\n");
+      failures++;
+    }
+    if (payload)
+      nvds_msg2p_release(ctx, payload);
+  }
+  return NULL;
+}
+
+static int test_concurrent_reload(const char *file)
+{
+  NvDsMsg2pCtx *ctx;
+  NvDsMsg2pReloadStats stats;
+  GThread *threads[GENERATE_THREADS];
+  FILE *fp;
+  int i;
+
+  write_config(file, NUM_SENSORS, 0, false);
+  ctx = nvds_msg2p_ctx_create(file, NVDS_PAYLOAD_DEEPSTREAM);
+  if (!ctx) {
+    printf("Failed to create context with %s\n", file);
+    return -1;
+  }
+
+  nvds_msg2p_get_reload_stats(ctx, &stats);
+  printf("initial load: %u sensors in %.1f ms\n", stats.numSensors,
+         stats.lastReloadTime / 1000.0);
+
+  for (i = 0; i < GENERATE_THREADS; i++)
+    threads[i] = g_thread_new("generate", generate_thread, ctx);
+
+  for (i = 0; i < RELOAD_COUNT; i++) {
+    write_config(file, NUM_SENSORS, (i + 1) % 2, false);
+    if (!nvds_msg2p_reload(ctx)) {
+      printf("reload failed\n");
+      failures++;
+    }
+  }
+
+  // broken file keeps previous configuration.
+  fp = fopen(file, "w");
+  fprintf(fp, "[sensor0]\nenable=1\nlocation=1.0;2.0\n");
+  fclose(fp);
+  if (nvds_msg2p_reload(ctx))
+    printf("reload of broken file succeeded\n");
+
+  stop = true;
+  for (i = 0; i < GENERATE_THREADS; i++)
+    g_thread_join(threads[i]);
+
+  nvds_msg2p_get_reload_stats(ctx, &stats);
+  printf("reloads %" G_GUINT64_FORMAT " failures %" G_GUINT64_FORMAT
+         ", %u sensors, last reload %.1f ms\n", stats.reloads,
+         stats.failures, stats.numSensors, stats.lastReloadTime / 1000.0);
+  if (stats.reloads != RELOAD_COUNT || stats.failures != 1 ||
+      stats.numSensors != NUM_SENSORS)
+    failures++;
+
+  nvds_msg2p_ctx_destroy(ctx);
+  return failures ? -1 : 0;
+}
+
+static int test_watch(const char *file)
+{
+  NvDsMsg2pCtx *ctx;
+  NvDsMsg2pReloadStats stats;
+  int i;
+
+  write_config(file, 1, 0, true);
+  ctx = nvds_msg2p_ctx_create(file, NVDS_PAYLOAD_DEEPSTREAM);
+  if (!ctx) {
+    printf("Failed to create context with %s\n", file);
+    return -1;
+  }
+
+  write_config(file, 2, 1, true);
+  for (i = 0; i < 200; i++) {
+    nvds_msg2p_get_reload_stats(ctx, &stats);
+    if (stats.reloads && stats.numSensors == 2)
+      break;
+    g_usleep(10000);
+  }
+  nvds_msg2p_ctx_destroy(ctx);
+
+  if (i == 200) {
+    printf("change of configuration file not detected\n");
+    return -1;
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  char file[] = "/tmp/nvmsgconv_reload_XXXXXX.txt";
+  int fd = mkstemps(file, 4);
+  int failed = 0;
+
+  if (fd < 0) {
+    printf("Unable to create configuration file\n");
+    return -1;
+  }
+  close(fd);
+
+  failed |= test_concurrent_reload(file);
+  failed |= test_watch(file);
+
+  unlink(file);
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+  return failed ? -1 : 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Loads a generated sensor catalog in CSV format and checks that payloads
+ * carry the values of the right rows, including quoted fields. Reports load
+ * time of the catalog and rejects malformed files.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "nvmsgconv.h"
+
+#define NUM_ROWS 50000
+
+static int write_catalog(const char *file, int numRows)
+{
+  FILE *fp = fopen(file, "w");
+  int i;
+
+  if (!fp)
+    return -1;
+
+  fprintf(fp, "cameraId,sensorId,description,cameraIDstring,"
+          "spot,level,lane\r\n");
+  for (i = 0; i < numRows; i++) {
+    if (i % 2)
+      fprintf(fp, "%d, CAM_%d ,\"Lane %d, \"\"north\"\"\",C%d,S%d,P%d,L%d\r\n",
+              i, i, i, i, i, i % 4, i % 3);
+    else
+      fprintf(fp, "%d,CAM_%d,Lane %d,C%d,S%d,P%d,L%d\n", i, i, i, i, i,
+              i % 4, i % 3);
+    // blank lines are ignored
+    if (i == 10)
+      fprintf(fp, "\n");
+  }
+  fclose(fp);
+  return 0;
+}
+
+static int check_row(NvDsMsg2pCtx *ctx, int row)
+{
+  NvDsEventMsgMeta meta;
+  NvDsEvent event;
+  NvDsPayload *payload;
+  char expected[128];
+  char *json;
+  int ret = 0;
+
+  memset(&meta, 0, sizeof(meta));
+  meta.type = NVDS_EVENT_PARKED;
+  meta.objType = NVDS_OBJECT_TYPE_VEHICLE;
+  meta.sensorId = meta.placeId = meta.moduleId = row;
+  meta.ts = (gchar *) "2018-09-10T11:12:13.456Z";
+  meta.objectId = (gchar *) "obj";
+  event.eventType = meta.type;
+  event.metadata = &meta;
+
+  payload = nvds_msg2p_generate(ctx, &event, 1);
+  if (!payload)
+    return -1;
+  json = g_strndup((const gchar *) payload->payload, payload->payloadSize);
+  nvds_msg2p_release(ctx, payload);
+
+  if (row % 2)
+    snprintf(expected, sizeof(expected),
+             "\"description\" : \"Lane %d, \\\"north\\\"\"", row);
+  else
+    snprintf(expected, sizeof(expected), "\"description\" : \"Lane %d\"",
+             row);
+  if (!strstr(json, expected))
+    ret = -1;
+
+  snprintf(expected, sizeof(expected), "\"id\" : \"CAM_%d\"", row);
+  if (!strstr(json, expected))
+    ret = -1;
+  snprintf(expected, sizeof(expected), "\"id\" : \"S%d\"", row);
+  if (!strstr(json, expected))
+    ret = -1;
+
+  if (ret)
+    printf("row %d: unexpected payload\n%s\n", row, json);
+  g_free(json);
+  return ret;
+}
+
+int main(int argc, char *argv[])
+{
+  char file[] = "/tmp/nvmsgconv_catalog_XXXXXX.csv";
+  int fd = mkstemps(file, 4);
+  NvDsMsg2pReloadStats stats;
+  NvDsMsg2pCtx *ctx;
+  FILE *fp;
+  int failed = 0;
+
+  if (fd < 0) {
+    printf("Unable to create catalog file\n");
+    return -1;
+  }
+  close(fd);
+
+  write_catalog(file, NUM_ROWS);
+  ctx = nvds_msg2p_ctx_create(file, NVDS_PAYLOAD_DEEPSTREAM);
+  if (!ctx) {
+    printf("Failed to load %s\n", file);
+    unlink(file);
+    return -1;
+  }
+
+  nvds_msg2p_get_reload_stats(ctx, &stats);
+  printf("%u rows loaded in %.1f ms\n", stats.numSensors,
+         stats.lastReloadTime / 1000.0);
+  if (stats.numSensors != NUM_ROWS)
+    failed = -1;
+
+  failed |= check_row(ctx, 0);
+  failed |= check_row(ctx, 11);
+  failed |= check_row(ctx, 12);
+  failed |= check_row(ctx, NUM_ROWS - 1);
+  nvds_msg2p_ctx_destroy(ctx);
+
+  // unterminated quote
+  fp = fopen(file, "w");
+  fprintf(fp, "cameraId,sensorId\n0,\"CAM_0,x,y,z,w,v\n");
+  fclose(fp);
+  ctx = nvds_msg2p_ctx_create(file, NVDS_PAYLOAD_DEEPSTREAM);
+  if (ctx) {
+    printf("malformed catalog loaded\n");
+    nvds_msg2p_ctx_destroy(ctx);
+    failed = -1;
+  }
+
+  unlink(file);
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+  return failed ? -1 : 0;
+}
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Streams moving events of several tracks through delta encoded and plain
+ * contexts and checks that the reference decoder gives back the plain
+ * payloads, including confidence, class id and signature changing between
+ * keyframes, that a lost delta breaks its track until next keyframe and that
+ * evicted tracks restart with a keyframe. Reports sizes of both streams.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "nvmsgconv.h"
+#include "delta_encoding.h"
+#include "test_helpers.h"
+
+#define TRACK_COUNT 4
+#define FRAME_COUNT 100
+#define KEYFRAME_INTERVAL 30
+// default fields with class id and confidence of object
+#define PROJECTION "projection=messageid;mdsversion;@timestamp;place;sensor;" \
+  "analyticsModule;object;object.classId;object.confidence;event;videoPath"
+
+static NvDsVehicleObject vehicle = {
+  (gchar *) "sedan", (gchar *) "Bugatti", (gchar *) "M",
+  (gchar *) "blue", (gchar *) "CA", (gchar *) "XX1234"
+};
+
+static gdouble signature[4];
+
+/** Moves object of @a track to its position in @a frame. */
+static void set_meta(NvDsEventMsgMeta *meta, NvDsEvent *event, int track,
+                     int frame)
+{
+  memset(meta, 0, sizeof(NvDsEventMsgMeta));
+  meta->type = NVDS_EVENT_MOVING;
+  meta->objType = NVDS_OBJECT_TYPE_VEHICLE;
+  // class id every 8 frames, confidence and signature every frame
+  meta->objClassId = 2 + (frame / 8) % 2;
+  meta->confidence = 0.5 + frame * 0.004;
+  signature[0] = track;
+  signature[1] = frame * 0.25;
+  meta->objSignature.signature = signature;
+  meta->objSignature.size = 4;
+  meta->trackingId = track + 1;
+  meta->bbox.left = 10 + track * 100 + frame * 2;
+  meta->bbox.top = 20 + (frame / 3);
+  meta->bbox.width = 100;
+  meta->bbox.height = 50 + (frame % 2);
+  // location only changes every 10 frames
+  meta->location.lat = 45.29 + (frame / 10) * 0.001;
+  meta->location.lon = -75.83;
+  meta->coordinate.x = track;
+  meta->ts = (gchar *) "2018-09-10T11:12:13.456Z";
+  meta->objectId = (gchar *) "obj";
+  meta->extMsg = &vehicle;
+  meta->extMsgSize = sizeof(vehicle);
+  event->eventType = meta->type;
+  event->metadata = meta;
+}
+
+/** Checks that decoded @a json has class id and confidence of @a meta. */
+static gboolean check_values(const gchar *json, const NvDsEventMsgMeta *meta)
+{
+  gchar expected[64];
+  const gchar *object = strstr(json, "\"object\":");
+
+  if (!object)
+    return FALSE;
+  snprintf(expected, sizeof(expected), "\"classId\":%d", meta->objClassId);
+  if (!strstr(object, expected))
+    return FALSE;
+  snprintf(expected, sizeof(expected), "\"confidence\":%.17g", meta->confidence);
+  // object, its vehicle and analytics module
+  return strstr(object, expected) && strstr(strstr(json, "\"vehicle\":"), expected) &&
+      strstr(strstr(json, "\"analyticsModule\":"), expected);
+}
+
+static gboolean is_keyframe(const gchar *json)
+{
+  return strstr(json, "\"frame\":\"key\"") != NULL;
+}
+
+int main(int argc, char *argv[])
+{
+  char file[] = "/tmp/nvmsgconv_delta_XXXXXX";
+  int fd = mkstemp(file);
+  NvDsMsg2pCtx *ctx = NULL;
+  NvDsMsg2pCtx *deltaCtx = NULL;
+  NvDsDeltaDecoder *decoder = nvds_delta_decoder_new();
+  NvDsEventMsgMeta meta;
+  NvDsEvent event;
+  GString *out = g_string_new(NULL);
+  NvDsDeltaStatus status;
+  gchar *schema;
+  gchar *json;
+  gchar *delta;
+  guint plainSize = 0;
+  guint deltaSize = 0;
+  guint keyframes = 0;
+  guint decoded = 0;
+  int track;
+  int frame;
+  int failed = 0;
+
+  if (fd < 0) {
+    printf("Unable to create configuration file\n");
+    return -1;
+  }
+  close(fd);
+
+  ctx = create_ctx(file, PROJECTION);
+  schema = g_strdup_printf(PROJECTION "\ndelta-encoding=1\n"
+                           "delta-keyframe-interval=%d", KEYFRAME_INTERVAL);
+  deltaCtx = create_ctx(file, schema);
+  g_free(schema);
+  if (!ctx || !deltaCtx) {
+    printf("Failed to create contexts\n");
+    failed = -1;
+    goto done;
+  }
+
+  for (frame = 0; frame < FRAME_COUNT; frame++) {
+    for (track = 0; track < TRACK_COUNT; track++) {
+      set_meta(&meta, &event, track, frame);
+      json = generate(ctx, &event, &plainSize);
+      delta = generate(deltaCtx, &event, &deltaSize);
+      if (!json || !delta) {
+        printf("Failed to generate payload\n");
+        g_free(json);
+        g_free(delta);
+        failed = -1;
+        goto done;
+      }
+      keyframes += is_keyframe(delta);
+
+      // track 1 loses one delta
+      if (track == 1 && frame == 5) {
+        g_free(json);
+        g_free(delta);
+        continue;
+      }
+
+      status = nvds_delta_decoder_decode(decoder, delta, strlen(delta), out);
+      if (track == 1 && frame > 5 && frame < KEYFRAME_INTERVAL) {
+        if (status != NVDS_DELTA_GAP) {
+          printf("frame %d: lost delta not detected\n", frame);
+          failed = -1;
+        }
+      } else if (status != NVDS_DELTA_DECODED) {
+        printf("frame %d track %d: status %d\n%s\n", frame, track, status,
+               delta);
+        failed = -1;
+      } else {
+        if (!check_values(out->str, &meta)) {
+          printf("frame %d track %d: stale values:\n%s\n", frame, track,
+                 out->str);
+          failed = -1;
+        }
+        mask_ids(json);
+        mask_ids(out->str);
+        if (strcmp(json, out->str)) {
+          printf("frame %d track %d: decoded payload differs:\n%s\n%s\n",
+                 frame, track, json, out->str);
+          failed = -1;
+        }
+        decoded++;
+      }
+      g_free(json);
+      g_free(delta);
+    }
+  }
+
+  if (keyframes != TRACK_COUNT * ((FRAME_COUNT + KEYFRAME_INTERVAL - 1) /
+                                  KEYFRAME_INTERVAL)) {
+    printf("unexpected number of keyframes %u\n", keyframes);
+    failed = -1;
+  }
+
+  // untracked objects are sent as is
+  for (frame = 0; frame < 2; frame++) {
+    set_meta(&meta, &event, 0, frame);
+    meta.trackingId = 0;
+    delta = generate(deltaCtx, &event, &deltaSize);
+    if (!delta || strstr(delta, "\"delta\":")) {
+      printf("untracked object is delta encoded:\n%s\n", delta);
+      failed = -1;
+    }
+    g_free(delta);
+  }
+
+  if (!nvds_msg2p_needs_ordered_generation(deltaCtx) ||
+      nvds_msg2p_needs_ordered_generation(ctx)) {
+    printf("wrong ordered generation of contexts\n");
+    failed = -1;
+  }
+
+  // other events are sent as is
+  set_meta(&meta, &event, 0, 0);
+  meta.type = NVDS_EVENT_ENTRY;
+  delta = generate(deltaCtx, &event, &deltaSize);
+  if (!delta || is_keyframe(delta) ||
+      nvds_delta_decoder_decode(decoder, delta, strlen(delta), out) !=
+      NVDS_DELTA_PASSTHROUGH) {
+    printf("entry event is delta encoded\n");
+    failed = -1;
+  }
+  g_free(delta);
+
+  printf("%u messages (%u keyframes, %u decoded): plain %u bytes, "
+         "delta %u bytes (%.1f%%)\n", FRAME_COUNT * TRACK_COUNT, keyframes,
+         decoded, plainSize, deltaSize, deltaSize * 100.0 / plainSize);
+
+  nvds_msg2p_ctx_destroy(deltaCtx);
+  deltaCtx = create_ctx(file, "delta-encoding=1\ndelta-max-tracks=2");
+  if (!deltaCtx) {
+    printf("Failed to create context\n");
+    failed = -1;
+    goto done;
+  }
+
+  // third track evicts the first one, which restarts with keyframe
+  for (track = 0; track < 3; track++) {
+    set_meta(&meta, &event, track, 0);
+    g_free(generate(deltaCtx, &event, &deltaSize));
+  }
+  set_meta(&meta, &event, 0, 1);
+  delta = generate(deltaCtx, &event, &deltaSize);
+  if (!delta || !is_keyframe(delta) || !strstr(delta, "\"seq\":0")) {
+    printf("evicted track doesn't restart with keyframe:\n%s\n", delta);
+    failed = -1;
+  }
+  g_free(delta);
+  set_meta(&meta, &event, 2, 1);
+  delta = generate(deltaCtx, &event, &deltaSize);
+  if (!delta || is_keyframe(delta)) {
+    printf("recent track lost\n");
+    failed = -1;
+  }
+  g_free(delta);
+
+  if (create_ctx(file, "delta-encoding=1\ndirect-writer=0") ||
+      create_ctx(file, "delta-encoding=1\nprojection=messageid;sensor.id") ||
+      create_ctx(file, "delta-encoding=1\ndelta-keyframe-interval=-1") ||
+      create_ctx(file, "delta-encoding=1\ndelta-max-tracks=0")) {
+    printf("invalid delta configuration accepted\n");
+    failed = -1;
+  }
+
+done:
+  if (ctx)
+    nvds_msg2p_ctx_destroy(ctx);
+  if (deltaCtx)
+    nvds_msg2p_ctx_destroy(deltaCtx);
+  nvds_delta_decoder_free(decoder);
+  g_string_free(out, TRUE);
+  unlink(file);
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+  return failed ? -1 : 0;
+}
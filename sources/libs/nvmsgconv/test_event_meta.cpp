@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Checks event metas of nvds_event_meta.h: copy relocation, block reuse,
+ * full blocks, use from several threads and payload against the one of a
+ * heap allocated meta. Reports generate + copy + free time against g_malloc
+ * and g_strdup.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "nvmsgconv.h"
+#include "nvds_event_meta.h"
+
+#define NUM_THREADS 4
+#define THREAD_COUNT 200000
+#define BENCH_COUNT 1000000
+#define SIGNATURE_SIZE 4
+
+static const char *vehicleStrings[] = {"sedan", "Bugatti", "M", "blue", "CA",
+                                       "XX1234"};
+
+static gboolean in_block(const NvDsEventMsgMeta *meta, const void *ptr)
+{
+  const NvDsEventMetaBlock *block = nvds_event_meta_get_block(meta);
+
+  return (const gchar *) ptr >= (const gchar *) block &&
+      (const gchar *) ptr < (const gchar *) block + block->used;
+}
+
+static NvDsEventMsgMeta *new_vehicle_meta(NvDsEventMetaArena *arena, int id)
+{
+  NvDsEventMsgMeta *meta = nvds_event_meta_new(arena);
+  NvDsVehicleObject *obj;
+  gdouble *signature;
+  gchar **strings;
+  gchar objectId[16];
+  int i;
+
+  g_snprintf(objectId, sizeof(objectId), "%d", id);
+  meta->type = NVDS_EVENT_MOVING;
+  meta->objType = NVDS_OBJECT_TYPE_VEHICLE;
+  meta->trackingId = id;
+  meta->bbox.width = 100;
+  meta->bbox.height = 50;
+  meta->ts = nvds_event_meta_strdup(meta, "2018-09-10T11:12:13.456Z");
+  meta->objectId = nvds_event_meta_strdup(meta, objectId);
+
+  signature = nvds_event_meta_alloc_signature(meta, SIGNATURE_SIZE);
+  for (i = 0; i < SIGNATURE_SIZE; i++)
+    signature[i] = i * 0.25;
+
+  obj = (NvDsVehicleObject *) nvds_event_meta_alloc_ext(meta,
+                                                        sizeof(*obj));
+  strings = (gchar **) obj;
+  for (i = 0; i < 6; i++)
+    strings[i] = nvds_event_meta_strdup(meta, vehicleStrings[i]);
+  return meta;
+}
+
+/** Returns whether @a copy is a relocated copy of @a src. */
+static gboolean check_copy(const NvDsEventMsgMeta *src,
+                           const NvDsEventMsgMeta *copy)
+{
+  gchar **strings = (gchar **) copy->extMsg;
+  int i;
+
+  if (!in_block(copy, copy->ts) || !in_block(copy, copy->objectId) ||
+      !in_block(copy, copy->extMsg) ||
+      !in_block(copy, copy->objSignature.signature) ||
+      strcmp(copy->ts, src->ts) || strcmp(copy->objectId, src->objectId) ||
+      copy->trackingId != src->trackingId ||
+      copy->extMsgSize != src->extMsgSize ||
+      copy->objSignature.size != src->objSignature.size ||
+      memcmp(copy->objSignature.signature, src->objSignature.signature,
+             src->objSignature.size * sizeof(gdouble)))
+    return FALSE;
+
+  for (i = 0; i < 6; i++) {
+    if (!in_block(copy, strings[i]) || strcmp(strings[i], vehicleStrings[i]))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+static int check_arena(void)
+{
+  NvDsEventMetaArena *arena = nvds_event_meta_arena_new(
+      NVDS_EVENT_META_DEFAULT_BLOCK_SIZE, 1);
+  NvDsEventMsgMeta *meta = new_vehicle_meta(arena, 7);
+  NvDsEventMsgMeta *copy = nvds_event_meta_copy(meta);
+  NvDsEventMsgMeta *reused;
+  const gchar *external = "not in block";
+  int failed = 0;
+
+  // copy stays valid once source is freed
+  nvds_event_meta_free(meta);
+  if (!check_copy(copy, copy) || strcmp(copy->objectId, "7")) {
+    printf("copy not relocated\n");
+    failed = -1;
+  }
+
+  // freed block is reused
+  reused = nvds_event_meta_new(arena);
+  if (reused != meta || reused->ts || reused->extMsg) {
+    printf("free block not reused or not cleared\n");
+    failed = -1;
+  }
+
+  // pointers out of the block are copied as is
+  reused->otherAttrs = (gchar *) external;
+  nvds_event_meta_free(copy);
+  copy = nvds_event_meta_copy(reused);
+  if (copy->otherAttrs != external) {
+    printf("external pointer relocated\n");
+    failed = -1;
+  }
+  nvds_event_meta_free(copy);
+
+  if (nvds_event_meta_alloc(reused, NVDS_EVENT_META_DEFAULT_BLOCK_SIZE, 1)) {
+    printf("allocation beyond block size succeeded\n");
+    failed = -1;
+  }
+  nvds_event_meta_free(reused);
+
+  // arena outlives its owner while metas are in use
+  meta = nvds_event_meta_new(arena);
+  nvds_event_meta_arena_unref(arena);
+  nvds_event_meta_free(meta);
+  return failed;
+}
+
+static gpointer thread_func(gpointer data)
+{
+  NvDsEventMetaArena *arena = (NvDsEventMetaArena *) data;
+  NvDsEventMsgMeta *meta;
+  NvDsEventMsgMeta *copy;
+  gsize errors = 0;
+  int i;
+
+  for (i = 0; i < THREAD_COUNT; i++) {
+    meta = new_vehicle_meta(arena, i);
+    copy = nvds_event_meta_copy(meta);
+    nvds_event_meta_free(meta);
+    if (!check_copy(copy, copy) || copy->trackingId != i)
+      errors++;
+    nvds_event_meta_free(copy);
+  }
+  return GSIZE_TO_POINTER(errors);
+}
+
+static NvDsMsg2pCtx *create_ctx(const char *file)
+{
+  FILE *fp = fopen(file, "w");
+
+  if (!fp)
+    return NULL;
+  fprintf(fp, "[schema]\npretty-print=0\n"
+          "projection=@timestamp;sensor.id;object\n\n"
+          "[sensor0]\nenable=1\ntype=Camera\nid=CAM_0\n"
+          "location=45.29;-75.83;48.15\ndescription=Entrance\n"
+          "coordinate=5.2;10.1;11.2\n\n");
+  fclose(fp);
+  return nvds_msg2p_ctx_create(file, NVDS_PAYLOAD_DEEPSTREAM);
+}
+
+static gchar *generate(NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
+{
+  NvDsEvent event = {meta->type, meta};
+  NvDsPayload *payload = nvds_msg2p_generate(ctx, &event, 1);
+  gchar *json;
+
+  if (!payload)
+    return NULL;
+  json = g_strndup((const gchar *) payload->payload, payload->payloadSize);
+  nvds_msg2p_release(ctx, payload);
+  return json;
+}
+
+/** Heap allocated meta as deepstream-test4 used to build it. */
+static NvDsEventMsgMeta *new_heap_meta(int id)
+{
+  NvDsEventMsgMeta *meta = g_new0(NvDsEventMsgMeta, 1);
+  NvDsVehicleObject *obj = g_new0(NvDsVehicleObject, 1);
+  int i;
+
+  meta->type = NVDS_EVENT_MOVING;
+  meta->objType = NVDS_OBJECT_TYPE_VEHICLE;
+  meta->trackingId = id;
+  meta->bbox.width = 100;
+  meta->bbox.height = 50;
+  meta->ts = g_strdup("2018-09-10T11:12:13.456Z");
+  meta->objectId = g_strdup_printf("%d", id);
+  meta->objSignature.signature = g_new(gdouble, SIGNATURE_SIZE);
+  meta->objSignature.size = SIGNATURE_SIZE;
+  for (i = 0; i < SIGNATURE_SIZE; i++)
+    meta->objSignature.signature[i] = i * 0.25;
+  obj->type = g_strdup(vehicleStrings[0]);
+  obj->make = g_strdup(vehicleStrings[1]);
+  obj->model = g_strdup(vehicleStrings[2]);
+  obj->color = g_strdup(vehicleStrings[3]);
+  obj->region = g_strdup(vehicleStrings[4]);
+  obj->license = g_strdup(vehicleStrings[5]);
+  meta->extMsg = obj;
+  meta->extMsgSize = sizeof(*obj);
+  return meta;
+}
+
+static NvDsEventMsgMeta *copy_heap_meta(const NvDsEventMsgMeta *src)
+{
+  NvDsEventMsgMeta *meta = (NvDsEventMsgMeta *) g_memdup(src, sizeof(*src));
+  NvDsVehicleObject *srcObj = (NvDsVehicleObject *) src->extMsg;
+  NvDsVehicleObject *obj = g_new0(NvDsVehicleObject, 1);
+
+  meta->ts = g_strdup(src->ts);
+  meta->objectId = g_strdup(src->objectId);
+  meta->objSignature.signature = (gdouble *) g_memdup(
+      src->objSignature.signature, src->objSignature.size * sizeof(gdouble));
+  obj->type = g_strdup(srcObj->type);
+  obj->make = g_strdup(srcObj->make);
+  obj->model = g_strdup(srcObj->model);
+  obj->color = g_strdup(srcObj->color);
+  obj->region = g_strdup(srcObj->region);
+  obj->license = g_strdup(srcObj->license);
+  meta->extMsg = obj;
+  return meta;
+}
+
+static void free_heap_meta(NvDsEventMsgMeta *meta)
+{
+  NvDsVehicleObject *obj = (NvDsVehicleObject *) meta->extMsg;
+
+  g_free(obj->type);
+  g_free(obj->make);
+  g_free(obj->model);
+  g_free(obj->color);
+  g_free(obj->region);
+  g_free(obj->license);
+  g_free(obj);
+  g_free(meta->ts);
+  g_free(meta->objectId);
+  g_free(meta->objSignature.signature);
+  g_free(meta);
+}
+
+static int check_payload(const char *file, NvDsEventMetaArena *arena)
+{
+  NvDsMsg2pCtx *ctx = create_ctx(file);
+  NvDsEventMsgMeta *heapMeta = new_heap_meta(42);
+  NvDsEventMsgMeta *arenaMeta = new_vehicle_meta(arena, 42);
+  NvDsEventMsgMeta *copy = nvds_event_meta_copy(arenaMeta);
+  gchar *heapJson = NULL;
+  gchar *arenaJson = NULL;
+  gchar *copyJson = NULL;
+  int failed = 0;
+
+  if (!ctx) {
+    printf("Failed to create context\n");
+    failed = -1;
+    goto done;
+  }
+
+  heapJson = generate(ctx, heapMeta);
+  arenaJson = generate(ctx, arenaMeta);
+  copyJson = generate(ctx, copy);
+  if (!heapJson || g_strcmp0(heapJson, arenaJson) ||
+      g_strcmp0(heapJson, copyJson)) {
+    printf("payloads differ:\n%s\n%s\n%s\n", heapJson, arenaJson, copyJson);
+    failed = -1;
+  }
+
+done:
+  g_free(heapJson);
+  g_free(arenaJson);
+  g_free(copyJson);
+  free_heap_meta(heapMeta);
+  nvds_event_meta_free(arenaMeta);
+  nvds_event_meta_free(copy);
+  if (ctx)
+    nvds_msg2p_ctx_destroy(ctx);
+  return failed;
+}
+
+int main(int argc, char *argv[])
+{
+  char file[] = "/tmp/nvmsgconv_event_meta_XXXXXX";
+  int fd = mkstemp(file);
+  NvDsEventMetaArena *arena = nvds_event_meta_arena_new(
+      NVDS_EVENT_META_DEFAULT_BLOCK_SIZE, 64);
+  GThread *threads[NUM_THREADS];
+  NvDsEventMsgMeta *meta;
+  gsize errors = 0;
+  gint64 start;
+  double heapNs;
+  double arenaNs;
+  int failed = 0;
+  int i;
+
+  if (fd < 0) {
+    printf("Unable to create configuration file\n");
+    return -1;
+  }
+  close(fd);
+
+  failed |= check_arena();
+
+  for (i = 0; i < NUM_THREADS; i++)
+    threads[i] = g_thread_new("event-meta", thread_func, arena);
+  for (i = 0; i < NUM_THREADS; i++)
+    errors += GPOINTER_TO_SIZE(g_thread_join(threads[i]));
+  if (errors) {
+    printf("%" G_GSIZE_FORMAT " bad copies from threads\n", errors);
+    failed = -1;
+  }
+
+  failed |= check_payload(file, arena);
+
+  // build, copy once (one downstream element) and free both
+  start = g_get_monotonic_time();
+  for (i = 0; i < BENCH_COUNT; i++) {
+    meta = new_heap_meta(i);
+    free_heap_meta(copy_heap_meta(meta));
+    free_heap_meta(meta);
+  }
+  heapNs = (g_get_monotonic_time() - start) * 1000.0 / BENCH_COUNT;
+
+  start = g_get_monotonic_time();
+  for (i = 0; i < BENCH_COUNT; i++) {
+    meta = new_vehicle_meta(arena, i);
+    nvds_event_meta_free(nvds_event_meta_copy(meta));
+    nvds_event_meta_free(meta);
+  }
+  arenaNs = (g_get_monotonic_time() - start) * 1000.0 / BENCH_COUNT;
+  printf("event meta + copy: heap %.1f ns (22 allocations), arena %.1f ns\n",
+         heapNs, arenaNs);
+
+  nvds_event_meta_arena_unref(arena);
+  unlink(file);
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+  return failed ? -1 : 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Helpers of nvmsgconv tests generating DeepStream schema payloads.
+ */
+#ifndef _NVDS_TEST_HELPERS_H_
+#define _NVDS_TEST_HELPERS_H_
+
+#include <stdio.h>
+#include <string.h>
+#include "nvmsgconv.h"
+
+/** characters of a uuid in text form. */
+#define TEST_UUID_LEN 36
+
+/**
+ * Writes configuration with @a schema lines in schema group and sensor0,
+ * place0, analytics0 to @a file, returns context of DeepStream schema.
+ */
+static inline NvDsMsg2pCtx *create_ctx(const char *file, const char *schema)
+{
+  FILE *fp = fopen(file, "w");
+
+  if (!fp)
+    return NULL;
+  fprintf(fp, "[schema]\npretty-print=0\n%s\n\n"
+          "[sensor0]\nenable=1\ntype=Camera\nid=CAM_0\n"
+          "location=45.29;-75.83;48.15\ndescription=Entrance\n"
+          "coordinate=5.2;10.1;11.2\n\n"
+          "[place0]\nenable=1\nid=1\ntype=garage\nname=XYZ\n"
+          "location=30.32;-40.55;100.0\ncoordinate=1.0;2.0;3.0\n"
+          "place-sub-field1=walsh\nplace-sub-field2=lane1\n"
+          "place-sub-field3=P2\n\n"
+          "[analytics0]\nenable=1\nid=XYZ\ndescription=detection\n"
+          "source=OpenALR\nversion=1.0\n", schema);
+  fclose(fp);
+  return nvds_msg2p_ctx_create(file, NVDS_PAYLOAD_DEEPSTREAM);
+}
+
+/** Replaces quoted uuids in @a json by '#', those differ for each generation. */
+static inline void mask_ids(gchar *json)
+{
+  size_t len = strlen(json);
+  gchar *p;
+  int i;
+
+  if (len < TEST_UUID_LEN + 2)
+    return;
+  // p[-1] and p[TEST_UUID_LEN] are the quotes
+  for (p = json + 1; p + TEST_UUID_LEN < json + len; p++) {
+    if (p[8] != '-' || p[13] != '-' || p[18] != '-' || p[23] != '-' ||
+        p[-1] != '"' || p[TEST_UUID_LEN] != '"')
+      continue;
+    for (i = 0; i < TEST_UUID_LEN; i++) {
+      if (p[i] != '-')
+        p[i] = '#';
+    }
+  }
+}
+
+/** Returns payload text, @a size (if not NULL) gets its size added. */
+static inline gchar *generate(NvDsMsg2pCtx *ctx, NvDsEvent *event,
+                              guint *size)
+{
+  NvDsPayload *payload = nvds_msg2p_generate(ctx, event, 1);
+  gchar *json;
+
+  if (!payload)
+    return NULL;
+  json = g_strndup((const gchar *) payload->payload, payload->payloadSize);
+  if (size)
+    *size += payload->payloadSize;
+  nvds_msg2p_release(ctx, payload);
+  return json;
+}
+
+/** Returns payload text with uuids replaced by '#'. */
+static inline gchar *generate_masked(NvDsMsg2pCtx *ctx, NvDsEvent *event)
+{
+  gchar *json = generate(ctx, event, NULL);
+
+  if (json)
+    mask_ids(json);
+  return json;
+}
+
+#endif
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Checks layout and uniqueness of ids generated in each id-mode, also
+ * after fork, and compares generation + formatting time against the libuuid
+ * path (uuid_generate_random + uuid_unparse_lower) used before.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <uuid/uuid.h>
+#include <string>
+#include <unordered_set>
+#include "id_generator.h"
+
+#define CHECK_COUNT 100000
+#define BENCH_COUNT 1000000
+
+static const char *mode_name[] = {"libuuid", "v4", "v7", "counter"};
+
+static int check_mode(NvDsIdMode mode)
+{
+  NvDsIdGenerator gen;
+  std::unordered_set<std::string> ids;
+  guint8 id[NVDS_ID_SIZE];
+  guint8 prev[NVDS_ID_SIZE];
+  char str[NVDS_ID_STR_LEN + 1];
+  int version = mode == NVDS_ID_MODE_V7 ? 7 :
+                mode == NVDS_ID_MODE_COUNTER ? 8 : 4;
+  int i;
+
+  id_generator_init(&gen, mode);
+  memset(prev, 0, sizeof(prev));
+
+  for (i = 0; i < CHECK_COUNT; i++) {
+    id_generator_next(&gen, 7, id);
+    id_format(id, str);
+    str[NVDS_ID_STR_LEN] = '\0';
+
+    if ((id[6] >> 4) != version || (id[8] & 0xC0) != 0x80) {
+      printf("%s: wrong version / variant %s\n", mode_name[mode], str);
+      return -1;
+    }
+    if (str[8] != '-' || str[13] != '-' || str[18] != '-' || str[23] != '-') {
+      printf("%s: wrong format %s\n", mode_name[mode], str);
+      return -1;
+    }
+    // time ordered: 48 bit timestamp never goes back.
+    if (mode == NVDS_ID_MODE_V7 && memcmp(id, prev, 6) < 0) {
+      printf("%s: not time ordered %s\n", mode_name[mode], str);
+      return -1;
+    }
+    memcpy(prev, id, sizeof(prev));
+
+    if (!ids.insert(str).second) {
+      printf("%s: duplicate id %s\n", mode_name[mode], str);
+      return -1;
+    }
+  }
+
+  // same text as libuuid formatting.
+  char uuidStr[37];
+  uuid_unparse_lower(id, uuidStr);
+  if (strcmp(uuidStr, str)) {
+    printf("%s: formatted %s, libuuid %s\n", mode_name[mode], str, uuidStr);
+    return -1;
+  }
+
+  return 0;
+}
+
+/** Checks that parent and forked child don't generate the same v4 ids. */
+static int check_fork(void)
+{
+  NvDsIdGenerator gen;
+  guint8 id[NVDS_ID_SIZE];
+  guint8 childId[NVDS_ID_SIZE];
+  int fds[2];
+  pid_t pid;
+  ssize_t len;
+
+  id_generator_init(&gen, NVDS_ID_MODE_V4);
+  // seeded before fork
+  id_generator_next(&gen, 0, id);
+
+  if (pipe(fds))
+    return -1;
+  pid = fork();
+  if (pid < 0)
+    return -1;
+  if (pid == 0) {
+    id_generator_next(&gen, 0, id);
+    _exit(write(fds[1], id, sizeof(id)) == sizeof(id) ? 0 : 1);
+  }
+  close(fds[1]);
+  id_generator_next(&gen, 0, id);
+  len = read(fds[0], childId, sizeof(childId));
+  close(fds[0]);
+  waitpid(pid, NULL, 0);
+
+  if (len != sizeof(childId) || !memcmp(id, childId, sizeof(id))) {
+    printf("v4: same id in parent and forked child\n");
+    return -1;
+  }
+  return 0;
+}
+
+static void bench_mode(NvDsIdMode mode)
+{
+  NvDsIdGenerator gen;
+  guint8 id[NVDS_ID_SIZE];
+  char str[NVDS_ID_STR_LEN + 1];
+  gint64 start;
+  int i;
+
+  id_generator_init(&gen, mode);
+
+  start = g_get_monotonic_time();
+  for (i = 0; i < BENCH_COUNT; i++) {
+    id_generator_next(&gen, i, id);
+    id_format(id, str);
+  }
+  printf("%-20s %8.1f ns/id\n", mode_name[mode],
+         (g_get_monotonic_time() - start) * 1000.0 / BENCH_COUNT);
+}
+
+static void bench_libuuid_unparse(void)
+{
+  uuid_t uuid;
+  char str[37];
+  gint64 start;
+  int i;
+
+  start = g_get_monotonic_time();
+  for (i = 0; i < BENCH_COUNT; i++) {
+    uuid_generate_random(uuid);
+    uuid_unparse_lower(uuid, str);
+  }
+  printf("%-20s %8.1f ns/id\n", "libuuid (unparse)",
+         (g_get_monotonic_time() - start) * 1000.0 / BENCH_COUNT);
+}
+
+int main()
+{
+  int failed = 0;
+
+  failed |= check_mode(NVDS_ID_MODE_LIBUUID);
+  failed |= check_mode(NVDS_ID_MODE_V4);
+  failed |= check_mode(NVDS_ID_MODE_V7);
+  failed |= check_mode(NVDS_ID_MODE_COUNTER);
+  failed |= check_fork();
+
+  bench_libuuid_unparse();
+  bench_mode(NVDS_ID_MODE_LIBUUID);
+  bench_mode(NVDS_ID_MODE_V4);
+  bench_mode(NVDS_ID_MODE_V7);
+  bench_mode(NVDS_ID_MODE_COUNTER);
+
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+  return failed ? -1 : 0;
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Checks NvDsIdTable with dense and sparse ids, then measures per event
+ * cost of sensor lookups (against unordered_map used before) and of
+ * lookup plus payload generation with 10, 1k and 100k sensor tables.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <unordered_map>
+#include "id_table.h"
+#include "nvmsgconv.h"
+
+#define LOOKUP_COUNT 10000000
+#define GENERATE_COUNT 200000
+
+/* same size as configuration objects of the library. */
+struct Entry {
+  gint id;
+  gchar data[100];
+};
+
+static const int tableSizes[] = {10, 1000, 100000};
+
+static int check_table(int count, int stride, int first)
+{
+  NvDsIdTable<Entry> table;
+  Entry entry;
+  Entry *found;
+  int i;
+
+  memset(&entry, 0, sizeof(entry));
+  for (i = 0; i < count; i++) {
+    entry.id = first + i * stride;
+    if (!table.insert(entry.id, entry)) {
+      printf("insert of %d failed\n", entry.id);
+      return -1;
+    }
+  }
+  if (count && table.insert(first, entry)) {
+    printf("duplicate id %d inserted\n", first);
+    return -1;
+  }
+
+  table.freeze();
+  for (i = 0; i < count; i++) {
+    found = table.find(first + i * stride);
+    if (!found || found->id != first + i * stride) {
+      printf("id %d not found\n", first + i * stride);
+      return -1;
+    }
+  }
+  if ((stride > 1 && table.find(first + 1)) || table.find(first - 1) ||
+      table.find(first + count * stride) || table.find(G_MAXINT) ||
+      table.find(G_MININT)) {
+    printf("found id which wasn't inserted\n");
+    return -1;
+  }
+
+  printf("%6d ids, stride %6d from %6d: %s\n", count, stride, first,
+         table.isDense ? "dense" : "sparse");
+  return 0;
+}
+
+static void bench_lookup(int count, int stride)
+{
+  NvDsIdTable<Entry> table;
+  std::unordered_map<int, Entry> map;
+  std::vector<int> ids(4096);
+  Entry entry;
+  gint64 start;
+  gint64 sum = 0;
+  double tableNs, mapNs;
+  int i;
+
+  memset(&entry, 0, sizeof(entry));
+  for (i = 0; i < count; i++) {
+    entry.id = i * stride;
+    table.insert(entry.id, entry);
+    map.insert(std::make_pair(entry.id, entry));
+  }
+  table.freeze();
+
+  for (i = 0; i < (int) ids.size(); i++)
+    ids[i] = (rand() % count) * stride;
+
+  start = g_get_monotonic_time();
+  for (i = 0; i < LOOKUP_COUNT; i++)
+    sum += table.find(ids[i & 4095])->id;
+  tableNs = (g_get_monotonic_time() - start) * 1000.0 / LOOKUP_COUNT;
+
+  start = g_get_monotonic_time();
+  for (i = 0; i < LOOKUP_COUNT; i++)
+    sum -= map.find(ids[i & 4095])->second.id;
+  mapNs = (g_get_monotonic_time() - start) * 1000.0 / LOOKUP_COUNT;
+
+  printf("lookup %6d %-6s  id table %5.1f ns  unordered_map %5.1f ns%s\n",
+         count, stride > 1 ? "sparse" : "dense", tableNs, mapNs,
+         sum ? " (mismatch)" : "");
+}
+
+static int bench_generate(const char *file, int count)
+{
+  NvDsMsg2pCtx *ctx;
+  NvDsEventMsgMeta meta;
+  NvDsEvent event;
+  NvDsPayload *payload;
+  FILE *fp;
+  gint64 start;
+  int i;
+
+  fp = fopen(file, "w");
+  if (!fp)
+    return -1;
+  fprintf(fp, "cameraId,sensorId,description,cameraIDstring,spot,level,lane\n");
+  for (i = 0; i < count; i++)
+    fprintf(fp, "%d,CAM_%d,Lane %d,C%d,S%d,P%d,L%d\n", i, i, i, i, i, i % 4,
+            i % 3);
+  fclose(fp);
+
+  ctx = nvds_msg2p_ctx_create(file, NVDS_PAYLOAD_DEEPSTREAM);
+  if (!ctx)
+    return -1;
+
+  memset(&meta, 0, sizeof(meta));
+  meta.type = NVDS_EVENT_PARKED;
+  meta.objType = NVDS_OBJECT_TYPE_VEHICLE;
+  meta.ts = (gchar *) "2018-09-10T11:12:13.456Z";
+  meta.objectId = (gchar *) "obj";
+  event.eventType = meta.type;
+  event.metadata = &meta;
+
+  start = g_get_monotonic_time();
+  for (i = 0; i < GENERATE_COUNT; i++) {
+    meta.sensorId = meta.placeId = meta.moduleId = rand() % count;
+    payload = nvds_msg2p_generate(ctx, &event, 1);
+    nvds_msg2p_release(ctx, payload);
+  }
+  printf("generate %6d sensors  %7.1f ns/event\n", count,
+         (g_get_monotonic_time() - start) * 1000.0 / GENERATE_COUNT);
+
+  nvds_msg2p_ctx_destroy(ctx);
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  char file[] = "/tmp/nvmsgconv_sensors_XXXXXX.csv";
+  int fd;
+  int failed = 0;
+  unsigned i;
+
+  failed |= check_table(1000, 1, 0);
+  failed |= check_table(1000, 3, -1500);
+  failed |= check_table(1000, 100003, 7);
+  failed |= check_table(10, 1000, 0);
+  failed |= check_table(0, 1, 0);
+
+  for (i = 0; i < G_N_ELEMENTS(tableSizes); i++) {
+    bench_lookup(tableSizes[i], 1);
+    bench_lookup(tableSizes[i], 7919);
+  }
+
+  fd = mkstemps(file, 4);
+  if (fd < 0) {
+    printf("Unable to create configuration file\n");
+    return -1;
+  }
+  close(fd);
+  for (i = 0; i < G_N_ELEMENTS(tableSizes); i++)
+    failed |= bench_generate(file, tableSizes[i]);
+  unlink(file);
+
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+  return failed ? -1 : 0;
+}
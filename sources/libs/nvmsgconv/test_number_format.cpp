@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Checks that formatted doubles and floats read back to the same value and
+ * how often they are longer than the shortest text, checks base64 encoding,
+ * signatures of payloads in each signature-format (default one formatted as
+ * g_ascii_dtostr like json-glib) and compares formatting
+ * time against g_ascii_dtostr used before.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include <unistd.h>
+#include <vector>
+#include "number_format.h"
+#include "nvmsgconv.h"
+
+#define CHECK_COUNT 1000000
+#define SHORTEST_COUNT 20000
+#define BENCH_COUNT 2000000
+#define SIGNATURE_SIZE 256
+
+static guint64 rand64(void)
+{
+  return ((guint64) rand() << 62) ^ ((guint64) rand() << 31) ^ rand();
+}
+
+static int check_double(gdouble value)
+{
+  gchar buf[NVDS_NUMBER_BUF_SIZE + 1];
+  guint len = format_double(value, buf);
+
+  buf[len] = '\0';
+  if (strtod(buf, NULL) != value || signbit(strtod(buf, NULL)) !=
+      signbit(value)) {
+    printf("%.17g formatted as %s\n", value, buf);
+    return -1;
+  }
+  return 0;
+}
+
+static int check_float(gfloat value)
+{
+  gchar buf[NVDS_NUMBER_BUF_SIZE + 1];
+  guint len = format_float(value, buf);
+
+  buf[len] = '\0';
+  if (strtof(buf, NULL) != value) {
+    printf("%.9g formatted as %s\n", value, buf);
+    return -1;
+  }
+  return 0;
+}
+
+/** number of significant digits of the shortest %g text reading back. */
+static guint shortest_digits(gdouble value)
+{
+  gchar buf[40];
+  int precision;
+
+  for (precision = 1; precision < 17; precision++) {
+    snprintf(buf, sizeof(buf), "%.*g", precision, value);
+    if (strtod(buf, NULL) == value)
+      break;
+  }
+  return precision;
+}
+
+static guint digits_of(const gchar *str, guint len)
+{
+  guint digits = 0;
+  guint i;
+
+  // significant digits, leading zeros are not counted
+  for (i = 0; i < len && str[i] != 'e'; i++) {
+    if (str[i] >= '1' && str[i] <= '9')
+      digits++;
+    else if (str[i] == '0' && digits)
+      digits++;
+  }
+  return digits;
+}
+
+static int check_layout(gdouble value, const char *expected)
+{
+  gchar buf[NVDS_NUMBER_BUF_SIZE + 1];
+  guint len = format_double(value, buf);
+
+  buf[len] = '\0';
+  if (strcmp(buf, expected)) {
+    printf("%.17g formatted as %s instead of %s\n", value, buf, expected);
+    return -1;
+  }
+  return 0;
+}
+
+static int check_base64(const char *data, const char *expected)
+{
+  gchar out[64];
+  gsize len = strlen(data);
+
+  base64_encode((const guint8 *) data, len, out);
+  out[NVDS_BASE64_LEN(len)] = '\0';
+  if (strcmp(out, expected)) {
+    printf("base64 of \"%s\" is %s instead of %s\n", data, out, expected);
+    return -1;
+  }
+  return 0;
+}
+
+static int base64_value(char c)
+{
+  const char *chars =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  const char *p = strchr(chars, c);
+
+  return p && c ? p - chars : -1;
+}
+
+/** Checks that signature of payload has the values of @a signature. */
+static int check_payload(const char *format)
+{
+  char file[] = "/tmp/nvmsgconv_signature_XXXXXX";
+  int fd = mkstemp(file);
+  gdouble signature[SIGNATURE_SIZE];
+  guint8 bytes[SIGNATURE_SIZE * 4];
+  NvDsEventMsgMeta meta;
+  NvDsEvent event;
+  NvDsMsg2pCtx *ctx;
+  NvDsPayload *payload;
+  gchar *json = NULL;
+  gchar *p;
+  gfloat value;
+  guint32 bits;
+  guint n = 0;
+  int ret = -1;
+  int i;
+  FILE *fp;
+
+  if (fd < 0)
+    return -1;
+  fp = fdopen(fd, "w");
+  fprintf(fp, "[schema]\npretty-print=0\nsignature-format=%s\n\n"
+          "[sensor0]\nenable=1\nid=CAM\nlocation=1;2;3\ncoordinate=1;2;3\n\n"
+          "[place0]\nenable=1\nid=1\nlocation=1;2;3\ncoordinate=1;2;3\n\n"
+          "[analytics0]\nenable=1\nid=XYZ\n", format);
+  fclose(fp);
+  ctx = nvds_msg2p_ctx_create(file, NVDS_PAYLOAD_DEEPSTREAM);
+  unlink(file);
+  if (!ctx)
+    return -1;
+
+  for (i = 0; i < SIGNATURE_SIZE; i++)
+    signature[i] = (gfloat) (rand() / (gdouble) RAND_MAX - 0.5);
+  // exact doubles as well, unless only floats are kept
+  if (!strcmp(format, "double") || !strcmp(format, "shortest"))
+    signature[0] = 0.1;
+  // whole number, written with ".0"
+  signature[1] = 2.0;
+
+  memset(&meta, 0, sizeof(meta));
+  meta.type = NVDS_EVENT_MOVING;
+  meta.objType = NVDS_OBJECT_TYPE_PERSON;
+  meta.ts = (gchar *) "2018-09-10T11:12:13.456Z";
+  meta.objectId = (gchar *) "obj";
+  meta.objSignature.signature = signature;
+  meta.objSignature.size = SIGNATURE_SIZE;
+  event.eventType = meta.type;
+  event.metadata = &meta;
+
+  payload = nvds_msg2p_generate(ctx, &event, 1);
+  if (!payload)
+    goto done;
+  json = g_strndup((const gchar *) payload->payload, payload->payloadSize);
+  nvds_msg2p_release(ctx, payload);
+
+  p = strstr(json, "\"signature\":");
+  if (!p)
+    goto done;
+  p += strlen("\"signature\":");
+
+  if (!strcmp(format, "base64")) {
+    int v[4];
+
+    if (*p++ != '"')
+      goto done;
+    // padding '=' ends the data
+    while (n < sizeof(bytes) && *p != '"') {
+      for (i = 0; i < 4; i++)
+        v[i] = p[i] == '=' ? 0 : base64_value(p[i]);
+      if (v[0] < 0 || v[1] < 0 || v[2] < 0 || v[3] < 0)
+        goto done;
+      bytes[n++] = (v[0] << 2) | (v[1] >> 4);
+      if (p[2] != '=' && n < sizeof(bytes))
+        bytes[n++] = (v[1] << 4) | (v[2] >> 2);
+      if (p[3] != '=' && n < sizeof(bytes))
+        bytes[n++] = (v[2] << 6) | v[3];
+      p += 4;
+    }
+    if (n != sizeof(bytes) || *p != '"')
+      goto done;
+    for (i = 0; i < SIGNATURE_SIZE; i++) {
+      memcpy(&bits, bytes + i * 4, 4);
+      bits = GUINT32_FROM_LE(bits);
+      memcpy(&value, &bits, 4);
+      if (value != (gfloat) signature[i])
+        goto done;
+    }
+  } else {
+    if (*p != '[')
+      goto done;
+    for (i = 0; i < SIGNATURE_SIZE; i++) {
+      p++;
+      if (!strcmp(format, "double")) {
+        gchar expected[G_ASCII_DTOSTR_BUF_SIZE + 2];
+
+        g_ascii_dtostr(expected, G_ASCII_DTOSTR_BUF_SIZE, signature[i]);
+        if (!strchr(expected, '.'))
+          strcat(expected, ".0");
+        if (strncmp(p, expected, strlen(expected)))
+          goto done;
+      }
+      if (!strcmp(format, "float") ? strtof(p, &p) != (gfloat) signature[i] :
+          strtod(p, &p) != signature[i])
+        goto done;
+      if (*p != (i == SIGNATURE_SIZE - 1 ? ']' : ','))
+        goto done;
+    }
+  }
+  printf("signature-format=%-8s %u bytes\n", format,
+         (guint) strlen(json));
+  ret = 0;
+
+done:
+  if (ret)
+    printf("signature-format=%s: wrong signature in\n%s\n", format, json);
+  g_free(json);
+  nvds_msg2p_ctx_destroy(ctx);
+  return ret;
+}
+
+/** Checks that signatures in @a format are rejected with json-glib writer. */
+static int check_needs_direct_writer(const char *format)
+{
+  char file[] = "/tmp/nvmsgconv_signature_XXXXXX";
+  int fd = mkstemp(file);
+  NvDsMsg2pCtx *ctx;
+  FILE *fp;
+
+  if (fd < 0)
+    return -1;
+  fp = fdopen(fd, "w");
+  fprintf(fp, "[schema]\ndirect-writer=0\nsignature-format=%s\n", format);
+  fclose(fp);
+  ctx = nvds_msg2p_ctx_create(file, NVDS_PAYLOAD_DEEPSTREAM);
+  unlink(file);
+  if (ctx) {
+    printf("signature-format=%s accepted with direct-writer=0\n", format);
+    nvds_msg2p_ctx_destroy(ctx);
+    return -1;
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+  std::vector<gdouble> values(4096);
+  guint64 bits;
+  gdouble value;
+  gfloat fvalue;
+  guint longer = 0;
+  gint64 start;
+  double dtostrNs, formatNs, floatNs;
+  int failed = 0;
+  int i;
+
+  failed |= check_layout(0.0, "0");
+  failed |= check_layout(-0.0, "-0");
+  failed |= check_layout(1.0, "1");
+  failed |= check_layout(-2.5, "-2.5");
+  failed |= check_layout(0.1, "0.1");
+  failed |= check_layout(0.0001, "0.0001");
+  failed |= check_layout(0.00001, "1e-05");
+  failed |= check_layout(123.456, "123.456");
+  failed |= check_layout(1e16, "10000000000000000");
+  failed |= check_layout(1e17, "1e+17");
+  failed |= check_layout(1.5e300, "1.5e+300");
+  failed |= check_layout(5e-324, "5e-324");
+  failed |= check_layout(DBL_MAX, "1.7976931348623157e+308");
+  failed |= check_layout(45.293701447, "45.293701447");
+
+  failed |= check_base64("", "");
+  failed |= check_base64("M", "TQ==");
+  failed |= check_base64("Ma", "TWE=");
+  failed |= check_base64("Man", "TWFu");
+  failed |= check_base64("any carnal pleasure.", "YW55IGNhcm5hbCBwbGVhc3VyZS4=");
+
+  // random bit patterns cover all exponents, including subnormals
+  for (i = 0; i < CHECK_COUNT && !failed; i++) {
+    bits = rand64();
+    memcpy(&value, &bits, sizeof(value));
+    if (isfinite(value))
+      failed |= check_double(value);
+    fvalue = (gfloat) (rand() / (gdouble) RAND_MAX - 0.5);
+    failed |= check_float(fvalue);
+    memcpy(&fvalue, &bits, sizeof(fvalue));
+    if (isfinite(fvalue))
+      failed |= check_float(fvalue);
+  }
+
+  for (i = 0; i < SHORTEST_COUNT; i++) {
+    gchar out[NVDS_NUMBER_BUF_SIZE];
+    guint len;
+
+    bits = rand64();
+    memcpy(&value, &bits, sizeof(value));
+    if (!isfinite(value) || value == 0)
+      continue;
+    len = format_double(value, out);
+    if (digits_of(out, len) > shortest_digits(value))
+      longer++;
+  }
+  printf("%u of %d values are longer than shortest\n", longer,
+         SHORTEST_COUNT);
+
+  failed |= check_payload("double");
+  failed |= check_payload("shortest");
+  failed |= check_payload("float");
+  failed |= check_payload("base64");
+  failed |= check_needs_direct_writer("shortest");
+  failed |= check_needs_direct_writer("float");
+
+  // signature like values: floats in doubles
+  for (i = 0; i < (int) values.size(); i++)
+    values[i] = (gfloat) (rand() / (gdouble) RAND_MAX - 0.5);
+
+  start = g_get_monotonic_time();
+  for (i = 0; i < BENCH_COUNT; i++)
+    g_ascii_dtostr(buf, sizeof(buf), values[i & 4095]);
+  dtostrNs = (g_get_monotonic_time() - start) * 1000.0 / BENCH_COUNT;
+
+  start = g_get_monotonic_time();
+  for (i = 0; i < BENCH_COUNT; i++)
+    format_double(values[i & 4095], buf);
+  formatNs = (g_get_monotonic_time() - start) * 1000.0 / BENCH_COUNT;
+
+  start = g_get_monotonic_time();
+  for (i = 0; i < BENCH_COUNT; i++)
+    format_float((gfloat) values[i & 4095], buf);
+  floatNs = (g_get_monotonic_time() - start) * 1000.0 / BENCH_COUNT;
+
+  printf("g_ascii_dtostr %6.1f ns  format_double %6.1f ns  "
+         "format_float %6.1f ns\n", dtostrNs, formatNs, floatNs);
+
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+  return failed ? -1 : 0;
+}
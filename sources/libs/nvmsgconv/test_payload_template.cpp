@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Checks custom payloads generated from a template: event and
+ * configuration fields, escaping, missing entries, reload, and rejection of
+ * invalid templates at context creation. Reports generation time against
+ * the DeepStream schema payload.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "nvmsgconv.h"
+#include "test_helpers.h"
+
+#define BENCH_COUNT 100000
+
+static const char *templateText =
+    "{\"id\":\"{{messageid}}\",\"ts\":\"{{ @timestamp }}\","
+    "\"type\":\"{{event.type}}\",\n"
+    "\"camera\":\"{{sensor.id}}\",\"lat\":{{sensor.location.lat}},"
+    "\"place\":\"{{place.name}}/{{place.subField2}}\","
+    "\"module\":\"{{analyticsModule.version}}\",\n"
+    "\"object\":{\"track\":{{object.id}},\"name\":\"{{object.objectId}}\","
+    "\"kind\":\"{{object.type}}\",\"class\":{{object.classId}},"
+    "\"conf\":{{object.confidence}},\"box\":[{{object.bbox.topleftx}},"
+    "{{object.bbox.toplefty}},{{object.bbox.bottomrightx}},"
+    "{{object.bbox.bottomrighty}}],\"x\":{{object.coordinate.x}}}}";
+
+static const char *expectedPayload =
+    "{\"id\":\"########-####-####-####-############\","
+    "\"ts\":\"2018-09-10T11:12:13.456Z\",\"type\":\"moving\",\n"
+    "\"camera\":\"CAM_0\",\"lat\":45.29,\"place\":\"XYZ/lane1\","
+    "\"module\":\"1.0\",\n"
+    "\"object\":{\"track\":7,\"name\":\"car \\\"7\\\"\",\"kind\":\"vehicle\","
+    "\"class\":2,\"conf\":0.75,\"box\":[10,20,110,70],\"x\":-1.5}}";
+
+/** Writes configuration with template of @a text, @a sensorId of sensor0. */
+static gboolean write_config(const char *file, const char *tplFile,
+                             const char *text, const char *sensorId)
+{
+  FILE *fp = fopen(tplFile, "w");
+
+  if (!fp)
+    return FALSE;
+  fputs(text, fp);
+  fclose(fp);
+
+  fp = fopen(file, "w");
+  if (!fp)
+    return FALSE;
+  fprintf(fp, "[schema]\ntemplate=%s\n\n"
+          "[sensor0]\nenable=1\ntype=Camera\nid=%s\n"
+          "location=45.29;-75.83;48.15\ndescription=Entrance\n"
+          "coordinate=5.2;10.1;11.2\n\n"
+          "[place0]\nenable=1\nid=1\ntype=garage\nname=XYZ\n"
+          "location=30.32;-40.55;100.0\ncoordinate=1.0;2.0;3.0\n"
+          "place-sub-field1=walsh\nplace-sub-field2=lane1\n"
+          "place-sub-field3=P2\n\n"
+          "[analytics0]\nenable=1\nid=XYZ\ndescription=detection\n"
+          "source=OpenALR\nversion=1.0\n", tplFile, sensorId);
+  fclose(fp);
+  return TRUE;
+}
+
+static void init_meta(NvDsEventMsgMeta *meta, NvDsEvent *event)
+{
+  memset(meta, 0, sizeof(NvDsEventMsgMeta));
+  meta->type = NVDS_EVENT_MOVING;
+  meta->objType = NVDS_OBJECT_TYPE_VEHICLE;
+  meta->objClassId = 2;
+  meta->confidence = 0.75;
+  meta->trackingId = 7;
+  meta->bbox.left = 10;
+  meta->bbox.top = 20;
+  meta->bbox.width = 100;
+  meta->bbox.height = 50;
+  meta->coordinate.x = -1.5;
+  meta->ts = (gchar *) "2018-09-10T11:12:13.456Z";
+  meta->objectId = (gchar *) "car \"7\"";
+  event->eventType = meta->type;
+  event->metadata = meta;
+}
+
+static double bench(NvDsMsg2pCtx *ctx, NvDsEvent *event)
+{
+  gint64 start = g_get_monotonic_time();
+  int i;
+
+  for (i = 0; i < BENCH_COUNT; i++)
+    nvds_msg2p_release(ctx, nvds_msg2p_generate(ctx, event, 1));
+  return (g_get_monotonic_time() - start) * 1000.0 / BENCH_COUNT;
+}
+
+/** Checks that context creation fails for template @a text. */
+static int check_rejected(const char *file, const char *tplFile,
+                          const char *text)
+{
+  NvDsMsg2pCtx *ctx;
+
+  if (!write_config(file, tplFile, text, "CAM_0"))
+    return -1;
+  ctx = nvds_msg2p_ctx_create(file, NVDS_PAYLOAD_CUSTOM);
+  if (ctx) {
+    printf("invalid template accepted: %s\n", text);
+    nvds_msg2p_ctx_destroy(ctx);
+    return -1;
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  char file[] = "/tmp/nvmsgconv_template_XXXXXX";
+  char tplFile[] = "/tmp/nvmsgconv_template_tpl_XXXXXX";
+  int fd = mkstemp(file);
+  int tplFd = mkstemp(tplFile);
+  NvDsMsg2pCtx *ctx = NULL;
+  NvDsMsg2pCtx *schemaCtx = NULL;
+  NvDsEventMsgMeta meta;
+  NvDsEvent event;
+  gchar *json = NULL;
+  int failed = 0;
+
+  if (fd < 0 || tplFd < 0) {
+    printf("Unable to create configuration file\n");
+    return -1;
+  }
+  close(fd);
+  close(tplFd);
+  init_meta(&meta, &event);
+
+  if (write_config(file, tplFile, templateText, "CAM_0")) {
+    ctx = nvds_msg2p_ctx_create(file, NVDS_PAYLOAD_CUSTOM);
+    schemaCtx = nvds_msg2p_ctx_create(file, NVDS_PAYLOAD_DEEPSTREAM);
+  }
+  if (!ctx || !schemaCtx) {
+    printf("Failed to create contexts\n");
+    failed = -1;
+    goto done;
+  }
+
+  json = generate_masked(ctx, &event);
+  if (!json || strcmp(json, expectedPayload)) {
+    printf("unexpected payload:\n%s\n", json ? json : "");
+    failed = -1;
+  }
+  g_free(json);
+
+  // missing entries give empty values
+  meta.sensorId = 5;
+  meta.placeId = 5;
+  json = generate_masked(ctx, &event);
+  if (!json || !strstr(json, "\"camera\":\"\",\"lat\":0,\"place\":\"/\"")) {
+    printf("unexpected payload for missing entries:\n%s\n", json ? json : "");
+    failed = -1;
+  }
+  g_free(json);
+  meta.sensorId = 0;
+  meta.placeId = 0;
+
+  printf("template %.1f ns, deepstream schema %.1f ns\n", bench(ctx, &event),
+         bench(schemaCtx, &event));
+
+  // configuration fields come from reloaded tables
+  if (!write_config(file, tplFile, templateText, "CAM_1") ||
+      !nvds_msg2p_reload(ctx)) {
+    failed = -1;
+  } else {
+    json = generate_masked(ctx, &event);
+    if (!json || !strstr(json, "\"camera\":\"CAM_1\"")) {
+      printf("unexpected payload after reload:\n%s\n", json ? json : "");
+      failed = -1;
+    }
+    g_free(json);
+  }
+
+  failed |= check_rejected(file, tplFile, "{\"id\":{{object.height}}}");
+  failed |= check_rejected(file, tplFile, "{\"id\":\n{{messageid}");
+
+done:
+  if (ctx)
+    nvds_msg2p_ctx_destroy(ctx);
+  if (schemaCtx)
+    nvds_msg2p_ctx_destroy(schemaCtx);
+  unlink(file);
+  unlink(tplFile);
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+  return failed ? -1 : 0;
+}
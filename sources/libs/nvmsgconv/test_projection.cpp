@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Checks payloads generated with projection profiles: full profile gives
+ * the default payload, minimal profile only has selected fields, also after
+ * reload, and invalid profiles are rejected. Reports size and generation
+ * time of default and minimal payloads.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "nvmsgconv.h"
+#include "test_helpers.h"
+
+#define BENCH_COUNT 100000
+
+static const char *fullProfile =
+    "messageid;mdsversion;@timestamp;place;sensor;analyticsModule;object;"
+    "event;videoPath";
+
+static const char *minimalProfile =
+    "messageid;@timestamp;sensor.id;object.id;object.bbox;object.classId;"
+    "object.confidence";
+
+static const char *minimalPayload =
+    "{\"messageid\":\"########-####-####-####-############\","
+    "\"@timestamp\":\"2018-09-10T11:12:13.456Z\",\"sensor\":{\"id\":\"CAM_0\"},"
+    "\"object\":{\"id\":\"7\",\"bbox\":{\"topleftx\":10,\"toplefty\":20,"
+    "\"bottomrightx\":110,\"bottomrighty\":70},\"classId\":2,"
+    "\"confidence\":0.75}}";
+
+static NvDsVehicleObject vehicle = {
+  (gchar *) "sedan", (gchar *) "Bugatti", (gchar *) "M",
+  (gchar *) "blue", (gchar *) "CA", (gchar *) "XX1234"
+};
+
+static void init_meta(NvDsEventMsgMeta *meta, NvDsEvent *event)
+{
+  memset(meta, 0, sizeof(NvDsEventMsgMeta));
+  meta->type = NVDS_EVENT_MOVING;
+  meta->objType = NVDS_OBJECT_TYPE_VEHICLE;
+  meta->objClassId = 2;
+  meta->confidence = 0.75;
+  meta->trackingId = 7;
+  meta->bbox.left = 10;
+  meta->bbox.top = 20;
+  meta->bbox.width = 100;
+  meta->bbox.height = 50;
+  meta->ts = (gchar *) "2018-09-10T11:12:13.456Z";
+  meta->objectId = (gchar *) "obj";
+  meta->extMsg = &vehicle;
+  meta->extMsgSize = sizeof(vehicle);
+  event->eventType = meta->type;
+  event->metadata = meta;
+}
+
+static double bench(NvDsMsg2pCtx *ctx, NvDsEvent *event)
+{
+  gint64 start = g_get_monotonic_time();
+  int i;
+
+  for (i = 0; i < BENCH_COUNT; i++)
+    nvds_msg2p_release(ctx, nvds_msg2p_generate(ctx, event, 1));
+  return (g_get_monotonic_time() - start) * 1000.0 / BENCH_COUNT;
+}
+
+int main(int argc, char *argv[])
+{
+  char file[] = "/tmp/nvmsgconv_projection_XXXXXX";
+  int fd = mkstemp(file);
+  NvDsMsg2pCtx *ctx;
+  NvDsMsg2pCtx *fullCtx;
+  NvDsMsg2pCtx *minimalCtx;
+  NvDsEventMsgMeta meta;
+  NvDsEvent event;
+  gchar *schema;
+  gchar *json = NULL;
+  gchar *full = NULL;
+  gchar *minimal = NULL;
+  int failed = 0;
+
+  if (fd < 0) {
+    printf("Unable to create configuration file\n");
+    return -1;
+  }
+  close(fd);
+  init_meta(&meta, &event);
+
+  ctx = create_ctx(file, "");
+  schema = g_strdup_printf("projection=%s", fullProfile);
+  fullCtx = create_ctx(file, schema);
+  g_free(schema);
+  schema = g_strdup_printf("projection=%s", minimalProfile);
+  minimalCtx = create_ctx(file, schema);
+  g_free(schema);
+  if (!ctx || !fullCtx || !minimalCtx) {
+    printf("Failed to create contexts\n");
+    unlink(file);
+    return -1;
+  }
+
+  json = generate_masked(ctx, &event);
+  full = generate_masked(fullCtx, &event);
+  if (!json || !full || strcmp(json, full)) {
+    printf("full profile payload differs:\n%s\n%s\n", json, full);
+    failed = -1;
+  }
+
+  minimal = generate_masked(minimalCtx, &event);
+  if (!minimal || strcmp(minimal, minimalPayload)) {
+    printf("unexpected minimal payload:\n%s\n", minimal);
+    failed = -1;
+  }
+  g_free(minimal);
+
+  // fragments of reloaded tables are projected too
+  if (!nvds_msg2p_reload(minimalCtx)) {
+    failed = -1;
+  } else {
+    minimal = generate_masked(minimalCtx, &event);
+    if (!minimal || strcmp(minimal, minimalPayload)) {
+      printf("unexpected minimal payload after reload:\n%s\n", minimal ? minimal : "");
+      failed = -1;
+    }
+  }
+
+  printf("default %u bytes %.1f ns, minimal %u bytes %.1f ns\n",
+         (guint) strlen(json), bench(ctx, &event),
+         minimal ? (guint) strlen(minimal) : 0, bench(minimalCtx, &event));
+
+  g_free(json);
+  g_free(full);
+  g_free(minimal);
+  nvds_msg2p_ctx_destroy(ctx);
+  nvds_msg2p_ctx_destroy(fullCtx);
+  nvds_msg2p_ctx_destroy(minimalCtx);
+
+  ctx = create_ctx(file, "projection=object.height");
+  if (ctx) {
+    printf("unknown field accepted\n");
+    nvds_msg2p_ctx_destroy(ctx);
+    failed = -1;
+  }
+  ctx = create_ctx(file, "direct-writer=0\nprojection=object.id");
+  if (ctx) {
+    printf("projection accepted without direct writer\n");
+    nvds_msg2p_ctx_destroy(ctx);
+    failed = -1;
+  }
+
+  unlink(file);
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+  return failed ? -1 : 0;
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2018 NVIDIA Corporation.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ */
+
+/*
+ * Checks nvds_format_timestamp against strftime, also from several threads,
+ * and @timestamp of payloads for ts, tsEpochNs and timestamp-format=epoch-ms.
+ * tsEpochNs is only read with ts-epoch-ns=1.
+ * Reports formatting time against strftime.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "nvmsgconv.h"
+#include "nvds_timestamp.h"
+#include "test_helpers.h"
+
+#define CHECK_COUNT 1000000
+#define BENCH_COUNT 1000000
+#define NUM_THREADS 4
+#define PROJECTION "projection=@timestamp;sensor.id\n"
+
+/* 2018-09-10T11:12:13.456Z */
+#define EVENT_TIME_NS G_GUINT64_CONSTANT(1536577933456000000)
+
+/** Same formatting as generate_ts_rfc3339 of deepstream-test4. */
+static void format_strftime(guint64 epochNs, char *buf, int size)
+{
+  time_t tloc = epochNs / NVDS_NSEC_PER_SEC;
+  struct tm tm;
+  char strmsec[6];
+
+  gmtime_r(&tloc, &tm);
+  strftime(buf, size, "%Y-%m-%dT%H:%M:%S", &tm);
+  g_snprintf(strmsec, sizeof(strmsec), ".%.3dZ",
+             (int) (epochNs % NVDS_NSEC_PER_SEC / 1000000));
+  strncat(buf, strmsec, size - strlen(buf) - 1);
+}
+
+/** Formats increasing times from @a data, returns number of mismatches. */
+static gpointer check_thread(gpointer data)
+{
+  guint64 t = *(guint64 *) data;
+  char expected[64];
+  char buf[NVDS_TIMESTAMP_LEN + 1];
+  guint64 errors = 0;
+  unsigned seed = (unsigned) t;
+  int i;
+
+  for (i = 0; i < CHECK_COUNT; i++) {
+    // steps of 1..1000 us, crossing seconds every few hundred calls
+    t += (rand_r(&seed) % 1000 + 1) * 1000 + (i % 7);
+    format_strftime(t, expected, sizeof(expected));
+    if (nvds_format_timestamp(t, buf) != NVDS_TIMESTAMP_LEN ||
+        strcmp(buf, expected)) {
+      if (!errors)
+        printf("%" G_GUINT64_FORMAT ": %s, expected %s\n", t, buf, expected);
+      errors++;
+    }
+  }
+  return GSIZE_TO_POINTER(errors);
+}
+
+/** Returns @timestamp member of payload for @a meta. */
+static gchar *get_timestamp(NvDsMsg2pCtx *ctx, NvDsEventMsgMeta *meta)
+{
+  NvDsEvent event = {meta->type, meta};
+  NvDsPayload *payload = nvds_msg2p_generate(ctx, &event, 1);
+  gchar *json;
+  gchar *ts = NULL;
+  gchar *end;
+
+  if (!payload)
+    return NULL;
+  json = g_strndup((const gchar *) payload->payload, payload->payloadSize);
+  nvds_msg2p_release(ctx, payload);
+
+  ts = strstr(json, "\"@timestamp\":");
+  if (ts) {
+    ts += strlen("\"@timestamp\":");
+    end = strchr(ts, ',');
+    ts = end ? g_strndup(ts, end - ts) : NULL;
+  }
+  g_free(json);
+  return ts;
+}
+
+static int check_payload(const char *file)
+{
+  const char *isoTs = "\"2018-09-10T11:12:13.456Z\"";
+  const char *epochTs = "1536577933456";
+  NvDsMsg2pCtx *ctx = create_ctx(file, PROJECTION "ts-epoch-ns=1");
+  NvDsMsg2pCtx *epochCtx =
+      create_ctx(file, PROJECTION "ts-epoch-ns=1\ntimestamp-format=epoch-ms");
+  NvDsMsg2pCtx *legacyCtx = create_ctx(file, PROJECTION "");
+  NvDsEventMsgMeta meta;
+  gchar *fromTs = NULL;
+  gchar *fromEpoch = NULL;
+  gchar *epochFromTs = NULL;
+  gchar *epochFromEpoch = NULL;
+  gchar *legacyFromEpoch = NULL;
+  int failed = 0;
+
+  if (!ctx || !epochCtx || !legacyCtx) {
+    printf("Failed to create contexts\n");
+    failed = -1;
+    goto done;
+  }
+
+  memset(&meta, 0, sizeof(meta));
+  meta.type = NVDS_EVENT_ENTRY;
+  meta.objType = NVDS_OBJECT_TYPE_CUSTOM;
+  meta.ts = (gchar *) "2018-09-10T11:12:13.456Z";
+  fromTs = get_timestamp(ctx, &meta);
+  epochFromTs = get_timestamp(epochCtx, &meta);
+
+  meta.ts = NULL;
+  meta.tsEpochNs = EVENT_TIME_NS + 789;
+  fromEpoch = get_timestamp(ctx, &meta);
+  epochFromEpoch = get_timestamp(epochCtx, &meta);
+  legacyFromEpoch = get_timestamp(legacyCtx, &meta);
+
+  if (g_strcmp0(fromTs, isoTs) || g_strcmp0(fromEpoch, isoTs) ||
+      g_strcmp0(epochFromTs, epochTs) || g_strcmp0(epochFromEpoch, epochTs)) {
+    printf("unexpected @timestamp: %s %s %s %s\n", fromTs, fromEpoch,
+           epochFromTs, epochFromEpoch);
+    failed = -1;
+  }
+  if (g_strcmp0(legacyFromEpoch, "null")) {
+    printf("tsEpochNs read without ts-epoch-ns: %s\n", legacyFromEpoch);
+    failed = -1;
+  }
+
+done:
+  g_free(fromTs);
+  g_free(fromEpoch);
+  g_free(epochFromTs);
+  g_free(epochFromEpoch);
+  g_free(legacyFromEpoch);
+  if (ctx)
+    nvds_msg2p_ctx_destroy(ctx);
+  if (epochCtx)
+    nvds_msg2p_ctx_destroy(epochCtx);
+  if (legacyCtx)
+    nvds_msg2p_ctx_destroy(legacyCtx);
+
+  ctx = create_ctx(file, PROJECTION "timestamp-format=unix");
+  if (ctx) {
+    printf("unknown timestamp-format accepted\n");
+    nvds_msg2p_ctx_destroy(ctx);
+    failed = -1;
+  }
+  return failed;
+}
+
+int main(int argc, char *argv[])
+{
+  char file[] = "/tmp/nvmsgconv_timestamp_XXXXXX";
+  int fd = mkstemp(file);
+  GThread *threads[NUM_THREADS];
+  guint64 starts[NUM_THREADS];
+  char buf[64];
+  guint64 errors = 0;
+  guint64 t = nvds_get_epoch_ns();
+  gint64 start;
+  double strftimeNs;
+  double cachedNs;
+  int failed = 0;
+  int i;
+
+  if (fd < 0) {
+    printf("Unable to create configuration file\n");
+    return -1;
+  }
+  close(fd);
+
+  // epoch, now, far past and future, in different threads
+  starts[0] = 0;
+  starts[1] = t;
+  starts[2] = G_GUINT64_CONSTANT(946684799) * NVDS_NSEC_PER_SEC;
+  starts[3] = G_GUINT64_CONSTANT(4102444800) * NVDS_NSEC_PER_SEC;
+  for (i = 0; i < NUM_THREADS; i++)
+    threads[i] = g_thread_new("check", check_thread, &starts[i]);
+  for (i = 0; i < NUM_THREADS; i++)
+    errors += GPOINTER_TO_SIZE(g_thread_join(threads[i]));
+  if (errors) {
+    printf("%" G_GUINT64_FORMAT " timestamps differ\n", errors);
+    failed = -1;
+  }
+
+  start = g_get_monotonic_time();
+  for (i = 0; i < BENCH_COUNT; i++)
+    format_strftime(t + i * G_GUINT64_CONSTANT(10000), buf, sizeof(buf));
+  strftimeNs = (g_get_monotonic_time() - start) * 1000.0 / BENCH_COUNT;
+
+  start = g_get_monotonic_time();
+  for (i = 0; i < BENCH_COUNT; i++)
+    nvds_format_timestamp(t + i * G_GUINT64_CONSTANT(10000), buf);
+  cachedNs = (g_get_monotonic_time() - start) * 1000.0 / BENCH_COUNT;
+  printf("strftime %.1f ns, nvds_format_timestamp %.1f ns\n", strftimeNs,
+         cachedNs);
+
+  failed |= check_payload(file);
+
+  unlink(file);
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+  return failed ? -1 : 0;
+}